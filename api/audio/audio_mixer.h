@@ -11,6 +11,7 @@
 #ifndef API_AUDIO_AUDIO_MIXER_H_
 #define API_AUDIO_AUDIO_MIXER_H_
 
+#include <algorithm>
 #include <memory>
 
 #include "api/audio/audio_frame.h"
@@ -70,6 +71,23 @@ class AudioMixer : public rtc::RefCountInterface {
   virtual void Mix(size_t number_of_channels,
                    AudioFrame* audio_frame_for_mixing) = 0;
 
+  // Same as Mix(), but the mixed samples are written interleaved to
+  // |float_data| in the FloatS16 range, i.e. before they are rounded and
+  // saturated to 16 bits. |float_data| must hold
+  // AudioFrame::kMaxDataSizeSamples samples. The other fields of
+  // |audio_frame_for_mixing| are updated as by Mix(), but its samples are
+  // unspecified. The default implementation converts the result of Mix().
+  virtual void MixFloat(size_t number_of_channels,
+                        AudioFrame* audio_frame_for_mixing,
+                        float* float_data) {
+    Mix(number_of_channels, audio_frame_for_mixing);
+    const int16_t* data = audio_frame_for_mixing->data();
+    std::copy(data,
+              data + audio_frame_for_mixing->samples_per_channel_ *
+                         audio_frame_for_mixing->num_channels_,
+              float_data);
+  }
+
  protected:
   // Since the mixer is reference counted, the destructor may be
   // called from any thread.
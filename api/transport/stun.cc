@@ -40,6 +40,41 @@ uint32_t ReduceTransactionId(const std::string& transaction_id) {
   return result;
 }
 
+// Computes the MESSAGE-INTEGRITY value of the STUN message in |data|, whose
+// MESSAGE-INTEGRITY attribute of |mi_attr_size| bytes is at |mi_pos|, using
+// the procedure outlined in RFC 5389, section 15.4. The HMAC covers the
+// message up to that attribute, with the length in the header adjusted to
+// end with it. Only the header is copied to adjust the length; the rest of
+// the message is hashed in place.
+bool ComputeMessageIntegrity(const char* data,
+                             size_t mi_pos,
+                             size_t mi_attr_size,
+                             const std::string& password,
+                             char hmac[cricket::kStunMessageIntegritySize]) {
+  //      0                   1                   2                   3
+  //      0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+  //     +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  //     |0 0|     STUN Message Type     |         Message Length        |
+  //     +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  char header[cricket::kStunHeaderSize];
+  memcpy(header, data, sizeof(header));
+  rtc::SetBE16(header + 2, static_cast<uint16_t>(
+                               mi_pos + cricket::kStunAttributeHeaderSize +
+                               mi_attr_size - cricket::kStunHeaderSize));
+
+  std::unique_ptr<rtc::MessageDigest> digest(
+      rtc::MessageDigestFactory::Create(rtc::DIGEST_SHA_1));
+  if (!digest) {
+    return false;
+  }
+  size_t ret = rtc::ComputeHmacWithPrefix(
+      digest.get(), password.data(), password.size(), header, sizeof(header),
+      data + sizeof(header), mi_pos - sizeof(header), hmac,
+      cricket::kStunMessageIntegritySize);
+  RTC_DCHECK(ret == cricket::kStunMessageIntegritySize);
+  return ret == cricket::kStunMessageIntegritySize;
+}
+
 }  // namespace
 
 namespace cricket {
@@ -255,32 +290,9 @@ bool StunMessage::ValidateMessageIntegrityOfType(int mi_attr_type,
     return false;
   }
 
-  // Getting length of the message to calculate Message Integrity.
-  size_t mi_pos = current_pos;
-  std::unique_ptr<char[]> temp_data(new char[current_pos]);
-  memcpy(temp_data.get(), data, current_pos);
-  if (size > mi_pos + kStunAttributeHeaderSize + mi_attr_size) {
-    // Stun message has other attributes after message integrity.
-    // Adjust the length parameter in stun message to calculate HMAC.
-    size_t extra_offset =
-        size - (mi_pos + kStunAttributeHeaderSize + mi_attr_size);
-    size_t new_adjusted_len = size - extra_offset - kStunHeaderSize;
-
-    // Writing new length of the STUN message @ Message Length in temp buffer.
-    //      0                   1                   2                   3
-    //      0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
-    //     +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
-    //     |0 0|     STUN Message Type     |         Message Length        |
-    //     +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
-    rtc::SetBE16(temp_data.get() + 2, static_cast<uint16_t>(new_adjusted_len));
-  }
-
   char hmac[kStunMessageIntegritySize];
-  size_t ret =
-      rtc::ComputeHmac(rtc::DIGEST_SHA_1, password.c_str(), password.size(),
-                       temp_data.get(), mi_pos, hmac, sizeof(hmac));
-  RTC_DCHECK(ret == sizeof(hmac));
-  if (ret != sizeof(hmac)) {
+  if (!ComputeMessageIntegrity(data, current_pos, mi_attr_size, password,
+                               hmac)) {
     return false;
   }
 
@@ -617,6 +629,159 @@ bool StunMessage::EqualAttributes(
   return true;
 }
 
+// StunMessageView
+
+StunMessageView::StunMessageView()
+    : data_(nullptr),
+      size_(0),
+      message_integrity_offset_(0),
+      message_integrity32_offset_(0),
+      fingerprint_offset_(0) {}
+
+bool StunMessageView::Parse(const char* data, size_t size) {
+  data_ = nullptr;
+  size_ = 0;
+  message_integrity_offset_ = 0;
+  message_integrity32_offset_ = 0;
+  fingerprint_offset_ = 0;
+
+  if (size < kStunHeaderSize || size % 4 != 0) {
+    return false;
+  }
+  // RTP and RTCP packets have the MSB of the first byte set.
+  if (rtc::GetBE16(data) & 0x8000) {
+    return false;
+  }
+  if (rtc::GetBE16(data + 2) + kStunHeaderSize != size) {
+    return false;
+  }
+
+  size_t offset = kStunHeaderSize;
+  size_t last_offset = 0;
+  while (offset < size) {
+    if (offset + kStunAttributeHeaderSize > size) {
+      return false;
+    }
+    uint16_t attr_type = rtc::GetBE16(data + offset);
+    size_t attr_length = rtc::GetBE16(data + offset + 2);
+    size_t padded_length = (attr_length + 3) & ~static_cast<size_t>(3);
+    if (offset + kStunAttributeHeaderSize + padded_length > size) {
+      return false;
+    }
+    if (attr_type == STUN_ATTR_MESSAGE_INTEGRITY &&
+        message_integrity_offset_ == 0) {
+      message_integrity_offset_ = offset;
+    } else if (attr_type == STUN_ATTR_GOOG_MESSAGE_INTEGRITY_32 &&
+               message_integrity32_offset_ == 0) {
+      message_integrity32_offset_ = offset;
+    }
+    last_offset = offset;
+    offset += kStunAttributeHeaderSize + padded_length;
+  }
+
+  if (last_offset != 0 &&
+      rtc::GetBE16(data + last_offset) == STUN_ATTR_FINGERPRINT &&
+      rtc::GetBE16(data + last_offset + 2) == StunUInt32Attribute::SIZE) {
+    fingerprint_offset_ = last_offset;
+  }
+  data_ = data;
+  size_ = size;
+  return true;
+}
+
+int StunMessageView::type() const {
+  RTC_DCHECK(data_);
+  return rtc::GetBE16(data_);
+}
+
+size_t StunMessageView::length() const {
+  RTC_DCHECK(data_);
+  return size_ - kStunHeaderSize;
+}
+
+absl::string_view StunMessageView::transaction_id() const {
+  RTC_DCHECK(data_);
+  if (HasMagicCookie()) {
+    return absl::string_view(data_ + kStunTransactionIdOffset,
+                             kStunTransactionIdLength);
+  }
+  return absl::string_view(
+      data_ + kStunTransactionIdOffset - kStunMagicCookieLength,
+      kStunLegacyTransactionIdLength);
+}
+
+bool StunMessageView::HasMagicCookie() const {
+  RTC_DCHECK(data_);
+  return rtc::GetBE32(data_ + kStunTransactionIdOffset -
+                      kStunMagicCookieLength) == kStunMagicCookie;
+}
+
+bool StunMessageView::GetAttribute(int type, absl::string_view* value) const {
+  RTC_DCHECK(data_);
+  // Parse() has checked that the attributes fill the message.
+  size_t offset = kStunHeaderSize;
+  while (offset < size_) {
+    uint16_t attr_type = rtc::GetBE16(data_ + offset);
+    size_t attr_length = rtc::GetBE16(data_ + offset + 2);
+    if (attr_type == type) {
+      *value = absl::string_view(data_ + offset + kStunAttributeHeaderSize,
+                                 attr_length);
+      return true;
+    }
+    offset += kStunAttributeHeaderSize +
+              ((attr_length + 3) & ~static_cast<size_t>(3));
+  }
+  return false;
+}
+
+// Verifies a message is in fact a STUN message, by performing the checks
+// outlined in RFC 5389, section 7.3, including the FINGERPRINT check detailed
+// in section 15.5.
+bool StunMessageView::ValidateFingerprint() const {
+  RTC_DCHECK(data_);
+  if (fingerprint_offset_ == 0 || !HasMagicCookie()) {
+    return false;
+  }
+  uint32_t fingerprint =
+      rtc::GetBE32(data_ + fingerprint_offset_ + kStunAttributeHeaderSize);
+  return ((fingerprint ^ STUN_FINGERPRINT_XOR_VALUE) ==
+          rtc::ComputeCrc32(data_, fingerprint_offset_));
+}
+
+bool StunMessageView::ValidateMessageIntegrity(
+    const std::string& password) const {
+  return ValidateMessageIntegrityAt(message_integrity_offset_,
+                                    kStunMessageIntegritySize, password);
+}
+
+bool StunMessageView::ValidateMessageIntegrity32(
+    const std::string& password) const {
+  return ValidateMessageIntegrityAt(message_integrity32_offset_,
+                                    kStunMessageIntegrity32Size, password);
+}
+
+// Verifies a STUN message has a valid MESSAGE-INTEGRITY attribute, using the
+// procedure outlined in RFC 5389, section 15.4.
+bool StunMessageView::ValidateMessageIntegrityAt(
+    size_t offset,
+    size_t mi_attr_size,
+    const std::string& password) const {
+  RTC_DCHECK(data_);
+  RTC_DCHECK(mi_attr_size <= kStunMessageIntegritySize);
+  if (offset == 0 || rtc::GetBE16(data_ + offset + 2) != mi_attr_size) {
+    return false;
+  }
+
+  char hmac[kStunMessageIntegritySize];
+  if (!ComputeMessageIntegrity(data_, offset, mi_attr_size, password, hmac)) {
+    return false;
+  }
+
+  // Comparing the calculated HMAC with the one present in the message.
+  return memcmp(data_ + offset + kStunAttributeHeaderSize, hmac,
+                mi_attr_size) == 0;
+}
+
 // StunAttribute
 
 StunAttribute::StunAttribute(uint16_t type, uint16_t length)
@@ -21,6 +21,7 @@
 #include <string>
 #include <vector>
 
+#include "absl/strings/string_view.h"
 #include "rtc_base/byte_buffer.h"
 #include "rtc_base/ip_address.h"
 #include "rtc_base/socket_address.h"
@@ -266,6 +267,53 @@ class StunMessage {
   uint32_t stun_magic_cookie_;
 };
 
+// A STUN message in a buffer owned by the caller, which must outlive the view.
+// Unlike StunMessage::Read(), Parse() neither allocates nor copies anything: it
+// checks the framing of the message and remembers where the attributes that
+// authenticate it are. Attribute values are returned as views into the
+// buffer. This lets connectivity checks be validated in place, while
+// StunMessage remains the interface for creating and inspecting messages.
+class StunMessageView {
+ public:
+  StunMessageView();
+
+  // Returns true if |data| holds a single STUN message whose length matches
+  // |size| and whose attributes, padding included, exactly fill it. The
+  // attribute values are not checked.
+  bool Parse(const char* data, size_t size);
+
+  int type() const;
+  size_t length() const;
+  // Returns the transaction ID. As with StunMessage, it includes the magic
+  // cookie field if the message has no magic cookie (RFC 3489).
+  absl::string_view transaction_id() const;
+  bool HasMagicCookie() const;
+
+  // Sets |value| to the value, without padding, of the first attribute of
+  // |type| and returns true, or returns false if there is no such attribute.
+  bool GetAttribute(int type, absl::string_view* value) const;
+
+  // Like the static StunMessage methods of the same names, but without
+  // searching for the attributes again.
+  bool ValidateFingerprint() const;
+  bool ValidateMessageIntegrity(const std::string& password) const;
+  bool ValidateMessageIntegrity32(const std::string& password) const;
+
+ private:
+  bool ValidateMessageIntegrityAt(size_t offset,
+                                  size_t mi_attr_size,
+                                  const std::string& password) const;
+
+  const char* data_;
+  size_t size_;
+  // Offsets of the first MESSAGE-INTEGRITY and GOOG-MESSAGE-INTEGRITY-32
+  // attributes, and of the FINGERPRINT attribute if it is the last one, or 0
+  // if there is no such attribute.
+  size_t message_integrity_offset_;
+  size_t message_integrity32_offset_;
+  size_t fingerprint_offset_;
+};
+
 // Base class for all STUN/TURN attributes.
 class StunAttribute {
  public:
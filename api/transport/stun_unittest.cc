@@ -1368,6 +1368,63 @@ TEST_F(StunTest, ValidateMessageIntegrity32) {
   }
 }
 
+TEST_F(StunTest, ParseMessageView) {
+  StunMessageView view;
+  ASSERT_TRUE(view.Parse(reinterpret_cast<const char*>(kRfc5769SampleRequest),
+                         sizeof(kRfc5769SampleRequest)));
+  EXPECT_EQ(STUN_BINDING_REQUEST, view.type());
+  EXPECT_EQ(sizeof(kRfc5769SampleRequest) - kStunHeaderSize, view.length());
+  EXPECT_TRUE(view.HasMagicCookie());
+  EXPECT_EQ(absl::string_view(
+                reinterpret_cast<const char*>(kRfc5769SampleMsgTransactionId),
+                kStunTransactionIdLength),
+            view.transaction_id());
+
+  absl::string_view value;
+  ASSERT_TRUE(view.GetAttribute(STUN_ATTR_USERNAME, &value));
+  EXPECT_EQ(kRfc5769SampleMsgUsername, value);
+  ASSERT_TRUE(view.GetAttribute(STUN_ATTR_SOFTWARE, &value));
+  EXPECT_EQ(kRfc5769SampleMsgClientSoftware, value);
+  EXPECT_FALSE(view.GetAttribute(STUN_ATTR_ERROR_CODE, &value));
+
+  EXPECT_TRUE(view.ValidateFingerprint());
+  EXPECT_TRUE(view.ValidateMessageIntegrity(kRfc5769SampleMsgPassword));
+  EXPECT_FALSE(view.ValidateMessageIntegrity("InvalidPassword"));
+  EXPECT_FALSE(view.ValidateMessageIntegrity32(kRfc5769SampleMsgPassword));
+}
+
+TEST_F(StunTest, ParseMessageViewWithoutMagicCookie) {
+  unsigned char rfc3489_packet[sizeof(kStunMessageWithIPv4MappedAddress)];
+  memcpy(rfc3489_packet, kStunMessageWithIPv4MappedAddress,
+         sizeof(kStunMessageWithIPv4MappedAddress));
+  memcpy(&rfc3489_packet[4], "ABCD", 4);
+
+  StunMessageView view;
+  ASSERT_TRUE(view.Parse(reinterpret_cast<const char*>(rfc3489_packet),
+                         sizeof(rfc3489_packet)));
+  EXPECT_FALSE(view.HasMagicCookie());
+  EXPECT_EQ(absl::string_view(reinterpret_cast<const char*>(&rfc3489_packet[4]),
+                              kStunLegacyTransactionIdLength),
+            view.transaction_id());
+  EXPECT_FALSE(view.ValidateFingerprint());
+}
+
+TEST_F(StunTest, FailToParseMessageView) {
+  StunMessageView view;
+  EXPECT_FALSE(view.Parse(reinterpret_cast<const char*>(kRtcpPacket),
+                          sizeof(kRtcpPacket)));
+  EXPECT_FALSE(
+      view.Parse(reinterpret_cast<const char*>(kStunMessageWithExcessLength),
+                 sizeof(kStunMessageWithExcessLength)));
+  EXPECT_FALSE(
+      view.Parse(reinterpret_cast<const char*>(kStunMessageWithSmallLength),
+                 sizeof(kStunMessageWithSmallLength)));
+  // The length in the header matches, but the last attribute overruns it.
+  EXPECT_FALSE(
+      view.Parse(reinterpret_cast<const char*>(kStunMessageWithBadHmacAtEnd),
+                 sizeof(kStunMessageWithBadHmacAtEnd)));
+}
+
 // Validate that we generate correct MESSAGE-INTEGRITY-32 attributes.
 TEST_F(StunTest, AddMessageIntegrity32) {
   IceMessage msg;
@@ -10,6 +10,7 @@
 
 #include "audio/audio_state.h"
 
+#include <algorithm>
 #include <memory>
 #include <vector>
 
@@ -242,5 +243,52 @@ TEST(AudioStateTest,
       kSampleRate / 100, kNumberOfChannels * 2, kNumberOfChannels, kSampleRate,
       audio_buffer, n_samples_out, &elapsed_time_ms, &ntp_time_ms);
 }
+
+TEST(AudioStateTest, FloatRenderPathProcessesMixInFloat) {
+  ConfigHelper helper;
+  helper.config().use_float_render_path = true;
+  auto audio_state = AudioState::Create(helper.config());
+
+  FakeAudioSource fake_source;
+  helper.mixer()->AddSource(&fake_source);
+
+  EXPECT_CALL(fake_source, GetAudioFrameWithInfo(::testing::_, ::testing::_))
+      .WillRepeatedly(
+          ::testing::Invoke([](int sample_rate_hz, AudioFrame* audio_frame) {
+            audio_frame->sample_rate_hz_ = sample_rate_hz;
+            audio_frame->samples_per_channel_ = sample_rate_hz / 100;
+            audio_frame->num_channels_ = kNumberOfChannels;
+            int16_t* data = audio_frame->mutable_data();
+            std::fill(data, data + sample_rate_hz / 100 * kNumberOfChannels,
+                      1000);
+            return AudioMixer::Source::AudioFrameInfo::kNormal;
+          }));
+  MockAudioProcessing* ap =
+      static_cast<MockAudioProcessing*>(audio_state->audio_processing());
+  EXPECT_CALL(*ap, ProcessReverseStream(::testing::Matcher<AudioFrame*>(
+                       ::testing::_)))
+      .Times(0);
+  EXPECT_CALL(*ap, ProcessReverseStream(::testing::_, ::testing::_,
+                                        ::testing::_, ::testing::_))
+      .Times(2)
+      .WillRepeatedly(::testing::Return(AudioProcessing::kNoError));
+
+  int16_t audio_buffer[kSampleRate / 100 * kNumberOfChannels];
+  size_t n_samples_out;
+  int64_t elapsed_time_ms;
+  int64_t ntp_time_ms;
+  // The second call is compared, after the source is ramped in.
+  for (int i = 0; i < 2; ++i) {
+    audio_state->audio_transport()->NeedMorePlayData(
+        kSampleRate / 100, kNumberOfChannels * 2, kNumberOfChannels,
+        kSampleRate, audio_buffer, n_samples_out, &elapsed_time_ms,
+        &ntp_time_ms);
+  }
+  EXPECT_EQ(static_cast<size_t>(kSampleRate / 100 * kNumberOfChannels),
+            n_samples_out);
+  for (int16_t sample : audio_buffer) {
+    EXPECT_EQ(1000, sample);
+  }
+}
 }  // namespace test
 }  // namespace webrtc
@@ -20,6 +20,7 @@
 #include "audio/remix_resample.h"
 #include "audio/utility/audio_frame_operations.h"
 #include "call/audio_sender.h"
+#include "common_audio/include/audio_util.h"
 #include "rtc_base/checks.h"
 
 namespace webrtc {
@@ -83,8 +84,10 @@ int Resample(const AudioFrame& frame,
 }  // namespace
 
 AudioTransportImpl::AudioTransportImpl(AudioMixer* mixer,
-                                       AudioProcessing* audio_processing)
+                                       AudioProcessing* audio_processing,
+                                       bool use_float_render_path)
     : audio_processing_(audio_processing), mixer_(mixer),
+      use_float_render_path_(use_float_render_path),
       pre_deliver_callback_(nullptr),
       pre_deliver_callback_opaque_(nullptr) {
   RTC_DCHECK(mixer);
@@ -253,6 +256,16 @@ int32_t AudioTransportImpl::NeedMorePlayData(const size_t nSamples,
   RTC_DCHECK_LE(nBytesPerSample * nSamples * nChannels,
                 AudioFrame::kMaxDataSizeBytes);
 
+  if (use_float_render_path_) {
+    nSamplesOut = RenderFloat(samplesPerSec, nChannels,
+                              /*process_reverse_stream=*/true,
+                              static_cast<int16_t*>(audioSamples));
+    *elapsed_time_ms = mixed_frame_.elapsed_time_ms_;
+    *ntp_time_ms = mixed_frame_.ntp_time_ms_;
+    RTC_DCHECK_EQ(nSamplesOut, nChannels * nSamples);
+    return 0;
+  }
+
   mixer_->Mix(nChannels, &mixed_frame_);
   *elapsed_time_ms = mixed_frame_.elapsed_time_ms_;
   *ntp_time_ms = mixed_frame_.ntp_time_ms_;
@@ -285,6 +298,16 @@ void AudioTransportImpl::PullRenderData(int bits_per_sample,
   // 8 = bits per byte.
   RTC_DCHECK_LE(bits_per_sample / 8 * number_of_frames * number_of_channels,
                 AudioFrame::kMaxDataSizeBytes);
+  if (use_float_render_path_) {
+    auto output_samples = RenderFloat(sample_rate, number_of_channels,
+                                      /*process_reverse_stream=*/false,
+                                      static_cast<int16_t*>(audio_data));
+    *elapsed_time_ms = mixed_frame_.elapsed_time_ms_;
+    *ntp_time_ms = mixed_frame_.ntp_time_ms_;
+    RTC_DCHECK_EQ(output_samples, number_of_channels * number_of_frames);
+    return;
+  }
+
   mixer_->Mix(number_of_channels, &mixed_frame_);
   *elapsed_time_ms = mixed_frame_.elapsed_time_ms_;
   *ntp_time_ms = mixed_frame_.ntp_time_ms_;
@@ -294,6 +317,56 @@ void AudioTransportImpl::PullRenderData(int bits_per_sample,
   RTC_DCHECK_EQ(output_samples, number_of_channels * number_of_frames);
 }
 
+size_t AudioTransportImpl::RenderFloat(int sample_rate,
+                                       size_t number_of_channels,
+                                       bool process_reverse_stream,
+                                       int16_t* destination) {
+  mixer_->MixFloat(number_of_channels, &mixed_frame_, render_mix_.data());
+  const int mix_sample_rate = mixed_frame_.sample_rate_hz_;
+  const size_t samples_per_channel = mixed_frame_.samples_per_channel_;
+  const size_t mix_size = samples_per_channel * number_of_channels;
+  RTC_DCHECK_LE(mix_size, render_mix_.size());
+
+  if (process_reverse_stream) {
+    if (!render_channels_ ||
+        render_channels_->num_frames() != samples_per_channel ||
+        render_channels_->num_channels() != number_of_channels) {
+      render_channels_.reset(
+          new ChannelBuffer<float>(samples_per_channel, number_of_channels));
+    }
+    float* const* channels = render_channels_->channels();
+    // The float interface of the AudioProcessing module takes samples in
+    // [-1, 1], deinterleaved.
+    Deinterleave(render_mix_.data(), samples_per_channel, number_of_channels,
+                 channels);
+    for (size_t i = 0; i < number_of_channels; ++i) {
+      FloatS16ToFloat(channels[i], samples_per_channel, channels[i]);
+    }
+    const StreamConfig config(mix_sample_rate, number_of_channels);
+    const auto error = audio_processing_->ProcessReverseStream(
+        channels, config, config, channels);
+    RTC_DCHECK_EQ(error, AudioProcessing::kNoError);
+    for (size_t i = 0; i < number_of_channels; ++i) {
+      FloatToFloatS16(channels[i], samples_per_channel, channels[i]);
+    }
+    Interleave(channels, samples_per_channel, number_of_channels,
+               render_mix_.data());
+  }
+
+  if (mix_sample_rate == sample_rate) {
+    FloatS16ToS16(render_mix_.data(), mix_size, destination);
+    return mix_size;
+  }
+  render_float_resampler_.InitializeIfNeeded(
+      mix_sample_rate, sample_rate, static_cast<int>(number_of_channels));
+  const int output_size = render_float_resampler_.Resample(
+      render_mix_.data(), mix_size, render_resampled_.data(),
+      number_of_channels * (sample_rate / 100));
+  RTC_DCHECK_GE(output_size, 0);
+  FloatS16ToS16(render_resampled_.data(), output_size, destination);
+  return output_size;
+}
+
 void AudioTransportImpl::UpdateAudioSenders(std::vector<AudioSender*> senders,
                                             int send_sample_rate_hz,
                                             size_t send_num_channels) {
@@ -11,10 +11,13 @@
 #ifndef AUDIO_AUDIO_TRANSPORT_IMPL_H_
 #define AUDIO_AUDIO_TRANSPORT_IMPL_H_
 
+#include <array>
+#include <memory>
 #include <vector>
 
 #include "api/audio/audio_mixer.h"
 #include "api/scoped_refptr.h"
+#include "common_audio/channel_buffer.h"
 #include "common_audio/resampler/include/push_resampler.h"
 #include "modules/audio_device/include/audio_device.h"
 #include "modules/audio_processing/include/audio_processing.h"
@@ -36,7 +39,12 @@ class AudioTransportImpl : public AudioTransport {
       const size_t nBytesPerSample, const size_t nChannels,
       const uint32_t samplesPerSec);
 
-  AudioTransportImpl(AudioMixer* mixer, AudioProcessing* audio_processing);
+  // If |use_float_render_path| is true, the render side keeps the mixed audio
+  // in float through the AudioProcessing module and the resampler, and
+  // rounds it to 16 bits only once, when writing the device buffer.
+  AudioTransportImpl(AudioMixer* mixer,
+                     AudioProcessing* audio_processing,
+                     bool use_float_render_path);
   ~AudioTransportImpl() override;
 
   int32_t RecordedDataIsAvailable(const void* audioSamples,
@@ -83,6 +91,15 @@ class AudioTransportImpl : public AudioTransport {
   }
 
  private:
+  // Mixes |number_of_channels| channels with the float render path, passes
+  // the mix to the AudioProcessing module if |process_reverse_stream| is true
+  // and writes it to |destination| at |sample_rate|. Returns the number of
+  // samples written.
+  size_t RenderFloat(int sample_rate,
+                     size_t number_of_channels,
+                     bool process_reverse_stream,
+                     int16_t* destination);
+
   // Shared.
   AudioProcessing* audio_processing_ = nullptr;
 
@@ -101,6 +118,12 @@ class AudioTransportImpl : public AudioTransport {
   AudioFrame mixed_frame_;
   // Converts mixed audio to the audio device output rate.
   PushResampler<int16_t> render_resampler_;
+  // Used instead of |render_resampler_| by the float render path.
+  const bool use_float_render_path_;
+  std::array<float, AudioFrame::kMaxDataSizeSamples> render_mix_;
+  std::array<float, AudioFrame::kMaxDataSizeSamples> render_resampled_;
+  std::unique_ptr<ChannelBuffer<float>> render_channels_;
+  PushResampler<float> render_float_resampler_;
 
   PreDeliverRecordedDataCallback pre_deliver_callback_;
   void* pre_deliver_callback_opaque_;
@@ -37,6 +37,11 @@ class AudioState : public rtc::RefCountInterface {
 
     // TODO(solenberg): Temporary: audio device module.
     rtc::scoped_refptr<webrtc::AudioDeviceModule> audio_device_module;
+
+    // If true, the played out audio is kept in float from the mixer to the
+    // audio device buffer, instead of being rounded to 16 bits after mixing
+    // and again after the AudioProcessing module and the resampler.
+    bool use_float_render_path = false;
   };
 
   virtual AudioProcessing* audio_processing() = 0;
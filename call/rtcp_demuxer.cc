@@ -37,6 +37,7 @@ void RtcpDemuxer::AddSink(uint32_t sender_ssrc, RtcpPacketSinkInterface* sink) {
   RTC_DCHECK(!ContainerHasKey(broadcast_sinks_, sink));
   RTC_DCHECK(!MultimapAssociationExists(ssrc_sinks_, sender_ssrc, sink));
   ssrc_sinks_.emplace(sender_ssrc, sink);
+  UpdateSsrcSinkTable();
 }
 
 void RtcpDemuxer::AddSink(const std::string& rsid,
@@ -61,6 +62,7 @@ void RtcpDemuxer::RemoveSink(const RtcpPacketSinkInterface* sink) {
   size_t removal_count = RemoveFromMultimapByValue(&ssrc_sinks_, sink) +
                          RemoveFromMultimapByValue(&rsid_sinks_, sink);
   RTC_DCHECK_GT(removal_count, 0);
+  UpdateSsrcSinkTable();
 }
 
 void RtcpDemuxer::RemoveBroadcastSink(const RtcpPacketSinkInterface* sink) {
@@ -74,9 +76,12 @@ void RtcpDemuxer::OnRtcpPacket(rtc::ArrayView<const uint8_t> packet) {
   // Perform sender-SSRC-based demuxing for packets with a sender-SSRC.
   absl::optional<uint32_t> sender_ssrc = ParseRtcpPacketSenderSsrc(packet);
   if (sender_ssrc) {
-    auto it_range = ssrc_sinks_.equal_range(*sender_ssrc);
-    for (auto it = it_range.first; it != it_range.second; ++it) {
-      it->second->OnRtcpPacket(packet);
+    const std::vector<RtcpPacketSinkInterface*>* sinks =
+        ssrc_sink_table_.Find(*sender_ssrc);
+    if (sinks) {
+      for (RtcpPacketSinkInterface* sink : *sinks) {
+        sink->OnRtcpPacket(packet);
+      }
     }
   }
 
@@ -104,4 +109,12 @@ void RtcpDemuxer::OnSsrcBoundToRsid(const std::string& rsid, uint32_t ssrc) {
   rsid_sinks_.erase(it_range.first, it_range.second);
 }
 
+void RtcpDemuxer::UpdateSsrcSinkTable() {
+  ssrc_sink_table_.Clear();
+  for (const auto& ssrc_and_sink : ssrc_sinks_) {
+    ssrc_sink_table_.GetOrInsert(ssrc_and_sink.first)
+        .push_back(ssrc_and_sink.second);
+  }
+}
+
 }  // namespace webrtc
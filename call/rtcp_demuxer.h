@@ -17,6 +17,7 @@
 
 #include "api/array_view.h"
 #include "call/ssrc_binding_observer.h"
+#include "modules/rtp_rtcp/source/ssrc_table.h"
 
 namespace webrtc {
 
@@ -67,9 +68,16 @@ class RtcpDemuxer : public SsrcBindingObserver {
   // like in the RtpDemuxer case, once the relevant standard is finalized.
 
  private:
+  // Rebuilds |ssrc_sink_table_| from |ssrc_sinks_|.
+  void UpdateSsrcSinkTable();
+
   // Records the association SSRCs to sinks.
   std::multimap<uint32_t, RtcpPacketSinkInterface*> ssrc_sinks_;
 
+  // Copy of |ssrc_sinks_| in a flat hash table, used for the per-packet
+  // lookup in OnRtcpPacket(). Rebuilt whenever |ssrc_sinks_| changes.
+  SsrcTable<std::vector<RtcpPacketSinkInterface*>> ssrc_sink_table_;
+
   // Records the association RSIDs to sinks.
   std::multimap<std::string, RtcpPacketSinkInterface*> rsid_sinks_;
 
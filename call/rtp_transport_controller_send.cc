@@ -77,7 +77,10 @@ RtpTransportControllerSend::RtpTransportControllerSend(
       bitrate_configurator_(bitrate_config),
       process_thread_(std::move(process_thread)),
       use_task_queue_pacer_(IsEnabled(trials, "WebRTC-TaskQueuePacer")),
-      process_thread_pacer_(use_task_queue_pacer_
+      use_high_resolution_pacer_(
+          !use_task_queue_pacer_ &&
+          IsEnabled(trials, "WebRTC-HighResolutionPacer")),
+      process_thread_pacer_(use_task_queue_pacer_ || use_high_resolution_pacer_
                                 ? nullptr
                                 : new PacedSender(clock,
                                                   &packet_router_,
@@ -91,6 +94,14 @@ RtpTransportControllerSend::RtpTransportControllerSend(
                                                        trials,
                                                        task_queue_factory)
                             : nullptr),
+      high_resolution_pacer_(
+          use_high_resolution_pacer_
+              ? new HighResolutionPacedSender(clock,
+                                              &packet_router_,
+                                              event_log,
+                                              trials,
+                                              task_queue_factory)
+              : nullptr),
       observer_(nullptr),
       controller_factory_override_(controller_factory),
       controller_factory_fallback_(
@@ -117,13 +128,13 @@ RtpTransportControllerSend::RtpTransportControllerSend(
   pacer()->SetPacingRates(DataRate::bps(bitrate_config.start_bitrate_bps),
                           DataRate::Zero());
 
-  if (!use_task_queue_pacer_) {
+  if (process_thread_pacer_) {
     process_thread_->Start();
   }
 }
 
 RtpTransportControllerSend::~RtpTransportControllerSend() {
-  if (!use_task_queue_pacer_) {
+  if (process_thread_pacer_) {
     process_thread_->Stop();
   }
 }
@@ -176,6 +187,9 @@ RtpPacketPacer* RtpTransportControllerSend::pacer() {
   if (use_task_queue_pacer_) {
     return task_queue_pacer_.get();
   }
+  if (use_high_resolution_pacer_) {
+    return high_resolution_pacer_.get();
+  }
   return process_thread_pacer_.get();
 }
 
@@ -183,6 +197,9 @@ const RtpPacketPacer* RtpTransportControllerSend::pacer() const {
   if (use_task_queue_pacer_) {
     return task_queue_pacer_.get();
   }
+  if (use_high_resolution_pacer_) {
+    return high_resolution_pacer_.get();
+  }
   return process_thread_pacer_.get();
 }
 
@@ -208,6 +225,9 @@ RtpPacketSender* RtpTransportControllerSend::packet_sender() {
   if (use_task_queue_pacer_) {
     return task_queue_pacer_.get();
   }
+  if (use_high_resolution_pacer_) {
+    return high_resolution_pacer_.get();
+  }
   return process_thread_pacer_.get();
 }
 
@@ -441,6 +461,11 @@ void RtpTransportControllerSend::IncludeOverheadInPacedSender() {
   pacer()->SetIncludeOverhead();
 }
 
+void RtpTransportControllerSend::SetStreamWeightInPacedSender(uint32_t ssrc,
+                                                              double weight) {
+  pacer()->SetStreamWeight(ssrc, weight);
+}
+
 void RtpTransportControllerSend::OnReceivedEstimatedBitrate(uint32_t bitrate) {
   RemoteBitrateReport msg;
   msg.receive_time = Timestamp::ms(clock_->TimeInMilliseconds());
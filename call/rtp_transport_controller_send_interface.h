@@ -151,6 +151,9 @@ class RtpTransportControllerSendInterface {
 
   virtual void AccountForAudioPacketsInPacedSender(bool account_for_audio) = 0;
   virtual void IncludeOverheadInPacedSender() = 0;
+  // Sets the share of the pacing rate given to the stream with the given
+  // SSRC, relative to other streams of the same priority. Defaults to 1.0.
+  virtual void SetStreamWeightInPacedSender(uint32_t ssrc, double weight) = 0;
 };
 
 }  // namespace webrtc
@@ -0,0 +1,171 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "call/rtcp_demuxer.h"
+#include "call/rtcp_packet_sink_interface.h"
+#include "modules/pacing/packet_router.h"
+#include "modules/rtp_rtcp/mocks/mock_rtp_rtcp.h"
+#include "modules/rtp_rtcp/source/rtcp_packet/receiver_report.h"
+#include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
+#include "rtc_base/buffer.h"
+#include "rtc_base/time_utils.h"
+#include "test/gmock.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace {
+
+using ::testing::NiceMock;
+
+constexpr uint32_t kFirstSsrc = 1234;
+// SSRCs are random in practice, spread them out over the SSRC space.
+constexpr uint32_t kSsrcStep = 0x9e3779b1;
+constexpr int kPacketsPerBatch = 10000;
+constexpr int kNumBatches = 100;
+constexpr int kNumStreams[] = {1, 10, 100};
+
+uint32_t StreamSsrc(int stream_index) {
+  return kFirstSsrc + kSsrcStep * static_cast<uint32_t>(stream_index);
+}
+
+// RTP module that accepts every packet without doing any work, so that the
+// measurement only covers the routing in PacketRouter.
+class AcceptingRtpRtcp : public NiceMock<MockRtpRtcp> {
+ public:
+  explicit AcceptingRtpRtcp(uint32_t ssrc) : ssrc_(ssrc) {}
+
+  uint32_t SSRC() const override { return ssrc_; }
+  absl::optional<uint32_t> RtxSsrc() const override { return absl::nullopt; }
+  absl::optional<uint32_t> FlexfecSsrc() const override {
+    return absl::nullopt;
+  }
+  bool IsAudioConfigured() const override { return false; }
+  bool SupportsRtxPayloadPadding() const override { return false; }
+  bool TrySendPacket(RtpPacketToSend* packet,
+                     const PacedPacketInfo& pacing_info) override {
+    ++packets_sent_;
+    return true;
+  }
+
+  int packets_sent() const { return packets_sent_; }
+
+ private:
+  const uint32_t ssrc_;
+  int packets_sent_ = 0;
+};
+
+class CountingRtcpSink : public RtcpPacketSinkInterface {
+ public:
+  void OnRtcpPacket(rtc::ArrayView<const uint8_t> packet) override {
+    ++packets_received_;
+  }
+
+  int packets_received() const { return packets_received_; }
+
+ private:
+  int packets_received_ = 0;
+};
+
+// Returns the average time, in nanoseconds, PacketRouter::SendPacket() takes
+// when packets are sent round robin over |num_streams| streams.
+double MeasurePacketRouterSendCostNs(int num_streams) {
+  PacketRouter packet_router;
+  std::vector<std::unique_ptr<AcceptingRtpRtcp>> modules;
+  for (int i = 0; i < num_streams; ++i) {
+    modules.push_back(std::make_unique<AcceptingRtpRtcp>(StreamSsrc(i)));
+    packet_router.AddSendRtpModule(modules.back().get(),
+                                   /*remb_candidate=*/false);
+  }
+
+  // Packets are created ahead of each timed batch, so that allocating them
+  // is not part of the measurement.
+  int64_t elapsed_us = 0;
+  std::vector<std::unique_ptr<RtpPacketToSend>> packets(kPacketsPerBatch);
+  for (int batch = 0; batch < kNumBatches; ++batch) {
+    for (int i = 0; i < kPacketsPerBatch; ++i) {
+      packets[i] = std::make_unique<RtpPacketToSend>(nullptr);
+      packets[i]->SetSsrc(StreamSsrc(i % num_streams));
+    }
+    const int64_t start_time_us = rtc::TimeMicros();
+    for (auto& packet : packets) {
+      packet_router.SendPacket(std::move(packet), PacedPacketInfo());
+    }
+    elapsed_us += rtc::TimeMicros() - start_time_us;
+  }
+
+  int packets_sent = 0;
+  for (auto& module : modules) {
+    packets_sent += module->packets_sent();
+    packet_router.RemoveSendRtpModule(module.get());
+  }
+  EXPECT_EQ(packets_sent, kPacketsPerBatch * kNumBatches);
+  return 1000.0 * elapsed_us / packets_sent;
+}
+
+// Returns the average time, in nanoseconds, RtcpDemuxer::OnRtcpPacket() takes
+// when receiver reports from |num_streams| streams arrive round robin.
+double MeasureRtcpDemuxerCostNs(int num_streams) {
+  RtcpDemuxer demuxer;
+  std::vector<CountingRtcpSink> sinks(num_streams);
+  std::vector<rtc::Buffer> rtcp_packets;
+  for (int i = 0; i < num_streams; ++i) {
+    demuxer.AddSink(StreamSsrc(i), &sinks[i]);
+    rtcp::ReceiverReport receiver_report;
+    receiver_report.SetSenderSsrc(StreamSsrc(i));
+    rtcp_packets.push_back(receiver_report.Build());
+  }
+
+  const int num_packets = kPacketsPerBatch * kNumBatches;
+  const int64_t start_time_us = rtc::TimeMicros();
+  for (int i = 0; i < num_packets; ++i) {
+    demuxer.OnRtcpPacket(rtcp_packets[i % num_streams]);
+  }
+  const int64_t elapsed_us = rtc::TimeMicros() - start_time_us;
+
+  int packets_received = 0;
+  for (CountingRtcpSink& sink : sinks) {
+    packets_received += sink.packets_received();
+    demuxer.RemoveSink(&sink);
+  }
+  EXPECT_EQ(packets_received, num_packets);
+  return 1000.0 * elapsed_us / num_packets;
+}
+
+}  // namespace
+
+TEST(SsrcRoutingPerfTest, PacketRouterSendPacket) {
+  for (int num_streams : kNumStreams) {
+    test::PrintResult("packet_router_send_packet_cost", "",
+                      std::to_string(num_streams) + "_streams",
+                      MeasurePacketRouterSendCostNs(num_streams), "ns",
+                      /*important=*/false,
+                      test::ImproveDirection::kSmallerIsBetter);
+  }
+}
+
+TEST(SsrcRoutingPerfTest, RtcpDemuxerOnRtcpPacket) {
+  for (int num_streams : kNumStreams) {
+    test::PrintResult("rtcp_demuxer_on_rtcp_packet_cost", "",
+                      std::to_string(num_streams) + "_streams",
+                      MeasureRtcpDemuxerCostNs(num_streams), "ns",
+                      /*important=*/false,
+                      test::ImproveDirection::kSmallerIsBetter);
+  }
+}
+
+}  // namespace webrtc
@@ -68,6 +68,7 @@ class MockRtpTransportControllerSend
   MOCK_METHOD1(OnTransportOverheadChanged, void(size_t));
   MOCK_METHOD1(AccountForAudioPacketsInPacedSender, void(bool));
   MOCK_METHOD0(IncludeOverheadInPacedSender, void());
+  MOCK_METHOD2(SetStreamWeightInPacedSender, void(uint32_t, double));
   MOCK_METHOD1(OnReceivedPacket, void(const ReceivedPacket&));
 };
 }  // namespace webrtc
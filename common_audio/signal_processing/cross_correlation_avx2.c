@@ -0,0 +1,164 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <immintrin.h>
+
+#include "common_audio/signal_processing/include/signal_processing_library.h"
+
+// Adds the products seq1[k] * seq2[k], each right shifted by |shift|, for
+// 16 values of k to the eight 32 bit lanes of |sum|.
+static inline __m256i AccumulateShiftedProducts(__m256i sum,
+                                                __m256i seq1,
+                                                __m256i seq2,
+                                                __m128i shift) {
+  const __m256i low = _mm256_mullo_epi16(seq1, seq2);
+  const __m256i high = _mm256_mulhi_epi16(seq1, seq2);
+  sum = _mm256_add_epi32(
+      sum, _mm256_sra_epi32(_mm256_unpacklo_epi16(low, high), shift));
+  return _mm256_add_epi32(
+      sum, _mm256_sra_epi32(_mm256_unpackhi_epi16(low, high), shift));
+}
+
+// Same as above for eight values of k and four lanes.
+static inline __m128i AccumulateShiftedProducts128(__m128i sum,
+                                                   __m128i seq1,
+                                                   __m128i seq2,
+                                                   __m128i shift) {
+  const __m128i low = _mm_mullo_epi16(seq1, seq2);
+  const __m128i high = _mm_mulhi_epi16(seq1, seq2);
+  sum = _mm_add_epi32(sum, _mm_sra_epi32(_mm_unpacklo_epi16(low, high), shift));
+  return _mm_add_epi32(sum,
+                       _mm_sra_epi32(_mm_unpackhi_epi16(low, high), shift));
+}
+
+// Returns the horizontal sums of |a|, |b|, |c| and |d| in the four lanes.
+static inline __m128i HorizontalSums(__m256i a,
+                                     __m256i b,
+                                     __m256i c,
+                                     __m256i d) {
+  const __m256i ab = _mm256_add_epi32(_mm256_unpacklo_epi32(a, b),
+                                      _mm256_unpackhi_epi32(a, b));
+  const __m256i cd = _mm256_add_epi32(_mm256_unpacklo_epi32(c, d),
+                                      _mm256_unpackhi_epi32(c, d));
+  const __m256i abcd = _mm256_add_epi32(_mm256_unpacklo_epi64(ab, cd),
+                                        _mm256_unpackhi_epi64(ab, cd));
+  return _mm_add_epi32(_mm256_castsi256_si128(abcd),
+                       _mm256_extracti128_si256(abcd, 1));
+}
+
+// AVX2 version of WebRtcSpl_CrossCorrelation() for x86 platforms, bit-exact
+// with WebRtcSpl_CrossCorrelationC(). Four lags are computed per pass to
+// share the loads of |seq1|.
+void WebRtcSpl_CrossCorrelationAVX2(int32_t* cross_correlation,
+                                    const int16_t* seq1,
+                                    const int16_t* seq2,
+                                    size_t dim_seq,
+                                    size_t dim_cross_correlation,
+                                    int right_shifts,
+                                    int step_seq2) {
+  const size_t vectorized_length = dim_seq & ~(size_t)15;
+  const __m128i shift = _mm_cvtsi32_si128(right_shifts);
+  size_t i = 0;
+  size_t j = 0;
+
+  for (; i + 4 <= dim_cross_correlation; i += 4) {
+    const int16_t* seq2_0 = seq2;
+    const int16_t* seq2_1 = seq2_0 + step_seq2;
+    const int16_t* seq2_2 = seq2_1 + step_seq2;
+    const int16_t* seq2_3 = seq2_2 + step_seq2;
+    __m256i sum_0 = _mm256_setzero_si256();
+    __m256i sum_1 = _mm256_setzero_si256();
+    __m256i sum_2 = _mm256_setzero_si256();
+    __m256i sum_3 = _mm256_setzero_si256();
+    if (right_shifts == 0) {
+      // Without shifts, adjacent products can be summed before accumulation.
+      for (j = 0; j < vectorized_length; j += 16) {
+        const __m256i s1 = _mm256_loadu_si256((const __m256i*)&seq1[j]);
+        sum_0 = _mm256_add_epi32(
+            sum_0, _mm256_madd_epi16(
+                       s1, _mm256_loadu_si256((const __m256i*)&seq2_0[j])));
+        sum_1 = _mm256_add_epi32(
+            sum_1, _mm256_madd_epi16(
+                       s1, _mm256_loadu_si256((const __m256i*)&seq2_1[j])));
+        sum_2 = _mm256_add_epi32(
+            sum_2, _mm256_madd_epi16(
+                       s1, _mm256_loadu_si256((const __m256i*)&seq2_2[j])));
+        sum_3 = _mm256_add_epi32(
+            sum_3, _mm256_madd_epi16(
+                       s1, _mm256_loadu_si256((const __m256i*)&seq2_3[j])));
+      }
+    } else {
+      for (j = 0; j < vectorized_length; j += 16) {
+        const __m256i s1 = _mm256_loadu_si256((const __m256i*)&seq1[j]);
+        sum_0 = AccumulateShiftedProducts(
+            sum_0, s1, _mm256_loadu_si256((const __m256i*)&seq2_0[j]), shift);
+        sum_1 = AccumulateShiftedProducts(
+            sum_1, s1, _mm256_loadu_si256((const __m256i*)&seq2_1[j]), shift);
+        sum_2 = AccumulateShiftedProducts(
+            sum_2, s1, _mm256_loadu_si256((const __m256i*)&seq2_2[j]), shift);
+        sum_3 = AccumulateShiftedProducts(
+            sum_3, s1, _mm256_loadu_si256((const __m256i*)&seq2_3[j]), shift);
+      }
+    }
+    __m128i sums = HorizontalSums(sum_0, sum_1, sum_2, sum_3);
+    j = vectorized_length;
+    if (j + 8 <= dim_seq) {
+      // Eight of the remaining samples with 128 bit vectors.
+      const __m128i s1 = _mm_loadu_si128((const __m128i*)&seq1[j]);
+      const __m128i tail_0 = AccumulateShiftedProducts128(
+          _mm_setzero_si128(), s1, _mm_loadu_si128((const __m128i*)&seq2_0[j]),
+          shift);
+      const __m128i tail_1 = AccumulateShiftedProducts128(
+          _mm_setzero_si128(), s1, _mm_loadu_si128((const __m128i*)&seq2_1[j]),
+          shift);
+      const __m128i tail_2 = AccumulateShiftedProducts128(
+          _mm_setzero_si128(), s1, _mm_loadu_si128((const __m128i*)&seq2_2[j]),
+          shift);
+      const __m128i tail_3 = AccumulateShiftedProducts128(
+          _mm_setzero_si128(), s1, _mm_loadu_si128((const __m128i*)&seq2_3[j]),
+          shift);
+      const __m128i t01 = _mm_add_epi32(_mm_unpacklo_epi32(tail_0, tail_1),
+                                        _mm_unpackhi_epi32(tail_0, tail_1));
+      const __m128i t23 = _mm_add_epi32(_mm_unpacklo_epi32(tail_2, tail_3),
+                                        _mm_unpackhi_epi32(tail_2, tail_3));
+      sums = _mm_add_epi32(sums, _mm_add_epi32(_mm_unpacklo_epi64(t01, t23),
+                                               _mm_unpackhi_epi64(t01, t23)));
+      j += 8;
+    }
+    _mm_storeu_si128((__m128i*)cross_correlation, sums);
+    for (; j < dim_seq; j++) {
+      cross_correlation[0] += (seq1[j] * seq2_0[j]) >> right_shifts;
+      cross_correlation[1] += (seq1[j] * seq2_1[j]) >> right_shifts;
+      cross_correlation[2] += (seq1[j] * seq2_2[j]) >> right_shifts;
+      cross_correlation[3] += (seq1[j] * seq2_3[j]) >> right_shifts;
+    }
+    seq2 += 4 * step_seq2;
+    cross_correlation += 4;
+  }
+
+  // Remaining lags.
+  for (; i < dim_cross_correlation; i++) {
+    __m256i sum = _mm256_setzero_si256();
+    for (j = 0; j < vectorized_length; j += 16) {
+      sum = AccumulateShiftedProducts(
+          sum, _mm256_loadu_si256((const __m256i*)&seq1[j]),
+          _mm256_loadu_si256((const __m256i*)&seq2[j]), shift);
+    }
+    __m128i sum128 = _mm_add_epi32(_mm256_castsi256_si128(sum),
+                                   _mm256_extracti128_si256(sum, 1));
+    sum128 = _mm_add_epi32(sum128, _mm_srli_si128(sum128, 8));
+    sum128 = _mm_add_epi32(sum128, _mm_srli_si128(sum128, 4));
+    int32_t corr = _mm_cvtsi128_si32(sum128);
+    for (j = vectorized_length; j < dim_seq; j++)
+      corr += (seq1[j] * seq2[j]) >> right_shifts;
+    seq2 += step_seq2;
+    *cross_correlation++ = corr;
+  }
+}
@@ -0,0 +1,123 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <emmintrin.h>
+
+#include "common_audio/signal_processing/include/signal_processing_library.h"
+
+// Adds the products seq1[k] * seq2[k], each right shifted by |shift|, for
+// eight values of k to the four 32 bit lanes of |sum|.
+static inline __m128i AccumulateShiftedProducts(__m128i sum,
+                                                __m128i seq1,
+                                                __m128i seq2,
+                                                __m128i shift) {
+  const __m128i low = _mm_mullo_epi16(seq1, seq2);
+  const __m128i high = _mm_mulhi_epi16(seq1, seq2);
+  sum = _mm_add_epi32(sum, _mm_sra_epi32(_mm_unpacklo_epi16(low, high), shift));
+  return _mm_add_epi32(sum,
+                       _mm_sra_epi32(_mm_unpackhi_epi16(low, high), shift));
+}
+
+// Returns the horizontal sums of |a|, |b|, |c| and |d| in the four lanes.
+static inline __m128i HorizontalSums(__m128i a,
+                                     __m128i b,
+                                     __m128i c,
+                                     __m128i d) {
+  const __m128i ab = _mm_add_epi32(_mm_unpacklo_epi32(a, b),
+                                   _mm_unpackhi_epi32(a, b));
+  const __m128i cd = _mm_add_epi32(_mm_unpacklo_epi32(c, d),
+                                   _mm_unpackhi_epi32(c, d));
+  return _mm_add_epi32(_mm_unpacklo_epi64(ab, cd), _mm_unpackhi_epi64(ab, cd));
+}
+
+// SSE2 version of WebRtcSpl_CrossCorrelation() for x86 platforms. Each product
+// is shifted before it is accumulated, so the result is bit-exact with
+// WebRtcSpl_CrossCorrelationC(). Four lags are computed per pass to share the
+// loads of |seq1|.
+void WebRtcSpl_CrossCorrelationSSE2(int32_t* cross_correlation,
+                                    const int16_t* seq1,
+                                    const int16_t* seq2,
+                                    size_t dim_seq,
+                                    size_t dim_cross_correlation,
+                                    int right_shifts,
+                                    int step_seq2) {
+  const size_t vectorized_length = dim_seq & ~(size_t)7;
+  const __m128i shift = _mm_cvtsi32_si128(right_shifts);
+  size_t i = 0;
+  size_t j = 0;
+
+  for (; i + 4 <= dim_cross_correlation; i += 4) {
+    const int16_t* seq2_0 = seq2;
+    const int16_t* seq2_1 = seq2_0 + step_seq2;
+    const int16_t* seq2_2 = seq2_1 + step_seq2;
+    const int16_t* seq2_3 = seq2_2 + step_seq2;
+    __m128i sum_0 = _mm_setzero_si128();
+    __m128i sum_1 = _mm_setzero_si128();
+    __m128i sum_2 = _mm_setzero_si128();
+    __m128i sum_3 = _mm_setzero_si128();
+    if (right_shifts == 0) {
+      // Without shifts, adjacent products can be summed before accumulation.
+      for (j = 0; j < vectorized_length; j += 8) {
+        const __m128i s1 = _mm_loadu_si128((const __m128i*)&seq1[j]);
+        sum_0 = _mm_add_epi32(
+            sum_0,
+            _mm_madd_epi16(s1, _mm_loadu_si128((const __m128i*)&seq2_0[j])));
+        sum_1 = _mm_add_epi32(
+            sum_1,
+            _mm_madd_epi16(s1, _mm_loadu_si128((const __m128i*)&seq2_1[j])));
+        sum_2 = _mm_add_epi32(
+            sum_2,
+            _mm_madd_epi16(s1, _mm_loadu_si128((const __m128i*)&seq2_2[j])));
+        sum_3 = _mm_add_epi32(
+            sum_3,
+            _mm_madd_epi16(s1, _mm_loadu_si128((const __m128i*)&seq2_3[j])));
+      }
+    } else {
+      for (j = 0; j < vectorized_length; j += 8) {
+        const __m128i s1 = _mm_loadu_si128((const __m128i*)&seq1[j]);
+        sum_0 = AccumulateShiftedProducts(
+            sum_0, s1, _mm_loadu_si128((const __m128i*)&seq2_0[j]), shift);
+        sum_1 = AccumulateShiftedProducts(
+            sum_1, s1, _mm_loadu_si128((const __m128i*)&seq2_1[j]), shift);
+        sum_2 = AccumulateShiftedProducts(
+            sum_2, s1, _mm_loadu_si128((const __m128i*)&seq2_2[j]), shift);
+        sum_3 = AccumulateShiftedProducts(
+            sum_3, s1, _mm_loadu_si128((const __m128i*)&seq2_3[j]), shift);
+      }
+    }
+    _mm_storeu_si128((__m128i*)cross_correlation,
+                     HorizontalSums(sum_0, sum_1, sum_2, sum_3));
+    for (j = vectorized_length; j < dim_seq; j++) {
+      cross_correlation[0] += (seq1[j] * seq2_0[j]) >> right_shifts;
+      cross_correlation[1] += (seq1[j] * seq2_1[j]) >> right_shifts;
+      cross_correlation[2] += (seq1[j] * seq2_2[j]) >> right_shifts;
+      cross_correlation[3] += (seq1[j] * seq2_3[j]) >> right_shifts;
+    }
+    seq2 += 4 * step_seq2;
+    cross_correlation += 4;
+  }
+
+  // Remaining lags.
+  for (; i < dim_cross_correlation; i++) {
+    __m128i sum = _mm_setzero_si128();
+    for (j = 0; j < vectorized_length; j += 8) {
+      sum = AccumulateShiftedProducts(
+          sum, _mm_loadu_si128((const __m128i*)&seq1[j]),
+          _mm_loadu_si128((const __m128i*)&seq2[j]), shift);
+    }
+    sum = _mm_add_epi32(sum, _mm_srli_si128(sum, 8));
+    sum = _mm_add_epi32(sum, _mm_srli_si128(sum, 4));
+    int32_t corr = _mm_cvtsi128_si32(sum);
+    for (j = vectorized_length; j < dim_seq; j++)
+      corr += (seq1[j] * seq2[j]) >> right_shifts;
+    seq2 += step_seq2;
+    *cross_correlation++ = corr;
+  }
+}
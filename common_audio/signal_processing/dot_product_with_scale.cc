@@ -12,10 +12,10 @@
 
 #include "rtc_base/numerics/safe_conversions.h"
 
-int32_t WebRtcSpl_DotProductWithScale(const int16_t* vector1,
-                                      const int16_t* vector2,
-                                      size_t length,
-                                      int scaling) {
+int32_t WebRtcSpl_DotProductWithScaleC(const int16_t* vector1,
+                                       const int16_t* vector2,
+                                       size_t length,
+                                       int scaling) {
   int64_t sum = 0;
   size_t i = 0;
 
@@ -32,3 +32,13 @@ int32_t WebRtcSpl_DotProductWithScale(const int16_t* vector1,
 
   return rtc::saturated_cast<int32_t>(sum);
 }
+
+#if !defined(WEBRTC_ARCH_X86_FAMILY)
+// On x86 platforms, the implementation is selected in spl_init_x86.cc.
+int32_t WebRtcSpl_DotProductWithScale(const int16_t* vector1,
+                                      const int16_t* vector2,
+                                      size_t length,
+                                      int scaling) {
+  return WebRtcSpl_DotProductWithScaleC(vector1, vector2, length, scaling);
+}
+#endif
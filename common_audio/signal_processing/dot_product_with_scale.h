@@ -14,6 +14,8 @@
 #include <stdint.h>
 #include <string.h>
 
+#include "rtc_base/system/arch.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -34,6 +36,25 @@ int32_t WebRtcSpl_DotProductWithScale(const int16_t* vector1,
                                       size_t length,
                                       int scaling);
 
+// Implementations of WebRtcSpl_DotProductWithScale(). On x86 platforms, the
+// fastest one supported by the CPU is selected at runtime.
+int32_t WebRtcSpl_DotProductWithScaleC(const int16_t* vector1,
+                                       const int16_t* vector2,
+                                       size_t length,
+                                       int scaling);
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+int32_t WebRtcSpl_DotProductWithScaleSSE2(const int16_t* vector1,
+                                          const int16_t* vector2,
+                                          size_t length,
+                                          int scaling);
+#if defined(WEBRTC_ENABLE_AVX2)
+int32_t WebRtcSpl_DotProductWithScaleAVX2(const int16_t* vector1,
+                                          const int16_t* vector2,
+                                          size_t length,
+                                          int scaling);
+#endif
+#endif
+
 #ifdef __cplusplus
 }
 #endif  // __cplusplus
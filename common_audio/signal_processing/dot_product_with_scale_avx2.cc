@@ -0,0 +1,60 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <immintrin.h>
+
+#include "common_audio/signal_processing/dot_product_with_scale.h"
+#include "rtc_base/numerics/safe_conversions.h"
+
+namespace {
+
+// Adds the eight 32 bit lanes of |values| as 64 bit values to the four lanes
+// of |sum|.
+inline __m256i AccumulateWidened(__m256i sum, __m256i values) {
+  sum = _mm256_add_epi64(
+      sum, _mm256_cvtepi32_epi64(_mm256_castsi256_si128(values)));
+  return _mm256_add_epi64(
+      sum, _mm256_cvtepi32_epi64(_mm256_extracti128_si256(values, 1)));
+}
+
+}  // namespace
+
+// The products are shifted one by one and summed in 64 bits as in
+// WebRtcSpl_DotProductWithScaleC(), so the results are bit-exact.
+int32_t WebRtcSpl_DotProductWithScaleAVX2(const int16_t* vector1,
+                                          const int16_t* vector2,
+                                          size_t length,
+                                          int scaling) {
+  const __m128i shift = _mm_cvtsi32_si128(scaling);
+  __m256i sum = _mm256_setzero_si256();
+  size_t i = 0;
+
+  for (; i + 16 <= length; i += 16) {
+    const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(
+        &vector1[i]));
+    const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(
+        &vector2[i]));
+    const __m256i low = _mm256_mullo_epi16(a, b);
+    const __m256i high = _mm256_mulhi_epi16(a, b);
+    sum = AccumulateWidened(
+        sum, _mm256_sra_epi32(_mm256_unpacklo_epi16(low, high), shift));
+    sum = AccumulateWidened(
+        sum, _mm256_sra_epi32(_mm256_unpackhi_epi16(low, high), shift));
+  }
+
+  int64_t lanes[4];
+  _mm256_storeu_si256(reinterpret_cast<__m256i*>(lanes), sum);
+  int64_t total = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+  for (; i < length; i++) {
+    total += (vector1[i] * vector2[i]) >> scaling;
+  }
+
+  return rtc::saturated_cast<int32_t>(total);
+}
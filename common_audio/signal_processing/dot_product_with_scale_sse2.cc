@@ -0,0 +1,59 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <emmintrin.h>
+
+#include "common_audio/signal_processing/dot_product_with_scale.h"
+#include "rtc_base/numerics/safe_conversions.h"
+
+namespace {
+
+// Adds the four 32 bit lanes of |values| as 64 bit values to the two lanes of
+// |sum|.
+inline __m128i AccumulateWidened(__m128i sum, __m128i values) {
+  const __m128i sign = _mm_srai_epi32(values, 31);
+  sum = _mm_add_epi64(sum, _mm_unpacklo_epi32(values, sign));
+  return _mm_add_epi64(sum, _mm_unpackhi_epi32(values, sign));
+}
+
+}  // namespace
+
+// The products are shifted one by one and summed in 64 bits as in
+// WebRtcSpl_DotProductWithScaleC(), so the results are bit-exact.
+int32_t WebRtcSpl_DotProductWithScaleSSE2(const int16_t* vector1,
+                                          const int16_t* vector2,
+                                          size_t length,
+                                          int scaling) {
+  const __m128i shift = _mm_cvtsi32_si128(scaling);
+  __m128i sum = _mm_setzero_si128();
+  size_t i = 0;
+
+  for (; i + 8 <= length; i += 8) {
+    const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(
+        &vector1[i]));
+    const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(
+        &vector2[i]));
+    const __m128i low = _mm_mullo_epi16(a, b);
+    const __m128i high = _mm_mulhi_epi16(a, b);
+    sum = AccumulateWidened(
+        sum, _mm_sra_epi32(_mm_unpacklo_epi16(low, high), shift));
+    sum = AccumulateWidened(
+        sum, _mm_sra_epi32(_mm_unpackhi_epi16(low, high), shift));
+  }
+
+  int64_t lanes[2];
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), sum);
+  int64_t total = lanes[0] + lanes[1];
+  for (; i < length; i++) {
+    total += (vector1[i] * vector2[i]) >> scaling;
+  }
+
+  return rtc::saturated_cast<int32_t>(total);
+}
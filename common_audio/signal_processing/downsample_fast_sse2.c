@@ -0,0 +1,113 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <emmintrin.h>
+#include <stddef.h>
+
+#include "common_audio/signal_processing/include/signal_processing_library.h"
+
+// Longer filters are handled by WebRtcSpl_DownsampleFastC().
+enum { kMaxCoefficientsLength = 32 };
+
+// SSE2 version of WebRtcSpl_DownsampleFast() for x86 platforms, bit-exact
+// with WebRtcSpl_DownsampleFastC(). Each output sample is the dot product of
+// a window of input samples ending at the current position with the reversed
+// coefficients, computed eight products at a time. Four output samples are
+// computed per pass.
+int WebRtcSpl_DownsampleFastSSE2(const int16_t* data_in,
+                                 size_t data_in_length,
+                                 int16_t* data_out,
+                                 size_t data_out_length,
+                                 const int16_t* __restrict coefficients,
+                                 size_t coefficients_length,
+                                 int factor,
+                                 size_t delay) {
+  const size_t padded_length = (coefficients_length + 7) & ~(size_t)7;
+  const size_t padding = padded_length - coefficients_length;
+  size_t endpos = delay + factor * (data_out_length - 1) + 1;
+  int16_t reversed_coefficients[kMaxCoefficientsLength];
+  size_t first = 0;
+  size_t i = 0;
+  size_t j = 0;
+
+  // Return error if any of the running conditions doesn't meet.
+  if (data_out_length == 0 || coefficients_length == 0
+                           || data_in_length < endpos) {
+    return -1;
+  }
+  if (coefficients_length > kMaxCoefficientsLength) {
+    return WebRtcSpl_DownsampleFastC(data_in, data_in_length, data_out,
+                                     data_out_length, coefficients,
+                                     coefficients_length, factor, delay);
+  }
+
+  // Zeros in front of the reversed coefficients pad the windows to a multiple
+  // of eight samples.
+  for (j = 0; j < padded_length; j++) {
+    const size_t k = padded_length - 1 - j;
+    reversed_coefficients[j] = k < coefficients_length ? coefficients[k] : 0;
+  }
+
+  // The padding makes the windows start before the first sample read by the
+  // C version, which may be out of bounds for the first output samples. Those
+  // are computed by the C version, as are the last ones.
+  first = (padding + factor - 1) / factor;
+  if (first > data_out_length) {
+    first = data_out_length;
+  }
+  if (first > 0) {
+    WebRtcSpl_DownsampleFastC(data_in, data_in_length, data_out, first,
+                              coefficients, coefficients_length, factor,
+                              delay);
+  }
+
+  for (i = first; i + 4 <= data_out_length; i += 4) {
+    const int16_t* in = &data_in[(ptrdiff_t)(delay + factor * i) -
+                                 (ptrdiff_t)(padded_length - 1)];
+    __m128i sum_0 = _mm_setzero_si128();
+    __m128i sum_1 = _mm_setzero_si128();
+    __m128i sum_2 = _mm_setzero_si128();
+    __m128i sum_3 = _mm_setzero_si128();
+    __m128i out;
+    for (j = 0; j < padded_length; j += 8) {
+      const __m128i c =
+          _mm_loadu_si128((const __m128i*)&reversed_coefficients[j]);
+      sum_0 = _mm_add_epi32(
+          sum_0, _mm_madd_epi16(c, _mm_loadu_si128((const __m128i*)&in[j])));
+      sum_1 = _mm_add_epi32(
+          sum_1, _mm_madd_epi16(
+                     c, _mm_loadu_si128((const __m128i*)&in[factor + j])));
+      sum_2 = _mm_add_epi32(
+          sum_2, _mm_madd_epi16(
+                     c, _mm_loadu_si128((const __m128i*)&in[2 * factor + j])));
+      sum_3 = _mm_add_epi32(
+          sum_3, _mm_madd_epi16(
+                     c, _mm_loadu_si128((const __m128i*)&in[3 * factor + j])));
+    }
+    // Horizontal sums of the four accumulators.
+    sum_0 = _mm_add_epi32(_mm_unpacklo_epi32(sum_0, sum_1),
+                          _mm_unpackhi_epi32(sum_0, sum_1));
+    sum_2 = _mm_add_epi32(_mm_unpacklo_epi32(sum_2, sum_3),
+                          _mm_unpackhi_epi32(sum_2, sum_3));
+    out = _mm_add_epi32(_mm_unpacklo_epi64(sum_0, sum_2),
+                        _mm_unpackhi_epi64(sum_0, sum_2));
+    // Round, convert from Q12 to Q0 and saturate.
+    out = _mm_srai_epi32(_mm_add_epi32(out, _mm_set1_epi32(2048)), 12);
+    _mm_storel_epi64((__m128i*)&data_out[i], _mm_packs_epi32(out, out));
+  }
+
+  if (i < data_out_length) {
+    WebRtcSpl_DownsampleFastC(data_in, data_in_length, &data_out[i],
+                              data_out_length - i, coefficients,
+                              coefficients_length, factor,
+                              delay + factor * i);
+  }
+  return 0;
+}
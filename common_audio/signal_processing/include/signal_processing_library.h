@@ -20,6 +20,7 @@
 #include <string.h>
 
 #include "common_audio/signal_processing/dot_product_with_scale.h"
+#include "rtc_base/system/arch.h"
 
 // Macros specific for the fixed point implementation
 #define WEBRTC_SPL_WORD16_MAX 32767
@@ -524,6 +525,32 @@ void WebRtcSpl_CrossCorrelationNeon(int32_t* cross_correlation,
                                     int right_shifts,
                                     int step_seq2);
 #endif
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+// Selects the fastest of the implementations below supported by the CPU.
+void WebRtcSpl_CrossCorrelationX86(int32_t* cross_correlation,
+                                   const int16_t* seq1,
+                                   const int16_t* seq2,
+                                   size_t dim_seq,
+                                   size_t dim_cross_correlation,
+                                   int right_shifts,
+                                   int step_seq2);
+void WebRtcSpl_CrossCorrelationSSE2(int32_t* cross_correlation,
+                                    const int16_t* seq1,
+                                    const int16_t* seq2,
+                                    size_t dim_seq,
+                                    size_t dim_cross_correlation,
+                                    int right_shifts,
+                                    int step_seq2);
+#if defined(WEBRTC_ENABLE_AVX2)
+void WebRtcSpl_CrossCorrelationAVX2(int32_t* cross_correlation,
+                                    const int16_t* seq1,
+                                    const int16_t* seq2,
+                                    size_t dim_seq,
+                                    size_t dim_cross_correlation,
+                                    int right_shifts,
+                                    int step_seq2);
+#endif
+#endif
 #if defined(MIPS32_LE)
 void WebRtcSpl_CrossCorrelation_mips(int32_t* cross_correlation,
                                      const int16_t* seq1,
@@ -675,6 +702,35 @@ int WebRtcSpl_DownsampleFastNeon(const int16_t* data_in,
                                  int factor,
                                  size_t delay);
 #endif
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+// Selects the fastest of the implementations below supported by the CPU.
+int WebRtcSpl_DownsampleFastX86(const int16_t* data_in,
+                                size_t data_in_length,
+                                int16_t* data_out,
+                                size_t data_out_length,
+                                const int16_t* __restrict coefficients,
+                                size_t coefficients_length,
+                                int factor,
+                                size_t delay);
+int WebRtcSpl_DownsampleFastSSE2(const int16_t* data_in,
+                                 size_t data_in_length,
+                                 int16_t* data_out,
+                                 size_t data_out_length,
+                                 const int16_t* __restrict coefficients,
+                                 size_t coefficients_length,
+                                 int factor,
+                                 size_t delay);
+#if defined(WEBRTC_ENABLE_AVX2)
+int WebRtcSpl_DownsampleFastAVX2(const int16_t* data_in,
+                                 size_t data_in_length,
+                                 int16_t* data_out,
+                                 size_t data_out_length,
+                                 const int16_t* __restrict coefficients,
+                                 size_t coefficients_length,
+                                 int factor,
+                                 size_t delay);
+#endif
+#endif
 #if defined(MIPS32_LE)
 int WebRtcSpl_DownsampleFast_mips(const int16_t* data_in,
                                   size_t data_in_length,
@@ -9,9 +9,13 @@
  */
 
 #include <algorithm>
+#include <vector>
 
 #include "common_audio/signal_processing/include/signal_processing_library.h"
+#include "rtc_base/random.h"
 #include "rtc_base/strings/string_builder.h"
+#include "rtc_base/system/arch.h"
+#include "system_wrappers/include/cpu_features_wrapper.h"
 #include "test/gtest.h"
 
 static const size_t kVector16Size = 9;
@@ -491,18 +495,125 @@ TEST(SplTest, CrossCorrelationTest) {
   const int32_t kExpected[kCrossCorrelationDimension] = {-266947903, -15579555,
                                                          -171282001};
   const int32_t* expected = kExpected;
-#if !defined(MIPS32_LE)
+#if defined(WEBRTC_HAS_NEON)
   const int32_t kExpectedNeon[kCrossCorrelationDimension] = {
       -266947901, -15579553, -171281999};
-  if (WebRtcSpl_CrossCorrelation != WebRtcSpl_CrossCorrelationC) {
-    expected = kExpectedNeon;
-  }
+  expected = kExpectedNeon;
 #endif
   for (size_t i = 0; i < kCrossCorrelationDimension; ++i) {
     EXPECT_EQ(expected[i], vector32[i]);
   }
 }
 
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+namespace {
+
+typedef int32_t (*DotProductWithScale)(const int16_t* vector1,
+                                       const int16_t* vector2,
+                                       size_t length,
+                                       int scaling);
+
+// Fills |vector| with random samples, a quarter of which are the minimum value
+// to exercise the overflow corner cases of the vector multiplications.
+void FillRandom(webrtc::Random* random, std::vector<int16_t>* vector) {
+  for (int16_t& sample : *vector) {
+    sample = random->Rand(0, 3) == 0
+                 ? WEBRTC_SPL_WORD16_MIN
+                 : static_cast<int16_t>(random->Rand(WEBRTC_SPL_WORD16_MIN,
+                                                     WEBRTC_SPL_WORD16_MAX));
+  }
+}
+
+// Verifies that the given x86 implementations are bit-exact with the C ones
+// for lengths that are not multiples of the vector sizes.
+void VerifyBitExactWithC(CrossCorrelation cross_correlation,
+                         DownsampleFast downsample_fast,
+                         DotProductWithScale dot_product_with_scale) {
+  webrtc::Random random(42);
+  std::vector<int16_t> seq1(80);
+  std::vector<int16_t> seq2(200);
+  for (size_t dim_seq = 1; dim_seq <= seq1.size(); dim_seq += 3) {
+    FillRandom(&random, &seq1);
+    FillRandom(&random, &seq2);
+    for (int right_shifts = 0; right_shifts < 4; ++right_shifts) {
+      SCOPED_TRACE(dim_seq);
+      SCOPED_TRACE(right_shifts);
+      EXPECT_EQ(WebRtcSpl_DotProductWithScaleC(seq1.data(), seq2.data(),
+                                               dim_seq, right_shifts),
+                dot_product_with_scale(seq1.data(), seq2.data(), dim_seq,
+                                       right_shifts));
+      for (int step : {-1, 1, 2}) {
+        const size_t kDimCrossCorrelation = 11;
+        const int16_t* seq2_start = step < 0 ? &seq2[seq2.size() - 100]
+                                             : seq2.data();
+        int32_t expected[kDimCrossCorrelation];
+        int32_t actual[kDimCrossCorrelation];
+        WebRtcSpl_CrossCorrelationC(expected, seq1.data(), seq2_start, dim_seq,
+                                    kDimCrossCorrelation, right_shifts, step);
+        cross_correlation(actual, seq1.data(), seq2_start, dim_seq,
+                          kDimCrossCorrelation, right_shifts, step);
+        for (size_t i = 0; i < kDimCrossCorrelation; ++i) {
+          EXPECT_EQ(expected[i], actual[i]);
+        }
+      }
+    }
+  }
+
+  std::vector<int16_t> coefficients(12);
+  std::vector<int16_t> data_in(400);
+  for (size_t coefficients_length = 1;
+       coefficients_length <= coefficients.size(); ++coefficients_length) {
+    for (int factor : {2, 4, 12}) {
+      for (size_t delay : {0, 3}) {
+        FillRandom(&random, &coefficients);
+        FillRandom(&random, &data_in);
+        // The filter state precedes the input samples.
+        const int16_t* in = &data_in[coefficients_length - 1];
+        const size_t in_length = data_in.size() - (coefficients_length - 1);
+        const size_t out_length = (in_length - delay - 1) / factor + 1;
+        std::vector<int16_t> expected(out_length);
+        std::vector<int16_t> actual(out_length);
+        SCOPED_TRACE(coefficients_length);
+        SCOPED_TRACE(factor);
+        EXPECT_EQ(0, WebRtcSpl_DownsampleFastC(
+                         in, in_length, expected.data(), out_length,
+                         coefficients.data(), coefficients_length, factor,
+                         delay));
+        EXPECT_EQ(0, downsample_fast(in, in_length, actual.data(), out_length,
+                                     coefficients.data(), coefficients_length,
+                                     factor, delay));
+        EXPECT_EQ(expected, actual);
+        EXPECT_EQ(-1, downsample_fast(in, in_length, actual.data(),
+                                      out_length + 1, coefficients.data(),
+                                      coefficients_length, factor, delay));
+      }
+    }
+  }
+}
+
+}  // namespace
+
+TEST(SplTest, Sse2BitExactWithC) {
+  if (WebRtc_GetCPUInfo(kSSE2) == 0) {
+    return;
+  }
+  VerifyBitExactWithC(WebRtcSpl_CrossCorrelationSSE2,
+                      WebRtcSpl_DownsampleFastSSE2,
+                      WebRtcSpl_DotProductWithScaleSSE2);
+}
+
+#if defined(WEBRTC_ENABLE_AVX2)
+TEST(SplTest, Avx2BitExactWithC) {
+  if (WebRtc_GetCPUInfo(kAVX2) == 0) {
+    return;
+  }
+  VerifyBitExactWithC(WebRtcSpl_CrossCorrelationAVX2,
+                      WebRtcSpl_DownsampleFastAVX2,
+                      WebRtcSpl_DotProductWithScaleAVX2);
+}
+#endif
+#endif  // defined(WEBRTC_ARCH_X86_FAMILY)
+
 TEST(SplTest, AutoCorrelationTest) {
   int scale = 0;
   int32_t vector32[kVector16Size];
@@ -61,8 +61,15 @@ const MaxValueW16 WebRtcSpl_MaxValueW16 = WebRtcSpl_MaxValueW16C;
 const MaxValueW32 WebRtcSpl_MaxValueW32 = WebRtcSpl_MaxValueW32C;
 const MinValueW16 WebRtcSpl_MinValueW16 = WebRtcSpl_MinValueW16C;
 const MinValueW32 WebRtcSpl_MinValueW32 = WebRtcSpl_MinValueW32C;
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+// These select an SSE2 or AVX2 implementation at runtime.
+const CrossCorrelation WebRtcSpl_CrossCorrelation =
+    WebRtcSpl_CrossCorrelationX86;
+const DownsampleFast WebRtcSpl_DownsampleFast = WebRtcSpl_DownsampleFastX86;
+#else
 const CrossCorrelation WebRtcSpl_CrossCorrelation = WebRtcSpl_CrossCorrelationC;
 const DownsampleFast WebRtcSpl_DownsampleFast = WebRtcSpl_DownsampleFastC;
+#endif
 const ScaleAndAddVectorsWithRound WebRtcSpl_ScaleAndAddVectorsWithRound =
     WebRtcSpl_ScaleAndAddVectorsWithRoundC;
 
@@ -0,0 +1,114 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+// Runtime selection of the x86 implementations of the signal processing
+// library functions.
+
+#include "common_audio/signal_processing/include/signal_processing_library.h"
+#include "system_wrappers/include/cpu_features_wrapper.h"
+
+namespace {
+
+enum class Optimization { kNone, kSse2, kAvx2 };
+
+Optimization DetectOptimization() {
+#if defined(WEBRTC_ENABLE_AVX2)
+  if (WebRtc_GetCPUInfo(kAVX2) != 0) {
+    return Optimization::kAvx2;
+  }
+#endif
+// If we know the minimum architecture at compile time, avoid CPU detection.
+#if defined(__SSE2__)
+  return Optimization::kSse2;
+#else
+  return WebRtc_GetCPUInfo(kSSE2) != 0 ? Optimization::kSse2
+                                        : Optimization::kNone;
+#endif
+}
+
+// The functions are called many times per frame, while querying the CPU may
+// be slow, e.g., in virtual machines. Hence, the result is computed once.
+Optimization GetOptimization() {
+  static const Optimization optimization = DetectOptimization();
+  return optimization;
+}
+
+}  // namespace
+
+void WebRtcSpl_CrossCorrelationX86(int32_t* cross_correlation,
+                                   const int16_t* seq1,
+                                   const int16_t* seq2,
+                                   size_t dim_seq,
+                                   size_t dim_cross_correlation,
+                                   int right_shifts,
+                                   int step_seq2) {
+  switch (GetOptimization()) {
+#if defined(WEBRTC_ENABLE_AVX2)
+    case Optimization::kAvx2:
+      WebRtcSpl_CrossCorrelationAVX2(cross_correlation, seq1, seq2, dim_seq,
+                                     dim_cross_correlation, right_shifts,
+                                     step_seq2);
+      return;
+#endif
+    case Optimization::kSse2:
+      WebRtcSpl_CrossCorrelationSSE2(cross_correlation, seq1, seq2, dim_seq,
+                                     dim_cross_correlation, right_shifts,
+                                     step_seq2);
+      return;
+    default:
+      WebRtcSpl_CrossCorrelationC(cross_correlation, seq1, seq2, dim_seq,
+                                  dim_cross_correlation, right_shifts,
+                                  step_seq2);
+  }
+}
+
+int WebRtcSpl_DownsampleFastX86(const int16_t* data_in,
+                                size_t data_in_length,
+                                int16_t* data_out,
+                                size_t data_out_length,
+                                const int16_t* __restrict coefficients,
+                                size_t coefficients_length,
+                                int factor,
+                                size_t delay) {
+  switch (GetOptimization()) {
+#if defined(WEBRTC_ENABLE_AVX2)
+    case Optimization::kAvx2:
+      return WebRtcSpl_DownsampleFastAVX2(data_in, data_in_length, data_out,
+                                          data_out_length, coefficients,
+                                          coefficients_length, factor, delay);
+#endif
+    case Optimization::kSse2:
+      return WebRtcSpl_DownsampleFastSSE2(data_in, data_in_length, data_out,
+                                          data_out_length, coefficients,
+                                          coefficients_length, factor, delay);
+    default:
+      return WebRtcSpl_DownsampleFastC(data_in, data_in_length, data_out,
+                                       data_out_length, coefficients,
+                                       coefficients_length, factor, delay);
+  }
+}
+
+int32_t WebRtcSpl_DotProductWithScale(const int16_t* vector1,
+                                      const int16_t* vector2,
+                                      size_t length,
+                                      int scaling) {
+  switch (GetOptimization()) {
+#if defined(WEBRTC_ENABLE_AVX2)
+    case Optimization::kAvx2:
+      return WebRtcSpl_DotProductWithScaleAVX2(vector1, vector2, length,
+                                               scaling);
+#endif
+    case Optimization::kSse2:
+      return WebRtcSpl_DotProductWithScaleSSE2(vector1, vector2, length,
+                                               scaling);
+    default:
+      return WebRtcSpl_DotProductWithScaleC(vector1, vector2, length, scaling);
+  }
+}
@@ -17,11 +17,13 @@
 #include "examples/turnserver/read_auth_file.h"
 #include "p2p/base/basic_packet_socket_factory.h"
 #include "p2p/base/port_interface.h"
+#include "p2p/base/sharded_turn_server.h"
 #include "p2p/base/turn_server.h"
 #include "rtc_base/async_udp_socket.h"
 #include "rtc_base/ip_address.h"
 #include "rtc_base/socket_address.h"
 #include "rtc_base/socket_server.h"
+#include "rtc_base/string_to_number.h"
 #include "rtc_base/thread.h"
 
 namespace {
@@ -51,8 +53,8 @@ class TurnFileAuth : public cricket::TurnAuthInterface {
 }  // namespace
 
 int main(int argc, char* argv[]) {
-  if (argc != 5) {
-    std::cerr << "usage: turnserver int-addr ext-ip realm auth-file"
+  if (argc != 5 && argc != 6) {
+    std::cerr << "usage: turnserver int-addr ext-ip realm auth-file [threads]"
               << std::endl;
     return 1;
   }
@@ -69,7 +71,41 @@ int main(int argc, char* argv[]) {
     return 1;
   }
 
+  size_t num_threads = 1;
+  if (argc == 6) {
+    absl::optional<size_t> threads = rtc::StringToNumber<size_t>(argv[5]);
+    if (!threads || *threads == 0) {
+      std::cerr << "Invalid number of threads: " << argv[5] << std::endl;
+      return 1;
+    }
+    num_threads = *threads;
+  }
+
+  std::fstream auth_file(argv[4], std::fstream::in);
+  TurnFileAuth auth(auth_file.is_open()
+                        ? webrtc_examples::ReadAuthFile(&auth_file)
+                        : std::map<std::string, std::string>());
+
   rtc::Thread* main = rtc::Thread::Current();
+  if (num_threads > 1) {
+    // Each thread listens on its own SO_REUSEPORT socket and relays for the
+    // clients the kernel hashes to it.
+    cricket::ShardedTurnServer server(num_threads);
+    server.set_realm(argv[3]);
+    server.set_software(kSoftware);
+    server.set_auth_hook(&auth);
+    if (!server.Start(int_addr, ext_addr)) {
+      std::cerr << "Failed to start " << num_threads
+                << " TURN server threads at " << int_addr.ToString()
+                << std::endl;
+      return 1;
+    }
+    std::cout << "Listening internally at " << int_addr.ToString() << " on "
+              << num_threads << " threads" << std::endl;
+    main->Run();
+    return 0;
+  }
+
   rtc::AsyncUDPSocket* int_socket =
       rtc::AsyncUDPSocket::Create(main->socketserver(), int_addr);
   if (!int_socket) {
@@ -79,11 +115,6 @@ int main(int argc, char* argv[]) {
   }
 
   cricket::TurnServer server(main);
-  std::fstream auth_file(argv[4], std::fstream::in);
-
-  TurnFileAuth auth(auth_file.is_open()
-                        ? webrtc_examples::ReadAuthFile(&auth_file)
-                        : std::map<std::string, std::string>());
   server.set_realm(argv[3]);
   server.set_software(kSoftware);
   server.set_auth_hook(&auth);
@@ -22,6 +22,7 @@ enum PreservedErrno {
 #include <stdio.h>
 
 #include <memory>
+#include <utility>
 
 #include "absl/algorithm/container.h"
 #include "absl/base/attributes.h"
@@ -290,13 +291,9 @@ class SctpTransport::UsrSctpWrapper {
                         << "; set_df: " << rtc::ToHex(set_df);
 
     VerboseLogPacket(data, length, SCTP_DUMP_OUTBOUND);
-    // Note: We have to copy the data; the caller will delete it.
-    rtc::CopyOnWriteBuffer buf(reinterpret_cast<uint8_t*>(data), length);
-    // TODO(deadbeef): Why do we need an AsyncInvoke here? We're already on the
-    // right thread and don't need to unwind the stack.
-    transport->invoker_.AsyncInvoke<void>(
-        RTC_FROM_HERE, transport->network_thread_,
-        rtc::Bind(&SctpTransport::OnPacketFromSctpToNetwork, transport, buf));
+    // The packet is sent asynchronously, since this may be called on one of
+    // the usrsctp threads, or with usrsctp locks held.
+    transport->QueueOutboundPacket(data, length);
     return 0;
   }
 
@@ -1037,15 +1034,50 @@ sockaddr_conn SctpTransport::GetSctpSockAddr(int port) {
   return sconn;
 }
 
-void SctpTransport::OnPacketFromSctpToNetwork(
-    const rtc::CopyOnWriteBuffer& buffer) {
+void SctpTransport::QueueOutboundPacket(const void* data, size_t length) {
+  bool post_task;
+  {
+    rtc::CritScope cs(&outbound_packets_lock_);
+    // A task is already pending if packets are queued.
+    post_task = outbound_packet_sizes_.empty();
+    outbound_packet_data_.AppendData(static_cast<const uint8_t*>(data),
+                                     length);
+    outbound_packet_sizes_.push_back(length);
+  }
+  if (post_task) {
+    invoker_.AsyncInvoke<void>(
+        RTC_FROM_HERE, network_thread_,
+        rtc::Bind(&SctpTransport::SendQueuedOutboundPackets, this));
+  }
+}
+
+void SctpTransport::SendQueuedOutboundPackets() {
+  RTC_DCHECK_RUN_ON(network_thread_);
+  RTC_DCHECK(sending_packet_sizes_.empty());
+  {
+    rtc::CritScope cs(&outbound_packets_lock_);
+    std::swap(outbound_packet_data_, sending_packet_data_);
+    std::swap(outbound_packet_sizes_, sending_packet_sizes_);
+  }
+  const uint8_t* data = sending_packet_data_.data();
+  for (size_t length : sending_packet_sizes_) {
+    OnPacketFromSctpToNetwork(data, length);
+    data += length;
+  }
+  // Keep the capacity for the next swap.
+  sending_packet_data_.Clear();
+  sending_packet_sizes_.clear();
+}
+
+void SctpTransport::OnPacketFromSctpToNetwork(const uint8_t* data,
+                                              size_t length) {
   RTC_DCHECK_RUN_ON(network_thread_);
-  if (buffer.size() > (kSctpMtu)) {
+  if (length > (kSctpMtu)) {
     RTC_LOG(LS_ERROR) << debug_name_
                       << "->OnPacketFromSctpToNetwork(...): "
                          "SCTP seems to have made a packet that is bigger "
                          "than its official MTU: "
-                      << buffer.size() << " vs max of " << kSctpMtu;
+                      << length << " vs max of " << kSctpMtu;
   }
   TRACE_EVENT0("webrtc", "SctpTransport::OnPacketFromSctpToNetwork");
 
@@ -1056,7 +1088,7 @@ void SctpTransport::OnPacketFromSctpToNetwork(
   }
 
   // Bon voyage.
-  transport_->SendPacket(buffer.data<char>(), buffer.size(),
+  transport_->SendPacket(reinterpret_cast<const char*>(data), length,
                          rtc::PacketOptions(), PF_NORMAL);
 }
 
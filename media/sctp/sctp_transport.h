@@ -24,8 +24,10 @@
 #include "rtc_base/buffer.h"
 #include "rtc_base/constructor_magic.h"
 #include "rtc_base/copy_on_write_buffer.h"
+#include "rtc_base/critical_section.h"
 #include "rtc_base/third_party/sigslot/sigslot.h"
 #include "rtc_base/thread.h"
+#include "rtc_base/thread_annotations.h"
 // For SendDataParams/ReceiveDataParams.
 #include "media/base/media_channel.h"
 #include "media/sctp/sctp_transport_internal.h"
@@ -49,7 +51,8 @@ struct SctpInboundPacket;
 //  2.  usrsctp_sendv(data)
 // [network thread returns; sctp thread then calls the following]
 //  3.  OnSctpOutboundPacket(wrapped_data)
-// [sctp thread returns having async invoked on the network thread]
+// [sctp thread returns having queued the packet and, unless packets queued
+//  earlier are still waiting, async invoked on the network thread]
 //  4.  SctpTransport::OnPacketFromSctpToNetwork(wrapped_data)
 //  5.  DtlsTransport::SendPacket(wrapped_data)
 //  6.  ... across network ... a packet is sent back ...
@@ -170,8 +173,13 @@ class SctpTransport : public SctpTransportInternal,
   void OnSendThresholdCallback();
   sockaddr_conn GetSctpSockAddr(int port);
 
-  // Called using |invoker_| to send packet on the network.
-  void OnPacketFromSctpToNetwork(const rtc::CopyOnWriteBuffer& buffer);
+  // Copies a packet produced by usrsctp to the outbound queue, posting a task
+  // to send it unless one is pending already. Called on the usrsctp threads
+  // as well as on the network thread.
+  void QueueOutboundPacket(const void* data, size_t length);
+  // Called using |invoker_| to send the queued packets on the network.
+  void SendQueuedOutboundPackets();
+  void OnPacketFromSctpToNetwork(const uint8_t* data, size_t length);
   // Called using |invoker_| to decide what to do with the packet.
   // The |flags| parameter is used by SCTP to distinguish notification packets
   // from other types of packets.
@@ -193,6 +201,19 @@ class SctpTransport : public SctpTransportInternal,
   // Underlying DTLS transport.
   rtc::PacketTransportInternal* transport_ = nullptr;
 
+  // Packets produced by usrsctp that have yet to be sent on |transport_|,
+  // stored back to back in |outbound_packet_data_|. usrsctp frees a packet
+  // when the outbound callback returns, so it has to be copied, but the
+  // buffers are reused so that queueing a packet does not allocate.
+  rtc::CriticalSection outbound_packets_lock_;
+  rtc::Buffer outbound_packet_data_ RTC_GUARDED_BY(outbound_packets_lock_);
+  std::vector<size_t> outbound_packet_sizes_
+      RTC_GUARDED_BY(outbound_packets_lock_);
+  // The packets being sent by SendQueuedOutboundPackets(), swapped out of the
+  // queue so that the lock is not held while sending.
+  rtc::Buffer sending_packet_data_;
+  std::vector<size_t> sending_packet_sizes_;
+
   // Track the data received from usrsctp between callbacks until the EOR bit
   // arrives.
   rtc::CopyOnWriteBuffer partial_incoming_message_;
@@ -8,17 +8,18 @@
  *  be found in the AUTHORS file in the root of the source tree.
  */
 
-// This is the implementation of the PacketBuffer class. It is mostly based on
-// an STL list. The list is kept sorted at all times so that the next packet to
-// decode is at the beginning of the list.
+// This is the implementation of the PacketBuffer class. It is based on an STL
+// vector, which is kept sorted at all times so that the next packet to decode
+// is at the beginning of the buffer.
 
 #include "modules/audio_coding/neteq/packet_buffer.h"
 
 #include <algorithm>
-#include <list>
+#include <iterator>
 #include <memory>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "api/audio_codecs/audio_decoder.h"
 #include "api/neteq/tick_timer.h"
@@ -30,7 +31,7 @@
 
 namespace webrtc {
 namespace {
-// Predicate used when inserting packets in the buffer list.
+// Predicate used when inserting packets in the buffer.
 // Operator() returns true when |packet| goes before |new_packet|.
 class NewTimestampIsLarger {
  public:
@@ -75,10 +76,11 @@ PacketBuffer::~PacketBuffer() {
 // Flush the buffer. All packets in the buffer will be destroyed.
 void PacketBuffer::Flush() {
   buffer_.clear();
+  first_packet_index_ = 0;
 }
 
 bool PacketBuffer::Empty() const {
-  return buffer_.empty();
+  return first_packet_index_ == buffer_.size();
 }
 
 int PacketBuffer::InsertPacket(Packet&& packet, StatisticsCalculator* stats) {
@@ -94,7 +96,7 @@ int PacketBuffer::InsertPacket(Packet&& packet, StatisticsCalculator* stats) {
 
   packet.waiting_time = tick_timer_->GetNewStopwatch();
 
-  if (buffer_.size() >= max_number_of_packets_) {
+  if (NumPacketsInBuffer() >= max_number_of_packets_) {
     // Buffer is full. Flush it.
     Flush();
     stats->FlushedPacketBuffer();
@@ -102,16 +104,31 @@ int PacketBuffer::InsertPacket(Packet&& packet, StatisticsCalculator* stats) {
     return_val = kFlushed;
   }
 
+  if (first_packet_index_ > 0 && buffer_.size() == buffer_.capacity()) {
+    // The slots of the extracted packets are reused if they are at least half
+    // of the storage. Otherwise the storage grows, taking only the packets
+    // still in the buffer along.
+    if (first_packet_index_ >= NumPacketsInBuffer()) {
+      buffer_.erase(buffer_.begin(), FirstPacket());
+    } else {
+      std::vector<Packet> packets;
+      packets.reserve(2 * buffer_.capacity());
+      std::move(FirstPacket(), buffer_.end(), std::back_inserter(packets));
+      buffer_.swap(packets);
+    }
+    first_packet_index_ = 0;
+  }
+
   // Get an iterator pointing to the place in the buffer where the new packet
-  // should be inserted. The list is searched from the back, since the most
-  // likely case is that the new packet should be near the end of the list.
-  PacketList::reverse_iterator rit = std::find_if(
-      buffer_.rbegin(), buffer_.rend(), NewTimestampIsLarger(packet));
+  // should be inserted. The buffer is searched from the back, since the most
+  // likely case is that the new packet should be near the end of the buffer.
+  const auto rend = std::make_reverse_iterator(FirstPacket());
+  auto rit = std::find_if(buffer_.rbegin(), rend, NewTimestampIsLarger(packet));
 
   // The new packet is to be inserted to the right of |rit|. If it has the same
   // timestamp as |rit|, which has a higher priority, do not insert the new
-  // packet to list.
-  if (rit != buffer_.rend() && packet.timestamp == rit->timestamp) {
+  // packet to the buffer.
+  if (rit != rend && packet.timestamp == rit->timestamp) {
     LogPacketDiscarded(packet.priority.codec_level, stats);
     return return_val;
   }
@@ -119,10 +136,11 @@ int PacketBuffer::InsertPacket(Packet&& packet, StatisticsCalculator* stats) {
   // The new packet is to be inserted to the left of |it|. If it has the same
   // timestamp as |it|, which has a lower priority, replace |it| with the new
   // packet.
-  PacketList::iterator it = rit.base();
+  auto it = rit.base();
   if (it != buffer_.end() && packet.timestamp == it->timestamp) {
     LogPacketDiscarded(it->priority.codec_level, stats);
-    it = buffer_.erase(it);
+    *it = std::move(packet);
+    return return_val;
   }
   buffer_.insert(it, std::move(packet));  // Insert the packet at that position.
 
@@ -182,7 +200,7 @@ int PacketBuffer::NextTimestamp(uint32_t* next_timestamp) const {
   if (!next_timestamp) {
     return kInvalidPointer;
   }
-  *next_timestamp = buffer_.front().timestamp;
+  *next_timestamp = FirstPacket()->timestamp;
   return kOK;
 }
 
@@ -194,8 +212,7 @@ int PacketBuffer::NextHigherTimestamp(uint32_t timestamp,
   if (!next_timestamp) {
     return kInvalidPointer;
   }
-  PacketList::const_iterator it;
-  for (it = buffer_.begin(); it != buffer_.end(); ++it) {
+  for (auto it = FirstPacket(); it != buffer_.end(); ++it) {
     if (it->timestamp >= timestamp) {
       // Found a packet matching the search.
       *next_timestamp = it->timestamp;
@@ -206,7 +223,7 @@ int PacketBuffer::NextHigherTimestamp(uint32_t timestamp,
 }
 
 const Packet* PacketBuffer::PeekNextPacket() const {
-  return buffer_.empty() ? nullptr : &buffer_.front();
+  return Empty() ? nullptr : &*FirstPacket();
 }
 
 absl::optional<Packet> PacketBuffer::GetNextPacket() {
@@ -215,10 +232,9 @@ absl::optional<Packet> PacketBuffer::GetNextPacket() {
     return absl::nullopt;
   }
 
-  absl::optional<Packet> packet(std::move(buffer_.front()));
+  absl::optional<Packet> packet(PopFirstPacket());
   // Assert that the packet sanity checks in InsertPacket method works.
   RTC_DCHECK(!packet->empty());
-  buffer_.pop_front();
 
   return packet;
 }
@@ -228,17 +244,16 @@ int PacketBuffer::DiscardNextPacket(StatisticsCalculator* stats) {
     return kBufferEmpty;
   }
   // Assert that the packet sanity checks in InsertPacket method works.
-  const Packet& packet = buffer_.front();
+  const Packet packet = PopFirstPacket();
   RTC_DCHECK(!packet.empty());
   LogPacketDiscarded(packet.priority.codec_level, stats);
-  buffer_.pop_front();
   return kOK;
 }
 
 void PacketBuffer::DiscardOldPackets(uint32_t timestamp_limit,
                                      uint32_t horizon_samples,
                                      StatisticsCalculator* stats) {
-  buffer_.remove_if([timestamp_limit, horizon_samples, stats](const Packet& p) {
+  RemovePacketsIf([timestamp_limit, horizon_samples, stats](const Packet& p) {
     if (timestamp_limit == p.timestamp ||
         !IsObsoleteTimestamp(p.timestamp, timestamp_limit, horizon_samples)) {
       return false;
@@ -255,7 +270,7 @@ void PacketBuffer::DiscardAllOldPackets(uint32_t timestamp_limit,
 
 void PacketBuffer::DiscardPacketsWithPayloadType(uint8_t payload_type,
                                                  StatisticsCalculator* stats) {
-  buffer_.remove_if([payload_type, stats](const Packet& p) {
+  RemovePacketsIf([payload_type, stats](const Packet& p) {
     if (p.payload_type != payload_type) {
       return false;
     }
@@ -265,13 +280,14 @@ void PacketBuffer::DiscardPacketsWithPayloadType(uint8_t payload_type,
 }
 
 size_t PacketBuffer::NumPacketsInBuffer() const {
-  return buffer_.size();
+  return buffer_.size() - first_packet_index_;
 }
 
 size_t PacketBuffer::NumSamplesInBuffer(size_t last_decoded_length) const {
   size_t num_samples = 0;
   size_t last_duration = last_decoded_length;
-  for (const Packet& packet : buffer_) {
+  for (auto it = FirstPacket(); it != buffer_.end(); ++it) {
+    const Packet& packet = *it;
     if (packet.frame) {
       // TODO(hlundin): Verify that it's fine to count all packets and remove
       // this check.
@@ -291,11 +307,11 @@ size_t PacketBuffer::NumSamplesInBuffer(size_t last_decoded_length) const {
 size_t PacketBuffer::GetSpanSamples(size_t last_decoded_length,
                                     size_t sample_rate,
                                     bool count_dtx_waiting_time) const {
-  if (buffer_.size() == 0) {
+  if (Empty()) {
     return 0;
   }
 
-  size_t span = buffer_.back().timestamp - buffer_.front().timestamp;
+  size_t span = buffer_.back().timestamp - FirstPacket()->timestamp;
   if (buffer_.back().frame && buffer_.back().frame->Duration() > 0) {
     size_t duration = buffer_.back().frame->Duration();
     if (count_dtx_waiting_time && buffer_.back().frame->IsDtxPacket()) {
@@ -313,7 +329,8 @@ size_t PacketBuffer::GetSpanSamples(size_t last_decoded_length,
 bool PacketBuffer::ContainsDtxOrCngPacket(
     const DecoderDatabase* decoder_database) const {
   RTC_DCHECK(decoder_database);
-  for (const Packet& packet : buffer_) {
+  for (auto it = FirstPacket(); it != buffer_.end(); ++it) {
+    const Packet& packet = *it;
     if ((packet.frame && packet.frame->IsDtxPacket()) ||
         decoder_database->IsComfortNoise(packet.payload_type)) {
       return true;
@@ -322,4 +339,24 @@ bool PacketBuffer::ContainsDtxOrCngPacket(
   return false;
 }
 
+Packet PacketBuffer::PopFirstPacket() {
+  RTC_DCHECK(!Empty());
+  Packet packet = std::move(*FirstPacket());
+  ++first_packet_index_;
+  if (Empty()) {
+    // Start over from the beginning of the storage.
+    Flush();
+  }
+  return packet;
+}
+
+template <typename Predicate>
+void PacketBuffer::RemovePacketsIf(Predicate predicate) {
+  buffer_.erase(std::remove_if(FirstPacket(), buffer_.end(), predicate),
+                buffer_.end());
+  if (Empty()) {
+    Flush();
+  }
+}
+
 }  // namespace webrtc
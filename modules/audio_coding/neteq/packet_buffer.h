@@ -11,6 +11,8 @@
 #ifndef MODULES_AUDIO_CODING_NETEQ_PACKET_BUFFER_H_
 #define MODULES_AUDIO_CODING_NETEQ_PACKET_BUFFER_H_
 
+#include <vector>
+
 #include "absl/types/optional.h"
 #include "modules/audio_coding/neteq/decoder_database.h"
 #include "modules/audio_coding/neteq/packet.h"
@@ -146,8 +148,28 @@ class PacketBuffer {
   }
 
  private:
+  // Returns an iterator to the first packet in the buffer.
+  std::vector<Packet>::iterator FirstPacket() {
+    return buffer_.begin() + first_packet_index_;
+  }
+  std::vector<Packet>::const_iterator FirstPacket() const {
+    return buffer_.begin() + first_packet_index_;
+  }
+
+  // Extracts the first packet in the buffer, which must not be empty.
+  Packet PopFirstPacket();
+
+  // Erases the packets for which |predicate| returns true.
+  template <typename Predicate>
+  void RemovePacketsIf(Predicate predicate);
+
   size_t max_number_of_packets_;
-  PacketList buffer_;
+  // The packets, sorted so that the next packet to decode comes first. The
+  // packets before |first_packet_index_| have already been extracted; their
+  // slots are reused when the buffer would otherwise have to grow, so that a
+  // buffer in steady state does not allocate.
+  std::vector<Packet> buffer_;
+  size_t first_packet_index_ = 0;
   const TickTimer* tick_timer_;
   RTC_DISALLOW_COPY_AND_ASSIGN(PacketBuffer);
 };
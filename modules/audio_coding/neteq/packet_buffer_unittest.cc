@@ -13,6 +13,7 @@
 #include "modules/audio_coding/neteq/packet_buffer.h"
 
 #include <memory>
+#include <utility>
 
 #include "api/audio_codecs/builtin_audio_decoder_factory.h"
 #include "api/neteq/tick_timer.h"
@@ -451,6 +452,50 @@ TEST(PacketBuffer, Reordering) {
   EXPECT_CALL(decoder_database, Die());  // Called when object is deleted.
 }
 
+// Test that packets keep their order when packets are inserted and extracted
+// alternately, so that the buffer reuses the storage of extracted packets.
+TEST(PacketBuffer, InterleavedInsertAndExtract) {
+  TickTimer tick_timer;
+  PacketBuffer buffer(10, &tick_timer);  // 10 packets.
+  const uint32_t start_ts = 4711;
+  const uint32_t ts_increment = 10;
+  PacketGenerator gen(17, start_ts, 0, ts_increment);
+  const int payload_len = 10;
+  StrictMock<MockStatisticsCalculator> mock_stats;
+
+  // Keep four packets in the buffer. Every third packet is swapped with the
+  // one after it, so that some packets are inserted before the last one.
+  uint32_t current_ts = start_ts;
+  for (int i = 0; i < 100; i += 2) {
+    Packet first = gen.NextPacket(payload_len, nullptr);
+    Packet second = gen.NextPacket(payload_len, nullptr);
+    if (i % 3 == 0) {
+      std::swap(first, second);
+    }
+    EXPECT_EQ(PacketBuffer::kOK,
+              buffer.InsertPacket(std::move(first), &mock_stats));
+    EXPECT_EQ(PacketBuffer::kOK,
+              buffer.InsertPacket(std::move(second), &mock_stats));
+    if (i < 4) {
+      continue;
+    }
+    for (int j = 0; j < 2; ++j) {
+      const absl::optional<Packet> packet = buffer.GetNextPacket();
+      ASSERT_TRUE(packet);
+      EXPECT_EQ(current_ts, packet->timestamp);
+      current_ts += ts_increment;
+    }
+    EXPECT_EQ(4u, buffer.NumPacketsInBuffer());
+  }
+  for (int j = 0; j < 4; ++j) {
+    const absl::optional<Packet> packet = buffer.GetNextPacket();
+    ASSERT_TRUE(packet);
+    EXPECT_EQ(current_ts, packet->timestamp);
+    current_ts += ts_increment;
+  }
+  EXPECT_TRUE(buffer.Empty());
+}
+
 // The test first inserts a packet with narrow-band CNG, then a packet with
 // wide-band speech. The expected behavior of the packet buffer is to detect a
 // change in sample rate, even though no speech packet has been inserted before,
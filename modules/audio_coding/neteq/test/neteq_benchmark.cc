@@ -0,0 +1,358 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+// Replays a corpus of RTP dumps and RTC event logs through NetEq as fast as
+// possible and reports the CPU time, the allocations made by NetEq and the
+// growth of the memory use for each of them. The results are printed in the
+// perf test format and can be written as Chart JSON with --output_json for
+// regression tracking.
+
+#include <stdio.h>
+#include <stdlib.h>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/types/optional.h"
+#include "api/audio_codecs/builtin_audio_decoder_factory.h"
+#include "api/neteq/default_neteq_controller_factory.h"
+#include "api/neteq/neteq.h"
+#include "api/neteq/neteq_factory.h"
+#include "modules/audio_coding/neteq/neteq_impl.h"
+#include "modules/audio_coding/neteq/tools/neteq_event_log_input.h"
+#include "modules/audio_coding/neteq/tools/neteq_packet_source_input.h"
+#include "modules/audio_coding/neteq/tools/neteq_test.h"
+#include "modules/audio_coding/neteq/tools/neteq_test_factory.h"
+#include "modules/audio_coding/neteq/tools/rtp_file_source.h"
+#include "modules/rtp_rtcp/include/rtp_rtcp_defines.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/cpu_time.h"
+#include "rtc_base/memory_usage.h"
+#include "test/testsupport/perf_test.h"
+
+ABSL_FLAG(std::string,
+          output_json,
+          "",
+          "If set, the results are written to this file as Chart JSON.");
+
+namespace {
+
+// Updated by the replaced global operator new below while
+// |g_count_allocations| is set.
+std::atomic<bool> g_count_allocations(false);
+std::atomic<int64_t> g_num_allocations(0);
+std::atomic<int64_t> g_allocated_bytes(0);
+
+}  // namespace
+
+// The global allocation functions are replaced to count the allocations made
+// inside NetEq during the simulations.
+void* operator new(size_t size) {
+  if (g_count_allocations.load(std::memory_order_relaxed)) {
+    g_num_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+  }
+  void* ptr = malloc(size > 0 ? size : 1);
+  if (!ptr) {
+    abort();
+  }
+  return ptr;
+}
+
+void operator delete(void* ptr) noexcept {
+  free(ptr);
+}
+
+void operator delete(void* ptr, size_t size) noexcept {
+  free(ptr);
+}
+
+namespace webrtc {
+namespace test {
+namespace {
+
+using TestConfig = NetEqTestFactory::Config;
+
+// The resident size is sampled once per second of audio.
+constexpr int kResidentSizeIntervalGetAudioCalls = 100;
+
+const char* OperationName(NetEq::Operation operation) {
+  switch (operation) {
+    case NetEq::Operation::kNormal:
+      return "normal";
+    case NetEq::Operation::kMerge:
+      return "merge";
+    case NetEq::Operation::kExpand:
+      return "expand";
+    case NetEq::Operation::kAccelerate:
+      return "accelerate";
+    case NetEq::Operation::kFastAccelerate:
+      return "fast_accelerate";
+    case NetEq::Operation::kPreemptiveExpand:
+      return "preemptive_expand";
+    case NetEq::Operation::kRfc3389Cng:
+      return "rfc3389_cng";
+    case NetEq::Operation::kRfc3389CngNoPacket:
+      return "rfc3389_cng_no_packet";
+    case NetEq::Operation::kCodecInternalCng:
+      return "codec_internal_cng";
+    case NetEq::Operation::kDtmf:
+      return "dtmf";
+    case NetEq::Operation::kUndefined:
+      return "undefined";
+  }
+  RTC_NOTREACHED();
+  return "";
+}
+
+// Enables the allocation counting for the lifetime of the object.
+class ScopedAllocationCounting {
+ public:
+  ScopedAllocationCounting() {
+    g_count_allocations.store(true, std::memory_order_relaxed);
+  }
+  ~ScopedAllocationCounting() {
+    g_count_allocations.store(false, std::memory_order_relaxed);
+  }
+};
+
+// Counts the allocations made by InsertPacket and GetAudio only, so that the
+// parsing of the input file and the bookkeeping of NetEqTest are left out.
+class AllocationCountingNetEqImpl : public NetEqImpl {
+ public:
+  using NetEqImpl::NetEqImpl;
+
+  int InsertPacket(const RTPHeader& rtp_header,
+                   rtc::ArrayView<const uint8_t> payload) override {
+    ScopedAllocationCounting counting;
+    return NetEqImpl::InsertPacket(rtp_header, payload);
+  }
+
+  int GetAudio(AudioFrame* audio_frame,
+               bool* muted,
+               absl::optional<Operation> action_override) override {
+    ScopedAllocationCounting counting;
+    return NetEqImpl::GetAudio(audio_frame, muted, action_override);
+  }
+};
+
+// Creates NetEqImpl objects and keeps a pointer to the last one, so that the
+// operation performed by each GetAudio call can be looked up.
+class BenchmarkNetEqFactory : public NetEqFactory {
+ public:
+  std::unique_ptr<NetEq> CreateNetEq(
+      const NetEq::Config& config,
+      const rtc::scoped_refptr<AudioDecoderFactory>& decoder_factory,
+      Clock* clock) const override {
+    auto neteq = std::make_unique<AllocationCountingNetEqImpl>(
+        config, NetEqImpl::Dependencies(config, clock, decoder_factory,
+                                        controller_factory_));
+    neteq_ = neteq.get();
+    return neteq;
+  }
+
+  const NetEqImpl* neteq() const { return neteq_; }
+
+ private:
+  const DefaultNetEqControllerFactory controller_factory_;
+  mutable NetEqImpl* neteq_ = nullptr;
+};
+
+struct OperationStats {
+  int64_t num_calls = 0;
+  int64_t cpu_time_ns = 0;
+};
+
+// Measures the CPU time of each GetAudio call and attributes it to the
+// operation that NetEq performed in that call. Also tracks how far the
+// resident size of the process grows above |baseline_resident_size_bytes|.
+class GetAudioTimer : public NetEqGetAudioCallback {
+ public:
+  GetAudioTimer(const BenchmarkNetEqFactory* neteq_factory,
+                int64_t baseline_resident_size_bytes)
+      : neteq_factory_(neteq_factory),
+        baseline_resident_size_bytes_(baseline_resident_size_bytes),
+        peak_resident_size_bytes_(baseline_resident_size_bytes) {}
+
+  void BeforeGetAudio(NetEq* neteq) override {
+    start_time_ns_ = rtc::GetThreadCpuTimeNanos();
+  }
+
+  void AfterGetAudio(int64_t time_now_ms,
+                     const AudioFrame& audio_frame,
+                     bool muted,
+                     NetEq* neteq) override {
+    const int64_t elapsed_ns = rtc::GetThreadCpuTimeNanos() - start_time_ns_;
+    RTC_DCHECK(neteq_factory_->neteq());
+    OperationStats& stats =
+        operations_[neteq_factory_->neteq()->last_operation_for_test()];
+    ++stats.num_calls;
+    stats.cpu_time_ns += elapsed_ns;
+    get_audio_cpu_time_ns_ += elapsed_ns;
+    if (++num_get_audio_calls_ % kResidentSizeIntervalGetAudioCalls == 0) {
+      UpdatePeakResidentSize();
+    }
+  }
+
+  void UpdatePeakResidentSize() {
+    peak_resident_size_bytes_ = std::max(peak_resident_size_bytes_,
+                                         rtc::GetProcessResidentSizeBytes());
+  }
+
+  const std::map<NetEq::Operation, OperationStats>& operations() const {
+    return operations_;
+  }
+  int64_t get_audio_cpu_time_ns() const { return get_audio_cpu_time_ns_; }
+  int64_t peak_resident_size_increase_bytes() const {
+    return peak_resident_size_bytes_ - baseline_resident_size_bytes_;
+  }
+
+ private:
+  const BenchmarkNetEqFactory* const neteq_factory_;
+  int64_t start_time_ns_ = 0;
+  int64_t num_get_audio_calls_ = 0;
+  int64_t get_audio_cpu_time_ns_ = 0;
+  const int64_t baseline_resident_size_bytes_;
+  int64_t peak_resident_size_bytes_;
+  std::map<NetEq::Operation, OperationStats> operations_;
+};
+
+std::unique_ptr<NetEqInput> CreateInput(const std::string& file_name) {
+  if (RtpFileSource::ValidRtpDump(file_name) ||
+      RtpFileSource::ValidPcap(file_name)) {
+    const NetEqPacketSourceInput::RtpHeaderExtensionMap rtp_ext_map = {
+        {TestConfig::default_audio_level(), kRtpExtensionAudioLevel},
+        {TestConfig::default_abs_send_time(), kRtpExtensionAbsoluteSendTime},
+        {TestConfig::default_transport_seq_no(),
+         kRtpExtensionTransportSequenceNumber},
+        {TestConfig::default_video_content_type(),
+         kRtpExtensionVideoContentType},
+        {TestConfig::default_video_timing(), kRtpExtensionVideoTiming}};
+    return std::make_unique<NetEqRtpDumpInput>(file_name, rtp_ext_map,
+                                               absl::nullopt);
+  }
+  return std::unique_ptr<NetEqInput>(
+      NetEqEventLogInput::CreateFromFile(file_name, absl::nullopt));
+}
+
+std::string StreamLabel(const std::string& file_name) {
+  const size_t pos = file_name.find_last_of("/\\");
+  return pos == std::string::npos ? file_name : file_name.substr(pos + 1);
+}
+
+// Runs the simulation of |file_name| and prints the results. Returns false if
+// the file could not be read.
+bool RunStream(const std::string& file_name) {
+  std::unique_ptr<NetEqInput> input = CreateInput(file_name);
+  if (!input || input->ended()) {
+    std::cerr << "Error: Cannot read input file " << file_name << std::endl;
+    return false;
+  }
+
+  // The resident size is process-wide and includes whatever the earlier files
+  // and the parsed input left behind, so only the growth from here on is
+  // attributed to this file. The heap is trimmed first so that the memory
+  // freed by the earlier files is not silently reused.
+#if defined(__GLIBC__)
+  malloc_trim(0);
+#endif
+  BenchmarkNetEqFactory neteq_factory;
+  GetAudioTimer timer(&neteq_factory, rtc::GetProcessResidentSizeBytes());
+  NetEqTest::Callbacks callbacks;
+  callbacks.get_audio_callback = &timer;
+  NetEq::Config config;
+  config.max_packets_in_buffer = TestConfig::default_max_nr_packets_in_buffer();
+  NetEqTest test(config, CreateBuiltinAudioDecoderFactory(),
+                 NetEqTest::StandardDecoderMap(), /*text_log=*/nullptr,
+                 &neteq_factory, std::move(input), /*output=*/nullptr,
+                 callbacks);
+
+  const int64_t num_allocations_before = g_num_allocations;
+  const int64_t allocated_bytes_before = g_allocated_bytes;
+  const int64_t start_time_ns = rtc::GetThreadCpuTimeNanos();
+  const int64_t simulation_time_ms = test.Run();
+  const int64_t total_cpu_time_ns =
+      rtc::GetThreadCpuTimeNanos() - start_time_ns;
+  const int64_t num_allocations = g_num_allocations - num_allocations_before;
+  const int64_t allocated_bytes = g_allocated_bytes - allocated_bytes_before;
+  timer.UpdatePeakResidentSize();
+  if (simulation_time_ms <= 0) {
+    std::cerr << "Error: No audio produced for " << file_name << std::endl;
+    return false;
+  }
+
+  const std::string label = StreamLabel(file_name);
+  const double simulation_time_s = simulation_time_ms / 1000.0;
+  PrintResult("neteq_simulation_time", "", label, simulation_time_ms, "ms",
+              false);
+  PrintResult("neteq_total_cpu_time", "", label, total_cpu_time_ns / 1e6,
+              "ms", true, ImproveDirection::kSmallerIsBetter);
+  PrintResult("neteq_get_audio_cpu_time", "", label,
+              timer.get_audio_cpu_time_ns() / 1e6, "ms", true,
+              ImproveDirection::kSmallerIsBetter);
+  PrintResult("neteq_get_audio_cpu_time_per_second", "", label,
+              timer.get_audio_cpu_time_ns() / 1e6 / simulation_time_s, "ms",
+              true, ImproveDirection::kSmallerIsBetter);
+  for (const auto& operation : timer.operations()) {
+    const std::string name = OperationName(operation.first);
+    PrintResult("neteq_" + name + "_calls", "", label,
+                operation.second.num_calls, "count", false);
+    PrintResult("neteq_" + name + "_cpu_time", "", label,
+                operation.second.cpu_time_ns / 1e6, "ms", true,
+                ImproveDirection::kSmallerIsBetter);
+  }
+  PrintResult("neteq_allocations_per_second", "", label,
+              num_allocations / simulation_time_s, "count", true,
+              ImproveDirection::kSmallerIsBetter);
+  PrintResult("neteq_allocated_bytes_per_second", "", label,
+              allocated_bytes / simulation_time_s, "bytes", false,
+              ImproveDirection::kSmallerIsBetter);
+  PrintResult("neteq_peak_resident_size_increase", "", label,
+              timer.peak_resident_size_increase_bytes(), "bytes", false,
+              ImproveDirection::kSmallerIsBetter);
+  return true;
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace webrtc
+
+int main(int argc, char* argv[]) {
+  std::vector<char*> args = absl::ParseCommandLine(argc, argv);
+  if (args.size() < 2) {
+    std::cout << "Tool for benchmarking NetEq on recorded audio streams.\n"
+                 "Example usage:\n"
+              << args[0]
+              << " [--output_json=results.json] input1.rtp input2.rtc_log\n";
+    return 1;
+  }
+
+  bool success = true;
+  for (size_t i = 1; i < args.size(); ++i) {
+    success &= webrtc::test::RunStream(args[i]);
+  }
+
+  const std::string output_json = absl::GetFlag(FLAGS_output_json);
+  if (!output_json.empty()) {
+    webrtc::test::WritePerfResults(output_json);
+  }
+  return success ? 0 : 1;
+}
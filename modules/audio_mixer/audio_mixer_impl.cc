@@ -20,48 +20,30 @@
 #include "modules/audio_mixer/audio_frame_manipulator.h"
 #include "modules/audio_mixer/default_output_rate_calculator.h"
 #include "rtc_base/checks.h"
+#include "rtc_base/critical_section.h"
 #include "rtc_base/logging.h"
 #include "rtc_base/ref_counted_object.h"
+#include "rtc_base/time_utils.h"
 
 namespace webrtc {
 namespace {
 
 struct SourceFrame {
   SourceFrame(AudioMixerImpl::SourceStatus* source_status,
-              AudioFrame* audio_frame,
-              bool muted)
-      : source_status(source_status), audio_frame(audio_frame), muted(muted) {
-    RTC_DCHECK(source_status);
-    RTC_DCHECK(audio_frame);
-    if (!muted) {
-      energy = AudioMixerCalculateEnergy(*audio_frame);
-    }
-  }
-
-  SourceFrame(AudioMixerImpl::SourceStatus* source_status,
-              AudioFrame* audio_frame,
-              bool muted,
-              uint32_t energy)
-      : source_status(source_status),
-        audio_frame(audio_frame),
-        muted(muted),
-        energy(energy) {
+              AudioFrame* audio_frame)
+      : source_status(source_status), audio_frame(audio_frame) {
     RTC_DCHECK(source_status);
     RTC_DCHECK(audio_frame);
   }
 
   AudioMixerImpl::SourceStatus* source_status = nullptr;
   AudioFrame* audio_frame = nullptr;
-  bool muted = true;
+  // Only computed when the sources to mix have to be selected.
   uint32_t energy = 0;
 };
 
 // ShouldMixBefore(a, b) is used to select mixer sources.
 bool ShouldMixBefore(const SourceFrame& a, const SourceFrame& b) {
-  if (a.muted != b.muted) {
-    return b.muted;
-  }
-
   const auto a_activity = a.audio_frame->vad_activity_;
   const auto b_activity = b.audio_frame->vad_activity_;
 
@@ -93,14 +75,130 @@ AudioMixerImpl::SourceStatusList::const_iterator FindSourceInList(
 }
 }  // namespace
 
+// The sources pulled in parallel for one call to Mix(). The mixer reuses the
+// same round for every call, so the worker tasks are tagged with the
+// generation they were posted for. Tasks still queued when a later round
+// starts find nothing to pull. Once a round is cancelled, the workers don't
+// touch the sources they have not started pulling, which may then be removed
+// or queued for another round.
+class AudioMixerImpl::PullRound {
+ public:
+  explicit PullRound(rtc::Event* late_pull_done)
+      : late_pull_done_(late_pull_done) {}
+
+  // Starts a new round without sources, and returns its generation.
+  uint64_t Reset() {
+    rtc::CritScope lock(&crit_);
+    ++generation_;
+    sources_.clear();
+    next_ = 0;
+    remaining_ = 0;
+    cancelled_ = false;
+    done_.Reset();
+    return generation_;
+  }
+
+  // Adds |source| to the round. Must be called before the round is posted.
+  void AddSource(SourceStatus* source) {
+    rtc::CritScope lock(&crit_);
+    sources_.push_back(source);
+    ++remaining_;
+  }
+
+  // Only called by the mixer, which is also the only thread changing them.
+  const std::vector<SourceStatus*>& sources() const
+      RTC_NO_THREAD_SAFETY_ANALYSIS {
+    return sources_;
+  }
+
+  // Pulls the sources of round |generation| not taken by another thread yet,
+  // one at a time, until the round is cancelled.
+  void PullSources(uint64_t generation, int sample_rate_hz) {
+    while (SourceStatus* const source = TakeSource(generation)) {
+      source->pull_result = source->audio_source->GetAudioFrameWithInfo(
+          sample_rate_hz, &source->audio_frame);
+      PullState state = PullState::kPulling;
+      if (source->pull_state.compare_exchange_strong(state,
+                                                     PullState::kDone)) {
+        rtc::CritScope lock(&crit_);
+        // The mixer may already have collected the frame and started a new
+        // round.
+        if (generation == generation_ && --remaining_ == 0) {
+          done_.Set();
+        }
+      } else {
+        // The mixer has moved on without this frame.
+        RTC_DCHECK(state == PullState::kLate);
+        source->pull_state = PullState::kIdle;
+        late_pull_done_->Set();
+      }
+    }
+  }
+
+  // Returns true if all frames were ready within |max_wait_ms|.
+  bool Wait(int max_wait_ms) { return done_.Wait(max_wait_ms); }
+
+  // Called by the mixer once it stops waiting. The sources still queued are
+  // left to the mixer.
+  void Cancel() {
+    rtc::CritScope lock(&crit_);
+    cancelled_ = true;
+  }
+
+ private:
+  // Returns the next source to pull, or null if there is none or round
+  // |generation| is cancelled or over.
+  SourceStatus* TakeSource(uint64_t generation) {
+    rtc::CritScope lock(&crit_);
+    if (generation != generation_ || cancelled_ || next_ == sources_.size()) {
+      return nullptr;
+    }
+    SourceStatus* const source = sources_[next_++];
+    RTC_DCHECK(source->pull_state == PullState::kQueued);
+    source->pull_state = PullState::kPulling;
+    return source;
+  }
+
+  rtc::Event* const late_pull_done_;
+  rtc::CriticalSection crit_;
+  uint64_t generation_ RTC_GUARDED_BY(crit_) = 0;
+  std::vector<SourceStatus*> sources_ RTC_GUARDED_BY(crit_);
+  size_t next_ RTC_GUARDED_BY(crit_) = 0;
+  size_t remaining_ RTC_GUARDED_BY(crit_) = 0;
+  bool cancelled_ RTC_GUARDED_BY(crit_) = false;
+  rtc::Event done_;
+};
+
+constexpr int AudioMixerImpl::kMixAllSources;
+
 AudioMixerImpl::AudioMixerImpl(
     std::unique_ptr<OutputRateCalculator> output_rate_calculator,
-    bool use_limiter)
+    bool use_limiter,
+    int max_sources_to_mix,
+    const ParallelPullConfig* parallel_pull_config)
     : output_rate_calculator_(std::move(output_rate_calculator)),
+      max_sources_to_mix_(max_sources_to_mix),
       output_frequency_(0),
       sample_size_(0),
       audio_source_list_(),
-      frame_combiner_(use_limiter) {}
+      frame_combiner_(use_limiter),
+      pull_deadline_ms_(parallel_pull_config ? parallel_pull_config->deadline_ms
+                                             : 0) {
+  RTC_DCHECK_GT(max_sources_to_mix_, 0);
+  if (parallel_pull_config) {
+    RTC_DCHECK(parallel_pull_config->task_queue_factory);
+    RTC_DCHECK_GT(parallel_pull_config->number_of_threads, 0);
+    RTC_DCHECK_GE(parallel_pull_config->deadline_ms, 0);
+    pull_round_ = std::make_unique<PullRound>(&late_pull_done_);
+    for (int i = 0; i < parallel_pull_config->number_of_threads; ++i) {
+      pull_workers_.push_back(std::make_unique<PullWorker>());
+      pull_workers_.back()->task_queue = std::make_unique<rtc::TaskQueue>(
+          parallel_pull_config->task_queue_factory->CreateTaskQueue(
+              "AudioMixerPull", TaskQueueFactory::Priority::HIGH));
+      pull_worker_order_.push_back(pull_workers_.back().get());
+    }
+  }
+}
 
 AudioMixerImpl::~AudioMixerImpl() {}
 
@@ -113,15 +211,36 @@ rtc::scoped_refptr<AudioMixerImpl> AudioMixerImpl::Create() {
 rtc::scoped_refptr<AudioMixerImpl> AudioMixerImpl::Create(
     std::unique_ptr<OutputRateCalculator> output_rate_calculator,
     bool use_limiter) {
+  return Create(std::move(output_rate_calculator), use_limiter,
+                kMaximumAmountOfMixedAudioSources);
+}
+
+rtc::scoped_refptr<AudioMixerImpl> AudioMixerImpl::Create(
+    std::unique_ptr<OutputRateCalculator> output_rate_calculator,
+    bool use_limiter,
+    int max_sources_to_mix) {
+  return rtc::scoped_refptr<AudioMixerImpl>(
+      new rtc::RefCountedObject<AudioMixerImpl>(
+          std::move(output_rate_calculator), use_limiter, max_sources_to_mix,
+          nullptr));
+}
+
+rtc::scoped_refptr<AudioMixerImpl> AudioMixerImpl::Create(
+    std::unique_ptr<OutputRateCalculator> output_rate_calculator,
+    bool use_limiter,
+    int max_sources_to_mix,
+    const ParallelPullConfig& parallel_pull_config) {
   return rtc::scoped_refptr<AudioMixerImpl>(
       new rtc::RefCountedObject<AudioMixerImpl>(
-          std::move(output_rate_calculator), use_limiter));
+          std::move(output_rate_calculator), use_limiter, max_sources_to_mix,
+          &parallel_pull_config));
 }
 
 void AudioMixerImpl::Mix(size_t number_of_channels,
                          AudioFrame* audio_frame_for_mixing) {
   RTC_DCHECK(number_of_channels >= 1);
   RTC_DCHECK_RUNS_SERIALIZED(&race_checker_);
+  mix_start_ms_ = rtc::TimeMillis();
 
   CalculateOutputFrequency();
 
@@ -136,6 +255,24 @@ void AudioMixerImpl::Mix(size_t number_of_channels,
   return;
 }
 
+void AudioMixerImpl::MixFloat(size_t number_of_channels,
+                              AudioFrame* audio_frame_for_mixing,
+                              float* float_data) {
+  RTC_DCHECK(number_of_channels >= 1);
+  RTC_DCHECK_RUNS_SERIALIZED(&race_checker_);
+  mix_start_ms_ = rtc::TimeMillis();
+
+  CalculateOutputFrequency();
+
+  {
+    rtc::CritScope lock(&crit_);
+    const size_t number_of_streams = audio_source_list_.size();
+    frame_combiner_.CombineToFloat(GetAudioFromSources(), number_of_channels,
+                                   OutputFrequency(), number_of_streams,
+                                   audio_frame_for_mixing, float_data);
+  }
+}
+
 void AudioMixerImpl::CalculateOutputFrequency() {
   RTC_DCHECK_RUNS_SERIALIZED(&race_checker_);
   rtc::CritScope lock(&crit_);
@@ -172,6 +309,10 @@ void AudioMixerImpl::RemoveSource(Source* audio_source) {
   rtc::CritScope lock(&crit_);
   const auto iter = FindSourceInList(audio_source, &audio_source_list_);
   RTC_DCHECK(iter != audio_source_list_.end()) << "Source not present in mixer";
+  // A pull that missed its deadline may still be running on a worker.
+  while ((*iter)->pull_state != PullState::kIdle) {
+    late_pull_done_.Wait(rtc::Event::kForever);
+  }
   audio_source_list_.erase(iter);
 }
 
@@ -179,49 +320,123 @@ AudioFrameList AudioMixerImpl::GetAudioFromSources() {
   RTC_DCHECK_RUNS_SERIALIZED(&race_checker_);
   AudioFrameList result;
   std::vector<SourceFrame> audio_source_mixing_data_list;
-  std::vector<SourceFrame> ramp_list;
 
-  // Get audio from the audio sources and put it in the SourceFrame vector.
-  for (auto& source_and_status : audio_source_list_) {
-    const auto audio_frame_info =
-        source_and_status->audio_source->GetAudioFrameWithInfo(
-            OutputFrequency(), &source_and_status->audio_frame);
+  // Get audio from the audio sources.
+  std::vector<SourceStatus*> pulled_sources;
+  if (pull_workers_.empty()) {
+    for (auto& source_and_status : audio_source_list_) {
+      source_and_status->pull_result =
+          source_and_status->audio_source->GetAudioFrameWithInfo(
+              OutputFrequency(), &source_and_status->audio_frame);
+      pulled_sources.push_back(source_and_status.get());
+    }
+  } else {
+    PullSourcesInParallel(&pulled_sources);
+  }
 
-    if (audio_frame_info == Source::AudioFrameInfo::kError) {
+  // Put the unmuted frames in the SourceFrame vector.
+  for (SourceStatus* source_status : pulled_sources) {
+    if (source_status->pull_result == Source::AudioFrameInfo::kError) {
       RTC_LOG_F(LS_WARNING) << "failed to GetAudioFrameWithInfo() from source";
       continue;
     }
-    audio_source_mixing_data_list.emplace_back(
-        source_and_status.get(), &source_and_status->audio_frame,
-        audio_frame_info == Source::AudioFrameInfo::kMuted);
+    if (source_status->pull_result == Source::AudioFrameInfo::kMuted) {
+      source_status->is_mixed = false;
+      continue;
+    }
+    audio_source_mixing_data_list.emplace_back(source_status,
+                                               &source_status->audio_frame);
   }
 
-  // Sort frames by sorting function.
-  std::sort(audio_source_mixing_data_list.begin(),
-            audio_source_mixing_data_list.end(), ShouldMixBefore);
-
-  int max_audio_frame_counter = kMaximumAmountOfMixedAudioSources;
+  // Only rank the frames when some of them can't be mixed.
+  const size_t max_audio_frame_count = static_cast<size_t>(max_sources_to_mix_);
+  if (audio_source_mixing_data_list.size() > max_audio_frame_count) {
+    for (auto& p : audio_source_mixing_data_list) {
+      p.energy = AudioMixerCalculateEnergy(*p.audio_frame);
+    }
+    std::partial_sort(
+        audio_source_mixing_data_list.begin(),
+        audio_source_mixing_data_list.begin() + max_audio_frame_count,
+        audio_source_mixing_data_list.end(), ShouldMixBefore);
+    for (size_t i = max_audio_frame_count;
+         i < audio_source_mixing_data_list.size(); ++i) {
+      audio_source_mixing_data_list[i].source_status->is_mixed = false;
+    }
+    audio_source_mixing_data_list.erase(
+        audio_source_mixing_data_list.begin() + max_audio_frame_count,
+        audio_source_mixing_data_list.end());
+  }
 
-  // Go through list in order and put unmuted frames in result list.
   for (const auto& p : audio_source_mixing_data_list) {
-    // Filter muted.
-    if (p.muted) {
-      p.source_status->is_mixed = false;
-      continue;
+    result.push_back(p.audio_frame);
+    p.source_status->is_mixed = true;
+  }
+  RampAndUpdateGain(audio_source_mixing_data_list);
+  return result;
+}
+
+void AudioMixerImpl::PullSourcesInParallel(
+    std::vector<SourceStatus*>* pulled) {
+  RTC_DCHECK_RUNS_SERIALIZED(&race_checker_);
+  const uint64_t generation = pull_round_->Reset();
+  for (auto& source_and_status : audio_source_list_) {
+    PullState state = PullState::kIdle;
+    if (source_and_status->pull_state.compare_exchange_strong(
+            state, PullState::kQueued)) {
+      pull_round_->AddSource(source_and_status.get());
+    } else {
+      RTC_DCHECK(state == PullState::kLate);
+      source_and_status->is_mixed = false;
     }
+  }
+  if (pull_round_->sources().empty()) {
+    return;
+  }
 
-    // Add frame to result vector for mixing.
-    bool is_mixed = false;
-    if (max_audio_frame_counter > 0) {
-      --max_audio_frame_counter;
-      result.push_back(p.audio_frame);
-      ramp_list.emplace_back(p.source_status, p.audio_frame, false, -1);
-      is_mixed = true;
+  // The calling thread only waits, so that a slow source can't hold it past
+  // the deadline.
+  const size_t number_of_workers =
+      std::min(pull_worker_order_.size(), pull_round_->sources().size());
+  std::partial_sort(pull_worker_order_.begin(),
+                    pull_worker_order_.begin() + number_of_workers,
+                    pull_worker_order_.end(),
+                    [](PullWorker* a, PullWorker* b) {
+                      return a->pending_rounds < b->pending_rounds;
+                    });
+  PullRound* const round = pull_round_.get();
+  const int sample_rate_hz = OutputFrequency();
+  for (size_t i = 0; i < number_of_workers; ++i) {
+    PullWorker* const worker = pull_worker_order_[i];
+    ++worker->pending_rounds;
+    worker->task_queue->PostTask([round, generation, sample_rate_hz, worker] {
+      round->PullSources(generation, sample_rate_hz);
+      --worker->pending_rounds;
+    });
+  }
+  const int64_t elapsed_ms = rtc::TimeMillis() - mix_start_ms_;
+  round->Wait(static_cast<int>(
+      std::max<int64_t>(pull_deadline_ms_ - elapsed_ms, 0)));
+  round->Cancel();
+
+  for (SourceStatus* source_status : round->sources()) {
+    PullState state = PullState::kQueued;
+    if (source_status->pull_state.compare_exchange_strong(state,
+                                                          PullState::kIdle)) {
+      // Not started in time.
+      source_status->is_mixed = false;
+      continue;
+    }
+    state = PullState::kPulling;
+    if (source_status->pull_state.compare_exchange_strong(state,
+                                                          PullState::kLate)) {
+      // Completed by the worker, which then makes the source idle again.
+      source_status->is_mixed = false;
+      continue;
     }
-    p.source_status->is_mixed = is_mixed;
+    RTC_DCHECK(state == PullState::kDone);
+    source_status->pull_state = PullState::kIdle;
+    pulled->push_back(source_status);
   }
-  RampAndUpdateGain(ramp_list);
-  return result;
 }
 
 bool AudioMixerImpl::GetAudioSourceMixabilityStatusForTest(
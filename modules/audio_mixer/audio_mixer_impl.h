@@ -13,17 +13,22 @@
 
 #include <stddef.h>
 
+#include <atomic>
+#include <limits>
 #include <memory>
 #include <vector>
 
 #include "api/audio/audio_frame.h"
 #include "api/audio/audio_mixer.h"
 #include "api/scoped_refptr.h"
+#include "api/task_queue/task_queue_factory.h"
 #include "modules/audio_mixer/frame_combiner.h"
 #include "modules/audio_mixer/output_rate_calculator.h"
 #include "rtc_base/constructor_magic.h"
 #include "rtc_base/critical_section.h"
+#include "rtc_base/event.h"
 #include "rtc_base/race_checker.h"
+#include "rtc_base/task_queue.h"
 #include "rtc_base/thread_annotations.h"
 
 namespace webrtc {
@@ -32,6 +37,9 @@ typedef std::vector<AudioFrame*> AudioFrameList;
 
 class AudioMixerImpl : public AudioMixer {
  public:
+  // Progress of a source pull on a worker thread, see ParallelPullConfig.
+  enum class PullState { kIdle, kQueued, kPulling, kDone, kLate };
+
   struct SourceStatus {
     SourceStatus(Source* audio_source, bool is_mixed, float gain)
         : audio_source(audio_source), is_mixed(is_mixed), gain(gain) {}
@@ -41,13 +49,36 @@ class AudioMixerImpl : public AudioMixer {
 
     // A frame that will be passed to audio_source->GetAudioFrameWithInfo.
     AudioFrame audio_frame;
+
+    // Only used when the sources are pulled in parallel.
+    std::atomic<PullState> pull_state{PullState::kIdle};
+    Source::AudioFrameInfo pull_result = Source::AudioFrameInfo::kError;
+  };
+
+  // Pulls audio from the sources on worker threads, e.g. when decoding the
+  // streams of many participants takes a large part of the 10 ms frame.
+  // Sources must then support being pulled from different threads, one at a
+  // time.
+  struct ParallelPullConfig {
+    TaskQueueFactory* task_queue_factory = nullptr;
+    // Worker threads pulling the sources. The thread calling Mix() waits for
+    // them.
+    int number_of_threads = 2;
+    // Sources that have not delivered their frame this long after Mix() was
+    // called are left out of the mix, and of the following mixes until their
+    // pull has completed.
+    int deadline_ms = 8;
   };
 
   using SourceStatusList = std::vector<std::unique_ptr<SourceStatus>>;
 
   // AudioProcessing only accepts 10 ms frames.
   static const int kFrameDurationInMs = 10;
+  // Default number of sources mixed every 10 ms.
   enum : int { kMaximumAmountOfMixedAudioSources = 3 };
+  // Mixes every source that is not muted, e.g. for local mixing of a
+  // microphone with several music tracks.
+  static constexpr int kMixAllSources = std::numeric_limits<int>::max();
 
   static rtc::scoped_refptr<AudioMixerImpl> Create();
 
@@ -55,6 +86,19 @@ class AudioMixerImpl : public AudioMixer {
       std::unique_ptr<OutputRateCalculator> output_rate_calculator,
       bool use_limiter);
 
+  // Mixes up to |max_sources_to_mix| sources. The loudest sources, preferring
+  // those with voice activity, are picked only when there are more of them.
+  static rtc::scoped_refptr<AudioMixerImpl> Create(
+      std::unique_ptr<OutputRateCalculator> output_rate_calculator,
+      bool use_limiter,
+      int max_sources_to_mix);
+
+  static rtc::scoped_refptr<AudioMixerImpl> Create(
+      std::unique_ptr<OutputRateCalculator> output_rate_calculator,
+      bool use_limiter,
+      int max_sources_to_mix,
+      const ParallelPullConfig& parallel_pull_config);
+
   ~AudioMixerImpl() override;
 
   // AudioMixer functions
@@ -64,6 +108,9 @@ class AudioMixerImpl : public AudioMixer {
   void Mix(size_t number_of_channels,
            AudioFrame* audio_frame_for_mixing) override
       RTC_LOCKS_EXCLUDED(crit_);
+  void MixFloat(size_t number_of_channels,
+                AudioFrame* audio_frame_for_mixing,
+                float* float_data) override RTC_LOCKS_EXCLUDED(crit_);
 
   // Returns true if the source was mixed last round. Returns
   // false and logs an error if the source was never added to the
@@ -72,7 +119,9 @@ class AudioMixerImpl : public AudioMixer {
 
  protected:
   AudioMixerImpl(std::unique_ptr<OutputRateCalculator> output_rate_calculator,
-                 bool use_limiter);
+                 bool use_limiter,
+                 int max_sources_to_mix,
+                 const ParallelPullConfig* parallel_pull_config);
 
  private:
   // Set mixing frequency through OutputFrequencyCalculator.
@@ -81,10 +130,17 @@ class AudioMixerImpl : public AudioMixer {
   int OutputFrequency() const;
 
   // Compute what audio sources to mix from audio_source_list_. Ramp
-  // in and out. Update mixed status. Mixes up to
-  // kMaximumAmountOfMixedAudioSources audio sources.
+  // in and out. Update mixed status. Mixes up to max_sources_to_mix_
+  // audio sources.
   AudioFrameList GetAudioFromSources() RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
 
+  // Pulls audio from the sources that are not still busy with a late pull,
+  // on the worker threads, and waits until all frames are ready or the
+  // deadline has passed. The sources of the frames ready in time are
+  // appended to |pulled|.
+  void PullSourcesInParallel(std::vector<SourceStatus*>* pulled)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_);
+
   // The critical section lock guards audio source insertion and
   // removal, which can be done from any thread. The race checker
   // checks that mixing is done sequentially.
@@ -92,9 +148,13 @@ class AudioMixerImpl : public AudioMixer {
   rtc::RaceChecker race_checker_;
 
   std::unique_ptr<OutputRateCalculator> output_rate_calculator_;
+  const int max_sources_to_mix_;
   // The current sample frequency and sample size when mixing.
   int output_frequency_ RTC_GUARDED_BY(race_checker_);
   size_t sample_size_ RTC_GUARDED_BY(race_checker_);
+  // When the current call to Mix() started, which the deadline of the
+  // parallel pulls is counted from.
+  int64_t mix_start_ms_ RTC_GUARDED_BY(race_checker_) = 0;
 
   // List of all audio sources. Note all lists are disjunct
   SourceStatusList audio_source_list_ RTC_GUARDED_BY(crit_);  // May be mixed.
@@ -102,6 +162,26 @@ class AudioMixerImpl : public AudioMixer {
   // Component that handles actual adding of audio frames.
   FrameCombiner frame_combiner_ RTC_GUARDED_BY(race_checker_);
 
+  struct PullWorker {
+    // Rounds posted and not completed. A worker busy with a late pull is
+    // given no new rounds while others are idle.
+    std::atomic<int> pending_rounds{0};
+    std::unique_ptr<rtc::TaskQueue> task_queue;
+  };
+
+  class PullRound;
+
+  // Set by the workers when a pull that missed its deadline completes.
+  rtc::Event late_pull_done_;
+  const int pull_deadline_ms_;
+  // Null unless the sources are pulled in parallel. Reused by every Mix().
+  std::unique_ptr<PullRound> pull_round_;
+  // The workers, least busy first as of the last Mix().
+  std::vector<PullWorker*> pull_worker_order_ RTC_GUARDED_BY(race_checker_);
+  // Empty unless the sources are pulled in parallel. Declared last, so that
+  // pending pulls complete before the state they use is destroyed.
+  std::vector<std::unique_ptr<PullWorker>> pull_workers_;
+
   RTC_DISALLOW_COPY_AND_ASSIGN(AudioMixerImpl);
 };
 }  // namespace webrtc
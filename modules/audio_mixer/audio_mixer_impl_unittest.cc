@@ -12,15 +12,20 @@
 
 #include <string.h>
 
+#include <algorithm>
+#include <atomic>
 #include <limits>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "api/audio/audio_mixer.h"
+#include "api/task_queue/default_task_queue_factory.h"
 #include "modules/audio_mixer/default_output_rate_calculator.h"
 #include "rtc_base/bind.h"
 #include "rtc_base/checks.h"
+#include "rtc_base/event.h"
 #include "rtc_base/strings/string_builder.h"
 #include "rtc_base/task_queue_for_test.h"
 #include "test/gmock.h"
@@ -100,6 +105,42 @@ class MockMixerAudioSource : public ::testing::NiceMock<AudioMixer::Source> {
   AudioFrameInfo fake_audio_frame_info_;
 };
 
+// Source whose pulls block until released, as a stream with a slow decoder.
+class BlockingAudioSource : public AudioMixer::Source {
+ public:
+  explicit BlockingAudioSource(int16_t sample) : sample_(sample) {}
+
+  AudioFrameInfo GetAudioFrameWithInfo(int sample_rate_hz,
+                                       AudioFrame* audio_frame) override {
+    ++number_of_pulls_;
+    if (blocking_) {
+      release_.Wait(rtc::Event::kForever);
+    }
+    ResetFrame(audio_frame);
+    audio_frame->sample_rate_hz_ = sample_rate_hz;
+    audio_frame->samples_per_channel_ = sample_rate_hz / 100;
+    std::fill(audio_frame->mutable_data(),
+              audio_frame->mutable_data() + audio_frame->samples_per_channel_,
+              sample_);
+    return AudioFrameInfo::kNormal;
+  }
+  int Ssrc() const override { return 0; }
+  int PreferredSampleRate() const override { return kDefaultSampleRateHz; }
+
+  void Block() { blocking_ = true; }
+  void Release() {
+    blocking_ = false;
+    release_.Set();
+  }
+  int number_of_pulls() const { return number_of_pulls_; }
+
+ private:
+  const int16_t sample_;
+  std::atomic<bool> blocking_{false};
+  std::atomic<int> number_of_pulls_{0};
+  rtc::Event release_;
+};
+
 class CustomRateCalculator : public OutputRateCalculator {
  public:
   explicit CustomRateCalculator(int rate) : rate_(rate) {}
@@ -369,6 +410,227 @@ TEST(AudioMixer, RampedOutSourcesShouldNotBeMarkedMixed) {
   }
 }
 
+TEST(AudioMixer, MixAllSourcesMixesEveryUnmutedSource) {
+  constexpr int kAudioSources =
+      AudioMixerImpl::kMaximumAmountOfMixedAudioSources + 3;
+
+  const auto mixer = AudioMixerImpl::Create(
+      std::make_unique<DefaultOutputRateCalculator>(), false,
+      AudioMixerImpl::kMixAllSources);
+  MockMixerAudioSource participants[kAudioSources];
+
+  for (int i = 0; i < kAudioSources; ++i) {
+    ResetFrame(participants[i].fake_frame());
+    int16_t* frame_data = participants[i].fake_frame()->mutable_data();
+    std::fill(frame_data, frame_data + kDefaultSampleRateHz / 100, 100 * i);
+    // Voice activity does not matter when all sources are mixed.
+    if (i % 2 == 0) {
+      participants[i].fake_frame()->vad_activity_ = AudioFrame::kVadPassive;
+    }
+    EXPECT_TRUE(mixer->AddSource(&participants[i]));
+  }
+  participants[1].set_fake_info(AudioMixer::Source::AudioFrameInfo::kMuted);
+
+  // Two mix iterations to compare after the ramp-up step.
+  AudioFrame audio_frame;
+  for (int i = 0; i < 2; ++i) {
+    mixer->Mix(1, &audio_frame);
+  }
+
+  int16_t expected_sample = 0;
+  for (int i = 0; i < kAudioSources; ++i) {
+    const bool is_mixed =
+        mixer->GetAudioSourceMixabilityStatusForTest(&participants[i]);
+    EXPECT_EQ(i != 1, is_mixed)
+        << "Mixing status of AudioSource #" << i << " wrong.";
+    if (is_mixed) {
+      expected_sample += 100 * i;
+    }
+  }
+  EXPECT_EQ(expected_sample,
+            audio_frame.data()[kDefaultSampleRateHz / 100 - 1]);
+}
+
+TEST(AudioMixer, MixFloatKeepsSamplesBeyond16Bits) {
+  const auto mixer = AudioMixerImpl::Create(
+      std::make_unique<DefaultOutputRateCalculator>(), false);
+  MockMixerAudioSource participants[2];
+  for (MockMixerAudioSource& participant : participants) {
+    ResetFrame(participant.fake_frame());
+    int16_t* frame_data = participant.fake_frame()->mutable_data();
+    std::fill(frame_data, frame_data + kDefaultSampleRateHz / 100, 20000);
+    EXPECT_TRUE(mixer->AddSource(&participant));
+  }
+
+  // Two mix iterations to compare after the ramp-up step.
+  AudioFrame audio_frame;
+  std::vector<float> float_data(AudioFrame::kMaxDataSizeSamples);
+  for (int i = 0; i < 2; ++i) {
+    mixer->MixFloat(1, &audio_frame, float_data.data());
+  }
+  EXPECT_EQ(static_cast<size_t>(kDefaultSampleRateHz / 100),
+            audio_frame.samples_per_channel_);
+  EXPECT_EQ(40000.f, float_data[kDefaultSampleRateHz / 100 - 1]);
+
+  mixer->Mix(1, &audio_frame);
+  EXPECT_EQ(32767, audio_frame.data()[kDefaultSampleRateHz / 100 - 1]);
+}
+
+TEST(AudioMixer, ConfiguredNumberOfLoudestSourcesMixed) {
+  constexpr int kSourcesToMix = 5;
+  constexpr int kAudioSources = kSourcesToMix + 2;
+
+  const auto mixer = AudioMixerImpl::Create(
+      std::make_unique<DefaultOutputRateCalculator>(), true, kSourcesToMix);
+  MockMixerAudioSource participants[kAudioSources];
+
+  for (int i = 0; i < kAudioSources; ++i) {
+    ResetFrame(participants[i].fake_frame());
+    // Set the participant audio energy to increase with the index |i|.
+    participants[i].fake_frame()->mutable_data()[80] = 100 * i;
+    EXPECT_TRUE(mixer->AddSource(&participants[i]));
+  }
+
+  mixer->Mix(1, &frame_for_mixing);
+
+  for (int i = 0; i < kAudioSources; ++i) {
+    EXPECT_EQ(i >= kAudioSources - kSourcesToMix,
+              mixer->GetAudioSourceMixabilityStatusForTest(&participants[i]))
+        << "Mixing status of AudioSource #" << i << " wrong.";
+  }
+}
+
+TEST(AudioMixer, ParallelPullMixesAllSources) {
+  constexpr int kAudioSources = 5;
+  const auto task_queue_factory = CreateDefaultTaskQueueFactory();
+  AudioMixerImpl::ParallelPullConfig config;
+  config.task_queue_factory = task_queue_factory.get();
+  config.deadline_ms = 1000;
+  const auto mixer = AudioMixerImpl::Create(
+      std::make_unique<DefaultOutputRateCalculator>(), false,
+      AudioMixerImpl::kMixAllSources, config);
+
+  std::vector<std::unique_ptr<BlockingAudioSource>> sources;
+  int16_t expected_sample = 0;
+  for (int i = 0; i < kAudioSources; ++i) {
+    sources.push_back(std::make_unique<BlockingAudioSource>(100 * (i + 1)));
+    expected_sample += 100 * (i + 1);
+    EXPECT_TRUE(mixer->AddSource(sources.back().get()));
+  }
+
+  // Two mix iterations to compare after the ramp-up step.
+  AudioFrame audio_frame;
+  for (int i = 0; i < 2; ++i) {
+    mixer->Mix(1, &audio_frame);
+  }
+
+  for (const auto& source : sources) {
+    EXPECT_EQ(2, source->number_of_pulls());
+    EXPECT_TRUE(mixer->GetAudioSourceMixabilityStatusForTest(source.get()));
+  }
+  EXPECT_EQ(expected_sample,
+            audio_frame.data()[kDefaultSampleRateHz / 100 - 1]);
+}
+
+TEST(AudioMixer, ParallelPullLeavesOutSourcesMissingDeadline) {
+  const auto task_queue_factory = CreateDefaultTaskQueueFactory();
+  AudioMixerImpl::ParallelPullConfig config;
+  config.task_queue_factory = task_queue_factory.get();
+  config.deadline_ms = 50;
+  const auto mixer = AudioMixerImpl::Create(
+      std::make_unique<DefaultOutputRateCalculator>(), false,
+      AudioMixerImpl::kMixAllSources, config);
+
+  BlockingAudioSource slow_source(100);
+  BlockingAudioSource fast_source(200);
+  slow_source.Block();
+  EXPECT_TRUE(mixer->AddSource(&slow_source));
+  EXPECT_TRUE(mixer->AddSource(&fast_source));
+
+  mixer->Mix(1, &frame_for_mixing);
+  EXPECT_FALSE(mixer->GetAudioSourceMixabilityStatusForTest(&slow_source));
+  EXPECT_TRUE(mixer->GetAudioSourceMixabilityStatusForTest(&fast_source));
+
+  // The late source is not pulled again until its pull completes.
+  mixer->Mix(1, &frame_for_mixing);
+  EXPECT_EQ(1, slow_source.number_of_pulls());
+  EXPECT_EQ(2, fast_source.number_of_pulls());
+
+  slow_source.Release();
+  bool slow_source_mixed = false;
+  for (int i = 0; i < 100 && !slow_source_mixed; ++i) {
+    mixer->Mix(1, &frame_for_mixing);
+    slow_source_mixed =
+        mixer->GetAudioSourceMixabilityStatusForTest(&slow_source);
+  }
+  EXPECT_TRUE(slow_source_mixed);
+}
+
+TEST(AudioMixer, RemoveSourceWaitsForLatePull) {
+  const auto task_queue_factory = CreateDefaultTaskQueueFactory();
+  AudioMixerImpl::ParallelPullConfig config;
+  config.task_queue_factory = task_queue_factory.get();
+  config.deadline_ms = 50;
+  const auto mixer = AudioMixerImpl::Create(
+      std::make_unique<DefaultOutputRateCalculator>(), false,
+      AudioMixerImpl::kMixAllSources, config);
+
+  auto source = std::make_unique<BlockingAudioSource>(100);
+  source->Block();
+  EXPECT_TRUE(mixer->AddSource(source.get()));
+  mixer->Mix(1, &frame_for_mixing);
+  EXPECT_EQ(1, source->number_of_pulls());
+
+  TaskQueueForTest release_queue("release");
+  BlockingAudioSource* const source_ptr = source.get();
+  release_queue.PostDelayedTask([source_ptr] { source_ptr->Release(); }, 10);
+  // Returns once the source is no longer used by the workers, so that it can
+  // be destroyed.
+  mixer->RemoveSource(source.get());
+  release_queue.SendTask([] {}, RTC_FROM_HERE);
+  source.reset();
+}
+
+// A worker still busy with the round of an earlier Mix() must leave the
+// sources of that round it has not started to the mixer, as they may have
+// been removed or queued for a later round since.
+TEST(AudioMixer, RemoveSourceWhileStaleRoundIsPulling) {
+  const auto task_queue_factory = CreateDefaultTaskQueueFactory();
+  AudioMixerImpl::ParallelPullConfig config;
+  config.task_queue_factory = task_queue_factory.get();
+  config.number_of_threads = 1;
+  config.deadline_ms = 100;
+  const auto mixer = AudioMixerImpl::Create(
+      std::make_unique<DefaultOutputRateCalculator>(), false,
+      AudioMixerImpl::kMixAllSources, config);
+
+  BlockingAudioSource slow_source(100);
+  auto removed_source = std::make_unique<BlockingAudioSource>(200);
+  slow_source.Block();
+  EXPECT_TRUE(mixer->AddSource(&slow_source));
+  EXPECT_TRUE(mixer->AddSource(removed_source.get()));
+
+  // The only worker is stuck pulling |slow_source|, so |removed_source| is
+  // never started.
+  mixer->Mix(1, &frame_for_mixing);
+  EXPECT_FALSE(
+      mixer->GetAudioSourceMixabilityStatusForTest(removed_source.get()));
+  mixer->RemoveSource(removed_source.get());
+  EXPECT_EQ(0, removed_source->number_of_pulls());
+  removed_source.reset();
+
+  // Unblock the worker while the next mix waits for |added_source|.
+  BlockingAudioSource added_source(300);
+  EXPECT_TRUE(mixer->AddSource(&added_source));
+  TaskQueueForTest release_queue("release");
+  release_queue.PostDelayedTask([&slow_source] { slow_source.Release(); },
+                                10);
+  mixer->Mix(1, &frame_for_mixing);
+  release_queue.SendTask([] {}, RTC_FROM_HERE);
+  EXPECT_TRUE(mixer->GetAudioSourceMixabilityStatusForTest(&added_source));
+  EXPECT_EQ(1, added_source.number_of_pulls());
+}
+
 // This test checks that the initialization and participant addition
 // can be done on a different thread.
 TEST(AudioMixer, ConstructFromOtherThread) {
@@ -10,6 +10,16 @@
 
 #include "modules/audio_mixer/frame_combiner.h"
 
+// Defines WEBRTC_ARCH_X86_FAMILY, used below.
+#include "rtc_base/system/arch.h"
+
+#if defined(WEBRTC_HAS_NEON)
+#include <arm_neon.h>
+#endif
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+#include <emmintrin.h>
+#endif
+
 #include <algorithm>
 #include <array>
 #include <cstdint>
@@ -74,28 +84,81 @@ void MixFewFramesWithNoLimiter(const std::vector<AudioFrame*>& mix_list,
             audio_frame_for_mixing->mutable_data());
 }
 
+// Converts the frame to FloatS16 if there is one, and writes silence
+// otherwise.
+void MixFewFramesWithNoLimiterToFloat(const std::vector<AudioFrame*>& mix_list,
+                                      size_t number_of_samples,
+                                      float* float_output) {
+  if (mix_list.empty()) {
+    std::fill(float_output, float_output + number_of_samples, 0.f);
+    return;
+  }
+  RTC_DCHECK_LE(mix_list.size(), 1);
+  S16ToFloatS16(mix_list[0]->data(), number_of_samples, float_output);
+}
+
+// Adds |samples| to |accumulator|, converted to FloatS16.
+void AccumulateS16(rtc::ArrayView<const int16_t> samples, float* accumulator) {
+  const size_t size = samples.size();
+  size_t k = 0;
+#if defined(WEBRTC_HAS_NEON)
+  for (; k + 8 <= size; k += 8) {
+    const int16x8_t x = vld1q_s16(&samples[k]);
+    const float32x4_t low = vcvtq_f32_s32(vmovl_s16(vget_low_s16(x)));
+    const float32x4_t high = vcvtq_f32_s32(vmovl_s16(vget_high_s16(x)));
+    vst1q_f32(&accumulator[k], vaddq_f32(vld1q_f32(&accumulator[k]), low));
+    vst1q_f32(&accumulator[k + 4],
+              vaddq_f32(vld1q_f32(&accumulator[k + 4]), high));
+  }
+#elif defined(WEBRTC_ARCH_X86_FAMILY)
+  for (; k + 8 <= size; k += 8) {
+    const __m128i x =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(&samples[k]));
+    // Sign extends the samples by moving them to the upper halves of 32 bit
+    // lanes and shifting them back.
+    const __m128 low =
+        _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16));
+    const __m128 high =
+        _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16));
+    _mm_storeu_ps(&accumulator[k],
+                  _mm_add_ps(_mm_loadu_ps(&accumulator[k]), low));
+    _mm_storeu_ps(&accumulator[k + 4],
+                  _mm_add_ps(_mm_loadu_ps(&accumulator[k + 4]), high));
+  }
+#endif
+  for (; k < size; ++k) {
+    accumulator[k] += samples[k];
+  }
+}
+
 void MixToFloatFrame(const std::vector<AudioFrame*>& mix_list,
                      size_t samples_per_channel,
                      size_t number_of_channels,
+                     FrameCombiner::InterleavedBuffer* interleaved_buffer,
                      MixingBuffer* mixing_buffer) {
   RTC_DCHECK_LE(samples_per_channel, FrameCombiner::kMaximumChannelSize);
   RTC_DCHECK_LE(number_of_channels, FrameCombiner::kMaximumNumberOfChannels);
-  // Clear the mixing buffer.
-  for (auto& one_channel_buffer : *mixing_buffer) {
-    std::fill(one_channel_buffer.begin(), one_channel_buffer.end(), 0.f);
-  }
-
-  // Convert to FloatS16 and mix.
-  for (size_t i = 0; i < mix_list.size(); ++i) {
-    const AudioFrame* const frame = mix_list[i];
-    for (size_t j = 0; j < std::min(number_of_channels,
-                                    FrameCombiner::kMaximumNumberOfChannels);
-         ++j) {
-      for (size_t k = 0; k < std::min(samples_per_channel,
-                                      FrameCombiner::kMaximumChannelSize);
-           ++k) {
-        (*mixing_buffer)[j][k] += frame->data()[number_of_channels * k + j];
-      }
+  // Convert to FloatS16 and mix. All channels are summed in one pass over
+  // the interleaved samples, which is independent of the channel count.
+  const size_t number_of_samples =
+      std::min<size_t>(samples_per_channel * number_of_channels,
+                       AudioFrame::kMaxDataSizeSamples);
+  float* const interleaved = interleaved_buffer->data();
+  std::fill(interleaved, interleaved + number_of_samples, 0.f);
+  for (const AudioFrame* const frame : mix_list) {
+    AccumulateS16(
+        rtc::ArrayView<const int16_t>(frame->data(), number_of_samples),
+        interleaved);
+  }
+
+  // Deinterleave into the channels processed by the limiter.
+  const size_t output_number_of_channels =
+      std::min(number_of_channels, FrameCombiner::kMaximumNumberOfChannels);
+  const size_t output_samples_per_channel =
+      std::min(samples_per_channel, FrameCombiner::kMaximumChannelSize);
+  for (size_t j = 0; j < output_number_of_channels; ++j) {
+    for (size_t k = 0; k < output_samples_per_channel; ++k) {
+      (*mixing_buffer)[j][k] = interleaved[number_of_channels * k + j];
     }
   }
 }
@@ -121,6 +184,19 @@ void InterleaveToAudioFrame(AudioFrameView<const float> mixing_buffer_view,
     }
   }
 }
+
+// Interleaves without rounding.
+void InterleaveToFloat(AudioFrameView<const float> mixing_buffer_view,
+                       float* float_output) {
+  const size_t number_of_channels = mixing_buffer_view.num_channels();
+  const size_t samples_per_channel = mixing_buffer_view.samples_per_channel();
+  for (size_t i = 0; i < number_of_channels; ++i) {
+    for (size_t j = 0; j < samples_per_channel; ++j) {
+      float_output[number_of_channels * j + i] =
+          mixing_buffer_view.channel(i)[j];
+    }
+  }
+}
 }  // namespace
 
 constexpr size_t FrameCombiner::kMaximumNumberOfChannels;
@@ -131,6 +207,7 @@ FrameCombiner::FrameCombiner(bool use_limiter)
       mixing_buffer_(
           std::make_unique<std::array<std::array<float, kMaximumChannelSize>,
                                       kMaximumNumberOfChannels>>()),
+      interleaved_buffer_(std::make_unique<InterleavedBuffer>()),
       limiter_(static_cast<size_t>(48000), data_dumper_.get(), "AudioMixer"),
       use_limiter_(use_limiter) {
   static_assert(kMaximumChannelSize * kMaximumNumberOfChannels <=
@@ -145,6 +222,27 @@ void FrameCombiner::Combine(const std::vector<AudioFrame*>& mix_list,
                             int sample_rate,
                             size_t number_of_streams,
                             AudioFrame* audio_frame_for_mixing) {
+  CombineInternal(mix_list, number_of_channels, sample_rate, number_of_streams,
+                  audio_frame_for_mixing, nullptr);
+}
+
+void FrameCombiner::CombineToFloat(const std::vector<AudioFrame*>& mix_list,
+                                   size_t number_of_channels,
+                                   int sample_rate,
+                                   size_t number_of_streams,
+                                   AudioFrame* audio_frame_for_mixing,
+                                   float* float_output) {
+  RTC_DCHECK(float_output);
+  CombineInternal(mix_list, number_of_channels, sample_rate, number_of_streams,
+                  audio_frame_for_mixing, float_output);
+}
+
+void FrameCombiner::CombineInternal(const std::vector<AudioFrame*>& mix_list,
+                                    size_t number_of_channels,
+                                    int sample_rate,
+                                    size_t number_of_streams,
+                                    AudioFrame* audio_frame_for_mixing,
+                                    float* float_output) {
   RTC_DCHECK(audio_frame_for_mixing);
 
   LogMixingStats(mix_list, sample_rate, number_of_streams);
@@ -167,12 +265,20 @@ void FrameCombiner::Combine(const std::vector<AudioFrame*>& mix_list,
   }
 
   if (number_of_streams <= 1) {
-    MixFewFramesWithNoLimiter(mix_list, audio_frame_for_mixing);
+    if (float_output) {
+      MixFewFramesWithNoLimiterToFloat(
+          mix_list,
+          std::min<size_t>(samples_per_channel * number_of_channels,
+                           AudioFrame::kMaxDataSizeSamples),
+          float_output);
+    } else {
+      MixFewFramesWithNoLimiter(mix_list, audio_frame_for_mixing);
+    }
     return;
   }
 
   MixToFloatFrame(mix_list, samples_per_channel, number_of_channels,
-                  mixing_buffer_.get());
+                  interleaved_buffer_.get(), mixing_buffer_.get());
 
   const size_t output_number_of_channels =
       std::min(number_of_channels, kMaximumNumberOfChannels);
@@ -192,7 +298,11 @@ void FrameCombiner::Combine(const std::vector<AudioFrame*>& mix_list,
     RunLimiter(mixing_buffer_view, &limiter_);
   }
 
-  InterleaveToAudioFrame(mixing_buffer_view, audio_frame_for_mixing);
+  if (float_output) {
+    InterleaveToFloat(mixing_buffer_view, float_output);
+  } else {
+    InterleaveToAudioFrame(mixing_buffer_view, audio_frame_for_mixing);
+  }
 }
 
 void FrameCombiner::LogMixingStats(const std::vector<AudioFrame*>& mix_list,
@@ -38,20 +38,44 @@ class FrameCombiner {
                size_t number_of_streams,
                AudioFrame* audio_frame_for_mixing);
 
+  // Same as Combine(), but the combined samples are written interleaved to
+  // |float_output| in the FloatS16 range, without rounding or saturation.
+  // |float_output| must hold AudioFrame::kMaxDataSizeSamples samples. The
+  // other fields of |audio_frame_for_mixing| are set as by Combine(), and it
+  // is left muted.
+  void CombineToFloat(const std::vector<AudioFrame*>& mix_list,
+                      size_t number_of_channels,
+                      int sample_rate,
+                      size_t number_of_streams,
+                      AudioFrame* audio_frame_for_mixing,
+                      float* float_output);
+
   // Stereo, 48 kHz, 10 ms.
   static constexpr size_t kMaximumNumberOfChannels = 8;
   static constexpr size_t kMaximumChannelSize = 48 * 10;
 
   using MixingBuffer = std::array<std::array<float, kMaximumChannelSize>,
                                   kMaximumNumberOfChannels>;
+  using InterleavedBuffer = std::array<float, AudioFrame::kMaxDataSizeSamples>;
 
  private:
+  // Writes the result to |float_output| if it is not null, and to the samples
+  // of |audio_frame_for_mixing| otherwise.
+  void CombineInternal(const std::vector<AudioFrame*>& mix_list,
+                       size_t number_of_channels,
+                       int sample_rate,
+                       size_t number_of_streams,
+                       AudioFrame* audio_frame_for_mixing,
+                       float* float_output);
   void LogMixingStats(const std::vector<AudioFrame*>& mix_list,
                       int sample_rate,
                       size_t number_of_streams) const;
 
   std::unique_ptr<ApmDataDumper> data_dumper_;
   std::unique_ptr<MixingBuffer> mixing_buffer_;
+  // The frames are summed in interleaved order before being split into
+  // |mixing_buffer_|.
+  std::unique_ptr<InterleavedBuffer> interleaved_buffer_;
   Limiter limiter_;
   const bool use_limiter_;
   mutable int uma_logging_counter_ = 0;
@@ -10,11 +10,13 @@
 
 #include "modules/audio_mixer/frame_combiner.h"
 
+#include <algorithm>
 #include <cstdint>
 #include <initializer_list>
 #include <numeric>
 #include <string>
 #include <type_traits>
+#include <vector>
 
 #include "api/array_view.h"
 #include "audio/utility/audio_frame_operations.h"
@@ -216,6 +218,64 @@ TEST(FrameCombiner, CombiningOneFrameShouldNotChangeFrame) {
   }
 }
 
+TEST(FrameCombiner, CombiningTwoFramesWithoutLimiterAddsSamples) {
+  FrameCombiner combiner(false);
+  for (const int rate : {8000, 11000, 44100}) {
+    for (const int number_of_channels : {1, 2, 3}) {
+      SCOPED_TRACE(ProduceDebugText(rate, number_of_channels, 2));
+
+      SetUpFrames(rate, number_of_channels);
+      const int number_of_samples = number_of_channels * rate / 100;
+      int16_t* frame1_data = frame1.mutable_data();
+      int16_t* frame2_data = frame2.mutable_data();
+      std::iota(frame1_data, frame1_data + number_of_samples, -300);
+      std::iota(frame2_data, frame2_data + number_of_samples, -5000);
+      const std::vector<AudioFrame*> frames_to_combine = {&frame1, &frame2};
+      combiner.Combine(frames_to_combine, number_of_channels, rate,
+                       frames_to_combine.size(), &audio_frame_for_mixing);
+
+      const int16_t* audio_frame_for_mixing_data =
+          audio_frame_for_mixing.data();
+      const std::vector<int16_t> mixed_data(
+          audio_frame_for_mixing_data,
+          audio_frame_for_mixing_data + number_of_samples);
+
+      std::vector<int16_t> expected(number_of_samples);
+      for (int i = 0; i < number_of_samples; ++i) {
+        expected[i] = frame1_data[i] + frame2_data[i];
+      }
+      EXPECT_EQ(mixed_data, expected);
+    }
+  }
+}
+
+TEST(FrameCombiner, CombiningToFloatDoesNotSaturate) {
+  FrameCombiner combiner(false);
+  for (const int rate : {8000, 16000, 48000}) {
+    for (const int number_of_channels : {1, 2}) {
+      SCOPED_TRACE(ProduceDebugText(rate, number_of_channels, 2));
+
+      SetUpFrames(rate, number_of_channels);
+      const int number_of_samples = number_of_channels * rate / 100;
+      int16_t* frame1_data = frame1.mutable_data();
+      int16_t* frame2_data = frame2.mutable_data();
+      std::fill(frame1_data, frame1_data + number_of_samples, 30000);
+      std::iota(frame2_data, frame2_data + number_of_samples, 0);
+      const std::vector<AudioFrame*> frames_to_combine = {&frame1, &frame2};
+      std::vector<float> mixed_data(AudioFrame::kMaxDataSizeSamples);
+      combiner.CombineToFloat(frames_to_combine, number_of_channels, rate,
+                              frames_to_combine.size(),
+                              &audio_frame_for_mixing, mixed_data.data());
+
+      EXPECT_EQ(static_cast<size_t>(rate / 100),
+                audio_frame_for_mixing.samples_per_channel_);
+      for (int i = 0; i < number_of_samples; ++i) {
+        EXPECT_EQ(30000.f + i, mixed_data[i]);
+      }
+    }
+  }
+}
+
 // Send a sine wave through the FrameCombiner, and check that the
 // difference between input and output varies smoothly. Also check
 // that it is inside reasonable bounds. This is to catch issues like
@@ -557,6 +557,11 @@ void AdaptiveFirFilter::Filter(const RenderBuffer& render_buffer,
       aec3::ApplyFilter_Sse2(render_buffer, current_size_partitions_, H_, S);
       break;
 #endif
+#if defined(WEBRTC_ENABLE_AVX2)
+    case Aec3Optimization::kAvx2:
+      aec3::ApplyFilter_Avx2(render_buffer, current_size_partitions_, H_, S);
+      break;
+#endif
 #if defined(WEBRTC_HAS_NEON)
     case Aec3Optimization::kNeon:
       aec3::ApplyFilter_Neon(render_buffer, current_size_partitions_, H_, S);
@@ -598,6 +603,11 @@ void AdaptiveFirFilter::ComputeFrequencyResponse(
       aec3::ComputeFrequencyResponse_Sse2(current_size_partitions_, H_, H2);
       break;
 #endif
+#if defined(WEBRTC_ENABLE_AVX2)
+    case Aec3Optimization::kAvx2:
+      aec3::ComputeFrequencyResponse_Avx2(current_size_partitions_, H_, H2);
+      break;
+#endif
 #if defined(WEBRTC_HAS_NEON)
     case Aec3Optimization::kNeon:
       aec3::ComputeFrequencyResponse_Neon(current_size_partitions_, H_, H2);
@@ -621,6 +631,12 @@ void AdaptiveFirFilter::AdaptAndUpdateSize(const RenderBuffer& render_buffer,
                                  &H_);
       break;
 #endif
+#if defined(WEBRTC_ENABLE_AVX2)
+    case Aec3Optimization::kAvx2:
+      aec3::AdaptPartitions_Avx2(render_buffer, G, current_size_partitions_,
+                                 &H_);
+      break;
+#endif
 #if defined(WEBRTC_HAS_NEON)
     case Aec3Optimization::kNeon:
       aec3::AdaptPartitions_Neon(render_buffer, G, current_size_partitions_,
@@ -37,6 +37,11 @@ void ErlComputer_SSE2(
     const std::vector<std::array<float, kFftLengthBy2Plus1>>& H2,
     rtc::ArrayView<float> erl);
 #endif
+#if defined(WEBRTC_ENABLE_AVX2)
+void ErlComputer_AVX2(
+    const std::vector<std::array<float, kFftLengthBy2Plus1>>& H2,
+    rtc::ArrayView<float> erl);
+#endif
 
 }  // namespace aec3
 
@@ -30,8 +30,10 @@
 #include "modules/audio_processing/aec3/shadow_filter_update_gain.h"
 #include "modules/audio_processing/logging/apm_data_dumper.h"
 #include "modules/audio_processing/test/echo_canceller_test_tools.h"
+#include "modules/audio_processing/test/performance_timer.h"
 #include "modules/audio_processing/utility/cascaded_biquad_filter.h"
 #include "rtc_base/arraysize.h"
+#include "rtc_base/logging.h"
 #include "rtc_base/numerics/safe_minmax.h"
 #include "rtc_base/random.h"
 #include "rtc_base/strings/string_builder.h"
@@ -283,6 +285,136 @@ TEST_P(AdaptiveFirFilterOneTwoFourEightRenderChannels,
 
 #endif
 
+#if defined(WEBRTC_ENABLE_AVX2)
+namespace {
+
+// Returns the largest magnitude of any real or imaginary value in X, used to
+// scale the tolerance when comparing non-bitexact results.
+float MaxMagnitude(const FftData& X) {
+  float max_magnitude = 1.f;
+  for (size_t k = 0; k < X.re.size(); ++k) {
+    max_magnitude = std::max(max_magnitude, fabsf(X.re[k]));
+    max_magnitude = std::max(max_magnitude, fabsf(X.im[k]));
+  }
+  return max_magnitude;
+}
+
+}  // namespace
+
+// Verifies that the optimized methods for filter adaptation are similar to
+// their reference counterparts. Fused multiply-adds round differently, so the
+// results are not bitexact.
+TEST_P(AdaptiveFirFilterOneTwoFourEightRenderChannels,
+       FilterAdaptationAvx2Optimizations) {
+  const size_t num_render_channels = GetParam();
+  constexpr int kSampleRateHz = 48000;
+  constexpr size_t kNumBands = NumBandsForRate(kSampleRateHz);
+
+  bool use_avx2 = (WebRtc_GetCPUInfo(kAVX2) != 0);
+  if (use_avx2) {
+    for (size_t num_partitions : {2, 5, 12, 30, 50}) {
+      std::unique_ptr<RenderDelayBuffer> render_delay_buffer(
+          RenderDelayBuffer::Create(EchoCanceller3Config(), kSampleRateHz,
+                                    num_render_channels));
+      Random random_generator(42U);
+      std::vector<std::vector<std::vector<float>>> x(
+          kNumBands,
+          std::vector<std::vector<float>>(num_render_channels,
+                                          std::vector<float>(kBlockSize, 0.f)));
+      FftData S_C;
+      FftData S_Avx2;
+      FftData G;
+      Aec3Fft fft;
+      std::vector<std::vector<FftData>> H_C(
+          num_partitions, std::vector<FftData>(num_render_channels));
+      std::vector<std::vector<FftData>> H_Avx2(
+          num_partitions, std::vector<FftData>(num_render_channels));
+      for (size_t p = 0; p < num_partitions; ++p) {
+        for (size_t ch = 0; ch < num_render_channels; ++ch) {
+          H_C[p][ch].Clear();
+          H_Avx2[p][ch].Clear();
+        }
+      }
+
+      for (size_t k = 0; k < 500; ++k) {
+        for (size_t band = 0; band < x.size(); ++band) {
+          for (size_t ch = 0; ch < x[band].size(); ++ch) {
+            RandomizeSampleVector(&random_generator, x[band][ch]);
+          }
+        }
+        render_delay_buffer->Insert(x);
+        if (k == 0) {
+          render_delay_buffer->Reset();
+        }
+        render_delay_buffer->PrepareCaptureProcessing();
+        auto* const render_buffer = render_delay_buffer->GetRenderBuffer();
+
+        ApplyFilter_Avx2(*render_buffer, num_partitions, H_Avx2, &S_Avx2);
+        ApplyFilter(*render_buffer, num_partitions, H_C, &S_C);
+        const float S_tolerance = MaxMagnitude(S_C) * 1e-5f;
+        for (size_t j = 0; j < S_C.re.size(); ++j) {
+          EXPECT_NEAR(S_C.re[j], S_Avx2.re[j], S_tolerance);
+          EXPECT_NEAR(S_C.im[j], S_Avx2.im[j], S_tolerance);
+        }
+
+        std::for_each(G.re.begin(), G.re.end(),
+                      [&](float& a) { a = random_generator.Rand<float>(); });
+        std::for_each(G.im.begin(), G.im.end(),
+                      [&](float& a) { a = random_generator.Rand<float>(); });
+
+        AdaptPartitions_Avx2(*render_buffer, G, num_partitions, &H_Avx2);
+        AdaptPartitions(*render_buffer, G, num_partitions, &H_C);
+
+        for (size_t p = 0; p < num_partitions; ++p) {
+          for (size_t ch = 0; ch < num_render_channels; ++ch) {
+            const float H_tolerance = MaxMagnitude(H_C[p][ch]) * 1e-5f;
+            for (size_t j = 0; j < H_C[p][ch].re.size(); ++j) {
+              EXPECT_NEAR(H_C[p][ch].re[j], H_Avx2[p][ch].re[j], H_tolerance);
+              EXPECT_NEAR(H_C[p][ch].im[j], H_Avx2[p][ch].im[j], H_tolerance);
+            }
+          }
+        }
+      }
+    }
+  }
+}
+
+// Verifies that the optimized method for frequency response computation is
+// similar to the reference counterpart.
+TEST_P(AdaptiveFirFilterOneTwoFourEightRenderChannels,
+       ComputeFrequencyResponseAvx2Optimization) {
+  const size_t num_render_channels = GetParam();
+  bool use_avx2 = (WebRtc_GetCPUInfo(kAVX2) != 0);
+  if (use_avx2) {
+    for (size_t num_partitions : {2, 5, 12, 30, 50}) {
+      std::vector<std::vector<FftData>> H(
+          num_partitions, std::vector<FftData>(num_render_channels));
+      std::vector<std::array<float, kFftLengthBy2Plus1>> H2(num_partitions);
+      std::vector<std::array<float, kFftLengthBy2Plus1>> H2_Avx2(
+          num_partitions);
+
+      for (size_t p = 0; p < num_partitions; ++p) {
+        for (size_t ch = 0; ch < num_render_channels; ++ch) {
+          for (size_t k = 0; k < H[p][ch].re.size(); ++k) {
+            H[p][ch].re[k] = k + p / 3.f + ch;
+            H[p][ch].im[k] = p + k / 7.f - ch;
+          }
+        }
+      }
+
+      ComputeFrequencyResponse(num_partitions, H, &H2);
+      ComputeFrequencyResponse_Avx2(num_partitions, H, &H2_Avx2);
+
+      for (size_t p = 0; p < num_partitions; ++p) {
+        for (size_t k = 0; k < H2[p].size(); ++k) {
+          EXPECT_FLOAT_EQ(H2[p][k], H2_Avx2[p][k]);
+        }
+      }
+    }
+  }
+}
+#endif
+
 #if RTC_DCHECK_IS_ON && GTEST_HAS_DEATH_TEST && !defined(WEBRTC_ANDROID)
 // Verifies that the check for non-null data dumper works.
 TEST(AdaptiveFirFilterTest, NullDataDumper) {
@@ -491,5 +623,77 @@ TEST_P(AdaptiveFirFilterMultiChannel, FilterAndAdapt) {
   }
 }
 
+// Performance test for the filter kernels of each available optimization.
+// Keep disabled and only enable locally to measure performance by running this
+// unit test adding "--logs".
+TEST(AdaptiveFirFilterTest, DISABLED_KernelPerformance) {
+  constexpr int kSampleRateHz = 48000;
+  constexpr size_t kNumBands = NumBandsForRate(kSampleRateHz);
+  constexpr size_t kNumRenderChannels = 2;
+  constexpr size_t kNumBlocks = 1000;
+
+  std::vector<Aec3Optimization> optimizations = {Aec3Optimization::kNone};
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+  if (WebRtc_GetCPUInfo(kSSE2) != 0) {
+    optimizations.push_back(Aec3Optimization::kSse2);
+  }
+#endif
+#if defined(WEBRTC_ENABLE_AVX2)
+  if (WebRtc_GetCPUInfo(kAVX2) != 0) {
+    optimizations.push_back(Aec3Optimization::kAvx2);
+  }
+#endif
+#if defined(WEBRTC_HAS_NEON)
+  optimizations.push_back(Aec3Optimization::kNeon);
+#endif
+
+  EchoCanceller3Config config;
+  ApmDataDumper data_dumper(42);
+  for (Aec3Optimization optimization : optimizations) {
+    AdaptiveFirFilter filter(
+        config.filter.main.length_blocks, config.filter.main.length_blocks,
+        config.filter.config_change_duration_blocks, kNumRenderChannels,
+        optimization, &data_dumper);
+    std::vector<std::array<float, kFftLengthBy2Plus1>> H2(
+        filter.max_filter_size_partitions());
+    std::unique_ptr<RenderDelayBuffer> render_delay_buffer(
+        RenderDelayBuffer::Create(config, kSampleRateHz, kNumRenderChannels));
+    Random random_generator(42U);
+    std::vector<std::vector<std::vector<float>>> x(
+        kNumBands,
+        std::vector<std::vector<float>>(kNumRenderChannels,
+                                        std::vector<float>(kBlockSize, 0.f)));
+    FftData S;
+    FftData G;
+    G.Clear();
+
+    ::webrtc::test::PerformanceTimer perf_timer(kNumBlocks);
+    for (size_t k = 0; k < kNumBlocks; ++k) {
+      for (auto& band : x) {
+        for (auto& channel : band) {
+          RandomizeSampleVector(&random_generator, channel);
+        }
+      }
+      render_delay_buffer->Insert(x);
+      if (k == 0) {
+        render_delay_buffer->Reset();
+      }
+      render_delay_buffer->PrepareCaptureProcessing();
+      const RenderBuffer& render_buffer =
+          *render_delay_buffer->GetRenderBuffer();
+
+      perf_timer.StartTimer();
+      filter.Filter(render_buffer, &S);
+      filter.Adapt(render_buffer, G);
+      filter.ComputeFrequencyResponse(&H2);
+      perf_timer.StopTimer();
+    }
+    RTC_LOG(LS_INFO) << "Optimization " << static_cast<int>(optimization)
+                     << ": " << perf_timer.GetDurationAverage() << " +/- "
+                     << perf_timer.GetDurationStandardDeviation()
+                     << " us per block";
+  }
+}
+
 }  // namespace aec3
 }  // namespace webrtc
@@ -20,6 +20,11 @@ namespace webrtc {
 
 Aec3Optimization DetectOptimization() {
 #if defined(WEBRTC_ARCH_X86_FAMILY)
+#if defined(WEBRTC_ENABLE_AVX2)
+  if (WebRtc_GetCPUInfo(kAVX2) != 0) {
+    return Aec3Optimization::kAvx2;
+  }
+#endif
   if (WebRtc_GetCPUInfo(kSSE2) != 0) {
     return Aec3Optimization::kSse2;
   }
@@ -45,6 +45,11 @@ struct FftData {
                 rtc::ArrayView<float> power_spectrum) const {
     RTC_DCHECK_EQ(kFftLengthBy2Plus1, power_spectrum.size());
     switch (optimization) {
+#if defined(WEBRTC_ENABLE_AVX2)
+      case Aec3Optimization::kAvx2:
+        SpectrumAVX2(power_spectrum);
+        break;
+#endif
 #if defined(WEBRTC_ARCH_X86_FAMILY)
       case Aec3Optimization::kSse2: {
         constexpr int kNumFourBinBands = kFftLengthBy2 / 4;
@@ -91,6 +96,12 @@ struct FftData {
 
   std::array<float, kFftLengthBy2Plus1> re;
   std::array<float, kFftLengthBy2Plus1> im;
+
+#if defined(WEBRTC_ENABLE_AVX2)
+ private:
+  // Defined in fft_data_avx2.cc, which is built with AVX2 enabled.
+  void SpectrumAVX2(rtc::ArrayView<float> power_spectrum) const;
+#endif
 };
 
 }  // namespace webrtc
@@ -41,6 +41,32 @@ TEST(FftData, TestOptimizations) {
 }
 #endif
 
+#if defined(WEBRTC_ENABLE_AVX2)
+// Verifies that the AVX2 power spectrum matches the reference counterpart.
+TEST(FftData, TestAvx2Optimizations) {
+  if (WebRtc_GetCPUInfo(kAVX2) != 0) {
+    FftData x;
+
+    for (size_t k = 0; k < x.re.size(); ++k) {
+      x.re[k] = k + 1;
+    }
+
+    x.im[0] = x.im[x.im.size() - 1] = 0.f;
+    for (size_t k = 1; k < x.im.size() - 1; ++k) {
+      x.im[k] = 2.f * (k + 1);
+    }
+
+    std::array<float, kFftLengthBy2Plus1> spectrum;
+    std::array<float, kFftLengthBy2Plus1> spectrum_avx2;
+    x.Spectrum(Aec3Optimization::kNone, spectrum);
+    x.Spectrum(Aec3Optimization::kAvx2, spectrum_avx2);
+    for (size_t k = 0; k < spectrum.size(); ++k) {
+      EXPECT_FLOAT_EQ(spectrum[k], spectrum_avx2[k]);
+    }
+  }
+}
+#endif
+
 #if RTC_DCHECK_IS_ON && GTEST_HAS_DEATH_TEST && !defined(WEBRTC_ANDROID)
 
 // Verifies the check for null output in CopyToPackedArray.
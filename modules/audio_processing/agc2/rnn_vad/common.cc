@@ -18,6 +18,11 @@ namespace rnn_vad {
 
 Optimization DetectOptimization() {
 #if defined(WEBRTC_ARCH_X86_FAMILY)
+#if defined(WEBRTC_ENABLE_AVX2)
+  if (WebRtc_GetCPUInfo(kAVX2) != 0) {
+    return Optimization::kAvx2;
+  }
+#endif
   if (WebRtc_GetCPUInfo(kSSE2) != 0) {
     return Optimization::kSse2;
   }
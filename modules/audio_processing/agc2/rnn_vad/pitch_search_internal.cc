@@ -16,6 +16,7 @@
 #include <cmath>
 #include <cstddef>
 #include <numeric>
+#include <utility>
 
 #include "modules/audio_processing/agc2/rnn_vad/common.h"
 #include "rtc_base/checks.h"
@@ -36,11 +37,41 @@ float ComputeAutoCorrelationCoeff(rtc::ArrayView<const float> pitch_buf,
   RTC_DCHECK_LT(inv_lag, pitch_buf.size());
   RTC_DCHECK_LT(max_pitch_period, pitch_buf.size());
   RTC_DCHECK_LE(inv_lag, max_pitch_period);
-  // TODO(bugs.webrtc.org/9076): Maybe optimize using vectorization.
   return std::inner_product(pitch_buf.begin() + max_pitch_period,
                             pitch_buf.end(), pitch_buf.begin() + inv_lag, 0.f);
 }
 
+// Computes the auto-correlation coefficients for the consecutive inverted lags
+// starting from |first_inv_lag| and writes them into |auto_corr|. Groups of
+// four lags are computed in a single pass over |pitch_buf| with independent
+// accumulators, which the compiler vectorizes across the lags. Each
+// coefficient is accumulated in the same order as in
+// ComputeAutoCorrelationCoeff(), so the results are bit-exact.
+void ComputeAutoCorrelationCoeffs(rtc::ArrayView<const float> pitch_buf,
+                                  size_t first_inv_lag,
+                                  size_t max_pitch_period,
+                                  rtc::ArrayView<float> auto_corr) {
+  RTC_DCHECK_LE(first_inv_lag + auto_corr.size(), max_pitch_period + 1);
+  constexpr size_t kNumLagsPerPass = 4;
+  const size_t frame_size = pitch_buf.size() - max_pitch_period;
+  const float* x = pitch_buf.data() + max_pitch_period;
+  size_t i = 0;
+  for (; i + kNumLagsPerPass <= auto_corr.size(); i += kNumLagsPerPass) {
+    const float* y = pitch_buf.data() + first_inv_lag + i;
+    std::array<float, kNumLagsPerPass> sums = {};
+    for (size_t k = 0; k < frame_size; ++k) {
+      for (size_t j = 0; j < kNumLagsPerPass; ++j) {
+        sums[j] += x[k] * y[k + j];
+      }
+    }
+    std::copy(sums.begin(), sums.end(), auto_corr.begin() + i);
+  }
+  for (; i < auto_corr.size(); ++i) {
+    auto_corr[i] = ComputeAutoCorrelationCoeff(pitch_buf, first_inv_lag + i,
+                                               max_pitch_period);
+  }
+}
+
 // Computes a pseudo-interpolation offset for an estimated pitch period |lag| by
 // looking at the auto-correlation coefficients in the neighborhood of |lag|.
 // (namely, |prev_auto_corr|, |lag_auto_corr| and |next_auto_corr|). The output
@@ -278,13 +309,30 @@ size_t RefinePitchPeriod48kHz(
   // for a few lag values).
   std::array<float, kNumInvertedLags24kHz> auto_corr;
   auto_corr.fill(0.f);  // Zeros become ignored lags in FindBestPitchPeriods().
-  auto is_neighbor = [](size_t i, size_t j) {
-    return ((i > j) ? (i - j) : (j - i)) <= 2;
+  // The neighbors of a candidate are the lags in [inv_lag - 2, inv_lag + 2].
+  // When the neighborhoods of the two candidates overlap or are adjacent,
+  // they are computed as a single range.
+  auto range_begin = [&auto_corr](size_t inv_lag) {
+    return std::min(inv_lag > 2 ? inv_lag - 2 : 0, auto_corr.size());
   };
-  for (size_t inv_lag = 0; inv_lag < auto_corr.size(); ++inv_lag) {
-    if (is_neighbor(inv_lag, inv_lags[0]) || is_neighbor(inv_lag, inv_lags[1]))
-      auto_corr[inv_lag] =
-          ComputeAutoCorrelationCoeff(pitch_buf, inv_lag, kMaxPitch24kHz);
+  auto range_end = [&auto_corr](size_t inv_lag) {
+    return std::min(inv_lag + 3, auto_corr.size());
+  };
+  const size_t lower_inv_lag = std::min(inv_lags[0], inv_lags[1]);
+  const size_t upper_inv_lag = std::max(inv_lags[0], inv_lags[1]);
+  std::array<std::pair<size_t, size_t>, 2> ranges = {
+      {{range_begin(lower_inv_lag), range_end(lower_inv_lag)},
+       {range_begin(upper_inv_lag), range_end(upper_inv_lag)}}};
+  if (ranges[1].first <= ranges[0].second) {
+    ranges[0].second = ranges[1].second;
+    ranges[1].first = ranges[1].second;  // Empty.
+  }
+  for (const auto& range : ranges) {
+    if (range.first < range.second) {
+      ComputeAutoCorrelationCoeffs(
+          pitch_buf, range.first, kMaxPitch24kHz,
+          {auto_corr.data() + range.first, range.second - range.first});
+    }
   }
   // Find best pitch at 24 kHz.
   const auto pitch_candidates_inv_lags = FindBestPitchPeriods(
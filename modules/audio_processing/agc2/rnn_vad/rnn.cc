@@ -22,7 +22,6 @@
 #include <algorithm>
 #include <array>
 #include <cmath>
-#include <numeric>
 
 #include "rtc_base/checks.h"
 #include "rtc_base/logging.h"
@@ -63,6 +62,26 @@ inline float RectifiedLinearUnit(float x) {
   return x < 0.f ? 0.f : x;
 }
 
+// Returns true if |optimization| selects an implementation that vectorizes
+// over the outputs of a layer, which requires input-major weights.
+bool UsesInputMajorWeights(Optimization optimization) {
+  switch (optimization) {
+#if defined(WEBRTC_ARCH_X86_FAMILY)
+    case Optimization::kSse2:
+#if defined(WEBRTC_ENABLE_AVX2)
+    case Optimization::kAvx2:
+#endif
+      return true;
+#endif
+#if defined(WEBRTC_HAS_NEON)
+    case Optimization::kNeon:
+      return true;
+#endif
+    default:
+      return false;
+  }
+}
+
 std::vector<float> GetScaledParams(rtc::ArrayView<const int8_t> params) {
   std::vector<float> scaled_params(params.size());
   std::transform(params.begin(), params.end(), scaled_params.begin(),
@@ -74,11 +93,13 @@ std::vector<float> GetScaledParams(rtc::ArrayView<const int8_t> params) {
 
 // TODO(bugs.chromium.org/10480): Hard-code optimized layout and remove this
 // function to improve setup time.
-// Casts and scales |weights| and re-arranges the layout.
+// Casts and scales |weights| and, unless |input_major| is true, re-arranges
+// the layout so that the weights of each output are contiguous.
 std::vector<float> GetPreprocessedFcWeights(
     rtc::ArrayView<const int8_t> weights,
-    size_t output_size) {
-  if (output_size == 1) {
+    size_t output_size,
+    bool input_major) {
+  if (output_size == 1 || input_major) {
     return GetScaledParams(weights);
   }
   // Transpose, scale and cast.
@@ -98,10 +119,13 @@ constexpr size_t kNumGruGates = 3;  // Update, reset, output.
 // TODO(bugs.chromium.org/10480): Hard-coded optimized layout and remove this
 // function to improve setup time.
 // Casts and scales |tensor_src| for a GRU layer and re-arranges the layout.
-// It works both for weights, recurrent weights and bias.
+// It works both for weights, recurrent weights and bias. The gates are always
+// split; if |input_major| is false, each gate is also transposed so that the
+// weights of each output are contiguous.
 std::vector<float> GetPreprocessedGruTensor(
     rtc::ArrayView<const int8_t> tensor_src,
-    size_t output_size) {
+    size_t output_size,
+    bool input_major) {
   // Transpose, cast and scale.
   // |n| is the size of the first dimension of the 3-dim tensor |weights|.
   const size_t n =
@@ -112,7 +136,8 @@ std::vector<float> GetPreprocessedGruTensor(
   for (size_t g = 0; g < kNumGruGates; ++g) {
     for (size_t o = 0; o < output_size; ++o) {
       for (size_t i = 0; i < n; ++i) {
-        tensor_dst[g * stride_dst + o * n + i] =
+        const size_t dst_index = input_major ? i * output_size + o : o * n + i;
+        tensor_dst[g * stride_dst + dst_index] =
             rnnoise::kWeightsScale *
             static_cast<float>(
                 tensor_src[i * stride_src + g * output_size + o]);
@@ -227,41 +252,160 @@ void ComputeFullyConnectedLayerOutput(
   }
 }
 
+// Signature of the vectorized implementations of the matrix-vector product;
+// see AccumulateMatrixVectorProductAvx2().
+using MatrixVectorProduct = void (*)(rtc::ArrayView<const float> input,
+                                     rtc::ArrayView<const float> scale,
+                                     rtc::ArrayView<const float> weights,
+                                     rtc::ArrayView<float> output);
+
 #if defined(WEBRTC_ARCH_X86_FAMILY)
-// Fully connected layer SSE2 implementation.
-void ComputeFullyConnectedLayerOutputSse2(
-    size_t input_size,
-    size_t output_size,
+// Like AccumulateMatrixVectorProductAvx2(), but SSE2 implementation.
+void AccumulateMatrixVectorProductSse2(rtc::ArrayView<const float> input,
+                                       rtc::ArrayView<const float> scale,
+                                       rtc::ArrayView<const float> weights,
+                                       rtc::ArrayView<float> output) {
+  const size_t output_size = output.size();
+  RTC_DCHECK_EQ(weights.size(), input.size() * output_size);
+  RTC_DCHECK(scale.empty() || scale.size() == input.size());
+  // Perform 128 bit vector operations on four outputs at a time. The products
+  // are accumulated in the same order as in the un-optimized implementation.
+  const size_t vectorized_size = output_size & ~3;
+  for (size_t o = 0; o < vectorized_size; o += 4) {
+    __m128 sum = _mm_loadu_ps(&output[o]);
+    const float* w_p = weights.data() + o;
+    for (size_t i = 0; i < input.size(); ++i, w_p += output_size) {
+      __m128 wx = _mm_mul_ps(_mm_set1_ps(input[i]), _mm_loadu_ps(w_p));
+      if (!scale.empty()) {
+        wx = _mm_mul_ps(wx, _mm_set1_ps(scale[i]));
+      }
+      sum = _mm_add_ps(sum, wx);
+    }
+    _mm_storeu_ps(&output[o], sum);
+  }
+  // Perform non-vector operations for any remaining outputs.
+  for (size_t o = vectorized_size; o < output_size; ++o) {
+    for (size_t i = 0; i < input.size(); ++i) {
+      output[o] += scale.empty()
+                       ? input[i] * weights[i * output_size + o]
+                       : input[i] * weights[i * output_size + o] * scale[i];
+    }
+  }
+}
+#endif
+
+#if defined(WEBRTC_HAS_NEON)
+// Like AccumulateMatrixVectorProductAvx2(), but NEON implementation.
+void AccumulateMatrixVectorProductNeon(rtc::ArrayView<const float> input,
+                                       rtc::ArrayView<const float> scale,
+                                       rtc::ArrayView<const float> weights,
+                                       rtc::ArrayView<float> output) {
+  const size_t output_size = output.size();
+  RTC_DCHECK_EQ(weights.size(), input.size() * output_size);
+  RTC_DCHECK(scale.empty() || scale.size() == input.size());
+  // Perform 128 bit vector operations on four outputs at a time.
+  const size_t vectorized_size = output_size & ~3;
+  for (size_t o = 0; o < vectorized_size; o += 4) {
+    float32x4_t sum = vld1q_f32(&output[o]);
+    const float* w_p = weights.data() + o;
+    for (size_t i = 0; i < input.size(); ++i, w_p += output_size) {
+      float32x4_t wx = vmulq_n_f32(vld1q_f32(w_p), input[i]);
+      if (!scale.empty()) {
+        wx = vmulq_n_f32(wx, scale[i]);
+      }
+      sum = vaddq_f32(sum, wx);
+    }
+    vst1q_f32(&output[o], sum);
+  }
+  // Perform non-vector operations for any remaining outputs.
+  for (size_t o = vectorized_size; o < output_size; ++o) {
+    for (size_t i = 0; i < input.size(); ++i) {
+      output[o] += scale.empty()
+                       ? input[i] * weights[i * output_size + o]
+                       : input[i] * weights[i * output_size + o] * scale[i];
+    }
+  }
+}
+#endif
+
+// Fully connected layer implementation vectorized over the outputs. Requires
+// input-major weights.
+void ComputeFullyConnectedLayerOutputVectorized(
     rtc::ArrayView<const float> input,
     rtc::ArrayView<const float> bias,
     rtc::ArrayView<const float> weights,
     rtc::FunctionView<float(float)> activation_function,
+    MatrixVectorProduct matrix_vector_product,
     rtc::ArrayView<float> output) {
-  RTC_DCHECK_EQ(input.size(), input_size);
-  RTC_DCHECK_EQ(bias.size(), output_size);
-  RTC_DCHECK_EQ(weights.size(), input_size * output_size);
-  const size_t input_size_by_4 = input_size >> 2;
-  const size_t offset = input_size & ~3;
-  __m128 sum_wx_128;
-  const float* v = reinterpret_cast<const float*>(&sum_wx_128);
+  RTC_DCHECK_EQ(bias.size(), output.size());
+  std::copy(bias.begin(), bias.end(), output.begin());
+  matrix_vector_product(input, {}, weights, output);
+  for (float& y : output) {
+    y = activation_function(y);
+  }
+}
+
+// Gated recurrent unit (GRU) layer implementation vectorized over the outputs.
+// Requires input-major weights.
+void ComputeGruLayerOutputVectorized(
+    size_t input_size,
+    size_t output_size,
+    rtc::ArrayView<const float> input,
+    rtc::ArrayView<const float> weights,
+    rtc::ArrayView<const float> recurrent_weights,
+    rtc::ArrayView<const float> bias,
+    MatrixVectorProduct matrix_vector_product,
+    rtc::ArrayView<float> state) {
+  RTC_DCHECK_EQ(input_size, input.size());
+  // Stride and offset used to read parameter arrays.
+  const size_t stride_in = input_size * output_size;
+  const size_t stride_out = output_size * output_size;
+  const rtc::ArrayView<const float> prev_state(state.data(), output_size);
+
+  // Computes the bias and the weighted sums of the input and of the (scaled)
+  // state for |gate_index|.
+  auto compute_gate = [&](size_t gate_index, rtc::ArrayView<const float> scale,
+                          rtc::ArrayView<float> gate) {
+    const auto gate_bias = bias.subview(gate_index * output_size, output_size);
+    std::copy(gate_bias.begin(), gate_bias.end(), gate.begin());
+    matrix_vector_product(input, {},
+                          weights.subview(gate_index * stride_in, stride_in),
+                          gate);
+    matrix_vector_product(
+        prev_state, scale,
+        recurrent_weights.subview(gate_index * stride_out, stride_out), gate);
+  };
+
+  // Update gate.
+  std::array<float, kRecurrentLayersMaxUnits> update;
+  rtc::ArrayView<float> update_view(update.data(), output_size);
+  compute_gate(0, {}, update_view);
+  for (float& u : update_view) {
+    u = SigmoidApproximated(u);
+  }
+
+  // Reset gate.
+  std::array<float, kRecurrentLayersMaxUnits> reset;
+  rtc::ArrayView<float> reset_view(reset.data(), output_size);
+  compute_gate(1, {}, reset_view);
+  for (float& r : reset_view) {
+    r = SigmoidApproximated(r);
+  }
+
+  // Output gate.
+  std::array<float, kRecurrentLayersMaxUnits> output;
+  rtc::ArrayView<float> output_view(output.data(), output_size);
+  compute_gate(2, reset_view, output_view);
+  for (float& y : output_view) {
+    y = RectifiedLinearUnit(y);
+  }
+
+  // Update output through the update gates and update the state.
   for (size_t o = 0; o < output_size; ++o) {
-    // Perform 128 bit vector operations.
-    sum_wx_128 = _mm_set1_ps(0);
-    const float* x_p = input.data();
-    const float* w_p = weights.data() + o * input_size;
-    for (size_t i = 0; i < input_size_by_4; ++i, x_p += 4, w_p += 4) {
-      sum_wx_128 = _mm_add_ps(sum_wx_128,
-                              _mm_mul_ps(_mm_loadu_ps(x_p), _mm_loadu_ps(w_p)));
-    }
-    // Perform non-vector operations for any remaining items, sum up bias term
-    // and results from the vectorized code, and apply the activation function.
-    output[o] = activation_function(
-        std::inner_product(input.begin() + offset, input.end(),
-                           weights.begin() + o * input_size + offset,
-                           bias[o] + v[0] + v[1] + v[2] + v[3]));
+    output[o] = update[o] * state[o] + (1.f - update[o]) * output[o];
+    state[o] = output[o];
   }
 }
-#endif
 
 }  // namespace
 
@@ -275,7 +419,9 @@ FullyConnectedLayer::FullyConnectedLayer(
     : input_size_(input_size),
       output_size_(output_size),
       bias_(GetScaledParams(bias)),
-      weights_(GetPreprocessedFcWeights(weights, output_size)),
+      weights_(GetPreprocessedFcWeights(weights,
+                                        output_size,
+                                        UsesInputMajorWeights(optimization))),
       activation_function_(activation_function),
       optimization_(optimization) {
   RTC_DCHECK_LE(output_size_, kFullyConnectedLayersMaxUnits)
@@ -294,19 +440,27 @@ rtc::ArrayView<const float> FullyConnectedLayer::GetOutput() const {
 }
 
 void FullyConnectedLayer::ComputeOutput(rtc::ArrayView<const float> input) {
+  rtc::ArrayView<float> output(output_.data(), output_size_);
   switch (optimization_) {
 #if defined(WEBRTC_ARCH_X86_FAMILY)
     case Optimization::kSse2:
-      ComputeFullyConnectedLayerOutputSse2(input_size_, output_size_, input,
-                                           bias_, weights_,
-                                           activation_function_, output_);
+      ComputeFullyConnectedLayerOutputVectorized(
+          input, bias_, weights_, activation_function_,
+          AccumulateMatrixVectorProductSse2, output);
+      break;
+#if defined(WEBRTC_ENABLE_AVX2)
+    case Optimization::kAvx2:
+      ComputeFullyConnectedLayerOutputVectorized(
+          input, bias_, weights_, activation_function_,
+          AccumulateMatrixVectorProductAvx2, output);
       break;
 #endif
+#endif
 #if defined(WEBRTC_HAS_NEON)
     case Optimization::kNeon:
-      // TODO(bugs.chromium.org/10480): Handle Optimization::kNeon.
-      ComputeFullyConnectedLayerOutput(input_size_, output_size_, input, bias_,
-                                       weights_, activation_function_, output_);
+      ComputeFullyConnectedLayerOutputVectorized(
+          input, bias_, weights_, activation_function_,
+          AccumulateMatrixVectorProductNeon, output);
       break;
 #endif
     default:
@@ -324,10 +478,16 @@ GatedRecurrentLayer::GatedRecurrentLayer(
     Optimization optimization)
     : input_size_(input_size),
       output_size_(output_size),
-      bias_(GetPreprocessedGruTensor(bias, output_size)),
-      weights_(GetPreprocessedGruTensor(weights, output_size)),
+      bias_(GetPreprocessedGruTensor(bias,
+                                     output_size,
+                                     UsesInputMajorWeights(optimization))),
+      weights_(GetPreprocessedGruTensor(weights,
+                                        output_size,
+                                        UsesInputMajorWeights(optimization))),
       recurrent_weights_(
-          GetPreprocessedGruTensor(recurrent_weights, output_size)),
+          GetPreprocessedGruTensor(recurrent_weights,
+                                   output_size,
+                                   UsesInputMajorWeights(optimization))),
       optimization_(optimization) {
   RTC_DCHECK_LE(output_size_, kRecurrentLayersMaxUnits)
       << "Static over-allocation of recurrent layers state vectors is not "
@@ -357,16 +517,26 @@ void GatedRecurrentLayer::ComputeOutput(rtc::ArrayView<const float> input) {
   switch (optimization_) {
 #if defined(WEBRTC_ARCH_X86_FAMILY)
     case Optimization::kSse2:
-      // TODO(bugs.chromium.org/10480): Handle Optimization::kSse2.
-      ComputeGruLayerOutput(input_size_, output_size_, input, weights_,
-                            recurrent_weights_, bias_, state_);
+      ComputeGruLayerOutputVectorized(input_size_, output_size_, input,
+                                      weights_, recurrent_weights_, bias_,
+                                      AccumulateMatrixVectorProductSse2,
+                                      state_);
       break;
+#if defined(WEBRTC_ENABLE_AVX2)
+    case Optimization::kAvx2:
+      ComputeGruLayerOutputVectorized(input_size_, output_size_, input,
+                                      weights_, recurrent_weights_, bias_,
+                                      AccumulateMatrixVectorProductAvx2,
+                                      state_);
+      break;
+#endif
 #endif
 #if defined(WEBRTC_HAS_NEON)
     case Optimization::kNeon:
-      // TODO(bugs.chromium.org/10480): Handle Optimization::kNeon.
-      ComputeGruLayerOutput(input_size_, output_size_, input, weights_,
-                            recurrent_weights_, bias_, state_);
+      ComputeGruLayerOutputVectorized(input_size_, output_size_, input,
+                                      weights_, recurrent_weights_, bias_,
+                                      AccumulateMatrixVectorProductNeon,
+                                      state_);
       break;
 #endif
     default:
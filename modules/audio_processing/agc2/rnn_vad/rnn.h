@@ -37,6 +37,17 @@ constexpr size_t kFullyConnectedLayersMaxUnits = 24;
 // recurrent layer.
 constexpr size_t kRecurrentLayersMaxUnits = 24;
 
+#if defined(WEBRTC_ENABLE_AVX2)
+// Adds to |output| the product of |input| and the matrix |weights|, which has
+// |input.size()| rows and |output.size()| columns stored row by row. If
+// |scale| is not empty, the i-th row of |weights| is also multiplied by
+// |scale[i]|. AVX2 implementation used by the layers below.
+void AccumulateMatrixVectorProductAvx2(rtc::ArrayView<const float> input,
+                                       rtc::ArrayView<const float> scale,
+                                       rtc::ArrayView<const float> weights,
+                                       rtc::ArrayView<float> output);
+#endif
+
 // Fully-connected layer.
 class FullyConnectedLayer {
  public:
@@ -60,6 +71,7 @@ class FullyConnectedLayer {
   const size_t input_size_;
   const size_t output_size_;
   const std::vector<float> bias_;
+  // Input-major for the vectorized implementations, output-major otherwise.
   const std::vector<float> weights_;
   rtc::FunctionView<float(float)> activation_function_;
   // The output vector of a recurrent layer has length equal to |output_size_|.
@@ -93,6 +105,8 @@ class GatedRecurrentLayer {
   const size_t input_size_;
   const size_t output_size_;
   const std::vector<float> bias_;
+  // Per gate, input-major for the vectorized implementations, output-major
+  // otherwise.
   const std::vector<float> weights_;
   const std::vector<float> recurrent_weights_;
   // The state vector of a recurrent layer has length equal to |output_size_|.
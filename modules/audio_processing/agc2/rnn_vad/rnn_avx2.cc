@@ -0,0 +1,69 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_processing/agc2/rnn_vad/rnn.h"
+
+#include <immintrin.h>
+
+#include "rtc_base/checks.h"
+
+namespace webrtc {
+namespace rnn_vad {
+
+void AccumulateMatrixVectorProductAvx2(rtc::ArrayView<const float> input,
+                                       rtc::ArrayView<const float> scale,
+                                       rtc::ArrayView<const float> weights,
+                                       rtc::ArrayView<float> output) {
+  const size_t output_size = output.size();
+  RTC_DCHECK_EQ(weights.size(), input.size() * output_size);
+  RTC_DCHECK(scale.empty() || scale.size() == input.size());
+  // Perform 256 bit vector operations on eight outputs at a time. FMA is not
+  // used so that the products are rounded and accumulated as in the
+  // un-optimized implementation.
+  size_t vectorized_size = output_size & ~7;
+  for (size_t o = 0; o < vectorized_size; o += 8) {
+    __m256 sum = _mm256_loadu_ps(&output[o]);
+    const float* w_p = weights.data() + o;
+    for (size_t i = 0; i < input.size(); ++i, w_p += output_size) {
+      __m256 wx = _mm256_mul_ps(_mm256_set1_ps(input[i]), _mm256_loadu_ps(w_p));
+      if (!scale.empty()) {
+        wx = _mm256_mul_ps(wx, _mm256_set1_ps(scale[i]));
+      }
+      sum = _mm256_add_ps(sum, wx);
+    }
+    _mm256_storeu_ps(&output[o], sum);
+  }
+  // Perform 128 bit vector operations on four of the remaining outputs.
+  if (vectorized_size + 4 <= output_size) {
+    const size_t o = vectorized_size;
+    __m128 sum = _mm_loadu_ps(&output[o]);
+    const float* w_p = weights.data() + o;
+    for (size_t i = 0; i < input.size(); ++i, w_p += output_size) {
+      __m128 wx = _mm_mul_ps(_mm_set1_ps(input[i]), _mm_loadu_ps(w_p));
+      if (!scale.empty()) {
+        wx = _mm_mul_ps(wx, _mm_set1_ps(scale[i]));
+      }
+      sum = _mm_add_ps(sum, wx);
+    }
+    _mm_storeu_ps(&output[o], sum);
+    vectorized_size += 4;
+  }
+  // Perform non-vector operations for any remaining outputs.
+  for (size_t o = vectorized_size; o < output_size; ++o) {
+    for (size_t i = 0; i < input.size(); ++i) {
+      output[o] += scale.empty()
+                       ? input[i] * weights[i * output_size + o]
+                       : input[i] * weights[i * output_size + o] * scale[i];
+    }
+  }
+}
+
+}  // namespace rnn_vad
+}  // namespace webrtc
@@ -136,6 +136,8 @@ std::string GetOptimizationName(Optimization optimization) {
   switch (optimization) {
     case Optimization::kSse2:
       return "SSE2";
+    case Optimization::kAvx2:
+      return "AVX2";
     case Optimization::kNeon:
       return "NEON";
     case Optimization::kNone:
@@ -197,6 +199,69 @@ TEST(RnnVadTest, CheckGatedRecurrentLayerSse2) {
   TestGatedRecurrentLayer(&gru, kGruInputSequence, kGruExpectedOutputSequence);
 }
 
+// Like CheckFullyConnectedLayerOutput, but testing the AVX2 implementation.
+TEST(RnnVadTest, CheckFullyConnectedLayerOutputAvx2) {
+  if (!IsOptimizationAvailable(Optimization::kAvx2)) {
+    return;
+  }
+
+  FullyConnectedLayer fc(rnnoise::kInputLayerInputSize,
+                         rnnoise::kInputLayerOutputSize,
+                         rnnoise::kInputDenseBias, rnnoise::kInputDenseWeights,
+                         rnnoise::TansigApproximated, Optimization::kAvx2);
+  TestFullyConnectedLayer(&fc, kFullyConnectedInputVector,
+                          kFullyConnectedExpectedOutput);
+}
+
+// Like CheckGatedRecurrentLayer, but testing the AVX2 implementation.
+TEST(RnnVadTest, CheckGatedRecurrentLayerAvx2) {
+  if (!IsOptimizationAvailable(Optimization::kAvx2)) {
+    return;
+  }
+
+  GatedRecurrentLayer gru(kGruInputSize, kGruOutputSize, kGruBias, kGruWeights,
+                          kGruRecurrentWeights, Optimization::kAvx2);
+  TestGatedRecurrentLayer(&gru, kGruInputSequence, kGruExpectedOutputSequence);
+}
+
+// Checks that the vectorized implementations of the fully connected and of
+// the GRU layers produce the same output as the un-optimized ones.
+TEST(RnnVadTest, VectorizedLayersMatchUnoptimized) {
+  for (Optimization optimization : {Optimization::kSse2, Optimization::kAvx2}) {
+    if (!IsOptimizationAvailable(optimization)) {
+      continue;
+    }
+    SCOPED_TRACE(GetOptimizationName(optimization));
+
+    FullyConnectedLayer fc(
+        rnnoise::kInputLayerInputSize, rnnoise::kInputLayerOutputSize,
+        rnnoise::kInputDenseBias, rnnoise::kInputDenseWeights,
+        rnnoise::TansigApproximated, Optimization::kNone);
+    FullyConnectedLayer fc_vectorized(
+        rnnoise::kInputLayerInputSize, rnnoise::kInputLayerOutputSize,
+        rnnoise::kInputDenseBias, rnnoise::kInputDenseWeights,
+        rnnoise::TansigApproximated, optimization);
+    fc.ComputeOutput(kFullyConnectedInputVector);
+    fc_vectorized.ComputeOutput(kFullyConnectedInputVector);
+    ExpectEqualFloatArray(fc.GetOutput(), fc_vectorized.GetOutput());
+
+    GatedRecurrentLayer gru(kGruInputSize, kGruOutputSize, kGruBias,
+                            kGruWeights, kGruRecurrentWeights,
+                            Optimization::kNone);
+    GatedRecurrentLayer gru_vectorized(kGruInputSize, kGruOutputSize, kGruBias,
+                                       kGruWeights, kGruRecurrentWeights,
+                                       optimization);
+    rtc::ArrayView<const float> input_sequence(kGruInputSequence);
+    for (size_t i = 0; i < kGruInputSequence.size() / kGruInputSize; ++i) {
+      const auto input =
+          input_sequence.subview(i * kGruInputSize, kGruInputSize);
+      gru.ComputeOutput(input);
+      gru_vectorized.ComputeOutput(input);
+      ExpectEqualFloatArray(gru.GetOutput(), gru_vectorized.GetOutput());
+    }
+  }
+}
+
 #endif  // WEBRTC_ARCH_X86_FAMILY
 
 TEST(RnnVadTest, DISABLED_BenchmarkFullyConnectedLayer) {
@@ -205,11 +270,14 @@ TEST(RnnVadTest, DISABLED_BenchmarkFullyConnectedLayer) {
       rnnoise::kInputLayerInputSize, rnnoise::kInputLayerOutputSize,
       rnnoise::kInputDenseBias, rnnoise::kInputDenseWeights,
       rnnoise::TansigApproximated, Optimization::kNone));
-  if (IsOptimizationAvailable(Optimization::kSse2)) {
-    implementations.emplace_back(std::make_unique<FullyConnectedLayer>(
-        rnnoise::kInputLayerInputSize, rnnoise::kInputLayerOutputSize,
-        rnnoise::kInputDenseBias, rnnoise::kInputDenseWeights,
-        rnnoise::TansigApproximated, Optimization::kSse2));
+  for (Optimization optimization :
+       {Optimization::kSse2, Optimization::kAvx2, Optimization::kNeon}) {
+    if (IsOptimizationAvailable(optimization)) {
+      implementations.emplace_back(std::make_unique<FullyConnectedLayer>(
+          rnnoise::kInputLayerInputSize, rnnoise::kInputLayerOutputSize,
+          rnnoise::kInputDenseBias, rnnoise::kInputDenseWeights,
+          rnnoise::TansigApproximated, optimization));
+    }
   }
 
   std::vector<Result> results;
@@ -237,6 +305,14 @@ TEST(RnnVadTest, DISABLED_BenchmarkGatedRecurrentLayer) {
   implementations.emplace_back(std::make_unique<GatedRecurrentLayer>(
       kGruInputSize, kGruOutputSize, kGruBias, kGruWeights,
       kGruRecurrentWeights, Optimization::kNone));
+  for (Optimization optimization :
+       {Optimization::kSse2, Optimization::kAvx2, Optimization::kNeon}) {
+    if (IsOptimizationAvailable(optimization)) {
+      implementations.emplace_back(std::make_unique<GatedRecurrentLayer>(
+          kGruInputSize, kGruOutputSize, kGruBias, kGruWeights,
+          kGruRecurrentWeights, optimization));
+    }
+  }
 
   rtc::ArrayView<const float> input_sequence(kGruInputSequence);
   static_assert(kGruInputSequence.size() % kGruInputSize == 0, "");
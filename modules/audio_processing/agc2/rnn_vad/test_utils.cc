@@ -112,6 +112,12 @@ bool IsOptimizationAvailable(Optimization optimization) {
       return WebRtc_GetCPUInfo(kSSE2) != 0;
 #else
       return false;
+#endif
+    case Optimization::kAvx2:
+#if defined(WEBRTC_ARCH_X86_FAMILY) && defined(WEBRTC_ENABLE_AVX2)
+      return WebRtc_GetCPUInfo(kAVX2) != 0;
+#else
+      return false;
 #endif
     case Optimization::kNeon:
 #if defined(WEBRTC_HAS_NEON)
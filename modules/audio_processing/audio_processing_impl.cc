@@ -785,8 +785,45 @@ void AudioProcessingImpl::SetRuntimeSetting(RuntimeSetting setting) {
   RTC_NOTREACHED();
 }
 
+AudioProcessingImpl::RuntimeSettingQueue::RuntimeSettingQueue(size_t size)
+    : queue_(size) {}
+
+AudioProcessingImpl::RuntimeSettingQueue::~RuntimeSettingQueue() = default;
+
+void AudioProcessingImpl::RuntimeSettingQueue::Insert(RuntimeSetting setting) {
+  // Once a setting has been kept aside, the later ones are too, so that they
+  // are not removed before it.
+  if (!overflowed_.load(std::memory_order_acquire) && queue_.Insert(setting))
+    return;
+  rtc::CritScope cs(&overflow_crit_);
+  if (!overflowed_.load(std::memory_order_relaxed)) {
+    RTC_LOG(LS_WARNING) << "The runtime settings queue is full. Only the "
+                           "newest setting of each type is kept.";
+  }
+  overflow_[static_cast<size_t>(setting.type())] = setting;
+  overflowed_.store(true, std::memory_order_release);
+}
+
+bool AudioProcessingImpl::RuntimeSettingQueue::Remove(
+    RuntimeSetting* setting) {
+  if (queue_.Remove(setting))
+    return true;
+  if (!overflowed_.load(std::memory_order_acquire))
+    return false;
+  rtc::CritScope cs(&overflow_crit_);
+  for (RuntimeSetting& stored_setting : overflow_) {
+    if (stored_setting.type() != RuntimeSetting::Type::kNotSpecified) {
+      *setting = stored_setting;
+      stored_setting = RuntimeSetting();
+      return true;
+    }
+  }
+  overflowed_.store(false, std::memory_order_release);
+  return false;
+}
+
 AudioProcessingImpl::RuntimeSettingEnqueuer::RuntimeSettingEnqueuer(
-    SwapQueue<RuntimeSetting>* runtime_settings)
+    RuntimeSettingQueue* runtime_settings)
     : runtime_settings_(*runtime_settings) {
   RTC_DCHECK(runtime_settings);
 }
@@ -796,15 +833,7 @@ AudioProcessingImpl::RuntimeSettingEnqueuer::~RuntimeSettingEnqueuer() =
 
 void AudioProcessingImpl::RuntimeSettingEnqueuer::Enqueue(
     RuntimeSetting setting) {
-  size_t remaining_attempts = 10;
-  while (!runtime_settings_.Insert(&setting) && remaining_attempts-- > 0) {
-    RuntimeSetting setting_to_discard;
-    if (runtime_settings_.Remove(&setting_to_discard))
-      RTC_LOG(LS_ERROR)
-          << "The runtime settings queue is full. Oldest setting discarded.";
-  }
-  if (remaining_attempts == 0)
-    RTC_LOG(LS_ERROR) << "Cannot enqueue a new runtime setting.";
+  runtime_settings_.Insert(setting);
 }
 
 int AudioProcessingImpl::MaybeInitializeCapture(
@@ -966,43 +995,38 @@ void AudioProcessingImpl::QueueBandedRenderAudio(AudioBuffer* audio) {
                                                  num_reverse_channels(),
                                                  &aecm_render_queue_buffer_);
     RTC_DCHECK(aecm_render_signal_queue_);
-    // Insert the samples into the queue.
-    if (!aecm_render_signal_queue_->Insert(&aecm_render_queue_buffer_)) {
-      // The data queue is full and needs to be emptied.
-      EmptyQueuedRenderAudio();
-
-      // Retry the insert (should always work).
-      bool result =
-          aecm_render_signal_queue_->Insert(&aecm_render_queue_buffer_);
-      RTC_DCHECK(result);
-    }
+    InsertRenderQueueBlock(aecm_render_signal_queue_.get(),
+                           &aecm_render_queue_buffer_);
   }
 
   if (!submodules_.agc_manager && submodules_.gain_control) {
     GainControlImpl::PackRenderAudioBuffer(*audio, &agc_render_queue_buffer_);
-    // Insert the samples into the queue.
-    if (!agc_render_signal_queue_->Insert(&agc_render_queue_buffer_)) {
-      // The data queue is full and needs to be emptied.
-      EmptyQueuedRenderAudio();
-
-      // Retry the insert (should always work).
-      bool result = agc_render_signal_queue_->Insert(&agc_render_queue_buffer_);
-      RTC_DCHECK(result);
-    }
+    InsertRenderQueueBlock(agc_render_signal_queue_.get(),
+                           &agc_render_queue_buffer_);
   }
 }
 
 void AudioProcessingImpl::QueueNonbandedRenderAudio(AudioBuffer* audio) {
   ResidualEchoDetector::PackRenderAudioBuffer(audio, &red_render_queue_buffer_);
 
-  // Insert the samples into the queue.
-  if (!red_render_signal_queue_->Insert(&red_render_queue_buffer_)) {
-    // The data queue is full and needs to be emptied.
-    EmptyQueuedRenderAudio();
+  InsertRenderQueueBlock(red_render_signal_queue_.get(),
+                         &red_render_queue_buffer_);
+}
 
-    // Retry the insert (should always work).
-    bool result = red_render_signal_queue_->Insert(&red_render_queue_buffer_);
-    RTC_DCHECK(result);
+template <typename T>
+void AudioProcessingImpl::InsertRenderQueueBlock(
+    SwapQueue<std::vector<T>, RenderQueueItemVerifier<T>>* queue,
+    std::vector<T>* block) {
+  RTC_DCHECK(queue);
+  if (queue->Insert(block)) {
+    return;
+  }
+  // The capture side has not run for kMaxNumFramesToBuffer render frames.
+  // Emptying the queue from here would make the render thread wait for the
+  // capture lock, so the block is dropped instead, and the capture side
+  // discards the blocks left in the queues once it runs again.
+  if (!render_queue_overflowed_.exchange(true)) {
+    RTC_LOG(LS_WARNING) << "Render queue full, dropping render audio.";
   }
 }
 
@@ -1055,8 +1079,17 @@ void AudioProcessingImpl::AllocateRenderQueue() {
   }
 }
 
-void AudioProcessingImpl::EmptyQueuedRenderAudio() {
-  rtc::CritScope cs_capture(&crit_capture_);
+void AudioProcessingImpl::EmptyQueuedRenderAudioLocked() {
+  if (render_queue_overflowed_.exchange(false)) {
+    // Render audio was dropped, so the queued blocks are too old to be used.
+    if (aecm_render_signal_queue_) {
+      aecm_render_signal_queue_->Clear();
+    }
+    agc_render_signal_queue_->Clear();
+    red_render_signal_queue_->Clear();
+    return;
+  }
+
   if (submodules_.echo_control_mobile) {
     RTC_DCHECK(aecm_render_signal_queue_);
     while (aecm_render_signal_queue_->Remove(&aecm_capture_queue_buffer_)) {
@@ -1123,7 +1156,7 @@ int AudioProcessingImpl::ProcessStream(AudioFrame* frame) {
 }
 
 int AudioProcessingImpl::ProcessCaptureStreamLocked() {
-  EmptyQueuedRenderAudio();
+  EmptyQueuedRenderAudioLocked();
   HandleCaptureRuntimeSettings();
 
   // Ensure that not both the AEC and AECM are active at the same time.
@@ -11,6 +11,8 @@
 #ifndef MODULES_AUDIO_PROCESSING_AUDIO_PROCESSING_IMPL_H_
 #define MODULES_AUDIO_PROCESSING_AUDIO_PROCESSING_IMPL_H_
 
+#include <array>
+#include <atomic>
 #include <list>
 #include <memory>
 #include <vector>
@@ -38,6 +40,7 @@
 #include "rtc_base/critical_section.h"
 #include "rtc_base/gtest_prod_util.h"
 #include "rtc_base/ignore_wundef.h"
+#include "rtc_base/mpsc_queue.h"
 #include "rtc_base/swap_queue.h"
 #include "rtc_base/thread_annotations.h"
 
@@ -137,17 +140,44 @@ class AudioProcessingImpl : public AudioProcessing {
   FRIEND_TEST_ALL_PREFIXES(ApmConfiguration, ValidConfigBehavior);
   FRIEND_TEST_ALL_PREFIXES(ApmConfiguration, InValidConfigBehavior);
 
+  // Queue of runtime settings, which any thread can insert into without
+  // taking a lock as long as it is not full, and the thread applying the
+  // settings removes from. When it is full, only the newest setting of each
+  // type is kept aside, and later settings are collapsed into those until
+  // they have all been removed. Hence, no setting is lost unless a newer one
+  // of the same type replaces it.
+  class RuntimeSettingQueue {
+   public:
+    explicit RuntimeSettingQueue(size_t size);
+    ~RuntimeSettingQueue();
+    void Insert(RuntimeSetting setting);
+    bool Remove(RuntimeSetting* setting);
+
+   private:
+    static constexpr size_t kNumSettingTypes =
+        static_cast<size_t>(RuntimeSetting::Type::kPlayoutAudioDeviceChange) +
+        1;
+
+    MpscQueue<RuntimeSetting> queue_;
+    // Set while |overflow_| holds any setting.
+    std::atomic<bool> overflowed_{false};
+    rtc::CriticalSection overflow_crit_;
+    // Indexed by setting type. Unused entries are kNotSpecified.
+    std::array<RuntimeSetting, kNumSettingTypes> overflow_
+        RTC_GUARDED_BY(overflow_crit_);
+  };
+
   // Class providing thread-safe message pipe functionality for
-  // |runtime_settings_|.
+  // |runtime_settings_|. Settings may be enqueued from any thread without
+  // taking a lock.
   class RuntimeSettingEnqueuer {
    public:
-    explicit RuntimeSettingEnqueuer(
-        SwapQueue<RuntimeSetting>* runtime_settings);
+    explicit RuntimeSettingEnqueuer(RuntimeSettingQueue* runtime_settings);
     ~RuntimeSettingEnqueuer();
     void Enqueue(RuntimeSetting setting);
 
    private:
-    SwapQueue<RuntimeSetting>& runtime_settings_;
+    RuntimeSettingQueue& runtime_settings_;
   };
 
   std::unique_ptr<ApmDataDumper> data_dumper_;
@@ -155,8 +185,8 @@ class AudioProcessingImpl : public AudioProcessing {
   const bool enforced_usage_of_legacy_ns_;
   const bool use_setup_specific_default_aec3_config_;
 
-  SwapQueue<RuntimeSetting> capture_runtime_settings_;
-  SwapQueue<RuntimeSetting> render_runtime_settings_;
+  RuntimeSettingQueue capture_runtime_settings_;
+  RuntimeSettingQueue render_runtime_settings_;
 
   RuntimeSettingEnqueuer capture_runtime_settings_enqueuer_;
   RuntimeSettingEnqueuer render_runtime_settings_enqueuer_;
@@ -261,13 +291,20 @@ class AudioProcessingImpl : public AudioProcessing {
       RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_capture_);
   void HandleRenderRuntimeSettings() RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_render_);
 
-  void EmptyQueuedRenderAudio();
+  void EmptyQueuedRenderAudioLocked()
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_capture_);
   void AllocateRenderQueue()
       RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_render_, crit_capture_);
   void QueueBandedRenderAudio(AudioBuffer* audio)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_render_);
   void QueueNonbandedRenderAudio(AudioBuffer* audio)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_render_);
+  // Inserts |block| into |queue| without waiting for the capture side. If the
+  // queue is full, the block is dropped and |render_queue_overflowed_| set.
+  template <typename T>
+  void InsertRenderQueueBlock(
+      SwapQueue<std::vector<T>, RenderQueueItemVerifier<T>>* queue,
+      std::vector<T>* block) RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_render_);
 
   // Capture-side exclusive methods possibly running APM in a multi-threaded
   // manner that are called with the render lock already acquired.
@@ -436,6 +473,11 @@ class AudioProcessingImpl : public AudioProcessing {
     std::unique_ptr<AudioBuffer> render_audio;
   } render_ RTC_GUARDED_BY(crit_render_);
 
+  // Set by the render side when it drops a block because a render queue is
+  // full, and cleared by the capture side, which then discards the queued
+  // blocks rather than feeding the submodules out of date render audio.
+  std::atomic<bool> render_queue_overflowed_{false};
+
   // Class for statistics reporting. The class is thread-safe and no lock is
   // needed when accessing it.
   class ApmStatsReporter {
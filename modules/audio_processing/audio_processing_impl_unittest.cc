@@ -10,13 +10,17 @@
 
 #include "modules/audio_processing/audio_processing_impl.h"
 
+#include <atomic>
 #include <memory>
+#include <string>
 
 #include "api/scoped_refptr.h"
 #include "modules/audio_processing/include/audio_processing.h"
 #include "modules/audio_processing/test/echo_control_mock.h"
 #include "modules/audio_processing/test/test_utils.h"
 #include "rtc_base/checks.h"
+#include "rtc_base/event.h"
+#include "rtc_base/platform_thread.h"
 #include "rtc_base/ref_counted_object.h"
 #include "test/gmock.h"
 #include "test/gtest.h"
@@ -92,11 +96,13 @@ class TestEchoDetector : public EchoDetector {
  public:
   TestEchoDetector()
       : analyze_render_audio_called_(false),
+        num_analyzed_render_frames_(0),
         last_render_audio_first_sample_(0.f) {}
   ~TestEchoDetector() override = default;
   void AnalyzeRenderAudio(rtc::ArrayView<const float> render_audio) override {
     last_render_audio_first_sample_ = render_audio[0];
     analyze_render_audio_called_ = true;
+    ++num_analyzed_render_frames_;
   }
   void AnalyzeCaptureAudio(rtc::ArrayView<const float> capture_audio) override {
   }
@@ -109,6 +115,8 @@ class TestEchoDetector : public EchoDetector {
   bool analyze_render_audio_called() const {
     return analyze_render_audio_called_;
   }
+  // Returns the number of calls to AnalyzeRenderAudio().
+  int num_analyzed_render_frames() const { return num_analyzed_render_frames_; }
   // Returns the first sample of the last analyzed render frame.
   float last_render_audio_first_sample() const {
     return last_render_audio_first_sample_;
@@ -116,6 +124,7 @@ class TestEchoDetector : public EchoDetector {
 
  private:
   bool analyze_render_audio_called_;
+  int num_analyzed_render_frames_;
   float last_render_audio_first_sample_;
 };
 
@@ -142,6 +151,48 @@ class TestRenderPreProcessor : public CustomProcessing {
   static constexpr float ProcessSample(float x) { return 2.f * x; }
 };
 
+// CustomProcessing which, once armed, signals |entered| and then blocks until
+// |release| is set, or for at most |max_wait_ms|. Meant to stall the capture
+// thread while it holds the APM capture lock.
+class BlockingCaptureProcessor : public CustomProcessing {
+ public:
+  BlockingCaptureProcessor(rtc::Event* entered,
+                           rtc::Event* release,
+                           int max_wait_ms)
+      : entered_(entered), release_(release), max_wait_ms_(max_wait_ms) {}
+  void Initialize(int sample_rate_hz, int num_channels) override {}
+  void Process(AudioBuffer* audio) override {
+    if (armed_) {
+      entered_->Set();
+      released_ = release_->Wait(max_wait_ms_);
+    }
+  }
+  std::string ToString() const override { return "BlockingCaptureProcessor"; }
+  void SetRuntimeSetting(AudioProcessing::RuntimeSetting setting) override {}
+  void set_armed(bool armed) { armed_ = armed; }
+  // Returns false if the last stall ended because |max_wait_ms| elapsed.
+  bool released() const { return released_; }
+
+ private:
+  rtc::Event* const entered_;
+  rtc::Event* const release_;
+  const int max_wait_ms_;
+  std::atomic<bool> armed_{false};
+  std::atomic<bool> released_{true};
+};
+
+struct CaptureThreadParams {
+  AudioProcessing* apm;
+  AudioFrame* frame;
+};
+
+void ProcessCaptureFrame(void* params_ptr) {
+  CaptureThreadParams* params = static_cast<CaptureThreadParams*>(params_ptr);
+  params->apm->set_stream_delay_ms(0);
+  EXPECT_EQ(AudioProcessing::kNoError,
+            params->apm->ProcessStream(params->frame));
+}
+
 }  // namespace
 
 TEST(AudioProcessingImplTest, AudioParameterChangeTriggersInit) {
@@ -212,6 +263,39 @@ TEST(AudioProcessingImplTest, UpdateCapturePreGainRuntimeSetting) {
       << "Frame should be amplified.";
 }
 
+TEST(AudioProcessingImplTest, NewestRuntimeSettingIsKeptWhenQueueIsFull) {
+  std::unique_ptr<AudioProcessing> apm(AudioProcessingBuilder().Create());
+  webrtc::AudioProcessing::Config apm_config;
+  apm_config.pre_amplifier.enabled = true;
+  apm_config.pre_amplifier.fixed_gain_factor = 1.f;
+  apm->ApplyConfig(apm_config);
+
+  AudioFrame frame;
+  constexpr int16_t kAudioLevel = 10000;
+  constexpr size_t kSampleRateHz = 48000;
+  constexpr size_t kNumChannels = 2;
+  InitializeAudioFrame(kSampleRateHz, kNumChannels, &frame);
+  FillFixedFrame(kAudioLevel, &frame);
+  apm->ProcessStream(&frame);
+
+  // More settings than the queue holds before the capture side runs again.
+  for (int i = 0; i < 500; ++i) {
+    apm->SetRuntimeSetting(
+        AudioProcessing::RuntimeSetting::CreateCapturePreGain(1.5f));
+  }
+  constexpr float kGainFactor = 2.f;
+  apm->SetRuntimeSetting(
+      AudioProcessing::RuntimeSetting::CreateCapturePreGain(kGainFactor));
+
+  // Process for two frames to have time to ramp up gain.
+  for (int i = 0; i < 2; ++i) {
+    FillFixedFrame(kAudioLevel, &frame);
+    apm->ProcessStream(&frame);
+  }
+  EXPECT_EQ(frame.data()[100], kGainFactor * kAudioLevel)
+      << "The newest gain should be applied.";
+}
+
 TEST(AudioProcessingImplTest,
      EchoControllerObservesPreAmplifierEchoPathGainChange) {
   // Tests that the echo controller observes an echo path gain change when the
@@ -413,4 +497,85 @@ TEST(AudioProcessingImplTest, RenderPreProcessorBeforeEchoDetector) {
             test_echo_detector->last_render_audio_first_sample());
 }
 
+// Verifies that the render side keeps processing while the capture side is
+// stalled with the capture lock held, also once more render frames have been
+// queued than the capture side can buffer, and that the capture side then
+// drops the out of date render audio instead of analyzing it.
+TEST(AudioProcessingImplTest, RenderDoesNotWaitForStalledCapture) {
+  constexpr int kMaxWaitMs = 10000;
+  rtc::Event entered;
+  rtc::Event release;
+  auto blocking_processor = std::make_unique<BlockingCaptureProcessor>(
+      &entered, &release, kMaxWaitMs);
+  BlockingCaptureProcessor* blocking_processor_ptr = blocking_processor.get();
+  rtc::scoped_refptr<TestEchoDetector> test_echo_detector(
+      new rtc::RefCountedObject<TestEchoDetector>());
+  std::unique_ptr<AudioProcessing> apm(
+      AudioProcessingBuilder()
+          .SetCapturePostProcessing(std::move(blocking_processor))
+          .SetEchoDetector(test_echo_detector)
+          .Create());
+  webrtc::AudioProcessing::Config apm_config;
+  apm_config.echo_canceller.enabled = true;
+  apm_config.echo_canceller.mobile_mode = true;
+  apm_config.residual_echo_detector.enabled = true;
+  apm->ApplyConfig(apm_config);
+
+  constexpr int kSampleRateHz = 16000;
+  constexpr size_t kNumChannels = 1;
+  AudioFrame render_frame;
+  InitializeAudioFrame(kSampleRateHz, kNumChannels, &render_frame);
+  AudioFrame capture_frame;
+  InitializeAudioFrame(kSampleRateHz, kNumChannels, &capture_frame);
+  FillFixedFrame(1000, &render_frame);
+  FillFixedFrame(1000, &capture_frame);
+
+  // Process one frame in each direction so that no further initialization,
+  // which requires both locks, is triggered.
+  ASSERT_EQ(AudioProcessing::kNoError,
+            apm->ProcessReverseStream(&render_frame));
+  apm->set_stream_delay_ms(0);
+  ASSERT_EQ(AudioProcessing::kNoError, apm->ProcessStream(&capture_frame));
+
+  blocking_processor_ptr->set_armed(true);
+  CaptureThreadParams params = {apm.get(), &capture_frame};
+  rtc::PlatformThread capture_thread(ProcessCaptureFrame, &params,
+                                     "StalledCapture");
+  capture_thread.Start();
+  EXPECT_TRUE(entered.Wait(kMaxWaitMs));
+
+  // More frames than the render queues can hold. If the render side waited
+  // for the capture lock, the stall would only end after |kMaxWaitMs|.
+  for (int i = 0; i < 300; ++i) {
+    ASSERT_EQ(AudioProcessing::kNoError,
+              apm->ProcessReverseStream(&render_frame));
+  }
+  apm->SetRuntimeSetting(
+      AudioProcessing::RuntimeSetting::CreateCapturePreGain(2.f));
+
+  blocking_processor_ptr->set_armed(false);
+  release.Set();
+  capture_thread.Stop();
+  EXPECT_TRUE(blocking_processor_ptr->released());
+
+  // The capture side resumes after the overflow and drops the queued render
+  // audio, which is older than the audio that could not be queued.
+  const int num_analyzed_render_frames =
+      test_echo_detector->num_analyzed_render_frames();
+  apm->set_stream_delay_ms(0);
+  ASSERT_EQ(AudioProcessing::kNoError, apm->ProcessStream(&capture_frame));
+  EXPECT_EQ(num_analyzed_render_frames,
+            test_echo_detector->num_analyzed_render_frames());
+
+  // Render audio queued after that is analyzed again.
+  FillFixedFrame(2000, &render_frame);
+  ASSERT_EQ(AudioProcessing::kNoError,
+            apm->ProcessReverseStream(&render_frame));
+  apm->set_stream_delay_ms(0);
+  ASSERT_EQ(AudioProcessing::kNoError, apm->ProcessStream(&capture_frame));
+  EXPECT_EQ(num_analyzed_render_frames + 1,
+            test_echo_detector->num_analyzed_render_frames());
+  EXPECT_EQ(2000.f, test_echo_detector->last_render_audio_first_sample());
+}
+
 }  // namespace webrtc
@@ -0,0 +1,261 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_processing/batched_audio_processing.h"
+
+#include <algorithm>
+
+#include "modules/audio_processing/high_pass_filter.h"
+#include "modules/audio_processing/ns/ns_config.h"
+#include "rtc_base/checks.h"
+#include "system_wrappers/include/field_trial.h"
+
+namespace webrtc {
+
+namespace {
+
+constexpr int kSplitBandSampleRateHz = AudioProcessing::kSampleRate16kHz;
+
+bool SampleRateSupportsMultiBand(int sample_rate_hz) {
+  return sample_rate_hz == AudioProcessing::kSampleRate32kHz ||
+         sample_rate_hz == AudioProcessing::kSampleRate48kHz;
+}
+
+NsConfig::SuppressionLevel MapNsLevel(
+    AudioProcessing::Config::NoiseSuppression::Level level) {
+  using NoiseSuppresionConfig = AudioProcessing::Config::NoiseSuppression;
+  switch (level) {
+    case NoiseSuppresionConfig::kLow:
+      return NsConfig::SuppressionLevel::k6dB;
+    case NoiseSuppresionConfig::kModerate:
+      return NsConfig::SuppressionLevel::k12dB;
+    case NoiseSuppresionConfig::kHigh:
+      return NsConfig::SuppressionLevel::k18dB;
+    case NoiseSuppresionConfig::kVeryHigh:
+      return NsConfig::SuppressionLevel::k21dB;
+  }
+  RTC_NOTREACHED();
+  return NsConfig::SuppressionLevel::k12dB;
+}
+
+}  // namespace
+
+BatchedAudioProcessing::Stream::Stream(const AudioProcessing::Config& config,
+                                       const StreamConfig& stream_config)
+    : audio(stream_config.sample_rate_hz(),
+            stream_config.num_channels(),
+            stream_config.sample_rate_hz(),
+            stream_config.num_channels(),
+            stream_config.sample_rate_hz(),
+            stream_config.num_channels()) {
+  if (config.noise_suppression.enabled) {
+    NsConfig ns_config;
+    ns_config.target_level = MapNsLevel(config.noise_suppression.level);
+    noise_suppressor = std::make_unique<NoiseSuppressor>(
+        ns_config, stream_config.sample_rate_hz(),
+        stream_config.num_channels());
+  }
+  if (config.gain_controller2.enabled) {
+    gain_controller2 = std::make_unique<GainController2>();
+    gain_controller2->Initialize(stream_config.sample_rate_hz());
+    gain_controller2->ApplyConfig(config.gain_controller2);
+  }
+}
+
+BatchedAudioProcessing::Stream::~Stream() = default;
+
+bool BatchedAudioProcessing::Validate(const AudioProcessing::Config& config) {
+  // The residual echo detector is enabled by default but only analyzes the
+  // signal; it is ignored since there is no render signal.
+  return !config.pre_amplifier.enabled && !config.echo_canceller.enabled &&
+         !config.noise_suppression.use_legacy_ns &&
+         !config.transient_suppression.enabled &&
+         !config.voice_detection.enabled &&
+         !config.gain_controller1.enabled && !config.level_estimation.enabled &&
+         (!config.gain_controller2.enabled ||
+          GainController2::Validate(config.gain_controller2));
+}
+
+BatchedAudioProcessing::BatchedAudioProcessing(
+    const AudioProcessing::Config& config,
+    const StreamConfig& stream_config,
+    size_t num_streams)
+    : config_(config),
+      stream_config_(stream_config),
+      high_pass_filter_enabled_(config.high_pass_filter.enabled ||
+                                config.noise_suppression.enabled),
+      // As in AudioProcessing, the field trial forces split-band filtering.
+      high_pass_filter_in_full_band_(
+          config.high_pass_filter.apply_in_full_band &&
+          !field_trial::IsEnabled("WebRTC-FullBandHpfKillSwitch")),
+      multi_band_processing_(
+          high_pass_filter_enabled_ &&
+          SampleRateSupportsMultiBand(stream_config.sample_rate_hz())) {
+  RTC_DCHECK(Validate(config));
+  RTC_DCHECK(stream_config.sample_rate_hz() ==
+                 AudioProcessing::kSampleRate16kHz ||
+             SampleRateSupportsMultiBand(stream_config.sample_rate_hz()));
+  RTC_DCHECK_LT(0, stream_config.num_channels());
+  RTC_DCHECK_LT(0, num_streams);
+
+  streams_.reserve(num_streams);
+  for (size_t k = 0; k < num_streams; ++k) {
+    streams_.push_back(std::make_unique<Stream>(config_, stream_config_));
+  }
+
+  if (high_pass_filter_enabled_) {
+    const size_t num_lanes = num_streams * stream_config_.num_channels();
+    hpf_x0_.resize(num_lanes, 0.f);
+    hpf_x1_.resize(num_lanes, 0.f);
+    hpf_y0_.resize(num_lanes, 0.f);
+    hpf_y1_.resize(num_lanes, 0.f);
+    hpf_signal_.resize(num_lanes * streams_[0]->audio.num_frames());
+  }
+}
+
+BatchedAudioProcessing::~BatchedAudioProcessing() = default;
+
+int BatchedAudioProcessing::ProcessStreams(
+    rtc::ArrayView<const float* const* const> src,
+    rtc::ArrayView<float* const* const> dest) {
+  if (src.size() != streams_.size() || dest.size() != streams_.size()) {
+    return AudioProcessing::kBadNumberChannelsError;
+  }
+  for (size_t k = 0; k < streams_.size(); ++k) {
+    if (!src[k] || !dest[k]) {
+      return AudioProcessing::kNullPointerError;
+    }
+  }
+
+  for (size_t k = 0; k < streams_.size(); ++k) {
+    streams_[k]->audio.CopyFrom(src[k], stream_config_);
+  }
+
+  if (high_pass_filter_enabled_ && high_pass_filter_in_full_band_) {
+    ApplyHighPassFilter();
+  }
+
+  if (multi_band_processing_) {
+    for (auto& stream : streams_) {
+      stream->audio.SplitIntoFrequencyBands();
+    }
+  }
+
+  if (high_pass_filter_enabled_ && !high_pass_filter_in_full_band_) {
+    ApplyHighPassFilter();
+  }
+
+  if (config_.noise_suppression.enabled) {
+    for (auto& stream : streams_) {
+      stream->noise_suppressor->Analyze(stream->audio);
+    }
+    for (auto& stream : streams_) {
+      stream->noise_suppressor->Process(&stream->audio);
+    }
+  }
+
+  if (multi_band_processing_) {
+    for (auto& stream : streams_) {
+      stream->audio.MergeFrequencyBands();
+    }
+  }
+
+  if (config_.gain_controller2.enabled) {
+    for (auto& stream : streams_) {
+      stream->gain_controller2->Process(&stream->audio);
+    }
+  }
+
+  for (size_t k = 0; k < streams_.size(); ++k) {
+    streams_[k]->audio.CopyTo(stream_config_, dest[k]);
+  }
+
+  return AudioProcessing::kNoError;
+}
+
+void BatchedAudioProcessing::ResetStream(size_t stream_index) {
+  RTC_DCHECK_LT(stream_index, streams_.size());
+  streams_[stream_index] = std::make_unique<Stream>(config_, stream_config_);
+
+  if (high_pass_filter_enabled_) {
+    const size_t num_channels = stream_config_.num_channels();
+    const size_t first_lane = stream_index * num_channels;
+    for (auto* state : {&hpf_x0_, &hpf_x1_, &hpf_y0_, &hpf_y1_}) {
+      std::fill(state->begin() + first_lane,
+                state->begin() + first_lane + num_channels, 0.f);
+    }
+  }
+}
+
+void BatchedAudioProcessing::ApplyHighPassFilter() {
+  const size_t num_channels = stream_config_.num_channels();
+  const size_t num_lanes = streams_.size() * num_channels;
+  const bool full_band = high_pass_filter_in_full_band_;
+  const size_t num_frames = full_band
+                                ? streams_[0]->audio.num_frames()
+                                : streams_[0]->audio.num_frames_per_band();
+  const CascadedBiQuadFilter::BiQuadCoefficients& coefficients =
+      HighPassFilter::Coefficients(full_band ? stream_config_.sample_rate_hz()
+                                             : kSplitBandSampleRateHz);
+  RTC_DCHECK_LE(num_lanes * num_frames, hpf_signal_.size());
+
+  // Transpose the signal so that the values of all lanes for a sample are
+  // adjacent.
+  for (size_t s = 0; s < streams_.size(); ++s) {
+    AudioBuffer& audio = streams_[s]->audio;
+    for (size_t ch = 0; ch < num_channels; ++ch) {
+      const float* x =
+          full_band ? audio.channels_const()[ch] : audio.split_bands(ch)[0];
+      const size_t lane = s * num_channels + ch;
+      for (size_t k = 0; k < num_frames; ++k) {
+        hpf_signal_[k * num_lanes + lane] = x[k];
+      }
+    }
+  }
+
+  // Apply the biquad to all lanes in lockstep. The filter recursion is over
+  // time, so the lanes are independent and the inner loop vectorizes. The
+  // arithmetic is the same as in CascadedBiQuadFilter.
+  const float b0 = coefficients.b[0];
+  const float b1 = coefficients.b[1];
+  const float b2 = coefficients.b[2];
+  const float a0 = coefficients.a[0];
+  const float a1 = coefficients.a[1];
+  float* x0 = hpf_x0_.data();
+  float* x1 = hpf_x1_.data();
+  float* y0 = hpf_y0_.data();
+  float* y1 = hpf_y1_.data();
+  for (size_t k = 0; k < num_frames; ++k) {
+    float* signal = &hpf_signal_[k * num_lanes];
+    for (size_t l = 0; l < num_lanes; ++l) {
+      const float tmp = signal[l];
+      const float y =
+          b0 * tmp + b1 * x0[l] + b2 * x1[l] - a0 * y0[l] - a1 * y1[l];
+      x1[l] = x0[l];
+      x0[l] = tmp;
+      y1[l] = y0[l];
+      y0[l] = y;
+      signal[l] = y;
+    }
+  }
+
+  for (size_t s = 0; s < streams_.size(); ++s) {
+    AudioBuffer& audio = streams_[s]->audio;
+    for (size_t ch = 0; ch < num_channels; ++ch) {
+      float* x = full_band ? audio.channels()[ch] : audio.split_bands(ch)[0];
+      const size_t lane = s * num_channels + ch;
+      for (size_t k = 0; k < num_frames; ++k) {
+        x[k] = hpf_signal_[k * num_lanes + lane];
+      }
+    }
+  }
+}
+
+}  // namespace webrtc
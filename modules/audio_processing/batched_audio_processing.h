@@ -0,0 +1,107 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_AUDIO_PROCESSING_BATCHED_AUDIO_PROCESSING_H_
+#define MODULES_AUDIO_PROCESSING_BATCHED_AUDIO_PROCESSING_H_
+
+#include <stddef.h>
+
+#include <memory>
+#include <vector>
+
+#include "api/array_view.h"
+#include "modules/audio_processing/audio_buffer.h"
+#include "modules/audio_processing/gain_controller2.h"
+#include "modules/audio_processing/include/audio_processing.h"
+#include "modules/audio_processing/ns/noise_suppressor.h"
+
+namespace webrtc {
+
+// Processes the capture side of many independent streams that share one
+// configuration, e.g. for cleaning up incoming streams on a media server.
+//
+// Compared to running one AudioProcessing instance per stream, all streams
+// are processed in a single call without any locking, and each submodule is
+// run over all streams before the next one starts.
+//
+// Only the high-pass filter is batched: it is applied to all streams at once
+// on a structure-of-arrays copy of the signal, so that it vectorizes across
+// streams. The band splitting, the noise suppressor and the gain controller
+// 2 still run one stream at a time, with their own per-stream instances.
+//
+// Only the submodules that do not need a render signal are supported: the
+// high-pass filter, the noise suppressor and the gain controller 2. As in
+// AudioProcessing, enabling noise suppression also enables the high-pass
+// filter. The output of each stream matches that of an AudioProcessing
+// instance with the same configuration.
+//
+// The class is not thread safe.
+class BatchedAudioProcessing {
+ public:
+  // Returns true if |config| only enables submodules that are supported.
+  static bool Validate(const AudioProcessing::Config& config);
+
+  // Creates an engine for |num_streams| streams, which all use
+  // |stream_config| for both the input and the output. The sample rate must
+  // be 16, 32 or 48 kHz.
+  BatchedAudioProcessing(const AudioProcessing::Config& config,
+                         const StreamConfig& stream_config,
+                         size_t num_streams);
+  ~BatchedAudioProcessing();
+  BatchedAudioProcessing(const BatchedAudioProcessing&) = delete;
+  BatchedAudioProcessing& operator=(const BatchedAudioProcessing&) = delete;
+
+  // Processes one 10 ms chunk of every stream. |src[k]| and |dest[k]| point
+  // to the deinterleaved channels of stream k, in the float [-1, 1] range.
+  // They may point to the same data. Returns an AudioProcessing::Error code.
+  int ProcessStreams(rtc::ArrayView<const float* const* const> src,
+                     rtc::ArrayView<float* const* const> dest);
+
+  // Resets the state of the stream |stream_index|, so that its slot can be
+  // reused for a new stream.
+  void ResetStream(size_t stream_index);
+
+  size_t num_streams() const { return streams_.size(); }
+  const StreamConfig& stream_config() const { return stream_config_; }
+
+ private:
+  struct Stream {
+    Stream(const AudioProcessing::Config& config,
+           const StreamConfig& stream_config);
+    ~Stream();
+
+    AudioBuffer audio;
+    std::unique_ptr<NoiseSuppressor> noise_suppressor;
+    std::unique_ptr<GainController2> gain_controller2;
+  };
+
+  // Applies the high-pass filter to all channels of all streams.
+  void ApplyHighPassFilter();
+
+  const AudioProcessing::Config config_;
+  const StreamConfig stream_config_;
+  const bool high_pass_filter_enabled_;
+  const bool high_pass_filter_in_full_band_;
+  const bool multi_band_processing_;
+  std::vector<std::unique_ptr<Stream>> streams_;
+
+  // Filter state and signal of the high-pass filter, indexed by lane, where
+  // lane l holds channel l % num_channels of stream l / num_channels. The
+  // signal is stored sample by sample, with one value per lane.
+  std::vector<float> hpf_x0_;
+  std::vector<float> hpf_x1_;
+  std::vector<float> hpf_y0_;
+  std::vector<float> hpf_y1_;
+  std::vector<float> hpf_signal_;
+};
+
+}  // namespace webrtc
+
+#endif  // MODULES_AUDIO_PROCESSING_BATCHED_AUDIO_PROCESSING_H_
@@ -0,0 +1,303 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/audio_processing/batched_audio_processing.h"
+
+#include <math.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common_audio/channel_buffer.h"
+#include "modules/audio_processing/test/performance_timer.h"
+#include "rtc_base/random.h"
+#include "rtc_base/strings/string_builder.h"
+#include "test/field_trial.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace {
+
+constexpr size_t kNumStreams = 5;
+constexpr size_t kNumFramesToProcess = 200;
+
+std::string ProduceDebugText(int sample_rate_hz, size_t num_channels) {
+  rtc::StringBuilder ss;
+  ss << "Sample rate: " << sample_rate_hz
+     << ", num channels: " << num_channels;
+  return ss.Release();
+}
+
+AudioProcessing::Config CreateConfig() {
+  AudioProcessing::Config config;
+  config.high_pass_filter.enabled = true;
+  config.noise_suppression.enabled = true;
+  config.noise_suppression.level =
+      AudioProcessing::Config::NoiseSuppression::kHigh;
+  config.gain_controller2.enabled = true;
+  config.gain_controller2.fixed_digital.gain_db = 6.f;
+  config.gain_controller2.adaptive_digital.enabled = true;
+  return config;
+}
+
+// Fills |frame| with a stream specific tone in noise.
+void GenerateFrame(size_t stream,
+                   size_t frame_index,
+                   Random* random_generator,
+                   ChannelBuffer<float>* frame) {
+  for (size_t ch = 0; ch < frame->num_channels(); ++ch) {
+    float* channel = frame->channels()[ch];
+    for (size_t k = 0; k < frame->num_frames(); ++k) {
+      const size_t n = frame_index * frame->num_frames() + k;
+      channel[k] = 0.1f * sinf(0.01f * (stream + 1) * n) +
+                   0.05f * (random_generator->Rand<float>() - 0.5f) +
+                   0.01f * ch;
+    }
+  }
+}
+
+void CopyFrame(const ChannelBuffer<float>& src, ChannelBuffer<float>* dest) {
+  for (size_t ch = 0; ch < src.num_channels(); ++ch) {
+    std::copy(src.channels()[ch], src.channels()[ch] + src.num_frames(),
+              dest->channels()[ch]);
+  }
+}
+
+// Verifies that each stream processed by BatchedAudioProcessing produces the
+// same output as a separate AudioProcessing instance with the same config.
+void VerifyMatchesAudioProcessing(const AudioProcessing::Config& config,
+                                  int sample_rate_hz,
+                                  size_t num_channels) {
+  const StreamConfig stream_config(sample_rate_hz, num_channels);
+  BatchedAudioProcessing batched(config, stream_config, kNumStreams);
+
+  std::vector<std::unique_ptr<AudioProcessing>> apms;
+  std::vector<std::unique_ptr<ChannelBuffer<float>>> reference;
+  std::vector<std::unique_ptr<ChannelBuffer<float>>> frames;
+  for (size_t s = 0; s < kNumStreams; ++s) {
+    apms.emplace_back(AudioProcessingBuilder().Create());
+    apms.back()->ApplyConfig(config);
+    reference.push_back(std::make_unique<ChannelBuffer<float>>(
+        stream_config.num_frames(), num_channels));
+    frames.push_back(std::make_unique<ChannelBuffer<float>>(
+        stream_config.num_frames(), num_channels));
+  }
+
+  Random random_generator(42U);
+  for (size_t i = 0; i < kNumFramesToProcess; ++i) {
+    std::vector<float* const*> channels(kNumStreams);
+    for (size_t s = 0; s < kNumStreams; ++s) {
+      GenerateFrame(s, i, &random_generator, frames[s].get());
+      CopyFrame(*frames[s], reference[s].get());
+      ASSERT_EQ(AudioProcessing::kNoError,
+                apms[s]->ProcessStream(reference[s]->channels(), stream_config,
+                                       stream_config,
+                                       reference[s]->channels()));
+      channels[s] = frames[s]->channels();
+    }
+
+    std::vector<const float* const*> const_channels(channels.begin(),
+                                                    channels.end());
+    ASSERT_EQ(AudioProcessing::kNoError,
+              batched.ProcessStreams(const_channels, channels));
+
+    for (size_t s = 0; s < kNumStreams; ++s) {
+      for (size_t ch = 0; ch < num_channels; ++ch) {
+        for (size_t k = 0; k < stream_config.num_frames(); ++k) {
+          ASSERT_NEAR(reference[s]->channels()[ch][k],
+                      frames[s]->channels()[ch][k], 1e-6f)
+              << "stream " << s << ", frame " << i;
+        }
+      }
+    }
+  }
+}
+
+// Reports the average time to process one chunk of |num_streams| streams with
+// BatchedAudioProcessing and with one AudioProcessing instance per stream.
+void BenchmarkAgainstAudioProcessing(const AudioProcessing::Config& config,
+                                     const StreamConfig& stream_config,
+                                     size_t num_streams) {
+  constexpr size_t kNumChunks = 1000;
+  constexpr size_t kNumWarmupChunks = 100;
+  BatchedAudioProcessing batched(config, stream_config, num_streams);
+  std::vector<std::unique_ptr<AudioProcessing>> apms;
+  std::vector<std::unique_ptr<ChannelBuffer<float>>> frames;
+  std::vector<float* const*> channels;
+  for (size_t s = 0; s < num_streams; ++s) {
+    apms.emplace_back(AudioProcessingBuilder().Create());
+    apms.back()->ApplyConfig(config);
+    frames.push_back(std::make_unique<ChannelBuffer<float>>(
+        stream_config.num_frames(), stream_config.num_channels()));
+    channels.push_back(frames.back()->channels());
+  }
+  std::vector<const float* const*> const_channels(channels.begin(),
+                                                  channels.end());
+
+  Random random_generator(42U);
+  test::PerformanceTimer batched_timer(kNumChunks);
+  test::PerformanceTimer apm_timer(kNumChunks);
+  for (size_t i = 0; i < kNumChunks; ++i) {
+    for (size_t s = 0; s < num_streams; ++s) {
+      GenerateFrame(s, i, &random_generator, frames[s].get());
+    }
+    batched_timer.StartTimer();
+    ASSERT_EQ(AudioProcessing::kNoError,
+              batched.ProcessStreams(const_channels, channels));
+    batched_timer.StopTimer();
+
+    for (size_t s = 0; s < num_streams; ++s) {
+      GenerateFrame(s, i, &random_generator, frames[s].get());
+    }
+    apm_timer.StartTimer();
+    for (size_t s = 0; s < num_streams; ++s) {
+      ASSERT_EQ(AudioProcessing::kNoError,
+                apms[s]->ProcessStream(channels[s], stream_config,
+                                       stream_config, channels[s]));
+    }
+    apm_timer.StopTimer();
+  }
+
+  rtc::StringBuilder trace;
+  trace << "_" << num_streams << "_streams_"
+        << stream_config.sample_rate_hz() << "Hz_"
+        << stream_config.num_channels() << "ch";
+  test::PrintResultMeanAndError(
+      "batched_apm_timing", trace.str(), "BatchedAudioProcessing",
+      batched_timer.GetDurationAverage(kNumWarmupChunks),
+      batched_timer.GetDurationStandardDeviation(kNumWarmupChunks), "us",
+      false);
+  test::PrintResultMeanAndError(
+      "batched_apm_timing", trace.str(), "AudioProcessing",
+      apm_timer.GetDurationAverage(kNumWarmupChunks),
+      apm_timer.GetDurationStandardDeviation(kNumWarmupChunks), "us", false);
+}
+
+}  // namespace
+
+TEST(BatchedAudioProcessing, MatchesAudioProcessing) {
+  for (int sample_rate_hz : {16000, 32000, 48000}) {
+    for (size_t num_channels : {1, 2}) {
+      SCOPED_TRACE(ProduceDebugText(sample_rate_hz, num_channels));
+      VerifyMatchesAudioProcessing(CreateConfig(), sample_rate_hz,
+                                   num_channels);
+    }
+  }
+}
+
+TEST(BatchedAudioProcessing, MatchesAudioProcessingWithSplitBandHpf) {
+  AudioProcessing::Config config = CreateConfig();
+  config.high_pass_filter.apply_in_full_band = false;
+  for (int sample_rate_hz : {16000, 48000}) {
+    SCOPED_TRACE(ProduceDebugText(sample_rate_hz, 1));
+    VerifyMatchesAudioProcessing(config, sample_rate_hz, 1);
+  }
+}
+
+TEST(BatchedAudioProcessing, MatchesAudioProcessingWithEnforcedSplitBandHpf) {
+  test::ScopedFieldTrials field_trials("WebRTC-FullBandHpfKillSwitch/Enabled/");
+  for (int sample_rate_hz : {16000, 48000}) {
+    SCOPED_TRACE(ProduceDebugText(sample_rate_hz, 2));
+    VerifyMatchesAudioProcessing(CreateConfig(), sample_rate_hz, 2);
+  }
+}
+
+TEST(BatchedAudioProcessing, MatchesAudioProcessingWithOnlyGainController2) {
+  AudioProcessing::Config config;
+  config.gain_controller2.enabled = true;
+  config.gain_controller2.fixed_digital.gain_db = 10.f;
+  VerifyMatchesAudioProcessing(config, 48000, 2);
+}
+
+// Verifies that a reset stream behaves as a newly created one.
+TEST(BatchedAudioProcessing, ResetStream) {
+  const StreamConfig stream_config(48000, 1);
+  BatchedAudioProcessing batched(CreateConfig(), stream_config, 2);
+  BatchedAudioProcessing fresh(CreateConfig(), stream_config, 1);
+  ChannelBuffer<float> frame0(stream_config.num_frames(), 1);
+  ChannelBuffer<float> frame1(stream_config.num_frames(), 1);
+  ChannelBuffer<float> fresh_frame(stream_config.num_frames(), 1);
+  std::vector<float* const*> channels = {frame0.channels(), frame1.channels()};
+  std::vector<const float* const*> const_channels(channels.begin(),
+                                                  channels.end());
+  std::vector<float* const*> fresh_channels = {fresh_frame.channels()};
+  std::vector<const float* const*> const_fresh_channels = {
+      fresh_frame.channels()};
+
+  Random random_generator(42U);
+  for (size_t i = 0; i < 50; ++i) {
+    GenerateFrame(0, i, &random_generator, &frame0);
+    GenerateFrame(1, i, &random_generator, &frame1);
+    ASSERT_EQ(AudioProcessing::kNoError,
+              batched.ProcessStreams(const_channels, channels));
+  }
+
+  batched.ResetStream(1);
+  for (size_t i = 0; i < 50; ++i) {
+    GenerateFrame(0, i, &random_generator, &frame0);
+    GenerateFrame(1, i, &random_generator, &frame1);
+    CopyFrame(frame1, &fresh_frame);
+    ASSERT_EQ(AudioProcessing::kNoError,
+              batched.ProcessStreams(const_channels, channels));
+    ASSERT_EQ(AudioProcessing::kNoError,
+              fresh.ProcessStreams(const_fresh_channels, fresh_channels));
+    for (size_t k = 0; k < stream_config.num_frames(); ++k) {
+      ASSERT_EQ(fresh_frame.channels()[0][k], frame1.channels()[0][k]);
+    }
+  }
+}
+
+TEST(BatchedAudioProcessing, RejectsMismatchingNumberOfStreams) {
+  const StreamConfig stream_config(16000, 1);
+  BatchedAudioProcessing batched(CreateConfig(), stream_config, 2);
+  ChannelBuffer<float> frame(stream_config.num_frames(), 1);
+  std::vector<float* const*> channels = {frame.channels()};
+  std::vector<const float* const*> const_channels = {frame.channels()};
+  EXPECT_EQ(AudioProcessing::kBadNumberChannelsError,
+            batched.ProcessStreams(const_channels, channels));
+}
+
+// Compares the batched processing with one AudioProcessing per stream, for the
+// full configuration and for the high-pass filter alone, which is the only
+// submodule processed across streams at once.
+TEST(BatchedAudioProcessing, DISABLED_Benchmark) {
+  constexpr size_t kNumBenchmarkStreams = 50;
+  for (int sample_rate_hz : {16000, 48000}) {
+    BenchmarkAgainstAudioProcessing(CreateConfig(),
+                                    StreamConfig(sample_rate_hz, 1),
+                                    kNumBenchmarkStreams);
+  }
+  AudioProcessing::Config high_pass_filter_config;
+  high_pass_filter_config.high_pass_filter.enabled = true;
+  BenchmarkAgainstAudioProcessing(high_pass_filter_config,
+                                  StreamConfig(48000, 1), kNumBenchmarkStreams);
+}
+
+TEST(BatchedAudioProcessing, Validate) {
+  EXPECT_TRUE(BatchedAudioProcessing::Validate(CreateConfig()));
+  EXPECT_TRUE(BatchedAudioProcessing::Validate(AudioProcessing::Config()));
+
+  AudioProcessing::Config config = CreateConfig();
+  config.echo_canceller.enabled = true;
+  EXPECT_FALSE(BatchedAudioProcessing::Validate(config));
+
+  config = CreateConfig();
+  config.gain_controller1.enabled = true;
+  EXPECT_FALSE(BatchedAudioProcessing::Validate(config));
+
+  config = CreateConfig();
+  config.noise_suppression.use_legacy_ns = true;
+  EXPECT_FALSE(BatchedAudioProcessing::Validate(config));
+}
+
+}  // namespace webrtc
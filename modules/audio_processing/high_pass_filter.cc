@@ -52,6 +52,13 @@ const CascadedBiQuadFilter::BiQuadCoefficients& ChooseCoefficients(
 
 }  // namespace
 
+const CascadedBiQuadFilter::BiQuadCoefficients& HighPassFilter::Coefficients(
+    int sample_rate_hz) {
+  static_assert(kNumberOfHighPassBiQuads == 1,
+                "The filter is expected to consist of a single biquad");
+  return ChooseCoefficients(sample_rate_hz);
+}
+
 HighPassFilter::HighPassFilter(int sample_rate_hz, size_t num_channels)
     : sample_rate_hz_(sample_rate_hz) {
   filters_.resize(num_channels);
@@ -36,6 +36,11 @@ class HighPassFilter {
   int sample_rate_hz() const { return sample_rate_hz_; }
   size_t num_channels() const { return filters_.size(); }
 
+  // Returns the coefficients of the single biquad that forms the filter for
+  // the sample rate |sample_rate_hz|.
+  static const CascadedBiQuadFilter::BiQuadCoefficients& Coefficients(
+      int sample_rate_hz);
+
  private:
   const int sample_rate_hz_;
   std::vector<std::unique_ptr<CascadedBiQuadFilter>> filters_;
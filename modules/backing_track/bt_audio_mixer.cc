@@ -5,6 +5,7 @@
 #include "audio/audio_transport_impl.h"
 #include "modules/audio_device/audio_device_buffer.h"
 #include "modules/audio_mixer/audio_mixer_impl.h"
+#include "modules/audio_mixer/default_output_rate_calculator.h"
 #include "modules/backing_track/audio_mixer_global.h"
 #include "modules/backing_track/audio_source_compressed.h"
 #include "modules/backing_track/bt_audio_mixer.h"
@@ -17,7 +18,11 @@ BtAudioMixer::BtAudioMixer(const MixerConfig& config,
                            SourceFinishCallback finish_callback,
                            SourceErrorCallback error_callback,
                            void* callback_opaque)
-    : mixer_(webrtc::AudioMixerImpl::Create()),
+    : mixer_(webrtc::AudioMixerImpl::Create(
+          absl::make_unique<webrtc::DefaultOutputRateCalculator>(), true,
+          // The microphone and every music track are mixed, not only the
+          // three loudest sources.
+          webrtc::AudioMixerImpl::kMixAllSources)),
       record_source_(nullptr),
       mixed_frame_(absl::make_unique<webrtc::AudioFrame>()),
       output_sample_rate_(config.output_sample_rate),
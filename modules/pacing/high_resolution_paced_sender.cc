@@ -0,0 +1,286 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/pacing/high_resolution_paced_sender.h"
+
+#if defined(WEBRTC_POSIX)
+#include <time.h>
+#endif
+
+#include <algorithm>
+#include <utility>
+
+#include "rtc_base/experiments/field_trial_parser.h"
+#include "rtc_base/experiments/field_trial_units.h"
+#include "system_wrappers/include/clock.h"
+
+namespace webrtc {
+namespace {
+// Lower bound on the time between two process calls, so that a pacing
+// controller that keeps asking to be processed immediately cannot make the
+// pacer spin.
+constexpr TimeDelta kMinTimeBetweenProcessCalls = TimeDelta::Micros<100>();
+}  // namespace
+
+HighResolutionPacedSender::HighResolutionPacedSender(
+    Clock* clock,
+    PacketRouter* packet_router,
+    RtcEventLog* event_log,
+    const WebRtcKeyValueConfig* field_trials,
+    TaskQueueFactory* task_queue_factory)
+    : clock_(clock),
+      packet_router_(packet_router),
+      pacing_controller_(clock,
+                         static_cast<PacingController::PacketSender*>(this),
+                         event_log,
+                         field_trials,
+                         PacingController::ProcessMode::kDynamic),
+      running_(true),
+      next_process_time_(Timestamp::MinusInfinity()),
+      task_queue_(task_queue_factory->CreateTaskQueue(
+          "HighResolutionPacer",
+          TaskQueueFactory::Priority::HIGH)) {
+  if (field_trials) {
+    FieldTrialParameter<TimeDelta> burst_interval("burst", TimeDelta::Zero());
+    ParseFieldTrial({&burst_interval},
+                    field_trials->Lookup("WebRTC-HighResolutionPacer"));
+    rtc::CritScope cs(&crit_);
+    pacing_controller_.SetSendBurstInterval(burst_interval.Get());
+  }
+}
+
+HighResolutionPacedSender::~HighResolutionPacedSender() {
+  // Tasks still pending when |task_queue_| is destroyed return early.
+  rtc::CritScope cs(&crit_);
+  running_ = false;
+}
+
+void HighResolutionPacedSender::CreateProbeCluster(DataRate bitrate,
+                                                   int cluster_id) {
+  {
+    rtc::CritScope cs(&crit_);
+    pacing_controller_.CreateProbeCluster(bitrate, cluster_id);
+  }
+  WakeUp();
+}
+
+void HighResolutionPacedSender::Pause() {
+  {
+    rtc::CritScope cs(&crit_);
+    pacing_controller_.Pause();
+  }
+  WakeUp();
+}
+
+void HighResolutionPacedSender::Resume() {
+  {
+    rtc::CritScope cs(&crit_);
+    pacing_controller_.Resume();
+  }
+  WakeUp();
+}
+
+void HighResolutionPacedSender::SetCongestionWindow(
+    DataSize congestion_window_size) {
+  {
+    rtc::CritScope cs(&crit_);
+    pacing_controller_.SetCongestionWindow(congestion_window_size);
+  }
+  WakeUp();
+}
+
+void HighResolutionPacedSender::UpdateOutstandingData(
+    DataSize outstanding_data) {
+  {
+    rtc::CritScope cs(&crit_);
+    pacing_controller_.UpdateOutstandingData(outstanding_data);
+  }
+  WakeUp();
+}
+
+void HighResolutionPacedSender::SetPacingRates(DataRate pacing_rate,
+                                               DataRate padding_rate) {
+  {
+    rtc::CritScope cs(&crit_);
+    pacing_controller_.SetPacingRates(pacing_rate, padding_rate);
+  }
+  WakeUp();
+}
+
+void HighResolutionPacedSender::EnqueuePackets(
+    std::vector<std::unique_ptr<RtpPacketToSend>> packets) {
+  {
+    rtc::CritScope cs(&crit_);
+    for (auto& packet : packets) {
+      pacing_controller_.EnqueuePacket(std::move(packet));
+    }
+  }
+  WakeUp();
+}
+
+void HighResolutionPacedSender::SetAccountForAudioPackets(
+    bool account_for_audio) {
+  rtc::CritScope cs(&crit_);
+  pacing_controller_.SetAccountForAudioPackets(account_for_audio);
+}
+
+void HighResolutionPacedSender::SetStreamWeight(uint32_t ssrc,
+                                                double weight) {
+  rtc::CritScope cs(&crit_);
+  pacing_controller_.SetStreamWeight(ssrc, weight);
+}
+
+void HighResolutionPacedSender::SetIncludeOverhead() {
+  rtc::CritScope cs(&crit_);
+  pacing_controller_.SetIncludeOverhead();
+}
+
+void HighResolutionPacedSender::SetTransportOverhead(
+    DataSize overhead_per_packet) {
+  rtc::CritScope cs(&crit_);
+  pacing_controller_.SetTransportOverhead(overhead_per_packet);
+}
+
+void HighResolutionPacedSender::SetQueueTimeLimit(TimeDelta limit) {
+  {
+    rtc::CritScope cs(&crit_);
+    pacing_controller_.SetQueueTimeLimit(limit);
+  }
+  WakeUp();
+}
+
+void HighResolutionPacedSender::SetSendBurstInterval(
+    TimeDelta burst_interval) {
+  {
+    rtc::CritScope cs(&crit_);
+    pacing_controller_.SetSendBurstInterval(burst_interval);
+  }
+  WakeUp();
+}
+
+TimeDelta HighResolutionPacedSender::ExpectedQueueTime() const {
+  rtc::CritScope cs(&crit_);
+  return pacing_controller_.ExpectedQueueTime();
+}
+
+DataSize HighResolutionPacedSender::QueueSizeData() const {
+  rtc::CritScope cs(&crit_);
+  return pacing_controller_.QueueSizeData();
+}
+
+absl::optional<Timestamp> HighResolutionPacedSender::FirstSentPacketTime()
+    const {
+  rtc::CritScope cs(&crit_);
+  return pacing_controller_.FirstSentPacketTime();
+}
+
+TimeDelta HighResolutionPacedSender::OldestPacketWaitTime() const {
+  rtc::CritScope cs(&crit_);
+  return pacing_controller_.OldestPacketWaitTime();
+}
+
+void HighResolutionPacedSender::WakeUp() {
+  task_queue_.PostTask(
+      [this]() { MaybeProcessPackets(Timestamp::MinusInfinity()); });
+}
+
+void HighResolutionPacedSender::MaybeProcessPackets(
+    Timestamp scheduled_process_time) {
+  RTC_DCHECK_RUN_ON(&task_queue_);
+  if (scheduled_process_time.IsFinite()) {
+    if (scheduled_process_time != next_process_time_) {
+      // Superseded by an earlier delayed call.
+      return;
+    }
+    next_process_time_ = Timestamp::MinusInfinity();
+  }
+
+  Timestamp now = Timestamp::MinusInfinity();
+  TimeDelta sleep_time = TimeDelta::Zero();
+  {
+    rtc::CritScope cs(&crit_);
+    if (!running_) {
+      return;
+    }
+    now = clock_->CurrentTime();
+    if (pacing_controller_.NextSendTime() <= now) {
+      pacing_controller_.ProcessPackets();
+      now = clock_->CurrentTime();
+    }
+    sleep_time = std::max(kMinTimeBetweenProcessCalls,
+                          pacing_controller_.NextSendTime() - now);
+  }
+  FlushSendBatch();
+
+  // Task queue timers only have millisecond resolution, so they are used for
+  // long waits, where a call made when the pacer state changes may cut the
+  // wait short. Shorter waits are slept on the task queue.
+  if (sleep_time < TimeDelta::ms(1) && SleepPrecisely(sleep_time)) {
+    WakeUp();
+    return;
+  }
+  const TimeDelta timer_delay = std::max(
+      TimeDelta::ms(1), TimeDelta::ms(sleep_time.us() / 1000));
+  const Timestamp next_process_time = now + timer_delay;
+  if (next_process_time_.IsFinite() &&
+      next_process_time_ <= next_process_time) {
+    // An earlier delayed call is already pending.
+    return;
+  }
+  next_process_time_ = next_process_time;
+  task_queue_.PostDelayedTask(
+      [this, next_process_time]() { MaybeProcessPackets(next_process_time); },
+      timer_delay.ms<uint32_t>());
+}
+
+bool HighResolutionPacedSender::SleepPrecisely(TimeDelta duration) {
+#if defined(WEBRTC_POSIX)
+  const Timestamp start_time = clock_->CurrentTime();
+  timespec sleep_duration;
+  sleep_duration.tv_sec = 0;
+  sleep_duration.tv_nsec = static_cast<long>(duration.us() * 1000);  // NOLINT
+#if defined(WEBRTC_LINUX) || defined(WEBRTC_ANDROID)
+  clock_nanosleep(CLOCK_MONOTONIC, 0, &sleep_duration, nullptr);
+#else
+  nanosleep(&sleep_duration, nullptr);
+#endif
+  return clock_->CurrentTime() > start_time;
+#else
+  return false;
+#endif
+}
+
+void HighResolutionPacedSender::FlushSendBatch() {
+  for (auto& packet_and_info : send_batch_) {
+    packet_router_->SendPacket(std::move(packet_and_info.first),
+                               packet_and_info.second);
+  }
+  send_batch_.clear();
+}
+
+void HighResolutionPacedSender::SendRtpPacket(
+    std::unique_ptr<RtpPacketToSend> packet,
+    const PacedPacketInfo& cluster_info) {
+  send_batch_.emplace_back(std::move(packet), cluster_info);
+}
+
+std::vector<std::unique_ptr<RtpPacketToSend>>
+HighResolutionPacedSender::GeneratePadding(DataSize size) {
+  // Send the pending batch first, so that padding generated from the packet
+  // history can use the packets released earlier in this process call.
+  std::vector<std::unique_ptr<RtpPacketToSend>> padding_packets;
+  crit_.Leave();
+  FlushSendBatch();
+  padding_packets = packet_router_->GeneratePadding(size.bytes());
+  crit_.Enter();
+  return padding_packets;
+}
+
+}  // namespace webrtc
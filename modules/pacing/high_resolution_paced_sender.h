@@ -0,0 +1,166 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_PACING_HIGH_RESOLUTION_PACED_SENDER_H_
+#define MODULES_PACING_HIGH_RESOLUTION_PACED_SENDER_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "api/task_queue/task_queue_factory.h"
+#include "api/transport/webrtc_key_value_config.h"
+#include "api/units/data_size.h"
+#include "api/units/time_delta.h"
+#include "api/units/timestamp.h"
+#include "modules/pacing/pacing_controller.h"
+#include "modules/pacing/packet_router.h"
+#include "modules/pacing/rtp_packet_pacer.h"
+#include "modules/rtp_rtcp/include/rtp_packet_sender.h"
+#include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
+#include "rtc_base/critical_section.h"
+#include "rtc_base/synchronization/sequence_checker.h"
+#include "rtc_base/task_queue.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace webrtc {
+class Clock;
+class RtcEventLog;
+
+// Pacer running on its own high priority task queue, intended for high
+// bitrates where the 5ms granularity of PacedSender, or the millisecond
+// timers of TaskQueuePacedSender, cause packets to be released in clumps.
+//
+// The pacer wakes up at the exact time the PacingController asks for,
+// sleeping with microsecond resolution on the task queue when the next send
+// time is less than a millisecond away. Packets released by one process call
+// are handed to the PacketRouter as a batch, after the pacer lock has been
+// released, so that slow transport sends do not block callers enqueueing new
+// packets.
+//
+// An optional send burst interval lets the pacer release media packets
+// ahead of their paced send time, see
+// PacingController::SetSendBurstInterval(). It can be set from the
+// "WebRTC-HighResolutionPacer" field trial using e.g. "burst:2ms".
+class HighResolutionPacedSender : public RtpPacketPacer,
+                                  public RtpPacketSender,
+                                  private PacingController::PacketSender {
+ public:
+  HighResolutionPacedSender(Clock* clock,
+                            PacketRouter* packet_router,
+                            RtcEventLog* event_log,
+                            const WebRtcKeyValueConfig* field_trials,
+                            TaskQueueFactory* task_queue_factory);
+
+  ~HighResolutionPacedSender() override;
+
+  // Methods implementing RtpPacketSender.
+
+  // Adds the packet to the queue and calls PacketRouter::SendPacket() when
+  // it's time to send.
+  void EnqueuePackets(
+      std::vector<std::unique_ptr<RtpPacketToSend>> packets) override;
+
+  // Methods implementing RtpPacketPacer:
+
+  void CreateProbeCluster(DataRate bitrate, int cluster_id) override;
+
+  // Temporarily pause all sending.
+  void Pause() override;
+
+  // Resume sending packets.
+  void Resume() override;
+
+  void SetCongestionWindow(DataSize congestion_window_size) override;
+  void UpdateOutstandingData(DataSize outstanding_data) override;
+
+  // Sets the pacing rates. Must be called once before packets can be sent.
+  void SetPacingRates(DataRate pacing_rate, DataRate padding_rate) override;
+
+  void SetAccountForAudioPackets(bool account_for_audio) override;
+
+  void SetIncludeOverhead() override;
+  void SetTransportOverhead(DataSize overhead_per_packet) override;
+  void SetStreamWeight(uint32_t ssrc, double weight) override;
+
+  // Returns the time since the oldest queued packet was enqueued.
+  TimeDelta OldestPacketWaitTime() const override;
+
+  // Returns total size of all packets in the pacer queue.
+  DataSize QueueSizeData() const override;
+
+  // Returns the time when the first packet was sent;
+  absl::optional<Timestamp> FirstSentPacketTime() const override;
+
+  // Returns the number of milliseconds it will take to send the current
+  // packets in the queue, given the current size and bitrate, ignoring prio.
+  TimeDelta ExpectedQueueTime() const override;
+
+  // Set the max desired queuing delay, pacer will override the pacing rate
+  // specified by SetPacingRates() if needed to achieve this goal.
+  void SetQueueTimeLimit(TimeDelta limit) override;
+
+  // Allows media packets to be released up to |burst_interval| ahead of
+  // their paced send time.
+  void SetSendBurstInterval(TimeDelta burst_interval);
+
+ private:
+  // Processes the pacing controller if it is time to send, and schedules the
+  // next call. |scheduled_process_time| is the time a delayed call was
+  // scheduled for, or Timestamp::MinusInfinity() for calls made because the
+  // pacer state changed. Delayed calls superseded by an earlier one return
+  // early.
+  void MaybeProcessPackets(Timestamp scheduled_process_time)
+      RTC_RUN_ON(task_queue_);
+
+  // Posts an immediate MaybeProcessPackets() call.
+  void WakeUp();
+
+  // Sleeps for |duration|, less than a millisecond, with microsecond
+  // resolution where the platform supports it. Returns false if |clock_| did
+  // not advance during the sleep, as is the case for simulated clocks.
+  bool SleepPrecisely(TimeDelta duration) RTC_RUN_ON(task_queue_);
+
+  // Hands all packets released by the last process call to the router.
+  void FlushSendBatch() RTC_RUN_ON(task_queue_);
+
+  // Methods implementing PacingController::PacketSender.
+
+  void SendRtpPacket(std::unique_ptr<RtpPacketToSend> packet,
+                     const PacedPacketInfo& cluster_info) override
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_) RTC_RUN_ON(task_queue_);
+
+  std::vector<std::unique_ptr<RtpPacketToSend>> GeneratePadding(
+      DataSize size) override RTC_EXCLUSIVE_LOCKS_REQUIRED(crit_)
+      RTC_RUN_ON(task_queue_);
+
+  Clock* const clock_;
+  PacketRouter* const packet_router_;
+
+  rtc::CriticalSection crit_;
+  PacingController pacing_controller_ RTC_GUARDED_BY(crit_);
+  bool running_ RTC_GUARDED_BY(crit_);
+
+  // Time of the pending delayed MaybeProcessPackets() call, or
+  // Timestamp::MinusInfinity() if there is none.
+  Timestamp next_process_time_ RTC_GUARDED_BY(task_queue_);
+
+  // Packets released by the pacing controller but not yet sent.
+  std::vector<std::pair<std::unique_ptr<RtpPacketToSend>, PacedPacketInfo>>
+      send_batch_ RTC_GUARDED_BY(task_queue_);
+
+  rtc::TaskQueue task_queue_;
+};
+}  // namespace webrtc
+#endif  // MODULES_PACING_HIGH_RESOLUTION_PACED_SENDER_H_
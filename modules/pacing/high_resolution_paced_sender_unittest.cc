@@ -0,0 +1,167 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/pacing/high_resolution_paced_sender.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "modules/pacing/packet_router.h"
+#include "test/gmock.h"
+#include "test/gtest.h"
+#include "test/time_controller/simulated_time_controller.h"
+
+namespace webrtc {
+namespace {
+constexpr uint32_t kVideoSsrc = 234565;
+constexpr size_t kDefaultPacketSize = 1234;
+
+class MockPacketRouter : public PacketRouter {
+ public:
+  MOCK_METHOD2(SendPacket,
+               void(std::unique_ptr<RtpPacketToSend> packet,
+                    const PacedPacketInfo& cluster_info));
+  MOCK_METHOD1(
+      GeneratePadding,
+      std::vector<std::unique_ptr<RtpPacketToSend>>(size_t target_size_bytes));
+};
+}  // namespace
+
+namespace test {
+
+class HighResolutionPacedSenderTest : public ::testing::Test {
+ public:
+  HighResolutionPacedSenderTest()
+      : time_controller_(Timestamp::ms(1234)),
+        pacer_(time_controller_.GetClock(),
+               &packet_router_,
+               /*event_log=*/nullptr,
+               /*field_trials=*/nullptr,
+               time_controller_.GetTaskQueueFactory()) {}
+
+ protected:
+  std::vector<std::unique_ptr<RtpPacketToSend>> GeneratePackets(
+      size_t num_packets) {
+    std::vector<std::unique_ptr<RtpPacketToSend>> packets;
+    for (size_t i = 0; i < num_packets; ++i) {
+      auto packet = std::make_unique<RtpPacketToSend>(nullptr);
+      packet->set_packet_type(RtpPacketToSend::Type::kVideo);
+      packet->SetSsrc(kVideoSsrc);
+      packet->SetPayloadSize(kDefaultPacketSize);
+      packets.push_back(std::move(packet));
+    }
+    return packets;
+  }
+
+  // Records the simulated time at which each packet is sent.
+  void ExpectPacketsSent(size_t num_packets) {
+    EXPECT_CALL(packet_router_, SendPacket)
+        .Times(num_packets)
+        .WillRepeatedly([this](std::unique_ptr<RtpPacketToSend> packet,
+                               const PacedPacketInfo& cluster_info) {
+          send_times_.push_back(CurrentTime());
+        });
+  }
+
+  Timestamp CurrentTime() { return time_controller_.GetClock()->CurrentTime(); }
+
+  GlobalSimulatedTimeController time_controller_;
+  ::testing::NiceMock<MockPacketRouter> packet_router_;
+  HighResolutionPacedSender pacer_;
+  std::vector<Timestamp> send_times_;
+};
+
+TEST_F(HighResolutionPacedSenderTest, PacesPackets) {
+  // Ten packets, paced out 20ms apart.
+  const size_t kPacketsToSend = 10;
+  pacer_.SetPacingRates(DataRate::bps(kDefaultPacketSize * 8 * 50),
+                        DataRate::Zero());
+  ExpectPacketsSent(kPacketsToSend);
+  const Timestamp start_time = CurrentTime();
+  pacer_.EnqueuePackets(GeneratePackets(kPacketsToSend));
+  time_controller_.AdvanceTime(TimeDelta::seconds(1));
+
+  // The first packet goes out immediately, the rest are paced.
+  ASSERT_EQ(send_times_.size(), kPacketsToSend);
+  EXPECT_EQ(send_times_.front(), start_time);
+  for (size_t i = 1; i < send_times_.size(); ++i) {
+    EXPECT_NEAR((send_times_[i] - send_times_[i - 1]).ms(), 20, 1);
+  }
+  EXPECT_EQ(pacer_.QueueSizeData(), DataSize::Zero());
+}
+
+TEST_F(HighResolutionPacedSenderTest,
+       FallsBackToMillisecondTimersOnSimulatedClock) {
+  // At 50 Mbps, each packet takes ~0.2ms to send. Sleeping does not advance a
+  // simulated clock, so the pacer wakes up on 1ms timers instead and sends the
+  // packets that are due by then. Pacing 500 packets should still take close
+  // to 100ms.
+  const size_t kPacketsToSend = 500;
+  const DataRate kPacingRate = DataRate::kbps(50000);
+  pacer_.SetPacingRates(kPacingRate, DataRate::Zero());
+  ExpectPacketsSent(kPacketsToSend);
+  const Timestamp start_time = CurrentTime();
+  pacer_.EnqueuePackets(GeneratePackets(kPacketsToSend));
+
+  // Half way through, about half of the packets have been sent.
+  time_controller_.AdvanceTime(TimeDelta::ms(50));
+  EXPECT_NEAR(send_times_.size(), kPacketsToSend / 2, kPacketsToSend / 10);
+
+  time_controller_.AdvanceTime(TimeDelta::ms(150));
+  ASSERT_EQ(send_times_.size(), kPacketsToSend);
+  const TimeDelta expected_duration =
+      DataSize::bytes(kDefaultPacketSize * (kPacketsToSend - 1)) / kPacingRate;
+  EXPECT_NEAR((send_times_.back() - start_time).ms(), expected_duration.ms(),
+              expected_duration.ms() / 10);
+
+  // Packets go out in batches, one millisecond apart.
+  for (size_t i = 1; i < send_times_.size(); ++i) {
+    const TimeDelta spacing = send_times_[i] - send_times_[i - 1];
+    EXPECT_TRUE(spacing.IsZero() || spacing == TimeDelta::ms(1))
+        << "Packet " << i << " sent " << spacing.us() << "us after the last";
+  }
+}
+
+TEST_F(HighResolutionPacedSenderTest, BurstIntervalReleasesPacketsEarly) {
+  // Without a burst interval, these packets would take 450ms to pace out.
+  const size_t kPacketsToSend = 10;
+  pacer_.SetPacingRates(DataRate::bps(kDefaultPacketSize * 8 * 20),
+                        DataRate::Zero());
+  pacer_.SetSendBurstInterval(TimeDelta::seconds(1));
+  ExpectPacketsSent(kPacketsToSend);
+  const Timestamp start_time = CurrentTime();
+  pacer_.EnqueuePackets(GeneratePackets(kPacketsToSend));
+  time_controller_.AdvanceTime(TimeDelta::ms(1));
+
+  ASSERT_EQ(send_times_.size(), kPacketsToSend);
+  EXPECT_EQ(send_times_.back(), start_time);
+}
+
+TEST_F(HighResolutionPacedSenderTest, HandlesPauseAndResume) {
+  pacer_.SetPacingRates(DataRate::kbps(10000), DataRate::Zero());
+  pacer_.Pause();
+
+  EXPECT_CALL(packet_router_, SendPacket).Times(0);
+  pacer_.EnqueuePackets(GeneratePackets(5));
+  time_controller_.AdvanceTime(TimeDelta::ms(100));
+  ::testing::Mock::VerifyAndClearExpectations(&packet_router_);
+  EXPECT_GT(pacer_.QueueSizeData(), DataSize::Zero());
+
+  ExpectPacketsSent(5);
+  const Timestamp resume_time = CurrentTime();
+  pacer_.Resume();
+  time_controller_.AdvanceTime(TimeDelta::ms(100));
+  ASSERT_EQ(send_times_.size(), 5u);
+  EXPECT_EQ(send_times_.front(), resume_time);
+}
+
+}  // namespace test
+}  // namespace webrtc
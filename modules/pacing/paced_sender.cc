@@ -126,6 +126,11 @@ void PacedSender::SetAccountForAudioPackets(bool account_for_audio) {
   pacing_controller_.SetAccountForAudioPackets(account_for_audio);
 }
 
+void PacedSender::SetStreamWeight(uint32_t ssrc, double weight) {
+  rtc::CritScope cs(&critsect_);
+  pacing_controller_.SetStreamWeight(ssrc, weight);
+}
+
 void PacedSender::SetIncludeOverhead() {
   rtc::CritScope cs(&critsect_);
   pacing_controller_.SetIncludeOverhead();
@@ -99,6 +99,7 @@ class PacedSender : public Module,
 
   void SetIncludeOverhead() override;
   void SetTransportOverhead(DataSize overhead_per_packet) override;
+  void SetStreamWeight(uint32_t ssrc, double weight) override;
 
   // Returns the time since the oldest queued packet was enqueued.
   TimeDelta OldestPacketWaitTime() const override;
@@ -102,6 +102,7 @@ PacingController::PacingController(Clock* clock,
       ignore_transport_overhead_(
           IsEnabled(*field_trials_, "WebRTC-Pacer-IgnoreTransportOverhead")),
       min_packet_limit_(kDefaultMinPacketLimit),
+      send_burst_interval_(TimeDelta::Zero()),
       transport_overhead_per_packet_(DataSize::Zero()),
       last_timestamp_(clock_->CurrentTime()),
       paused_(false),
@@ -359,8 +360,13 @@ Timestamp PacingController::NextSendTime() const {
   // be late in starting padding.
   if (media_rate_ > DataRate::Zero() &&
       (!packet_queue_.Empty() || !media_debt_.IsZero())) {
+    // Packets may be released while the remaining debt fits within the
+    // burst interval, so wake up as soon as that is the case.
+    DataSize burst_debt = media_rate_ * send_burst_interval_;
+    DataSize debt_to_drain =
+        media_debt_ - std::min(media_debt_, burst_debt);
     return std::min(last_send_time_ + kPausedProcessInterval,
-                    last_process_time_ + media_debt_ / media_rate_);
+                    last_process_time_ + debt_to_drain / media_rate_);
   }
 
   // If we _don't_ have pending packets, check how long until we have
@@ -632,8 +638,9 @@ std::unique_ptr<RtpPacketToSend> PacingController::GetPendingPacket(
         // We allow sending slightly early if we think that we would actually
         // had been able to, had we been right on time - i.e. the current debt
         // is not more than would be reduced to zero at the target sent time.
+        // A configured burst interval extends that allowance further.
         TimeDelta flush_time = media_debt_ / media_rate_;
-        if (now + flush_time > target_send_time) {
+        if (now + flush_time > target_send_time + send_burst_interval_) {
           return nullptr;
         }
       }
@@ -694,4 +701,13 @@ void PacingController::SetQueueTimeLimit(TimeDelta limit) {
   queue_time_limit = limit;
 }
 
+void PacingController::SetStreamWeight(uint32_t ssrc, double weight) {
+  packet_queue_.SetStreamWeight(ssrc, weight);
+}
+
+void PacingController::SetSendBurstInterval(TimeDelta burst_interval) {
+  RTC_DCHECK_GE(burst_interval, TimeDelta::Zero());
+  send_burst_interval_ = burst_interval;
+}
+
 }  // namespace webrtc
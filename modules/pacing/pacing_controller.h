@@ -131,6 +131,16 @@ class PacingController {
 
   void SetQueueTimeLimit(TimeDelta limit);
 
+  // Sets the share of the send rate given to the stream with the given SSRC,
+  // relative to other streams of the same priority. Defaults to 1.0.
+  void SetStreamWeight(uint32_t ssrc, double weight);
+
+  // In dynamic mode, allows media packets to be released up to
+  // |burst_interval| ahead of their paced send time, so that a process call
+  // can hand several packets to the transport at once. Zero (the default)
+  // means every packet is released at its exact paced send time.
+  void SetSendBurstInterval(TimeDelta burst_interval);
+
   // Enable bitrate probing. Enabled by default, mostly here to simplify
   // testing. Must be called before any packets are being sent to have an
   // effect.
@@ -182,6 +192,7 @@ class PacingController {
   const bool ignore_transport_overhead_;
 
   TimeDelta min_packet_limit_;
+  TimeDelta send_burst_interval_;
 
   DataSize transport_overhead_per_packet_;
 
@@ -1737,6 +1737,35 @@ TEST_P(PacingControllerTest, TaskLate) {
   pacer_->ProcessPackets();
 }
 
+TEST_P(PacingControllerTest, SendBurstIntervalReleasesPacketsEarly) {
+  if (PeriodicProcess()) {
+    // This test applies only when NOT using interval budget.
+    return;
+  }
+
+  // At 30kbps, each 234 byte packet takes ~62ms to drain.
+  DataRate kSendRate = DataRate::kbps(30);
+  pacer_->SetPacingRates(kSendRate, DataRate::Zero());
+  pacer_->SetSendBurstInterval(TimeDelta::ms(100));
+
+  for (int i = 0; i < 4; ++i) {
+    pacer_->EnqueuePacket(BuildRtpPacket(RtpPacketToSend::Type::kVideo));
+  }
+
+  // The second packet fits within the burst interval, the third does not.
+  EXPECT_CALL(callback_, SendPacket).Times(2);
+  pacer_->ProcessPackets();
+
+  // The next process call is due once the debt is back within the burst
+  // interval, which is sooner than the time it takes to drain one packet.
+  const TimeDelta time_between_packets = DataSize::bytes(234) / kSendRate;
+  EXPECT_LT(pacer_->NextSendTime() - clock_.CurrentTime(),
+            time_between_packets);
+
+  EXPECT_CALL(callback_, SendPacket).Times(1);
+  AdvanceTimeAndProcess();
+}
+
 TEST_P(PacingControllerTest, NoProbingWhilePaused) {
   uint32_t ssrc = 12345;
   uint16_t sequence_number = 1234;
@@ -63,6 +63,18 @@ void PacketRouter::AddSendRtpModule(RtpRtcp* rtp_module, bool remb_candidate) {
     AddSendRtpModuleToMap(rtp_module, *flexfec_ssrc);
   }
 
+  // Always keep the audio modules at the back of the list, so that when we
+  // iterate over the modules in order to find one that can send padding we
+  // will prioritize video. This is important to make sure they are counted
+  // into the bandwidth estimate properly.
+  RTC_DCHECK(std::find(send_modules_list_.begin(), send_modules_list_.end(),
+                       rtp_module) == send_modules_list_.end());
+  if (rtp_module->IsAudioConfigured()) {
+    send_modules_list_.push_back(rtp_module);
+  } else {
+    send_modules_list_.insert(send_modules_list_.begin(), rtp_module);
+  }
+
   if (rtp_module->SupportsRtxPayloadPadding()) {
     last_send_module_ = rtp_module;
   }
@@ -73,24 +85,13 @@ void PacketRouter::AddSendRtpModule(RtpRtcp* rtp_module, bool remb_candidate) {
 }
 
 void PacketRouter::AddSendRtpModuleToMap(RtpRtcp* rtp_module, uint32_t ssrc) {
-  RTC_DCHECK(send_modules_map_.find(ssrc) == send_modules_map_.end());
-  // Always keep the audio modules at the back of the list, so that when we
-  // iterate over the modules in order to find one that can send padding we
-  // will prioritize video. This is important to make sure they are counted
-  // into the bandwidth estimate properly.
-  if (rtp_module->IsAudioConfigured()) {
-    send_modules_list_.push_back(rtp_module);
-  } else {
-    send_modules_list_.push_front(rtp_module);
-  }
-  send_modules_map_[ssrc] = rtp_module;
+  RTC_DCHECK(send_modules_map_.Find(ssrc) == nullptr);
+  send_modules_map_.GetOrInsert(ssrc) = rtp_module;
 }
 
 void PacketRouter::RemoveSendRtpModuleFromMap(uint32_t ssrc) {
-  auto kv = send_modules_map_.find(ssrc);
-  RTC_DCHECK(kv != send_modules_map_.end());
-  send_modules_list_.remove(kv->second);
-  send_modules_map_.erase(kv);
+  bool removed = send_modules_map_.Erase(ssrc);
+  RTC_DCHECK(removed);
 }
 
 void PacketRouter::RemoveSendRtpModule(RtpRtcp* rtp_module) {
@@ -105,6 +106,11 @@ void PacketRouter::RemoveSendRtpModule(RtpRtcp* rtp_module) {
     RemoveSendRtpModuleFromMap(*flexfec_ssrc);
   }
 
+  auto it = std::find(send_modules_list_.begin(), send_modules_list_.end(),
+                      rtp_module);
+  RTC_DCHECK(it != send_modules_list_.end());
+  send_modules_list_.erase(it);
+
   if (last_send_module_ == rtp_module) {
     last_send_module_ = nullptr;
   }
@@ -144,8 +150,8 @@ void PacketRouter::SendPacket(std::unique_ptr<RtpPacketToSend> packet,
   }
 
   uint32_t ssrc = packet->Ssrc();
-  auto kv = send_modules_map_.find(ssrc);
-  if (kv == send_modules_map_.end()) {
+  RtpRtcp** rtp_module_entry = send_modules_map_.Find(ssrc);
+  if (rtp_module_entry == nullptr) {
     RTC_LOG(LS_WARNING)
         << "Failed to send packet, matching RTP module not found "
            "or transport error. SSRC = "
@@ -153,7 +159,7 @@ void PacketRouter::SendPacket(std::unique_ptr<RtpPacketToSend> packet,
     return;
   }
 
-  RtpRtcp* rtp_module = kv->second;
+  RtpRtcp* rtp_module = *rtp_module_entry;
   if (!rtp_module->TrySendPacket(packet.get(), cluster_info)) {
     RTC_LOG(LS_WARNING) << "Failed to send packet, rejected by RTP module.";
     return;
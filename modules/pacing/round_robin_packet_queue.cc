@@ -18,9 +18,16 @@
 
 namespace webrtc {
 namespace {
-static constexpr DataSize kMaxLeadingSize = DataSize::Bytes<1400>();
+// Bytes a stream with weight 1.0 may send each time it has its turn in the
+// round robin. Roughly one full size packet.
+static constexpr DataSize kDefaultQuantum = DataSize::Bytes<1400>();
+// Lower weights are clamped to this, so that a stream always gets a full size
+// packet through within a bounded number of rounds.
+static constexpr double kMinStreamWeight = 1.0 / 16;
 }
 
+constexpr size_t RoundRobinPacketQueue::kNoStream;
+
 RoundRobinPacketQueue::QueuedPacket::QueuedPacket(const QueuedPacket& rhs) =
     default;
 RoundRobinPacketQueue::QueuedPacket::~QueuedPacket() = default;
@@ -97,8 +104,17 @@ RoundRobinPacketQueue::PriorityPacketQueue::end() const {
   return c.end();
 }
 
-RoundRobinPacketQueue::Stream::Stream() : size(DataSize::Zero()), ssrc(0) {}
+RoundRobinPacketQueue::Stream::Stream(uint32_t ssrc)
+    : ssrc(ssrc),
+      quantum(kDefaultQuantum),
+      deficit(DataSize::Zero()),
+      scheduled(false),
+      priority(0),
+      prev(kNoStream),
+      next(kNoStream) {}
 RoundRobinPacketQueue::Stream::Stream(const Stream& stream) = default;
+RoundRobinPacketQueue::Stream& RoundRobinPacketQueue::Stream::operator=(
+    const Stream& stream) = default;
 RoundRobinPacketQueue::Stream::~Stream() = default;
 
 bool IsEnabled(const WebRtcKeyValueConfig* field_trials, const char* name) {
@@ -116,7 +132,6 @@ RoundRobinPacketQueue::RoundRobinPacketQueue(
       paused_(false),
       size_packets_(0),
       size_(DataSize::Zero()),
-      max_size_(kMaxLeadingSize),
       queue_time_sum_(TimeDelta::Zero()),
       pause_time_sum_(TimeDelta::Zero()),
       include_overhead_(false) {}
@@ -139,11 +154,9 @@ void RoundRobinPacketQueue::Push(int priority,
 
 std::unique_ptr<RtpPacketToSend> RoundRobinPacketQueue::Pop() {
   RTC_DCHECK(!Empty());
-  Stream* stream = GetHighestPriorityStream();
+  Stream* stream = GetNextStream();
   const QueuedPacket& queued_packet = stream->packet_queue.top();
 
-  stream_priorities_.erase(stream->priority_it);
-
   // Calculate the total amount of time spent by this packet in the queue
   // while in a non-paused state. Note that the |pause_time_sum_ms_| was
   // subtracted from |packet.enqueue_time_ms| when the packet was pushed, and
@@ -156,22 +169,8 @@ std::unique_ptr<RtpPacketToSend> RoundRobinPacketQueue::Pop() {
   RTC_CHECK(queued_packet.EnqueueTimeIterator() != enqueue_times_.end());
   enqueue_times_.erase(queued_packet.EnqueueTimeIterator());
 
-  // Update |bytes| of this stream. The general idea is that the stream that
-  // has sent the least amount of bytes should have the highest priority.
-  // The problem with that is if streams send with different rates, in which
-  // case a "budget" will be built up for the stream sending at the lower
-  // rate. To avoid building a too large budget we limit |bytes| to be within
-  // kMaxLeading bytes of the stream that has sent the most amount of bytes.
-  DataSize packet_size =
-      DataSize::bytes(queued_packet.RtpPacket()->payload_size() +
-                      queued_packet.RtpPacket()->padding_size());
-  if (include_overhead_) {
-    packet_size += DataSize::bytes(queued_packet.RtpPacket()->headers_size()) +
-                   transport_overhead_per_packet_;
-  }
-  stream->size =
-      std::max(stream->size + packet_size, max_size_ - kMaxLeadingSize);
-  max_size_ = std::max(max_size_, stream->size);
+  DataSize packet_size = PacketSize(queued_packet);
+  stream->deficit -= std::min(stream->deficit, packet_size);
 
   size_ -= packet_size;
   size_packets_ -= 1;
@@ -180,23 +179,25 @@ std::unique_ptr<RtpPacketToSend> RoundRobinPacketQueue::Pop() {
   std::unique_ptr<RtpPacketToSend> rtp_packet(queued_packet.RtpPacket());
   stream->packet_queue.pop();
 
-  // If there are packets left to be sent, schedule the stream again.
-  RTC_CHECK(!IsSsrcScheduled(stream->ssrc));
+  // A stream that runs out of packets forfeits its remaining deficit, so that
+  // it can't build up a budget while idle. If packets remain, the stream
+  // keeps its turn unless the next packet has a different priority.
+  size_t stream_index = stream - streams_.data();
   if (stream->packet_queue.empty()) {
-    stream->priority_it = stream_priorities_.end();
-  } else {
-    int priority = stream->packet_queue.top().Priority();
-    stream->priority_it = stream_priorities_.emplace(
-        StreamPrioKey(priority, stream->size), stream->ssrc);
+    stream->deficit = DataSize::Zero();
+    Unschedule(stream_index);
+  } else if (stream->packet_queue.top().Priority() != stream->priority) {
+    Unschedule(stream_index);
+    Schedule(stream_index, stream->packet_queue.top().Priority());
   }
 
   return rtp_packet;
 }
 
 bool RoundRobinPacketQueue::Empty() const {
-  RTC_CHECK((!stream_priorities_.empty() && size_packets_ > 0) ||
-            (stream_priorities_.empty() && size_packets_ == 0));
-  return stream_priorities_.empty();
+  RTC_DCHECK((GetHighestPriorityLevel() != nullptr && size_packets_ > 0) ||
+             (GetHighestPriorityLevel() == nullptr && size_packets_ == 0));
+  return size_packets_ == 0;
 }
 
 size_t RoundRobinPacketQueue::SizeInPackets() const {
@@ -208,13 +209,11 @@ DataSize RoundRobinPacketQueue::Size() const {
 }
 
 bool RoundRobinPacketQueue::NextPacketIsAudio() const {
-  if (stream_priorities_.empty()) {
+  const PriorityLevel* level = GetHighestPriorityLevel();
+  if (level == nullptr) {
     return false;
   }
-  uint32_t ssrc = stream_priorities_.begin()->second;
-
-  auto stream_info_it = streams_.find(ssrc);
-  return stream_info_it->second.packet_queue.top().Type() ==
+  return streams_[level->head].packet_queue.top().Type() ==
          RtpPacketToSend::Type::kAudio;
 }
 
@@ -251,8 +250,8 @@ void RoundRobinPacketQueue::SetPauseState(bool paused, Timestamp now) {
 void RoundRobinPacketQueue::SetIncludeOverhead() {
   include_overhead_ = true;
   // We need to update the size to reflect overhead for existing packets.
-  for (const auto& stream : streams_) {
-    for (const QueuedPacket& packet : stream.second.packet_queue) {
+  for (const Stream& stream : streams_) {
+    for (const QueuedPacket& packet : stream.packet_queue) {
       size_ += DataSize::bytes(packet.RtpPacket()->headers_size()) +
                transport_overhead_per_packet_;
     }
@@ -263,8 +262,8 @@ void RoundRobinPacketQueue::SetTransportOverhead(DataSize overhead_per_packet) {
   if (include_overhead_) {
     DataSize previous_overhead = transport_overhead_per_packet_;
     // We need to update the size to reflect overhead for existing packets.
-    for (const auto& stream : streams_) {
-      int packets = stream.second.packet_queue.size();
+    for (const Stream& stream : streams_) {
+      int packets = stream.packet_queue.size();
       size_ -= packets * previous_overhead;
       size_ += packets * overhead_per_packet;
     }
@@ -272,6 +271,12 @@ void RoundRobinPacketQueue::SetTransportOverhead(DataSize overhead_per_packet) {
   transport_overhead_per_packet_ = overhead_per_packet;
 }
 
+void RoundRobinPacketQueue::SetStreamWeight(uint32_t ssrc, double weight) {
+  RTC_DCHECK_GT(weight, 0.0);
+  Stream& stream = streams_[GetOrCreateStream(ssrc)];
+  stream.quantum = kDefaultQuantum * std::max(weight, kMinStreamWeight);
+}
+
 TimeDelta RoundRobinPacketQueue::AverageQueueTime() const {
   if (Empty())
     return TimeDelta::Zero();
@@ -279,30 +284,19 @@ TimeDelta RoundRobinPacketQueue::AverageQueueTime() const {
 }
 
 void RoundRobinPacketQueue::Push(QueuedPacket packet) {
-  auto stream_info_it = streams_.find(packet.Ssrc());
-  if (stream_info_it == streams_.end()) {
-    stream_info_it = streams_.emplace(packet.Ssrc(), Stream()).first;
-    stream_info_it->second.priority_it = stream_priorities_.end();
-    stream_info_it->second.ssrc = packet.Ssrc();
+  size_t stream_index = GetOrCreateStream(packet.Ssrc());
+  Stream* stream = &streams_[stream_index];
+
+  if (!stream->scheduled) {
+    Schedule(stream_index, packet.Priority());
+  } else if (packet.Priority() < stream->priority) {
+    // If the priority of this SSRC increased, move it to the round robin of
+    // the new priority level. Note that |priority_| uses lower ordinal for
+    // higher priority.
+    Unschedule(stream_index);
+    Schedule(stream_index, packet.Priority());
   }
 
-  Stream* stream = &stream_info_it->second;
-
-  if (stream->priority_it == stream_priorities_.end()) {
-    // If the SSRC is not currently scheduled, add it to |stream_priorities_|.
-    RTC_CHECK(!IsSsrcScheduled(stream->ssrc));
-    stream->priority_it = stream_priorities_.emplace(
-        StreamPrioKey(packet.Priority(), stream->size), packet.Ssrc());
-  } else if (packet.Priority() < stream->priority_it->first.priority) {
-    // If the priority of this SSRC increased, remove the outdated StreamPrioKey
-    // and insert a new one with the new priority. Note that |priority_| uses
-    // lower ordinal for higher priority.
-    stream_priorities_.erase(stream->priority_it);
-    stream->priority_it = stream_priorities_.emplace(
-        StreamPrioKey(packet.Priority(), stream->size), packet.Ssrc());
-  }
-  RTC_CHECK(stream->priority_it != stream_priorities_.end());
-
   // In order to figure out how much time a packet has spent in the queue while
   // not in a paused state, we subtract the total amount of time the queue has
   // been paused so far, and when the packet is popped we subtract the total
@@ -313,34 +307,121 @@ void RoundRobinPacketQueue::Push(QueuedPacket packet) {
   packet.SubtractPauseTime(pause_time_sum_);
 
   size_packets_ += 1;
-  size_ += DataSize::bytes(packet.RtpPacket()->payload_size() +
-                           packet.RtpPacket()->padding_size());
+  size_ += PacketSize(packet);
+
+  stream->packet_queue.push(packet);
+}
+
+DataSize RoundRobinPacketQueue::PacketSize(const QueuedPacket& packet) const {
+  DataSize packet_size = DataSize::bytes(packet.RtpPacket()->payload_size() +
+                                         packet.RtpPacket()->padding_size());
   if (include_overhead_) {
-    size_ += DataSize::bytes(packet.RtpPacket()->headers_size()) +
-             transport_overhead_per_packet_;
+    packet_size += DataSize::bytes(packet.RtpPacket()->headers_size()) +
+                   transport_overhead_per_packet_;
   }
+  return packet_size;
+}
 
-  stream->packet_queue.push(packet);
+size_t RoundRobinPacketQueue::GetOrCreateStream(uint32_t ssrc) {
+  auto it = std::lower_bound(
+      stream_indices_.begin(), stream_indices_.end(), ssrc,
+      [](const std::pair<uint32_t, size_t>& entry, uint32_t ssrc) {
+        return entry.first < ssrc;
+      });
+  if (it != stream_indices_.end() && it->first == ssrc) {
+    return it->second;
+  }
+  streams_.emplace_back(ssrc);
+  stream_indices_.emplace(it, ssrc, streams_.size() - 1);
+  return streams_.size() - 1;
 }
 
-RoundRobinPacketQueue::Stream*
-RoundRobinPacketQueue::GetHighestPriorityStream() {
-  RTC_CHECK(!stream_priorities_.empty());
-  uint32_t ssrc = stream_priorities_.begin()->second;
+RoundRobinPacketQueue::PriorityLevel*
+RoundRobinPacketQueue::GetOrCreatePriorityLevel(int priority) {
+  auto it = priority_levels_.begin();
+  while (it != priority_levels_.end() && it->priority < priority) {
+    ++it;
+  }
+  if (it == priority_levels_.end() || it->priority != priority) {
+    it = priority_levels_.insert(it, PriorityLevel{priority, kNoStream});
+  }
+  return &*it;
+}
+
+RoundRobinPacketQueue::PriorityLevel*
+RoundRobinPacketQueue::GetHighestPriorityLevel() {
+  for (PriorityLevel& level : priority_levels_) {
+    if (level.head != kNoStream) {
+      return &level;
+    }
+  }
+  return nullptr;
+}
 
-  auto stream_info_it = streams_.find(ssrc);
-  RTC_CHECK(stream_info_it != streams_.end());
-  RTC_CHECK(stream_info_it->second.priority_it == stream_priorities_.begin());
-  RTC_CHECK(!stream_info_it->second.packet_queue.empty());
-  return &stream_info_it->second;
+const RoundRobinPacketQueue::PriorityLevel*
+RoundRobinPacketQueue::GetHighestPriorityLevel() const {
+  for (const PriorityLevel& level : priority_levels_) {
+    if (level.head != kNoStream) {
+      return &level;
+    }
+  }
+  return nullptr;
 }
 
-bool RoundRobinPacketQueue::IsSsrcScheduled(uint32_t ssrc) const {
-  for (const auto& scheduled_stream : stream_priorities_) {
-    if (scheduled_stream.second == ssrc)
-      return true;
+void RoundRobinPacketQueue::Schedule(size_t stream_index, int priority) {
+  Stream& stream = streams_[stream_index];
+  RTC_DCHECK(!stream.scheduled);
+  PriorityLevel* level = GetOrCreatePriorityLevel(priority);
+  stream.scheduled = true;
+  stream.priority = priority;
+  if (level->head == kNoStream) {
+    stream.prev = stream_index;
+    stream.next = stream_index;
+    level->head = stream_index;
+    return;
+  }
+  // Insert before the head, i.e. at the back of the round robin.
+  Stream& head = streams_[level->head];
+  size_t tail_index = head.prev;
+  stream.prev = tail_index;
+  stream.next = level->head;
+  streams_[tail_index].next = stream_index;
+  head.prev = stream_index;
+}
+
+void RoundRobinPacketQueue::Unschedule(size_t stream_index) {
+  Stream& stream = streams_[stream_index];
+  RTC_DCHECK(stream.scheduled);
+  PriorityLevel* level = GetOrCreatePriorityLevel(stream.priority);
+  if (stream.next == stream_index) {
+    RTC_DCHECK_EQ(level->head, stream_index);
+    level->head = kNoStream;
+  } else {
+    streams_[stream.prev].next = stream.next;
+    streams_[stream.next].prev = stream.prev;
+    if (level->head == stream_index) {
+      level->head = stream.next;
+    }
+  }
+  stream.scheduled = false;
+  stream.prev = kNoStream;
+  stream.next = kNoStream;
+}
+
+RoundRobinPacketQueue::Stream* RoundRobinPacketQueue::GetNextStream() {
+  PriorityLevel* level = GetHighestPriorityLevel();
+  RTC_CHECK(level);
+  while (true) {
+    Stream* stream = &streams_[level->head];
+    RTC_DCHECK(!stream->packet_queue.empty());
+    if (stream->deficit >= PacketSize(stream->packet_queue.top())) {
+      return stream;
+    }
+    // Not enough deficit left to send the next packet; the turn passes to
+    // the next stream and this one gets a new quantum for its next turn.
+    stream->deficit += stream->quantum;
+    level->head = stream->next;
   }
-  return false;
 }
 
 }  // namespace webrtc
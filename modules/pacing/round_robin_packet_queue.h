@@ -15,10 +15,11 @@
 #include <stdint.h>
 
 #include <list>
-#include <map>
 #include <memory>
 #include <queue>
 #include <set>
+#include <utility>
+#include <vector>
 
 #include "absl/types/optional.h"
 #include "api/transport/webrtc_key_value_config.h"
@@ -31,6 +32,10 @@
 
 namespace webrtc {
 
+// Packet queue shared by all streams sent through the pacer. Packets are
+// always sent in priority order. Streams that have packets queued at the same
+// priority share the send rate using deficit round robin, in proportion to
+// their weights (by default all streams have equal weight).
 class RoundRobinPacketQueue {
  public:
   RoundRobinPacketQueue(Timestamp start_time,
@@ -55,6 +60,11 @@ class RoundRobinPacketQueue {
   void SetIncludeOverhead();
   void SetTransportOverhead(DataSize overhead_per_packet);
 
+  // Sets the share of the send rate the stream with the given SSRC gets,
+  // relative to other streams with packets queued at the same priority. The
+  // default weight is 1.0, weights below 1/16 are treated as 1/16.
+  void SetStreamWeight(uint32_t ssrc, double weight);
+
  private:
   struct QueuedPacket {
    public:
@@ -97,45 +107,57 @@ class RoundRobinPacketQueue {
     const_iterator end() const;
   };
 
-  struct StreamPrioKey {
-    StreamPrioKey(int priority, DataSize size)
-        : priority(priority), size(size) {}
-
-    bool operator<(const StreamPrioKey& other) const {
-      if (priority != other.priority)
-        return priority < other.priority;
-      return size < other.size;
-    }
-
-    const int priority;
-    const DataSize size;
-  };
+  static constexpr size_t kNoStream = static_cast<size_t>(-1);
 
   struct Stream {
-    Stream();
+    explicit Stream(uint32_t ssrc);
     Stream(const Stream&);
+    Stream& operator=(const Stream&);
+    ~Stream();
 
-    virtual ~Stream();
-
-    DataSize size;
     uint32_t ssrc;
 
+    // Bytes added to |deficit| each time this stream has its turn in the
+    // round robin. Proportional to the stream weight.
+    DataSize quantum;
+    // Bytes this stream may still send before yielding to the next stream
+    // at the same priority.
+    DataSize deficit;
+
     PriorityPacketQueue packet_queue;
 
-    // Whenever a packet is inserted for this stream we check if |priority_it|
-    // points to an element in |stream_priorities_|, and if it does it means
-    // this stream has already been scheduled, and if the scheduled priority is
-    // lower than the priority of the incoming packet we reschedule this stream
-    // with the higher priority.
-    std::multimap<StreamPrioKey, uint32_t>::iterator priority_it;
+    // Priority level this stream is currently scheduled at, and its links in
+    // the circular list of streams scheduled at that level. Only valid if
+    // |scheduled| is true.
+    bool scheduled;
+    int priority;
+    size_t prev;
+    size_t next;
+  };
+
+  // Streams that have packets queued at a given priority, in round robin
+  // order starting at |head|.
+  struct PriorityLevel {
+    int priority;
+    size_t head;
   };
 
   void Push(QueuedPacket packet);
 
-  Stream* GetHighestPriorityStream();
+  DataSize PacketSize(const QueuedPacket& packet) const;
+
+  size_t GetOrCreateStream(uint32_t ssrc);
+  PriorityLevel* GetOrCreatePriorityLevel(int priority);
+  PriorityLevel* GetHighestPriorityLevel();
+  const PriorityLevel* GetHighestPriorityLevel() const;
+
+  // Links the stream in at the back of the round robin of its priority level.
+  void Schedule(size_t stream_index, int priority);
+  void Unschedule(size_t stream_index);
 
-  // Just used to verify correctness.
-  bool IsSsrcScheduled(uint32_t ssrc) const;
+  // Finds the next stream to send from, adding quanta to stream deficits as
+  // streams take turns in the round robin.
+  Stream* GetNextStream();
 
   DataSize transport_overhead_per_packet_;
 
@@ -144,18 +166,19 @@ class RoundRobinPacketQueue {
   bool paused_;
   size_t size_packets_;
   DataSize size_;
-  DataSize max_size_;
   TimeDelta queue_time_sum_;
   TimeDelta pause_time_sum_;
 
-  // A map of streams used to prioritize from which stream to send next. We use
-  // a multimap instead of a priority_queue since the priority of a stream can
-  // change as a new packet is inserted, and a multimap allows us to remove and
-  // then reinsert a StreamPrioKey if the priority has increased.
-  std::multimap<StreamPrioKey, uint32_t> stream_priorities_;
+  // All streams that have ever had packets queued, indexed by the values in
+  // |stream_indices_|. Streams are never removed, so indices stay valid.
+  std::vector<Stream> streams_;
+  // SSRC to index in |streams_|, sorted by SSRC.
+  std::vector<std::pair<uint32_t, size_t>> stream_indices_;
 
-  // A map of SSRCs to Streams.
-  std::map<uint32_t, Stream> streams_;
+  // Priority levels, sorted with the highest priority (lowest value) first.
+  // Levels are kept when they have no streams scheduled, since there are
+  // only a handful of distinct priorities in use.
+  std::vector<PriorityLevel> priority_levels_;
 
   // The enqueue time of every packet currently in the queue. Used to figure out
   // the age of the oldest packet in the queue.
@@ -0,0 +1,157 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/pacing/round_robin_packet_queue.h"
+
+#include <map>
+#include <memory>
+#include <utility>
+
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+constexpr uint32_t kSsrc1 = 1111;
+constexpr uint32_t kSsrc2 = 2222;
+constexpr uint32_t kSsrc3 = 3333;
+constexpr int kAudioPriority = 1;
+constexpr int kVideoPriority = 3;
+constexpr size_t kPacketSize = 1000;
+
+std::unique_ptr<RtpPacketToSend> BuildPacket(RtpPacketToSend::Type type,
+                                             uint32_t ssrc,
+                                             uint16_t sequence_number,
+                                             size_t size) {
+  auto packet = std::make_unique<RtpPacketToSend>(nullptr);
+  packet->set_packet_type(type);
+  packet->SetSsrc(ssrc);
+  packet->SetSequenceNumber(sequence_number);
+  packet->SetPayloadSize(size);
+  return packet;
+}
+}  // namespace
+
+class RoundRobinPacketQueueTest : public ::testing::Test {
+ protected:
+  RoundRobinPacketQueueTest()
+      : now_(Timestamp::ms(1000)), queue_(now_, nullptr), enqueue_order_(0) {}
+
+  void PushVideo(uint32_t ssrc, int num_packets, size_t size = kPacketSize) {
+    for (int i = 0; i < num_packets; ++i) {
+      queue_.Push(kVideoPriority, now_, enqueue_order_,
+                  BuildPacket(RtpPacketToSend::Type::kVideo, ssrc,
+                              static_cast<uint16_t>(enqueue_order_), size));
+      ++enqueue_order_;
+    }
+  }
+
+  // Pops |num_packets| packets and returns the number of bytes sent per SSRC.
+  std::map<uint32_t, size_t> PopPackets(int num_packets) {
+    std::map<uint32_t, size_t> bytes_per_ssrc;
+    for (int i = 0; i < num_packets; ++i) {
+      std::unique_ptr<RtpPacketToSend> packet = queue_.Pop();
+      bytes_per_ssrc[packet->Ssrc()] += packet->payload_size();
+    }
+    return bytes_per_ssrc;
+  }
+
+  Timestamp now_;
+  RoundRobinPacketQueue queue_;
+  uint64_t enqueue_order_;
+};
+
+TEST_F(RoundRobinPacketQueueTest, PopsInEnqueueOrderWithinStream) {
+  PushVideo(kSsrc1, 5);
+  for (uint16_t i = 0; i < 5; ++i) {
+    EXPECT_EQ(queue_.Pop()->SequenceNumber(), i);
+  }
+  EXPECT_TRUE(queue_.Empty());
+  EXPECT_EQ(queue_.Size(), DataSize::Zero());
+}
+
+TEST_F(RoundRobinPacketQueueTest, HigherPriorityIsSentFirst) {
+  PushVideo(kSsrc1, 3);
+  queue_.Push(kAudioPriority, now_, enqueue_order_++,
+              BuildPacket(RtpPacketToSend::Type::kAudio, kSsrc2, 0, 100));
+  EXPECT_TRUE(queue_.NextPacketIsAudio());
+  EXPECT_EQ(queue_.Pop()->Ssrc(), kSsrc2);
+  EXPECT_FALSE(queue_.NextPacketIsAudio());
+  EXPECT_EQ(queue_.SizeInPackets(), 3u);
+}
+
+TEST_F(RoundRobinPacketQueueTest, InterleavesStreams) {
+  PushVideo(kSsrc1, 10);
+  PushVideo(kSsrc2, 10);
+  // Every window of four packets should contain both streams.
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(PopPackets(4).size(), 2u);
+  }
+}
+
+TEST_F(RoundRobinPacketQueueTest, SharesBytesEquallyWithDifferentSizes) {
+  // Stream 1 sends packets four times as large as stream 2, but both should
+  // get roughly the same number of bytes through.
+  PushVideo(kSsrc1, 100, 1200);
+  PushVideo(kSsrc2, 400, 300);
+  std::map<uint32_t, size_t> bytes = PopPackets(200);
+  EXPECT_NEAR(static_cast<double>(bytes[kSsrc1]) / bytes[kSsrc2], 1.0, 0.1);
+}
+
+TEST_F(RoundRobinPacketQueueTest, SharesBytesAccordingToWeights) {
+  queue_.SetStreamWeight(kSsrc1, 3.0);
+  queue_.SetStreamWeight(kSsrc2, 1.0);
+  PushVideo(kSsrc1, 200);
+  PushVideo(kSsrc2, 200);
+  PushVideo(kSsrc3, 200);
+  std::map<uint32_t, size_t> bytes = PopPackets(250);
+  EXPECT_NEAR(static_cast<double>(bytes[kSsrc1]) / bytes[kSsrc2], 3.0, 0.1);
+  EXPECT_NEAR(static_cast<double>(bytes[kSsrc2]) / bytes[kSsrc3], 1.0, 0.1);
+}
+
+TEST_F(RoundRobinPacketQueueTest, ClampsVeryLowWeights) {
+  // A near zero weight is clamped to 1/16, rather than making the stream wait
+  // for thousands of rounds before it can send a packet.
+  queue_.SetStreamWeight(kSsrc1, 1e-6);
+  PushVideo(kSsrc1, 100);
+  PushVideo(kSsrc2, 200);
+  std::map<uint32_t, size_t> bytes = PopPackets(170);
+  EXPECT_NEAR(static_cast<double>(bytes[kSsrc1]) / bytes[kSsrc2], 1.0 / 16,
+              0.01);
+}
+
+TEST_F(RoundRobinPacketQueueTest, IdleStreamDoesNotBuildUpBudget) {
+  PushVideo(kSsrc1, 1);
+  queue_.Pop();
+
+  // Stream 2 sends a lot while stream 1 is idle. Once stream 1 has packets
+  // again, it should alternate with stream 2 rather than catch up.
+  PushVideo(kSsrc2, 50);
+  PopPackets(40);
+  PushVideo(kSsrc1, 10);
+  std::map<uint32_t, size_t> bytes = PopPackets(10);
+  EXPECT_LE(bytes[kSsrc1], 6 * kPacketSize);
+  EXPECT_GE(bytes[kSsrc2], 4 * kPacketSize);
+}
+
+TEST_F(RoundRobinPacketQueueTest, StreamMovesToHigherPriority) {
+  PushVideo(kSsrc1, 2);
+  PushVideo(kSsrc2, 2);
+  // A retransmission on stream 2 makes that stream go first.
+  queue_.Push(kAudioPriority, now_, enqueue_order_++,
+              BuildPacket(RtpPacketToSend::Type::kRetransmission, kSsrc2,
+                          100, kPacketSize));
+  std::unique_ptr<RtpPacketToSend> packet = queue_.Pop();
+  EXPECT_EQ(packet->Ssrc(), kSsrc2);
+  EXPECT_EQ(packet->SequenceNumber(), 100);
+  EXPECT_EQ(PopPackets(4).size(), 2u);
+  EXPECT_TRUE(queue_.Empty());
+}
+
+}  // namespace webrtc
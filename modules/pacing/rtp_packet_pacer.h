@@ -66,6 +66,10 @@ class RtpPacketPacer {
   virtual void SetAccountForAudioPackets(bool account_for_audio) = 0;
   virtual void SetIncludeOverhead() = 0;
   virtual void SetTransportOverhead(DataSize overhead_per_packet) = 0;
+
+  // Sets the share of the send rate given to the stream with the given SSRC,
+  // relative to other streams of the same priority. Defaults to 1.0.
+  virtual void SetStreamWeight(uint32_t ssrc, double weight) = 0;
 };
 
 }  // namespace webrtc
@@ -136,6 +136,13 @@ void TaskQueuePacedSender::SetAccountForAudioPackets(bool account_for_audio) {
   });
 }
 
+void TaskQueuePacedSender::SetStreamWeight(uint32_t ssrc, double weight) {
+  task_queue_.PostTask([this, ssrc, weight]() {
+    RTC_DCHECK_RUN_ON(&task_queue_);
+    pacing_controller_.SetStreamWeight(ssrc, weight);
+  });
+}
+
 void TaskQueuePacedSender::SetIncludeOverhead() {
   task_queue_.PostTask([this]() {
     RTC_DCHECK_RUN_ON(&task_queue_);
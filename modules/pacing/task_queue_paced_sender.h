@@ -81,6 +81,7 @@ class TaskQueuePacedSender : public RtpPacketPacer,
 
   void SetIncludeOverhead() override;
   void SetTransportOverhead(DataSize overhead_per_packet) override;
+  void SetStreamWeight(uint32_t ssrc, double weight) override;
 
   // Returns the time since the oldest queued packet was enqueued.
   TimeDelta OldestPacketWaitTime() const override;
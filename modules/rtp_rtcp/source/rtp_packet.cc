@@ -68,6 +68,12 @@ RtpPacket::RtpPacket(const ExtensionManager* extensions, size_t capacity)
   Clear();
 }
 
+RtpPacket::RtpPacket(const RtpPacket& packet, rtc::CopyOnWriteBuffer buffer)
+    : RtpPacket(packet) {
+  buffer.SetData(packet.data(), packet.size());
+  buffer_ = std::move(buffer);
+}
+
 RtpPacket::~RtpPacket() {}
 
 void RtpPacket::IdentifyExtensions(const ExtensionManager& extensions) {
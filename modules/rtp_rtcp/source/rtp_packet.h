@@ -34,6 +34,9 @@ class RtpPacket {
   explicit RtpPacket(const ExtensionManager* extensions);
   RtpPacket(const RtpPacket&);
   RtpPacket(const ExtensionManager* extensions, size_t capacity);
+  // Copies |packet| into |buffer| and uses it as storage instead of sharing
+  // the buffer of |packet|. Allows callers to supply recycled memory.
+  RtpPacket(const RtpPacket& packet, rtc::CopyOnWriteBuffer buffer);
   ~RtpPacket();
 
   RtpPacket& operator=(const RtpPacket&) = default;
@@ -0,0 +1,104 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/rtp_rtcp/source/rtp_packet_buffer_pool.h"
+
+#include <utility>
+
+#include "api/scoped_refptr.h"
+#include "rtc_base/buffer.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/ref_counted_object.h"
+
+namespace webrtc {
+
+// Buffer that hands itself back to the pool instead of being deleted when the
+// last reference is released. While in use it keeps the pool alive.
+class RtpPacketBufferPool::PooledBuffer
+    : public rtc::RefCountedObject<rtc::Buffer> {
+ public:
+  explicit PooledBuffer(size_t capacity)
+      : rtc::RefCountedObject<rtc::Buffer>(size_t{0}, capacity) {}
+  ~PooledBuffer() override = default;
+
+  void set_pool(rtc::scoped_refptr<RtpPacketBufferPool> pool) {
+    pool_ = std::move(pool);
+  }
+
+  rtc::RefCountReleaseStatus Release() const override {
+    const auto status = ref_count_.DecRef();
+    if (status == rtc::RefCountReleaseStatus::kDroppedLastRef) {
+      // |this| may be deleted by Recycle(), so take the pool reference first.
+      rtc::scoped_refptr<RtpPacketBufferPool> pool = std::move(pool_);
+      pool->Recycle(const_cast<PooledBuffer*>(this));
+    }
+    return status;
+  }
+
+ private:
+  mutable rtc::scoped_refptr<RtpPacketBufferPool> pool_;
+};
+
+RtpPacketBufferPool::RtpPacketBufferPool(size_t max_idle_buffers)
+    : max_idle_buffers_(max_idle_buffers), buffer_capacity_(0) {}
+
+RtpPacketBufferPool::~RtpPacketBufferPool() {
+  // In-use buffers hold a reference to the pool, so only idle buffers remain.
+  for (PooledBuffer* buffer : idle_buffers_) {
+    delete buffer;
+  }
+}
+
+rtc::CopyOnWriteBuffer RtpPacketBufferPool::GetBuffer(size_t capacity) {
+  RTC_DCHECK_GT(capacity, 0);
+  PooledBuffer* buffer = nullptr;
+  {
+    rtc::CritScope lock(&crit_);
+    if (capacity != buffer_capacity_) {
+      for (PooledBuffer* idle_buffer : idle_buffers_) {
+        delete idle_buffer;
+      }
+      idle_buffers_.clear();
+      buffer_capacity_ = capacity;
+    }
+    if (!idle_buffers_.empty()) {
+      buffer = idle_buffers_.back();
+      idle_buffers_.pop_back();
+    }
+  }
+  if (buffer == nullptr) {
+    buffer = new PooledBuffer(capacity);
+  }
+  RTC_DCHECK_EQ(buffer->size(), 0);
+  buffer->set_pool(this);
+  return rtc::CopyOnWriteBuffer(
+      rtc::scoped_refptr<rtc::RefCountedObject<rtc::Buffer>>(buffer));
+}
+
+size_t RtpPacketBufferPool::NumIdleBuffersForTesting() const {
+  rtc::CritScope lock(&crit_);
+  return idle_buffers_.size();
+}
+
+void RtpPacketBufferPool::Recycle(PooledBuffer* buffer) {
+  {
+    rtc::CritScope lock(&crit_);
+    // The buffer may have been grown in place by its last user.
+    if (buffer->capacity() == buffer_capacity_ &&
+        idle_buffers_.size() < max_idle_buffers_) {
+      buffer->Clear();
+      idle_buffers_.push_back(buffer);
+      return;
+    }
+  }
+  delete buffer;
+}
+
+}  // namespace webrtc
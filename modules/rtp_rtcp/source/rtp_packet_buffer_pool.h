@@ -0,0 +1,61 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_RTP_RTCP_SOURCE_RTP_PACKET_BUFFER_POOL_H_
+#define MODULES_RTP_RTCP_SOURCE_RTP_PACKET_BUFFER_POOL_H_
+
+#include <stddef.h>
+
+#include <vector>
+
+#include "rtc_base/copy_on_write_buffer.h"
+#include "rtc_base/critical_section.h"
+#include "rtc_base/ref_count.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace webrtc {
+
+// Pool of fixed-capacity buffers used as storage for outgoing RTP packets.
+// A buffer handed out by GetBuffer() is returned to the pool when the last
+// CopyOnWriteBuffer referencing it is destroyed, typically when the packet
+// has been sent and is dropped from RtpPacketHistory. Recycled buffers have
+// already been touched, so steady state sending neither calls the allocator
+// nor takes page faults for packet storage.
+// If the requested capacity changes, idle buffers of the old capacity are
+// purged and buffers of the old capacity returned later are freed.
+// Buffers may be released on any thread; the pool is thread safe.
+class RtpPacketBufferPool : public rtc::RefCountInterface {
+ public:
+  // At most |max_idle_buffers| buffers are kept for reuse, buffers returned
+  // beyond that are freed.
+  explicit RtpPacketBufferPool(size_t max_idle_buffers);
+
+  // Returns an empty buffer with exactly |capacity| bytes of storage.
+  rtc::CopyOnWriteBuffer GetBuffer(size_t capacity);
+
+  size_t NumIdleBuffersForTesting() const;
+
+ protected:
+  ~RtpPacketBufferPool() override;
+
+ private:
+  class PooledBuffer;
+
+  void Recycle(PooledBuffer* buffer);
+
+  const size_t max_idle_buffers_;
+  rtc::CriticalSection crit_;
+  size_t buffer_capacity_ RTC_GUARDED_BY(crit_);
+  std::vector<PooledBuffer*> idle_buffers_ RTC_GUARDED_BY(crit_);
+};
+
+}  // namespace webrtc
+
+#endif  // MODULES_RTP_RTCP_SOURCE_RTP_PACKET_BUFFER_POOL_H_
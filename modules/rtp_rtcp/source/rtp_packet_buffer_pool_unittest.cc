@@ -0,0 +1,120 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/rtp_rtcp/source/rtp_packet_buffer_pool.h"
+
+#include <memory>
+#include <utility>
+
+#include "api/scoped_refptr.h"
+#include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
+#include "rtc_base/ref_counted_object.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+constexpr size_t kCapacity = 1216;
+constexpr size_t kMaxIdleBuffers = 2;
+constexpr uint32_t kSsrc = 0x12345678;
+
+rtc::scoped_refptr<RtpPacketBufferPool> CreatePool() {
+  return new rtc::RefCountedObject<RtpPacketBufferPool>(kMaxIdleBuffers);
+}
+
+TEST(RtpPacketBufferPoolTest, ReturnsEmptyBufferWithRequestedCapacity) {
+  auto pool = CreatePool();
+  rtc::CopyOnWriteBuffer buffer = pool->GetBuffer(kCapacity);
+  EXPECT_EQ(buffer.size(), 0u);
+  EXPECT_EQ(buffer.capacity(), kCapacity);
+}
+
+TEST(RtpPacketBufferPoolTest, ReusesReleasedBuffer) {
+  auto pool = CreatePool();
+  const uint8_t* data;
+  {
+    rtc::CopyOnWriteBuffer buffer = pool->GetBuffer(kCapacity);
+    buffer.SetSize(kCapacity);
+    data = buffer.cdata();
+    EXPECT_EQ(pool->NumIdleBuffersForTesting(), 0u);
+  }
+  EXPECT_EQ(pool->NumIdleBuffersForTesting(), 1u);
+
+  rtc::CopyOnWriteBuffer buffer = pool->GetBuffer(kCapacity);
+  EXPECT_EQ(buffer.cdata(), data);
+  EXPECT_EQ(buffer.size(), 0u);
+  EXPECT_EQ(pool->NumIdleBuffersForTesting(), 0u);
+}
+
+TEST(RtpPacketBufferPoolTest, BufferIsNotReturnedWhileShared) {
+  auto pool = CreatePool();
+  rtc::CopyOnWriteBuffer copy;
+  {
+    rtc::CopyOnWriteBuffer buffer = pool->GetBuffer(kCapacity);
+    copy = buffer;
+  }
+  EXPECT_EQ(pool->NumIdleBuffersForTesting(), 0u);
+  copy = rtc::CopyOnWriteBuffer();
+  EXPECT_EQ(pool->NumIdleBuffersForTesting(), 1u);
+}
+
+TEST(RtpPacketBufferPoolTest, KeepsAtMostMaxIdleBuffers) {
+  auto pool = CreatePool();
+  {
+    rtc::CopyOnWriteBuffer buffer1 = pool->GetBuffer(kCapacity);
+    rtc::CopyOnWriteBuffer buffer2 = pool->GetBuffer(kCapacity);
+    rtc::CopyOnWriteBuffer buffer3 = pool->GetBuffer(kCapacity);
+  }
+  EXPECT_EQ(pool->NumIdleBuffersForTesting(), kMaxIdleBuffers);
+}
+
+TEST(RtpPacketBufferPoolTest, PurgesBuffersWhenCapacityChanges) {
+  auto pool = CreatePool();
+  rtc::CopyOnWriteBuffer old_buffer = pool->GetBuffer(kCapacity);
+  { rtc::CopyOnWriteBuffer buffer = pool->GetBuffer(kCapacity); }
+  EXPECT_EQ(pool->NumIdleBuffersForTesting(), 1u);
+
+  rtc::CopyOnWriteBuffer new_buffer = pool->GetBuffer(kCapacity + 100);
+  EXPECT_EQ(new_buffer.capacity(), kCapacity + 100);
+  EXPECT_EQ(pool->NumIdleBuffersForTesting(), 0u);
+
+  // Buffers of the old capacity are freed instead of returned.
+  old_buffer = rtc::CopyOnWriteBuffer();
+  EXPECT_EQ(pool->NumIdleBuffersForTesting(), 0u);
+}
+
+TEST(RtpPacketBufferPoolTest, BufferOutlivesPool) {
+  auto pool = CreatePool();
+  rtc::CopyOnWriteBuffer buffer = pool->GetBuffer(kCapacity);
+  pool = nullptr;
+  buffer.SetSize(kCapacity);
+  EXPECT_EQ(buffer.size(), kCapacity);
+}
+
+TEST(RtpPacketBufferPoolTest, PacketCopyUsesPooledStorage) {
+  auto pool = CreatePool();
+  RtpPacketToSend packet(nullptr, kCapacity);
+  packet.SetSsrc(kSsrc);
+  packet.set_capture_time_ms(17);
+
+  RtpPacketToSend copy(packet, pool->GetBuffer(kCapacity));
+  EXPECT_EQ(copy.Ssrc(), kSsrc);
+  EXPECT_EQ(copy.capture_time_ms(), 17);
+  EXPECT_EQ(copy.capacity(), kCapacity);
+  EXPECT_NE(copy.data(), packet.data());
+
+  // Writing payload does not reallocate the exclusively owned storage.
+  const uint8_t* data = copy.data();
+  copy.AllocatePayload(100);
+  EXPECT_EQ(copy.data(), data);
+}
+
+}  // namespace
+}  // namespace webrtc
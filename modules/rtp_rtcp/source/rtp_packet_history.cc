@@ -29,10 +29,28 @@ constexpr int64_t RtpPacketHistory::kMinPacketDurationMs;
 constexpr int RtpPacketHistory::kMinPacketDurationRtt;
 constexpr int RtpPacketHistory::kPacketCullingDelayFactor;
 
+namespace {
+// Smallest ring buffer allocated for a history with storage enabled.
+constexpr size_t kMinRingSize = 16;
+
+// Returns the smallest power of two that can hold |num_packets| packets.
+size_t RingSizeFor(size_t num_packets) {
+  RTC_DCHECK_LE(num_packets, std::numeric_limits<uint16_t>::max() + 1);
+  size_t ring_size = kMinRingSize;
+  while (ring_size < num_packets) {
+    ring_size *= 2;
+  }
+  return ring_size;
+}
+}  // namespace
+
 RtpPacketHistory::PacketState::PacketState() = default;
 RtpPacketHistory::PacketState::PacketState(const PacketState&) = default;
 RtpPacketHistory::PacketState::~PacketState() = default;
 
+RtpPacketHistory::StoredPacket::StoredPacket()
+    : StoredPacket(nullptr, absl::nullopt, 0) {}
+
 RtpPacketHistory::StoredPacket::StoredPacket(
     std::unique_ptr<RtpPacketToSend> packet,
     absl::optional<int64_t> send_time_ms,
@@ -51,33 +69,15 @@ RtpPacketHistory::StoredPacket& RtpPacketHistory::StoredPacket::operator=(
     RtpPacketHistory::StoredPacket&&) = default;
 RtpPacketHistory::StoredPacket::~StoredPacket() = default;
 
-void RtpPacketHistory::StoredPacket::IncrementTimesRetransmitted(
-    PacketPrioritySet* priority_set) {
-  // Check if this StoredPacket is in the priority set. If so, we need to remove
-  // it before updating |times_retransmitted_| since that is used in sorting,
-  // and then add it back.
-  const bool in_priority_set = priority_set->erase(this) > 0;
-  ++times_retransmitted_;
-  if (in_priority_set) {
-    auto it = priority_set->insert(this);
-    RTC_DCHECK(it.second)
-        << "ERROR: Priority set already contains matching packet! In set: "
-           "insert order = "
-        << (*it.first)->insert_order_
-        << ", times retransmitted = " << (*it.first)->times_retransmitted_
-        << ". Trying to add: insert order = " << insert_order_
-        << ", times retransmitted = " << times_retransmitted_;
-  }
-}
-
-bool RtpPacketHistory::MoreUseful::operator()(StoredPacket* lhs,
-                                              StoredPacket* rhs) const {
+bool RtpPacketHistory::LessUseful::operator()(
+    const PaddingCandidate& lhs,
+    const PaddingCandidate& rhs) const {
   // Prefer to send packets we haven't already sent as padding.
-  if (lhs->times_retransmitted() != rhs->times_retransmitted()) {
-    return lhs->times_retransmitted() < rhs->times_retransmitted();
+  if (lhs.times_retransmitted != rhs.times_retransmitted) {
+    return lhs.times_retransmitted > rhs.times_retransmitted;
   }
   // All else being equal, prefer newer packets.
-  return lhs->insert_order() > rhs->insert_order();
+  return lhs.insert_order < rhs.insert_order;
 }
 
 RtpPacketHistory::RtpPacketHistory(Clock* clock)
@@ -85,7 +85,12 @@ RtpPacketHistory::RtpPacketHistory(Clock* clock)
       number_to_store_(0),
       mode_(StorageMode::kDisabled),
       rtt_ms_(-1),
-      packets_inserted_(0) {}
+      stored_bytes_(0),
+      first_sequence_number_(0),
+      num_packets_(0),
+      packets_inserted_(0) {
+  padding_priority_.reserve(kMaxPaddingtHistory);
+}
 
 RtpPacketHistory::~RtpPacketHistory() {}
 
@@ -99,6 +104,12 @@ void RtpPacketHistory::SetStorePacketsStatus(StorageMode mode,
   Reset();
   mode_ = mode;
   number_to_store_ = std::min(kMaxCapacity, number_to_store);
+  // (Re)allocate the ring up front, so that storing packets does not allocate
+  // in the common case.
+  packet_history_ = mode_ == StorageMode::kDisabled
+                        ? std::vector<StoredPacket>()
+                        : std::vector<StoredPacket>(RingSizeFor(
+                              std::max<size_t>(number_to_store_, 1)));
 }
 
 RtpPacketHistory::StorageMode RtpPacketHistory::GetStorageMode() const {
@@ -133,36 +144,39 @@ void RtpPacketHistory::PutRtpPacket(std::unique_ptr<RtpPacketToSend> packet,
   // Store packet.
   const uint16_t rtp_seq_no = packet->SequenceNumber();
   int packet_index = GetPacketIndex(rtp_seq_no);
-  if (packet_index >= 0u &&
-      static_cast<size_t>(packet_index) < packet_history_.size() &&
-      packet_history_[packet_index].packet_ != nullptr) {
+  if (packet_index >= 0 && static_cast<size_t>(packet_index) < num_packets_ &&
+      SlotAt(packet_index).packet_ != nullptr) {
     RTC_LOG(LS_WARNING) << "Duplicate packet inserted: " << rtp_seq_no;
     // Remove previous packet to avoid inconsistent state.
     RemovePacket(packet_index);
     packet_index = GetPacketIndex(rtp_seq_no);
   }
 
-  // Packet to be inserted ahead of first packet, expand front.
-  for (; packet_index < 0; ++packet_index) {
-    packet_history_.emplace_front(nullptr, absl::nullopt, 0);
+  if (num_packets_ == 0) {
+    first_sequence_number_ = rtp_seq_no;
+  } else if (packet_index < 0) {
+    // Packet to be inserted ahead of first packet, expand front. Slots are
+    // keyed by sequence number, so existing packets stay where they are.
+    EnsureCapacity(num_packets_ - packet_index);
+    first_sequence_number_ = rtp_seq_no;
+    num_packets_ -= packet_index;
+    packet_index = 0;
   }
   // Packet to be inserted behind last packet, expand back.
-  while (static_cast<int>(packet_history_.size()) <= packet_index) {
-    packet_history_.emplace_back(nullptr, absl::nullopt, 0);
+  if (static_cast<size_t>(packet_index) >= num_packets_) {
+    EnsureCapacity(packet_index + 1);
+    num_packets_ = packet_index + 1;
   }
 
   RTC_DCHECK_GE(packet_index, 0);
-  RTC_DCHECK_LT(packet_index, packet_history_.size());
-  RTC_DCHECK(packet_history_[packet_index].packet_ == nullptr);
+  RTC_DCHECK_LT(packet_index, num_packets_);
+  StoredPacket& stored_packet = SlotAt(packet_index);
+  RTC_DCHECK(stored_packet.packet_ == nullptr);
 
-  packet_history_[packet_index] =
+  stored_bytes_ += packet->size();
+  stored_packet =
       StoredPacket(std::move(packet), send_time_ms, packets_inserted_++);
-
-  if (padding_priority_.size() >= kMaxPaddingtHistory - 1) {
-    padding_priority_.erase(std::prev(padding_priority_.end()));
-  }
-  auto prio_it = padding_priority_.insert(&packet_history_[packet_index]);
-  RTC_DCHECK(prio_it.second) << "Failed to insert packet into prio set.";
+  AddPaddingCandidate(stored_packet);
 }
 
 std::unique_ptr<RtpPacketToSend> RtpPacketHistory::GetPacketAndSetSendTime(
@@ -183,7 +197,7 @@ std::unique_ptr<RtpPacketToSend> RtpPacketHistory::GetPacketAndSetSendTime(
   }
 
   if (packet->send_time_ms_) {
-    packet->IncrementTimesRetransmitted(&padding_priority_);
+    IncrementTimesRetransmitted(packet);
   }
 
   // Update send-time and mark as no long in pacer queue.
@@ -253,7 +267,7 @@ void RtpPacketHistory::MarkPacketAsSent(uint16_t sequence_number) {
   // transmission count.
   packet->send_time_ms_ = clock_->TimeInMilliseconds();
   packet->pending_transmission_ = false;
-  packet->IncrementTimesRetransmitted(&padding_priority_);
+  IncrementTimesRetransmitted(packet);
 }
 
 absl::optional<RtpPacketHistory::PacketState> RtpPacketHistory::GetPacketState(
@@ -264,11 +278,10 @@ absl::optional<RtpPacketHistory::PacketState> RtpPacketHistory::GetPacketState(
   }
 
   int packet_index = GetPacketIndex(sequence_number);
-  if (packet_index < 0 ||
-      static_cast<size_t>(packet_index) >= packet_history_.size()) {
+  if (packet_index < 0 || static_cast<size_t>(packet_index) >= num_packets_) {
     return absl::nullopt;
   }
-  const StoredPacket& packet = packet_history_[packet_index];
+  const StoredPacket& packet = SlotAt(packet_index);
   if (packet.packet_ == nullptr) {
     return absl::nullopt;
   }
@@ -311,8 +324,11 @@ std::unique_ptr<RtpPacketToSend> RtpPacketHistory::GetPayloadPaddingPacket(
     return nullptr;
   }
 
-  auto best_packet_it = padding_priority_.begin();
-  StoredPacket* best_packet = *best_packet_it;
+  StoredPacket* best_packet =
+      GetStoredPacket(padding_priority_.back().sequence_number);
+  RTC_DCHECK(best_packet);
+  RTC_DCHECK_EQ(best_packet->insert_order(),
+                padding_priority_.back().insert_order);
   if (best_packet->pending_transmission_) {
     // Because PacedSender releases it's lock when it calls
     // GeneratePadding() there is the potential for a race where a new
@@ -328,7 +344,7 @@ std::unique_ptr<RtpPacketToSend> RtpPacketHistory::GetPayloadPaddingPacket(
   }
 
   best_packet->send_time_ms_ = clock_->TimeInMilliseconds();
-  best_packet->IncrementTimesRetransmitted(&padding_priority_);
+  IncrementTimesRetransmitted(best_packet);
 
   return padding_packet;
 }
@@ -339,7 +355,7 @@ void RtpPacketHistory::CullAcknowledgedPackets(
   for (uint16_t sequence_number : sequence_numbers) {
     int packet_index = GetPacketIndex(sequence_number);
     if (packet_index < 0 ||
-        static_cast<size_t>(packet_index) >= packet_history_.size()) {
+        static_cast<size_t>(packet_index) >= num_packets_) {
       continue;
     }
     RemovePacket(packet_index);
@@ -366,23 +382,32 @@ void RtpPacketHistory::Clear() {
   Reset();
 }
 
+size_t RtpPacketHistory::GetStoredBytes() const {
+  rtc::CritScope cs(&lock_);
+  return stored_bytes_;
+}
+
 void RtpPacketHistory::Reset() {
-  packet_history_.clear();
+  for (size_t i = 0; i < num_packets_; ++i) {
+    SlotAt(i).packet_.reset();
+  }
+  num_packets_ = 0;
+  stored_bytes_ = 0;
   padding_priority_.clear();
 }
 
 void RtpPacketHistory::CullOldPackets(int64_t now_ms) {
   int64_t packet_duration_ms =
       std::max(kMinPacketDurationRtt * rtt_ms_, kMinPacketDurationMs);
-  while (!packet_history_.empty()) {
-    if (packet_history_.size() >= kMaxCapacity) {
+  while (num_packets_ > 0) {
+    if (num_packets_ >= kMaxCapacity) {
       // We have reached the absolute max capacity, remove one packet
       // unconditionally.
       RemovePacket(0);
       continue;
     }
 
-    const StoredPacket& stored_packet = packet_history_.front();
+    const StoredPacket& stored_packet = SlotAt(0);
     if (stored_packet.pending_transmission_) {
       // Don't remove packets in the pacer queue, pending tranmission.
       return;
@@ -393,7 +418,7 @@ void RtpPacketHistory::CullOldPackets(int64_t now_ms) {
       return;
     }
 
-    if (packet_history_.size() >= number_to_store_ ||
+    if (num_packets_ >= number_to_store_ ||
         *stored_packet.send_time_ms_ +
                 (packet_duration_ms * kPacketCullingDelayFactor) <=
             now_ms) {
@@ -410,16 +435,20 @@ void RtpPacketHistory::CullOldPackets(int64_t now_ms) {
 std::unique_ptr<RtpPacketToSend> RtpPacketHistory::RemovePacket(
     int packet_index) {
   // Move the packet out from the StoredPacket container.
+  StoredPacket& stored_packet = SlotAt(packet_index);
   std::unique_ptr<RtpPacketToSend> rtp_packet =
-      std::move(packet_history_[packet_index].packet_);
+      std::move(stored_packet.packet_);
 
-  // Erase from padding priority set, if eligible.
-  padding_priority_.erase(&packet_history_[packet_index]);
+  if (rtp_packet) {
+    stored_bytes_ -= rtp_packet->size();
+    // Erase from padding priority list, if eligible.
+    RemovePaddingCandidate(stored_packet);
+  }
 
   if (packet_index == 0) {
-    while (!packet_history_.empty() &&
-           packet_history_.front().packet_ == nullptr) {
-      packet_history_.pop_front();
+    while (num_packets_ > 0 && SlotAt(0).packet_ == nullptr) {
+      ++first_sequence_number_;
+      --num_packets_;
     }
   }
 
@@ -427,12 +456,12 @@ std::unique_ptr<RtpPacketToSend> RtpPacketHistory::RemovePacket(
 }
 
 int RtpPacketHistory::GetPacketIndex(uint16_t sequence_number) const {
-  if (packet_history_.empty()) {
+  if (num_packets_ == 0) {
     return 0;
   }
 
-  RTC_DCHECK(packet_history_.front().packet_ != nullptr);
-  int first_seq = packet_history_.front().packet_->SequenceNumber();
+  RTC_DCHECK(SlotAt(0).packet_ != nullptr);
+  int first_seq = first_sequence_number_;
   if (first_seq == sequence_number) {
     return 0;
   }
@@ -456,11 +485,78 @@ int RtpPacketHistory::GetPacketIndex(uint16_t sequence_number) const {
 RtpPacketHistory::StoredPacket* RtpPacketHistory::GetStoredPacket(
     uint16_t sequence_number) {
   int index = GetPacketIndex(sequence_number);
-  if (index < 0 || static_cast<size_t>(index) >= packet_history_.size() ||
-      packet_history_[index].packet_ == nullptr) {
+  if (index < 0 || static_cast<size_t>(index) >= num_packets_ ||
+      SlotAt(index).packet_ == nullptr) {
     return nullptr;
   }
-  return &packet_history_[index];
+  return &SlotAt(index);
+}
+
+RtpPacketHistory::StoredPacket& RtpPacketHistory::SlotAt(int packet_index) {
+  // The ring size is a power of two no larger than the sequence number space,
+  // so masking also handles sequence number wrap-around.
+  return packet_history_[static_cast<uint16_t>(first_sequence_number_ +
+                                               packet_index) &
+                         (packet_history_.size() - 1)];
+}
+
+const RtpPacketHistory::StoredPacket& RtpPacketHistory::SlotAt(
+    int packet_index) const {
+  return packet_history_[static_cast<uint16_t>(first_sequence_number_ +
+                                               packet_index) &
+                         (packet_history_.size() - 1)];
+}
+
+void RtpPacketHistory::EnsureCapacity(size_t num_packets) {
+  if (num_packets <= packet_history_.size()) {
+    return;
+  }
+  // Only happens if many packets are pending transmission or if sequence
+  // numbers jump; grow the ring and move packets to their new slots.
+  std::vector<StoredPacket> ring(RingSizeFor(num_packets));
+  for (size_t i = 0; i < num_packets_; ++i) {
+    const uint16_t sequence_number = first_sequence_number_ + i;
+    ring[sequence_number & (ring.size() - 1)] = std::move(SlotAt(i));
+  }
+  packet_history_ = std::move(ring);
+}
+
+void RtpPacketHistory::IncrementTimesRetransmitted(StoredPacket* packet) {
+  // The retransmission count is part of the padding priority sort key, so
+  // the packet has to be repositioned if it's a padding candidate.
+  const bool is_padding_candidate = RemovePaddingCandidate(*packet);
+  packet->IncrementTimesRetransmitted();
+  if (is_padding_candidate) {
+    AddPaddingCandidate(*packet);
+  }
+}
+
+void RtpPacketHistory::AddPaddingCandidate(const StoredPacket& packet) {
+  if (padding_priority_.size() >= kMaxPaddingtHistory - 1) {
+    // Drop the least useful candidate.
+    padding_priority_.erase(padding_priority_.begin());
+  }
+  const PaddingCandidate candidate = {packet.times_retransmitted(),
+                                      packet.insert_order(),
+                                      packet.packet_->SequenceNumber()};
+  padding_priority_.insert(
+      std::upper_bound(padding_priority_.begin(), padding_priority_.end(),
+                       candidate, LessUseful()),
+      candidate);
+}
+
+bool RtpPacketHistory::RemovePaddingCandidate(const StoredPacket& packet) {
+  // Insert order is unique, so the sort keys identify the packet.
+  const PaddingCandidate key = {packet.times_retransmitted(),
+                                packet.insert_order(), 0};
+  auto it = std::lower_bound(padding_priority_.begin(),
+                             padding_priority_.end(), key, LessUseful());
+  if (it == padding_priority_.end() ||
+      it->insert_order != packet.insert_order()) {
+    return false;
+  }
+  padding_priority_.erase(it);
+  return true;
 }
 
 RtpPacketHistory::PacketState RtpPacketHistory::StoredPacketToPacketState(
@@ -11,10 +11,7 @@
 #ifndef MODULES_RTP_RTCP_SOURCE_RTP_PACKET_HISTORY_H_
 #define MODULES_RTP_RTCP_SOURCE_RTP_PACKET_HISTORY_H_
 
-#include <deque>
-#include <map>
 #include <memory>
-#include <set>
 #include <vector>
 
 #include "api/function_view.h"
@@ -135,13 +132,13 @@ class RtpPacketHistory {
   // capacity.
   void Clear();
 
- private:
-  struct MoreUseful;
-  class StoredPacket;
-  using PacketPrioritySet = std::set<StoredPacket*, MoreUseful>;
+  // Total size of the packets currently in the history, in bytes.
+  size_t GetStoredBytes() const;
 
+ private:
   class StoredPacket {
    public:
+    StoredPacket();
     StoredPacket(std::unique_ptr<RtpPacketToSend> packet,
                  absl::optional<int64_t> send_time_ms,
                  uint64_t insert_order);
@@ -151,7 +148,7 @@ class RtpPacketHistory {
 
     uint64_t insert_order() const { return insert_order_; }
     size_t times_retransmitted() const { return times_retransmitted_; }
-    void IncrementTimesRetransmitted(PacketPrioritySet* priority_set);
+    void IncrementTimesRetransmitted() { ++times_retransmitted_; }
 
     // The time of last transmission, including retransmissions.
     absl::optional<int64_t> send_time_ms_;
@@ -170,8 +167,16 @@ class RtpPacketHistory {
     // Number of times RE-transmitted, ie excluding the first transmission.
     size_t times_retransmitted_;
   };
-  struct MoreUseful {
-    bool operator()(StoredPacket* lhs, StoredPacket* rhs) const;
+  // Entry in the padding priority list. Holds a copy of the sort keys so the
+  // list can be searched without touching the packets themselves.
+  struct PaddingCandidate {
+    size_t times_retransmitted;
+    uint64_t insert_order;
+    uint16_t sequence_number;
+  };
+  struct LessUseful {
+    bool operator()(const PaddingCandidate& lhs,
+                    const PaddingCandidate& rhs) const;
   };
 
   // Helper method used by GetPacketAndSetSendTime() and GetPacketState() to
@@ -188,6 +193,20 @@ class RtpPacketHistory {
       RTC_EXCLUSIVE_LOCKS_REQUIRED(lock_);
   StoredPacket* GetStoredPacket(uint16_t sequence_number)
       RTC_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  // Returns the ring slot for the packet |packet_index| positions after the
+  // oldest one.
+  StoredPacket& SlotAt(int packet_index) RTC_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  const StoredPacket& SlotAt(int packet_index) const
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  // Makes room for |num_packets| consecutive sequence numbers in the ring.
+  void EnsureCapacity(size_t num_packets) RTC_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  void IncrementTimesRetransmitted(StoredPacket* packet)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  void AddPaddingCandidate(const StoredPacket& packet)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  // Returns true if |packet| was a padding candidate.
+  bool RemovePaddingCandidate(const StoredPacket& packet)
+      RTC_EXCLUSIVE_LOCKS_REQUIRED(lock_);
   static PacketState StoredPacketToPacketState(
       const StoredPacket& stored_packet);
 
@@ -197,19 +216,28 @@ class RtpPacketHistory {
   StorageMode mode_ RTC_GUARDED_BY(lock_);
   int64_t rtt_ms_ RTC_GUARDED_BY(lock_);
 
-  // Queue of stored packets, ordered by sequence number, with older packets in
-  // the front and new packets being added to the back. Note that there may be
-  // wrap-arounds so the back may have a lower sequence number.
-  // Packets may also be removed out-of-order, in which case there will be
-  // instances of StoredPacket with |packet_| set to nullptr. The first and last
-  // entry in the queue will however always be populated.
-  std::deque<StoredPacket> packet_history_ RTC_GUARDED_BY(lock_);
+  size_t stored_bytes_ RTC_GUARDED_BY(lock_);
+
+  // Ring buffer of stored packets, keyed by sequence number: the packet with
+  // sequence number n lives in slot n % packet_history_.size(). The size is a
+  // power of two, sized from |number_to_store_| and only grown if more
+  // packets than that are pending transmission.
+  // |first_sequence_number_| is the oldest stored packet, and |num_packets_|
+  // the span of sequence numbers up to and including the newest one. Packets
+  // may be removed out-of-order, in which case there will be slots within the
+  // span with |packet_| set to nullptr. The first and last packet in the span
+  // will however always be populated, and all slots outside it are empty.
+  std::vector<StoredPacket> packet_history_ RTC_GUARDED_BY(lock_);
+  uint16_t first_sequence_number_ RTC_GUARDED_BY(lock_);
+  size_t num_packets_ RTC_GUARDED_BY(lock_);
 
   // Total number of packets with inserted.
   uint64_t packets_inserted_ RTC_GUARDED_BY(lock_);
-  // Objects from |packet_history_| ordered by "most likely to be useful", used
-  // in GetPayloadPaddingPacket().
-  PacketPrioritySet padding_priority_ RTC_GUARDED_BY(lock_);
+  // Packets from |packet_history_| ordered from least to most likely to be
+  // useful, used in GetPayloadPaddingPacket(). Bounded by
+  // kMaxPaddingtHistory, so a sorted flat array is cheaper to maintain than a
+  // node based tree.
+  std::vector<PaddingCandidate> padding_priority_ RTC_GUARDED_BY(lock_);
 
   RTC_DISALLOW_IMPLICIT_CONSTRUCTORS(RtpPacketHistory);
 };
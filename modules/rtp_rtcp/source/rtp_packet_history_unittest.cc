@@ -780,4 +780,43 @@ TEST_F(RtpPacketHistoryTest, OutOfOrderInsertRemoval) {
     expected_time_offset_ms += 33;
   }
 }
+
+TEST_F(RtpPacketHistoryTest, GrowsBeyondNumberToStoreWhilePending) {
+  const size_t kNumberToStore = 10;
+  const size_t kNumPackets = 100;
+  hist_.SetStorePacketsStatus(StorageMode::kStoreAndCull, kNumberToStore);
+
+  // Packets pending transmission are not culled, so the history must be able
+  // to hold more packets than it was sized for.
+  for (size_t i = 0; i < kNumPackets; ++i) {
+    hist_.PutRtpPacket(CreateRtpPacket(To16u(kStartSeqNum + i)),
+                       absl::nullopt);
+  }
+  for (size_t i = 0; i < kNumPackets; ++i) {
+    EXPECT_TRUE(hist_.GetPacketState(To16u(kStartSeqNum + i)));
+  }
+  EXPECT_FALSE(hist_.GetPacketState(To16u(kStartSeqNum + kNumPackets)));
+}
+
+TEST_F(RtpPacketHistoryTest, TracksStoredBytes) {
+  const size_t kPayloadSize = 100;
+  hist_.SetStorePacketsStatus(StorageMode::kStoreAndCull, 10);
+  EXPECT_EQ(hist_.GetStoredBytes(), 0u);
+
+  std::unique_ptr<RtpPacketToSend> packet = CreateRtpPacket(kStartSeqNum);
+  packet->SetPayloadSize(kPayloadSize);
+  const size_t packet_size = packet->size();
+  hist_.PutRtpPacket(std::move(packet), fake_clock_.TimeInMilliseconds());
+  packet = CreateRtpPacket(To16u(kStartSeqNum + 1));
+  packet->SetPayloadSize(kPayloadSize);
+  hist_.PutRtpPacket(std::move(packet), fake_clock_.TimeInMilliseconds());
+  EXPECT_EQ(hist_.GetStoredBytes(), 2 * packet_size);
+
+  hist_.CullAcknowledgedPackets(std::vector<uint16_t>{kStartSeqNum});
+  EXPECT_EQ(hist_.GetStoredBytes(), packet_size);
+
+  hist_.Clear();
+  EXPECT_EQ(hist_.GetStoredBytes(), 0u);
+}
+
 }  // namespace webrtc
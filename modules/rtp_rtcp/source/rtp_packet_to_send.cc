@@ -11,6 +11,7 @@
 #include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
 
 #include <cstdint>
+#include <utility>
 
 namespace webrtc {
 
@@ -20,6 +21,14 @@ RtpPacketToSend::RtpPacketToSend(const ExtensionManager* extensions,
                                  size_t capacity)
     : RtpPacket(extensions, capacity) {}
 RtpPacketToSend::RtpPacketToSend(const RtpPacketToSend& packet) = default;
+RtpPacketToSend::RtpPacketToSend(const RtpPacketToSend& packet,
+                                 rtc::CopyOnWriteBuffer buffer)
+    : RtpPacket(packet, std::move(buffer)),
+      capture_time_ms_(packet.capture_time_ms_),
+      packet_type_(packet.packet_type_),
+      allow_retransmission_(packet.allow_retransmission_),
+      retransmitted_sequence_number_(packet.retransmitted_sequence_number_),
+      application_data_(packet.application_data_) {}
 RtpPacketToSend::RtpPacketToSend(RtpPacketToSend&& packet) = default;
 
 RtpPacketToSend& RtpPacketToSend::operator=(const RtpPacketToSend& packet) =
@@ -36,6 +36,8 @@ class RtpPacketToSend : public RtpPacket {
   explicit RtpPacketToSend(const ExtensionManager* extensions);
   RtpPacketToSend(const ExtensionManager* extensions, size_t capacity);
   RtpPacketToSend(const RtpPacketToSend& packet);
+  // Copies |packet| into the storage provided by |buffer|, see RtpPacket.
+  RtpPacketToSend(const RtpPacketToSend& packet, rtc::CopyOnWriteBuffer buffer);
   RtpPacketToSend(RtpPacketToSend&& packet);
 
   RtpPacketToSend& operator=(const RtpPacketToSend& packet);
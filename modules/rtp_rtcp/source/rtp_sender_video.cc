@@ -34,6 +34,7 @@
 #include "modules/rtp_rtcp/source/time_util.h"
 #include "rtc_base/checks.h"
 #include "rtc_base/logging.h"
+#include "rtc_base/ref_counted_object.h"
 #include "rtc_base/trace_event.h"
 
 namespace webrtc {
@@ -59,6 +60,14 @@ constexpr int64_t kMaxUnretransmittableFrameIntervalMs = 33 * 4;
 const char kExcludeTransportSequenceNumberFromFecFieldTrial[] =
     "WebRTC-ExcludeTransportSequenceNumberFromFec";
 
+// When enabled, packets produced by the packetizer use storage recycled from
+// RtpPacketBufferPool instead of a fresh heap allocation per packet.
+const char kPooledPacketBuffersFieldTrial[] =
+    "WebRTC-Video-PooledRtpPacketBuffers";
+// Upper bound on idle buffers kept by the pool. Packets held by the packet
+// history are in use, so this only needs to absorb bursts (e.g. key frames).
+constexpr size_t kMaxIdlePooledPacketBuffers = 256;
+
 void BuildRedPayload(const RtpPacketToSend& media_packet,
                      RtpPacketToSend* red_packet) {
   uint8_t* red_payload = red_packet->AllocatePayload(
@@ -296,12 +305,29 @@ RTPSenderVideo::RTPSenderVideo(const Config& config)
           config.field_trials
               ->Lookup(kExcludeTransportSequenceNumberFromFecFieldTrial)
               .find("Enabled") == 0),
-      absolute_capture_time_sender_(config.clock) {
+      absolute_capture_time_sender_(config.clock),
+      packet_buffer_pool_(
+          config.field_trials->Lookup(kPooledPacketBuffersFieldTrial)
+                      .find("Enabled") == 0
+              ? new rtc::RefCountedObject<RtpPacketBufferPool>(
+                    kMaxIdlePooledPacketBuffers)
+              : nullptr) {
   RTC_DCHECK(playout_delay_oracle_);
 }
 
 RTPSenderVideo::~RTPSenderVideo() {}
 
+std::unique_ptr<RtpPacketToSend> RTPSenderVideo::CopyPacket(
+    const RtpPacketToSend& packet) {
+  if (!packet_buffer_pool_) {
+    return std::make_unique<RtpPacketToSend>(packet);
+  }
+  // Copy into exclusively owned storage up front, so that writing extensions
+  // and payload doesn't trigger a copy-on-write reallocation.
+  return std::make_unique<RtpPacketToSend>(
+      packet, packet_buffer_pool_->GetBuffer(packet.capacity()));
+}
+
 void RTPSenderVideo::AppendAsRedMaybeWithUlpfec(
     std::unique_ptr<RtpPacketToSend> media_packet,
     bool protect_media_packet,
@@ -591,9 +617,9 @@ bool RTPSenderVideo::SendVideo(
           Int64MsToUQ32x32(single_packet->capture_time_ms() + NtpOffsetMs()),
           /*estimated_capture_clock_offset=*/absl::nullopt);
 
-  auto first_packet = std::make_unique<RtpPacketToSend>(*single_packet);
-  auto middle_packet = std::make_unique<RtpPacketToSend>(*single_packet);
-  auto last_packet = std::make_unique<RtpPacketToSend>(*single_packet);
+  auto first_packet = CopyPacket(*single_packet);
+  auto middle_packet = CopyPacket(*single_packet);
+  auto last_packet = CopyPacket(*single_packet);
   // Simplest way to estimate how much extensions would occupy is to set them.
   AddRtpHeaderExtensions(video_header, playout_delay, absolute_capture_time,
                          video_structure_.get(), set_video_rotation,
@@ -731,7 +757,7 @@ bool RTPSenderVideo::SendVideo(
       expected_payload_capacity =
           limits.max_payload_len - limits.last_packet_reduction_len;
     } else {
-      packet = std::make_unique<RtpPacketToSend>(*middle_packet);
+      packet = CopyPacket(*middle_packet);
       expected_payload_capacity = limits.max_payload_len;
     }
 
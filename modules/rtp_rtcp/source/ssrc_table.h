@@ -0,0 +1,169 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef MODULES_RTP_RTCP_SOURCE_SSRC_TABLE_H_
+#define MODULES_RTP_RTCP_SOURCE_SSRC_TABLE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <utility>
+#include <vector>
+
+#include "rtc_base/checks.h"
+
+namespace webrtc {
+
+// Maps SSRCs to per-stream values, e.g. the module or sink a packet should be
+// routed to. Entries are stored in a flat, open-addressed array with linear
+// probing, so a lookup touches one or two cache lines rather than following
+// the node pointers of a std::map or std::unordered_map. The slot found by
+// the last successful lookup is checked first, since consecutive packets
+// usually belong to the same stream.
+//
+// Intended for read-mostly use: lookups happen per packet, while insertions
+// and removals only happen when streams are added or removed. Not thread
+// safe, and Find() updates the cached slot even though it is const.
+template <typename T>
+class SsrcTable {
+ public:
+  SsrcTable() : hash_shift_(32), size_(0), last_hit_(0) {}
+
+  // Returns the value for |ssrc|, or null if there is none.
+  T* Find(uint32_t ssrc) {
+    return const_cast<T*>(static_cast<const SsrcTable*>(this)->Find(ssrc));
+  }
+  const T* Find(uint32_t ssrc) const {
+    if (size_ == 0) {
+      return nullptr;
+    }
+    const Slot& cached = slots_[last_hit_];
+    if (cached.used && cached.ssrc == ssrc) {
+      return &cached.value;
+    }
+    const size_t mask = slots_.size() - 1;
+    for (size_t i = HomeSlot(ssrc);; i = (i + 1) & mask) {
+      const Slot& slot = slots_[i];
+      if (!slot.used) {
+        return nullptr;
+      }
+      if (slot.ssrc == ssrc) {
+        last_hit_ = i;
+        return &slot.value;
+      }
+    }
+  }
+
+  // Returns the value for |ssrc|, inserting a default constructed value if
+  // there is none.
+  T& GetOrInsert(uint32_t ssrc) {
+    if (T* value = Find(ssrc)) {
+      return *value;
+    }
+    // Keep the load factor at or below 1/2, so probe sequences stay short.
+    if (2 * (size_ + 1) > slots_.size()) {
+      Rehash(slots_.empty() ? kMinCapacity : 2 * slots_.size());
+    }
+    size_t i = InsertSlot(ssrc);
+    ++size_;
+    last_hit_ = i;
+    return slots_[i].value;
+  }
+
+  // Removes |ssrc| and returns true, or returns false if there was no value
+  // for it.
+  bool Erase(uint32_t ssrc) {
+    if (Find(ssrc) == nullptr) {
+      return false;
+    }
+    // Backward shift deletion: move later entries of the probe sequence into
+    // the hole, so that lookups never have to skip over removed entries.
+    const size_t mask = slots_.size() - 1;
+    size_t hole = last_hit_;
+    for (size_t i = (hole + 1) & mask; slots_[i].used; i = (i + 1) & mask) {
+      size_t home = HomeSlot(slots_[i].ssrc);
+      // Entry |i| may fill the hole if its home slot is not cyclically in
+      // (hole, i].
+      bool home_after_hole =
+          hole <= i ? (hole < home && home <= i) : (hole < home || home <= i);
+      if (!home_after_hole) {
+        slots_[hole] = std::move(slots_[i]);
+        hole = i;
+      }
+    }
+    slots_[hole] = Slot();
+    --size_;
+    last_hit_ = 0;
+    return true;
+  }
+
+  void Clear() {
+    slots_.clear();
+    hash_shift_ = 32;
+    size_ = 0;
+    last_hit_ = 0;
+  }
+
+  size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+ private:
+  static constexpr size_t kMinCapacity = 8;
+
+  struct Slot {
+    Slot() : ssrc(0), used(false), value() {}
+    uint32_t ssrc;
+    bool used;
+    T value;
+  };
+
+  size_t HomeSlot(uint32_t ssrc) const {
+    // Fibonacci hashing: the top bits of the product depend on all bits of
+    // the SSRC.
+    return static_cast<uint32_t>(ssrc * 2654435769u) >> hash_shift_;
+  }
+
+  size_t InsertSlot(uint32_t ssrc) {
+    const size_t mask = slots_.size() - 1;
+    size_t i = HomeSlot(ssrc);
+    while (slots_[i].used) {
+      i = (i + 1) & mask;
+    }
+    slots_[i].ssrc = ssrc;
+    slots_[i].used = true;
+    return i;
+  }
+
+  void Rehash(size_t capacity) {
+    RTC_DCHECK_EQ(capacity & (capacity - 1), 0);
+    std::vector<Slot> old_slots(capacity);
+    old_slots.swap(slots_);
+    hash_shift_ = 32;
+    for (size_t c = capacity; c > 1; c >>= 1) {
+      --hash_shift_;
+    }
+    for (Slot& slot : old_slots) {
+      if (slot.used) {
+        slots_[InsertSlot(slot.ssrc)].value = std::move(slot.value);
+      }
+    }
+    last_hit_ = 0;
+  }
+
+  std::vector<Slot> slots_;
+  // 32 - log2(capacity).
+  int hash_shift_;
+  size_t size_;
+  mutable size_t last_hit_;
+};
+
+}  // namespace webrtc
+
+#endif  // MODULES_RTP_RTCP_SOURCE_SSRC_TABLE_H_
@@ -0,0 +1,103 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "modules/rtp_rtcp/source/ssrc_table.h"
+
+#include <map>
+
+#include "rtc_base/random.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+namespace {
+
+TEST(SsrcTableTest, EmptyTableFindsNothing) {
+  SsrcTable<int> table;
+  EXPECT_TRUE(table.empty());
+  EXPECT_EQ(table.Find(1234), nullptr);
+  EXPECT_FALSE(table.Erase(1234));
+}
+
+TEST(SsrcTableTest, InsertsAndFindsValues) {
+  SsrcTable<int> table;
+  table.GetOrInsert(1111) = 1;
+  table.GetOrInsert(2222) = 2;
+  EXPECT_EQ(table.size(), 2u);
+  ASSERT_NE(table.Find(1111), nullptr);
+  EXPECT_EQ(*table.Find(1111), 1);
+  ASSERT_NE(table.Find(2222), nullptr);
+  EXPECT_EQ(*table.Find(2222), 2);
+  EXPECT_EQ(table.Find(3333), nullptr);
+
+  // Inserting an existing SSRC returns the existing value.
+  EXPECT_EQ(table.GetOrInsert(1111), 1);
+  EXPECT_EQ(table.size(), 2u);
+}
+
+TEST(SsrcTableTest, ErasesValues) {
+  SsrcTable<int> table;
+  table.GetOrInsert(1111) = 1;
+  table.GetOrInsert(2222) = 2;
+  EXPECT_TRUE(table.Erase(1111));
+  EXPECT_FALSE(table.Erase(1111));
+  EXPECT_EQ(table.Find(1111), nullptr);
+  ASSERT_NE(table.Find(2222), nullptr);
+  EXPECT_EQ(*table.Find(2222), 2);
+  EXPECT_EQ(table.size(), 1u);
+}
+
+TEST(SsrcTableTest, HandlesCollidingSsrcs) {
+  // SSRCs that only differ in their low bits, or only in their high bits.
+  SsrcTable<uint32_t> table;
+  for (uint32_t i = 0; i < 64; ++i) {
+    table.GetOrInsert(i) = i;
+    table.GetOrInsert(i << 24) = i << 24;
+  }
+  EXPECT_EQ(table.size(), 127u);
+  for (uint32_t i = 0; i < 64; ++i) {
+    ASSERT_NE(table.Find(i << 24), nullptr);
+    EXPECT_EQ(*table.Find(i << 24), i << 24);
+  }
+  for (uint32_t i = 0; i < 64; i += 2) {
+    EXPECT_TRUE(table.Erase(i));
+  }
+  for (uint32_t i = 0; i < 64; ++i) {
+    if (i % 2 == 0) {
+      EXPECT_EQ(table.Find(i), nullptr);
+    } else {
+      ASSERT_NE(table.Find(i), nullptr);
+      EXPECT_EQ(*table.Find(i), i);
+    }
+  }
+}
+
+TEST(SsrcTableTest, MatchesStdMapUnderRandomOperations) {
+  Random random(0x1234);
+  SsrcTable<uint32_t> table;
+  std::map<uint32_t, uint32_t> reference;
+  for (int i = 0; i < 10000; ++i) {
+    // Draw from a small SSRC space so that erases often hit.
+    uint32_t ssrc = random.Rand(0, 200) * 0x01000193u;
+    if (random.Rand(0, 2) == 0) {
+      EXPECT_EQ(table.Erase(ssrc), reference.erase(ssrc) == 1);
+    } else {
+      table.GetOrInsert(ssrc) = i;
+      reference[ssrc] = i;
+    }
+    ASSERT_EQ(table.size(), reference.size());
+  }
+  for (const auto& entry : reference) {
+    ASSERT_NE(table.Find(entry.first), nullptr);
+    EXPECT_EQ(*table.Find(entry.first), entry.second);
+  }
+}
+
+}  // namespace
+}  // namespace webrtc
@@ -0,0 +1,157 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "api/call/transport.h"
+#include "api/transport/webrtc_key_value_config.h"
+#include "modules/rtp_rtcp/include/rtp_packet_sender.h"
+#include "modules/rtp_rtcp/include/rtp_rtcp.h"
+#include "modules/rtp_rtcp/source/playout_delay_oracle.h"
+#include "modules/rtp_rtcp/source/rtp_packet_to_send.h"
+#include "modules/rtp_rtcp/source/rtp_sender_video.h"
+#include "rtc_base/rate_limiter.h"
+#include "rtc_base/time_utils.h"
+#include "system_wrappers/include/clock.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace webrtc {
+namespace {
+
+constexpr uint32_t kSsrc = 725242;
+constexpr int kPayloadType = 96;
+constexpr int64_t kStartTimeMs = 123456789;
+constexpr int64_t kFrameIntervalMs = 16;
+constexpr int64_t kExpectedRetransmissionTimeMs = 125;
+constexpr uint16_t kPacketHistorySize = 600;
+// Roughly a 4K delta frame at 40 Mbps and 60 fps, i.e. ~70 packets per frame.
+constexpr size_t kFrameSizeBytes = 80000;
+constexpr int kNumFrames = 3000;
+
+class FieldTrials : public WebRtcKeyValueConfig {
+ public:
+  explicit FieldTrials(bool use_pooled_buffers)
+      : use_pooled_buffers_(use_pooled_buffers) {}
+
+  std::string Lookup(absl::string_view key) const override {
+    return key == "WebRTC-Video-PooledRtpPacketBuffers" && use_pooled_buffers_
+               ? "Enabled"
+               : "";
+  }
+
+ private:
+  const bool use_pooled_buffers_;
+};
+
+class CountingTransport : public Transport {
+ public:
+  bool SendRtp(const uint8_t* packet,
+               size_t length,
+               const PacketOptions& options) override {
+    ++packets_sent_;
+    return true;
+  }
+  bool SendRtcp(const uint8_t* packet, size_t length) override { return true; }
+
+  int packets_sent() const { return packets_sent_; }
+
+ private:
+  int packets_sent_ = 0;
+};
+
+// Stands in for the pacer: releases every enqueued packet to the RTP module
+// straight away, so the measurement covers packetization, the hand-off to the
+// pacer, egress, packet history and packet destruction.
+class ImmediatePacer : public RtpPacketSender {
+ public:
+  void set_rtp_module(RtpRtcp* rtp_module) { rtp_module_ = rtp_module; }
+
+  void EnqueuePackets(
+      std::vector<std::unique_ptr<RtpPacketToSend>> packets) override {
+    for (auto& packet : packets) {
+      rtp_module_->TrySendPacket(packet.get(), PacedPacketInfo());
+    }
+  }
+
+ private:
+  RtpRtcp* rtp_module_ = nullptr;
+};
+
+// Returns the average time, in nanoseconds, spent per sent RTP packet.
+double MeasurePerPacketCostNs(bool use_pooled_buffers) {
+  FieldTrials field_trials(use_pooled_buffers);
+  SimulatedClock clock(kStartTimeMs);
+  RateLimiter retransmission_rate_limiter(&clock, 1000);
+  CountingTransport transport;
+  ImmediatePacer pacer;
+  std::unique_ptr<RtpRtcp> rtp_module = RtpRtcp::Create([&] {
+    RtpRtcp::Configuration config;
+    config.clock = &clock;
+    config.outgoing_transport = &transport;
+    config.paced_sender = &pacer;
+    config.retransmission_rate_limiter = &retransmission_rate_limiter;
+    config.field_trials = &field_trials;
+    config.local_media_ssrc = kSsrc;
+    return config;
+  }());
+  pacer.set_rtp_module(rtp_module.get());
+  rtp_module->SetSendingStatus(true);
+  rtp_module->SetSendingMediaStatus(true);
+  rtp_module->SetStorePacketsStatus(true, kPacketHistorySize);
+
+  PlayoutDelayOracle playout_delay_oracle;
+  RTPSenderVideo::Config config;
+  config.clock = &clock;
+  config.rtp_sender = rtp_module->RtpSender();
+  config.playout_delay_oracle = &playout_delay_oracle;
+  config.field_trials = &field_trials;
+  RTPSenderVideo rtp_sender_video(config);
+
+  const std::vector<uint8_t> frame(kFrameSizeBytes, 0x5a);
+  RTPVideoHeader video_header;
+  video_header.frame_type = VideoFrameType::kVideoFrameDelta;
+  uint32_t rtp_timestamp = 0;
+
+  const int64_t start_time_us = rtc::TimeMicros();
+  for (int i = 0; i < kNumFrames; ++i) {
+    EXPECT_TRUE(rtp_sender_video.SendVideo(
+        kPayloadType, kVideoCodecGeneric, rtp_timestamp,
+        clock.TimeInMilliseconds(), frame, nullptr, video_header,
+        kExpectedRetransmissionTimeMs));
+    rtp_timestamp += kFrameIntervalMs * 90;
+    clock.AdvanceTimeMilliseconds(kFrameIntervalMs);
+  }
+  const int64_t elapsed_us = rtc::TimeMicros() - start_time_us;
+
+  EXPECT_GT(transport.packets_sent(), 0);
+  return 1000.0 * elapsed_us / transport.packets_sent();
+}
+
+}  // namespace
+
+TEST(RtpSenderVideoPerfTest, PerPacketCostWithHeapAllocatedPackets) {
+  test::PrintResult("rtp_sender_video_per_packet_cost", "", "heap_allocated",
+                    MeasurePerPacketCostNs(/*use_pooled_buffers=*/false), "ns",
+                    /*important=*/false,
+                    test::ImproveDirection::kSmallerIsBetter);
+}
+
+TEST(RtpSenderVideoPerfTest, PerPacketCostWithPooledPacketBuffers) {
+  test::PrintResult("rtp_sender_video_per_packet_cost", "", "pooled",
+                    MeasurePerPacketCostNs(/*use_pooled_buffers=*/true), "ns",
+                    /*important=*/false,
+                    test::ImproveDirection::kSmallerIsBetter);
+}
+
+}  // namespace webrtc
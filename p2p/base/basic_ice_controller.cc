@@ -53,6 +53,30 @@ int CompareCandidatePairsByNetworkPreference(
   return a_and_b_equal;
 }
 
+// Sorts |connections| into the same order as std::stable_sort(), but with
+// fewer comparisons when they are nearly sorted already. That is the common
+// case, since between two sorts usually only the few connections whose state
+// changed are out of place. Each connection that is better than its
+// predecessor is moved to its place among the connections before it, found by
+// binary search. This takes n - 1 comparisons if nothing changed and
+// O(n log n) comparisons in the worst case.
+template <typename Compare>
+void StableSortNearlySorted(
+    std::vector<const cricket::Connection*>* connections,
+    Compare less) {
+  if (connections->size() < 2) {
+    return;
+  }
+  for (auto it = connections->begin() + 1; it != connections->end(); ++it) {
+    if (!less(*it, *(it - 1))) {
+      continue;
+    }
+    // Insert after the connections that are as good, to keep the sort stable.
+    auto pos = std::upper_bound(connections->begin(), it - 1, *it, less);
+    std::rotate(pos, it, it + 1);
+  }
+}
+
 }  // namespace
 
 namespace cricket {
@@ -173,34 +197,26 @@ const Connection* BasicIceController::FindNextPingableConnection() {
   // Otherwise, treat everything as unpinged.
   // TODO(honghaiz): Instead of adding two separate vectors, we can add a state
   // "pinged" to filter out unpinged connections.
-  if (absl::c_none_of(unpinged_connections_,
-                      [this, now](const Connection* conn) {
-                        return this->IsPingable(conn, now);
-                      })) {
+  // Among un-pinged pingable connections, "more pingable" takes precedence.
+  const Connection* most_pingable = FindMostPingableConnection(now);
+  if (!most_pingable) {
     unpinged_connections_.insert(pinged_connections_.begin(),
                                  pinged_connections_.end());
     pinged_connections_.clear();
+    most_pingable = FindMostPingableConnection(now);
   }
+  return most_pingable;
+}
 
-  // Among un-pinged pingable connections, "more pingable" takes precedence.
-  std::vector<const Connection*> pingable_connections;
-  absl::c_copy_if(
-      unpinged_connections_, std::back_inserter(pingable_connections),
-      [this, now](const Connection* conn) { return IsPingable(conn, now); });
-  auto iter = absl::c_max_element(
-      pingable_connections,
-      [this](const Connection* conn1, const Connection* conn2) {
-        // Some implementations of max_element
-        // compare an element with itself.
-        if (conn1 == conn2) {
-          return false;
-        }
-        return MorePingable(conn1, conn2) == conn2;
-      });
-  if (iter != pingable_connections.end()) {
-    return *iter;
+const Connection* BasicIceController::FindMostPingableConnection(int64_t now) {
+  const Connection* most_pingable = nullptr;
+  for (const Connection* conn : unpinged_connections_) {
+    if (IsPingable(conn, now) &&
+        (!most_pingable || MorePingable(most_pingable, conn) == conn)) {
+      most_pingable = conn;
+    }
   }
-  return nullptr;
+  return most_pingable;
 }
 
 // Find "triggered checks".  We ping first those connections that have
@@ -527,9 +543,10 @@ BasicIceController::SortAndSwitchConnection(IceControllerEvent reason) {
   // that amongst equal preference, writable connections, this will choose the
   // one whose estimated latency is lowest.  So it is the only one that we
   // need to consider switching to.
-  // TODO(honghaiz): Don't sort;  Just use std::max_element in the right places.
-  absl::c_stable_sort(
-      connections_, [this](const Connection* a, const Connection* b) {
+  // The connections are kept sorted, so only those whose state changed since
+  // the last sort need to be moved.
+  StableSortNearlySorted(
+      &connections_, [this](const Connection* a, const Connection* b) {
         int cmp = CompareConnections(a, b, absl::nullopt, nullptr);
         if (cmp != 0) {
           return cmp > 0;
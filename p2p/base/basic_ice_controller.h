@@ -79,6 +79,9 @@ class BasicIceController : public IceControllerInterface {
   }
 
   const Connection* FindOldestConnectionNeedingTriggeredCheck(int64_t now);
+  // Returns the pingable connection in |unpinged_connections_| that should be
+  // pinged first, or null if none of them is pingable.
+  const Connection* FindMostPingableConnection(int64_t now);
   // Between |conn1| and |conn2|, this function returns the one which should
   // be pinged first.
   const Connection* MorePingable(const Connection* conn1,
@@ -147,7 +150,9 @@ class BasicIceController : public IceControllerInterface {
   const IceFieldTrials* field_trials_;
 
   // |connections_| is a sorted list with the first one always be the
-  // |selected_connection_| when it's not nullptr. The combination of
+  // |selected_connection_| when it's not nullptr. It stays sorted between
+  // calls to SortAndSwitchConnection(), except for the connections whose
+  // state changed since. The combination of
   // |pinged_connections_| and |unpinged_connections_| has the same
   // connections as |connections_|. These 2 sets maintain whether a
   // connection should be pinged next or not.
@@ -444,20 +444,24 @@ bool Port::GetStunMessage(const char* data,
                           const rtc::SocketAddress& addr,
                           std::unique_ptr<IceMessage>* out_msg,
                           std::string* out_username) {
-  // NOTE: This could clearly be optimized to avoid allocating any memory.
-  //       However, at the data rates we'll be looking at on the client side,
-  //       this probably isn't worth worrying about.
   RTC_DCHECK(out_msg != NULL);
   RTC_DCHECK(out_username != NULL);
   out_username->clear();
 
-  // Don't bother parsing the packet if we can tell it's not STUN.
+  // Don't bother parsing the packet if we can tell it's not STUN. The
+  // FINGERPRINT and MESSAGE-INTEGRITY checks are done on a view of the packet,
+  // which locates the attributes once and does not copy the packet.
+  StunMessageView view;
+  if (!view.Parse(data, size)) {
+    return false;
+  }
+
   // In ICE mode, all STUN packets will have a valid fingerprint.
   // Except GOOG_PING_REQUEST/RESPONSE that does not send fingerprint.
   int types[] = {GOOG_PING_REQUEST, GOOG_PING_RESPONSE,
                  GOOG_PING_ERROR_RESPONSE};
   if (!StunMessage::IsStunMethod(types, data, size) &&
-      !StunMessage::ValidateFingerprint(data, size)) {
+      !view.ValidateFingerprint()) {
     return false;
   }
 
@@ -498,7 +502,7 @@ bool Port::GetStunMessage(const char* data,
     }
 
     // If ICE, and the MESSAGE-INTEGRITY is bad, fail with a 401 Unauthorized
-    if (!stun_msg->ValidateMessageIntegrity(data, size, password_)) {
+    if (!view.ValidateMessageIntegrity(password_)) {
       RTC_LOG(LS_ERROR) << ToString() << ": Received "
                         << StunMethodToString(stun_msg->type())
                         << " with bad M-I from " << addr.ToSensitiveString()
@@ -537,7 +541,7 @@ bool Port::GetStunMessage(const char* data,
     // No stun attributes will be verified, if it's stun indication message.
     // Returning from end of the this method.
   } else if (stun_msg->type() == GOOG_PING_REQUEST) {
-    if (!stun_msg->ValidateMessageIntegrity32(data, size, password_)) {
+    if (!view.ValidateMessageIntegrity32(password_)) {
       RTC_LOG(LS_ERROR) << ToString() << ": Received "
                         << StunMethodToString(stun_msg->type())
                         << " with bad M-I from " << addr.ToSensitiveString()
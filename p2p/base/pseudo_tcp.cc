@@ -114,6 +114,15 @@ const uint32_t DEF_ACK_DELAY = 100;  // 100 milliseconds
 
 const uint8_t FLAG_CTL = 0x02;
 const uint8_t FLAG_RST = 0x04;
+// Set on acks that carry SACK blocks instead of data. Each block is a pair
+// of 32-bit sequence numbers: the first byte received and the byte after the
+// last one.
+const uint8_t FLAG_SACK = 0x08;
+
+// Maximum number of SACK blocks per ack. The blocks nearest to the
+// cumulative ack are sent, since those are the holes retransmitted first.
+const uint32_t MAX_SACK_BLOCKS = 4;
+const uint32_t SACK_BLOCK_SIZE = 8;
 
 const uint8_t CTL_CONNECT = 0;
 
@@ -122,6 +131,7 @@ const uint8_t TCP_OPT_EOL = 0;        // End of list.
 const uint8_t TCP_OPT_NOOP = 1;       // No-op.
 const uint8_t TCP_OPT_MSS = 2;        // Maximum segment size.
 const uint8_t TCP_OPT_WND_SCALE = 3;  // Window scale factor.
+const uint8_t TCP_OPT_SACK_PERMITTED = 4;  // Selective acks understood.
 
 const long DEFAULT_TIMEOUT =
     4000;  // If there are no pending clocks, wake up every 4 seconds
@@ -156,6 +166,32 @@ inline uint16_t bytes_to_short(const void* buf) {
   return rtc::NetworkToHost16(*static_cast<const uint16_t*>(buf));
 }
 
+//////////////////////////////////////////////////////////////////////
+// NewReno congestion control
+//////////////////////////////////////////////////////////////////////
+
+class NewRenoCongestionControl : public IPseudoTcpCongestionControl {
+ public:
+  uint32_t OnAck(uint32_t cwnd,
+                 uint32_t ssthresh,
+                 uint32_t acked,
+                 uint32_t mss,
+                 uint32_t now) override {
+    // Slow start, congestion avoidance
+    if (cwnd < ssthresh) {
+      return cwnd + mss;
+    }
+    return cwnd + std::max<uint32_t>(1, mss * mss / cwnd);
+  }
+
+  uint32_t OnLoss(uint32_t cwnd,
+                  uint32_t in_flight,
+                  uint32_t mss,
+                  uint32_t now) override {
+    return std::max(in_flight / 2, 2 * mss);
+  }
+};
+
 //////////////////////////////////////////////////////////////////////
 // Debugging Statistics
 //////////////////////////////////////////////////////////////////////
@@ -245,6 +281,12 @@ PseudoTcp::PseudoTcp(IPseudoTcpNotify* notify, uint32_t conv)
 
   m_dup_acks = 0;
   m_recover = 0;
+  m_congestion_control = std::make_unique<NewRenoCongestionControl>();
+
+  m_support_sack = false;
+  m_sack_enabled = false;
+  m_sack_high = m_sack_rexmit = 0;
+  m_retransmits = 0;
 
   m_ts_recent = m_ts_lastack = 0;
 
@@ -297,13 +339,16 @@ void PseudoTcp::NotifyClock(uint32_t now) {
                        << ") (dup_acks: " << static_cast<unsigned>(m_dup_acks)
                        << ")";
 #endif  // _DEBUGMSG
+      // Retransmissions made during recovery may have been lost as well, and
+      // the peer is allowed to discard data it has SACKed.
+      clearScoreboard();
       if (!transmit(m_slist.begin(), now)) {
         closedown(ECONNABORTED);
         return;
       }
 
       uint32_t nInFlight = m_snd_nxt - m_snd_una;
-      m_ssthresh = std::max(nInFlight / 2, 2 * m_mss);
+      m_ssthresh = m_congestion_control->OnLoss(m_cwnd, nInFlight, m_mss, now);
       // RTC_LOG(LS_INFO) << "m_ssthresh: " << m_ssthresh << "  nInFlight: " <<
       // nInFlight << "  m_mss: " << m_mss;
       m_cwnd = m_mss;
@@ -373,6 +418,8 @@ void PseudoTcp::GetOption(Option opt, int* value) {
     *value = m_sbuf_len;
   } else if (opt == OPT_RCVBUF) {
     *value = m_rbuf_len;
+  } else if (opt == OPT_SACK) {
+    *value = m_support_sack ? 1 : 0;
   } else {
     RTC_NOTREACHED();
   }
@@ -388,11 +435,21 @@ void PseudoTcp::SetOption(Option opt, int value) {
   } else if (opt == OPT_RCVBUF) {
     RTC_DCHECK(m_state == TCP_LISTEN);
     resizeReceiveBuffer(value);
+  } else if (opt == OPT_SACK) {
+    RTC_DCHECK(m_state == TCP_LISTEN);
+    m_support_sack = value != 0;
   } else {
     RTC_NOTREACHED();
   }
 }
 
+void PseudoTcp::SetCongestionControl(
+    std::unique_ptr<IPseudoTcpCongestionControl> congestion_control) {
+  RTC_DCHECK(m_state == TCP_LISTEN);
+  RTC_DCHECK(congestion_control);
+  m_congestion_control = std::move(congestion_control);
+}
+
 uint32_t PseudoTcp::GetCongestionWindow() const {
   return m_cwnd;
 }
@@ -538,6 +595,34 @@ IPseudoTcpNotify::WriteResult PseudoTcp::packet(uint32_t seq,
     RTC_DCHECK(static_cast<uint32_t>(bytes_read) == len);
   }
 
+  // Report the out-of-order data on acks, merging adjacent and overlapping
+  // segments into blocks.
+  uint32_t sack_len = 0;
+  if (!len && m_sack_enabled && !m_rlist.empty()) {
+    uint8_t* block = buffer.get() + HEADER_SIZE;
+    uint32_t start = m_rlist.front().seq;
+    uint32_t end = start;
+    for (const RSegment& rseg : m_rlist) {
+      if (rseg.seq > end) {
+        long_to_bytes(start, block);
+        long_to_bytes(end, block + 4);
+        block += SACK_BLOCK_SIZE;
+        sack_len += SACK_BLOCK_SIZE;
+        if (sack_len == MAX_SACK_BLOCKS * SACK_BLOCK_SIZE) {
+          break;
+        }
+        start = rseg.seq;
+      }
+      end = std::max(end, rseg.seq + rseg.len);
+    }
+    if (sack_len < MAX_SACK_BLOCKS * SACK_BLOCK_SIZE) {
+      long_to_bytes(start, block);
+      long_to_bytes(end, block + 4);
+      sack_len += SACK_BLOCK_SIZE;
+    }
+    buffer[13] |= FLAG_SACK;
+  }
+
 #if _DEBUGMSG >= _DBG_VERBOSE
   RTC_LOG(LS_INFO) << "<-- <CONV=" << m_conv
                    << "><FLG=" << static_cast<unsigned>(flags)
@@ -549,7 +634,8 @@ IPseudoTcpNotify::WriteResult PseudoTcp::packet(uint32_t seq,
 #endif  // _DEBUGMSG
 
   IPseudoTcpNotify::WriteResult wres = m_notify->TcpWritePacket(
-      this, reinterpret_cast<char*>(buffer.get()), len + HEADER_SIZE);
+      this, reinterpret_cast<char*>(buffer.get()),
+      len + sack_len + HEADER_SIZE);
   // Note: When len is 0, this is an ACK packet.  We don't read the return value
   // for those, and thus we won't retry.  So go ahead and treat the packet as a
   // success (basically simulate as if it were dropped), which will prevent our
@@ -584,6 +670,19 @@ bool PseudoTcp::parse(const uint8_t* buffer, uint32_t size) {
   seg.data = reinterpret_cast<const char*>(buffer) + HEADER_SIZE;
   seg.len = size - HEADER_SIZE;
 
+  // SACK blocks are carried in place of data.
+  seg.sack = nullptr;
+  seg.sack_blocks = 0;
+  if (seg.flags & FLAG_SACK) {
+    if (seg.len % SACK_BLOCK_SIZE != 0) {
+      RTC_LOG_F(LS_WARNING) << "Invalid SACK blocks";
+      return false;
+    }
+    seg.sack = seg.data;
+    seg.sack_blocks = seg.len / SACK_BLOCK_SIZE;
+    seg.len = 0;
+  }
+
 #if _DEBUGMSG >= _DBG_VERBOSE
   RTC_LOG(LS_INFO) << "--> <CONV=" << seg.conv
                    << "><FLG=" << static_cast<unsigned>(seg.flags)
@@ -704,6 +803,10 @@ bool PseudoTcp::process(Segment& seg) {
     m_ts_recent = seg.tsval;
   }
 
+  if (seg.sack_blocks && m_sack_enabled) {
+    updateScoreboard(seg);
+  }
+
   // Check if this is a valuable ack
   if ((seg.ack > m_snd_una) && (seg.ack <= m_snd_nxt)) {
     // Calculate round-trip time
@@ -767,20 +870,22 @@ bool PseudoTcp::process(Segment& seg) {
 #if _DEBUGMSG >= _DBG_NORMAL
         RTC_LOG(LS_INFO) << "recovery retransmit";
 #endif  // _DEBUGMSG
-        if (!transmit(m_slist.begin(), now)) {
-          closedown(ECONNABORTED);
-          return false;
+        // With SACK the first hole may have been retransmitted already, in
+        // which case the next one is.
+        SList::iterator hole = m_sack_enabled ? nextHole() : m_slist.begin();
+        if (hole != m_slist.end()) {
+          if (!transmit(hole, now)) {
+            closedown(ECONNABORTED);
+            return false;
+          }
+          m_sack_rexmit = hole->seq + hole->len;
         }
         m_cwnd += m_mss - std::min(nAcked, m_cwnd);
       }
     } else {
       m_dup_acks = 0;
-      // Slow start, congestion avoidance
-      if (m_cwnd < m_ssthresh) {
-        m_cwnd += m_mss;
-      } else {
-        m_cwnd += std::max<uint32_t>(1, m_mss * m_mss / m_cwnd);
-      }
+      m_cwnd = m_congestion_control->OnAck(m_cwnd, m_ssthresh, nAcked, m_mss,
+                                           now);
     }
   } else if (seg.ack == m_snd_una) {
     // !?! Note, tcp says don't do this... but otherwise how does a closed
@@ -802,13 +907,27 @@ bool PseudoTcp::process(Segment& seg) {
           return false;
         }
         m_recover = m_snd_nxt;
+        m_sack_rexmit = m_slist.front().seq + m_slist.front().len;
         uint32_t nInFlight = m_snd_nxt - m_snd_una;
-        m_ssthresh = std::max(nInFlight / 2, 2 * m_mss);
+        m_ssthresh =
+            m_congestion_control->OnLoss(m_cwnd, nInFlight, m_mss, now);
         // RTC_LOG(LS_INFO) << "m_ssthresh: " << m_ssthresh << "  nInFlight: "
         // << nInFlight << "  m_mss: " << m_mss;
         m_cwnd = m_ssthresh + 3 * m_mss;
       } else if (m_dup_acks > 3) {
-        m_cwnd += m_mss;
+        // Each further duplicate ack means a segment has left the network.
+        // With SACK, use it to repair the next hole rather than to send new
+        // data.
+        SList::iterator hole = m_sack_enabled ? nextHole() : m_slist.end();
+        if (hole != m_slist.end()) {
+          if (!transmit(hole, now)) {
+            closedown(ECONNABORTED);
+            return false;
+          }
+          m_sack_rexmit = hole->seq + hole->len;
+        } else {
+          m_cwnd += m_mss;
+        }
       }
     } else {
       m_dup_acks = 0;
@@ -1040,6 +1159,7 @@ bool PseudoTcp::transmit(const SList::iterator& seg, uint32_t now) {
     SSegment subseg(seg->seq + nTransmit, seg->len - nTransmit, seg->bCtrl);
     // subseg.tstamp = seg->tstamp;
     subseg.xmit = seg->xmit;
+    subseg.bSacked = seg->bSacked;
     seg->len = nTransmit;
 
     SList::iterator next = seg;
@@ -1048,6 +1168,8 @@ bool PseudoTcp::transmit(const SList::iterator& seg, uint32_t now) {
 
   if (seg->xmit == 0) {
     m_snd_nxt += seg->len;
+  } else {
+    ++m_retransmits;
   }
   seg->xmit += 1;
   // seg->tstamp = now;
@@ -1058,6 +1180,49 @@ bool PseudoTcp::transmit(const SList::iterator& seg, uint32_t now) {
   return true;
 }
 
+void PseudoTcp::updateScoreboard(const Segment& seg) {
+  for (uint32_t i = 0; i < seg.sack_blocks; ++i) {
+    const char* block = seg.sack + i * SACK_BLOCK_SIZE;
+    uint32_t start = bytes_to_long(block);
+    uint32_t end = bytes_to_long(block + 4);
+    if ((start >= end) || (end > m_snd_nxt)) {
+      continue;
+    }
+    m_sack_high = std::max(m_sack_high, end);
+    for (SSegment& sseg : m_slist) {
+      if ((sseg.xmit == 0) || (sseg.seq >= end)) {
+        break;
+      }
+      if ((sseg.seq >= start) && (sseg.seq + sseg.len <= end)) {
+        sseg.bSacked = true;
+      }
+    }
+  }
+}
+
+void PseudoTcp::clearScoreboard() {
+  for (SSegment& sseg : m_slist) {
+    sseg.bSacked = false;
+  }
+  m_sack_high = m_sack_rexmit = m_snd_una;
+}
+
+PseudoTcp::SList::iterator PseudoTcp::nextHole() {
+  // The first unacknowledged segment is a hole unless it has been
+  // retransmitted already; later ones only if data above them was SACKed.
+  for (SList::iterator it = m_slist.begin();
+       (it != m_slist.end()) && (it->xmit > 0); ++it) {
+    if (it->bSacked || (it->seq < m_sack_rexmit)) {
+      continue;
+    }
+    if ((it == m_slist.begin()) || (it->seq < m_sack_high)) {
+      return it;
+    }
+    break;
+  }
+  return m_slist.end();
+}
+
 void PseudoTcp::attemptSend(SendFlags sflags) {
   uint32_t now = Now();
 
@@ -1189,6 +1354,14 @@ void PseudoTcp::disableWindowScale() {
   m_support_wnd_scale = false;
 }
 
+bool PseudoTcp::isSackEnabled() const {
+  return m_sack_enabled;
+}
+
+uint32_t PseudoTcp::retransmitCount() const {
+  return m_retransmits;
+}
+
 void PseudoTcp::queueConnectMessage() {
   rtc::ByteBufferWriter buf;
 
@@ -1198,6 +1371,10 @@ void PseudoTcp::queueConnectMessage() {
     buf.WriteUInt8(1);
     buf.WriteUInt8(m_rwnd_scale);
   }
+  if (m_support_sack) {
+    buf.WriteUInt8(TCP_OPT_SACK_PERMITTED);
+    buf.WriteUInt8(0);
+  }
   m_snd_wnd = static_cast<uint32_t>(buf.Length());
   queue(buf.Data(), static_cast<uint32_t>(buf.Length()), true);
 }
@@ -1246,6 +1423,10 @@ void PseudoTcp::parseOptions(const char* data, uint32_t len) {
       m_swnd_scale = 0;
     }
   }
+
+  m_sack_enabled =
+      m_support_sack && (options_specified.find(TCP_OPT_SACK_PERMITTED) !=
+                         options_specified.end());
 }
 
 void PseudoTcp::applyOption(char kind, const char* data, uint32_t len) {
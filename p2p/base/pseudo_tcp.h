@@ -15,6 +15,7 @@
 #include <stdint.h>
 
 #include <list>
+#include <memory>
 
 #include "rtc_base/memory/fifo_buffer.h"
 #include "rtc_base/system/rtc_export.h"
@@ -45,6 +46,34 @@ class IPseudoTcpNotify {
   virtual ~IPseudoTcpNotify() {}
 };
 
+//////////////////////////////////////////////////////////////////////
+// IPseudoTcpCongestionControl
+//////////////////////////////////////////////////////////////////////
+
+// Decides how the congestion window grows and how much it is cut on loss.
+// Fast retransmit and the window inflation during recovery are handled by
+// PseudoTcp itself. The default is NewReno (RFC 6582).
+class IPseudoTcpCongestionControl {
+ public:
+  virtual ~IPseudoTcpCongestionControl() {}
+
+  // Returns the congestion window to use after |acked| new bytes have been
+  // acknowledged outside of loss recovery.
+  virtual uint32_t OnAck(uint32_t cwnd,
+                         uint32_t ssthresh,
+                         uint32_t acked,
+                         uint32_t mss,
+                         uint32_t now) = 0;
+
+  // Returns the slow start threshold to use after a loss has been detected,
+  // by duplicate acks or by a retransmission timeout, with |in_flight| bytes
+  // not acknowledged.
+  virtual uint32_t OnLoss(uint32_t cwnd,
+                          uint32_t in_flight,
+                          uint32_t mss,
+                          uint32_t now) = 0;
+};
+
 //////////////////////////////////////////////////////////////////////
 // PseudoTcp
 //////////////////////////////////////////////////////////////////////
@@ -90,17 +119,24 @@ class RTC_EXPORT PseudoTcp {
   // instance's behaviour for the kind of data it will carry.
   // If an unrecognized option is set or got, an assertion will fire.
   //
-  // Setting options for OPT_RCVBUF or OPT_SNDBUF after Connect() is called
-  // will result in an assertion.
+  // Setting options for OPT_RCVBUF, OPT_SNDBUF or OPT_SACK after Connect() is
+  // called will result in an assertion.
   enum Option {
     OPT_NODELAY,   // Whether to enable Nagle's algorithm (0 == off)
     OPT_ACKDELAY,  // The Delayed ACK timeout (0 == off).
     OPT_RCVBUF,    // Set the receive buffer size, in bytes.
     OPT_SNDBUF,    // Set the send buffer size, in bytes.
+    OPT_SACK,      // Whether to offer selective acknowledgements (0 == off).
+                   // They are used only if both sides offer them.
   };
   void GetOption(Option opt, int* value);
   void SetOption(Option opt, int value);
 
+  // Replaces the default NewReno congestion control. Must be called before
+  // Connect().
+  void SetCongestionControl(
+      std::unique_ptr<IPseudoTcpCongestionControl> congestion_control);
+
   // Returns current congestion window in bytes.
   uint32_t GetCongestionWindow() const;
 
@@ -125,15 +161,20 @@ class RTC_EXPORT PseudoTcp {
     const char* data;
     uint32_t len;
     uint32_t tsval, tsecr;
+    // SACK blocks, as pairs of 32-bit sequence numbers in network order.
+    const char* sack;
+    uint32_t sack_blocks;
   };
 
   struct SSegment {
     SSegment(uint32_t s, uint32_t l, bool c)
-        : seq(s), len(l), /*tstamp(0),*/ xmit(0), bCtrl(c) {}
+        : seq(s), len(l), /*tstamp(0),*/ xmit(0), bCtrl(c), bSacked(false) {}
     uint32_t seq, len;
     // uint32_t tstamp;
     uint8_t xmit;
     bool bCtrl;
+    // Whether the peer has reported this segment in a SACK block.
+    bool bSacked;
   };
   typedef std::list<SSegment> SList;
 
@@ -166,6 +207,17 @@ class RTC_EXPORT PseudoTcp {
   bool process(Segment& seg);
   bool transmit(const SList::iterator& seg, uint32_t now);
 
+  // Marks the segments covered by the SACK blocks of |seg|.
+  void updateScoreboard(const Segment& seg);
+
+  // Forgets what the peer has reported and what was retransmitted, so that
+  // recovery after a timeout starts from |m_snd_una| again.
+  void clearScoreboard();
+
+  // Returns the next segment to retransmit during loss recovery, or
+  // m_slist.end() if there is none.
+  SList::iterator nextHole();
+
   void adjustMTU();
 
  protected:
@@ -176,6 +228,11 @@ class RTC_EXPORT PseudoTcp {
   // support for testing backward compatibility.
   void disableWindowScale();
 
+  // These methods are only used in tests, to check how losses are recovered
+  // from.
+  bool isSackEnabled() const;
+  uint32_t retransmitCount() const;
+
  private:
   // Queue the connect message with TCP options.
   void queueConnectMessage();
@@ -235,6 +292,16 @@ class RTC_EXPORT PseudoTcp {
   uint8_t m_dup_acks;
   uint32_t m_recover;
   uint32_t m_t_ack;
+  std::unique_ptr<IPseudoTcpCongestionControl> m_congestion_control;
+
+  // Selective acknowledgements. |m_sack_high| is the highest sequence number
+  // the peer has reported, and segments below |m_sack_rexmit| have been
+  // retransmitted in the current recovery.
+  bool m_support_sack, m_sack_enabled;
+  uint32_t m_sack_high, m_sack_rexmit;
+
+  // Number of segments sent more than once.
+  uint32_t m_retransmits;
 
   // Configuration options
   bool m_use_nagling;
@@ -0,0 +1,208 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+
+#include "api/units/time_delta.h"
+#include "p2p/base/pseudo_tcp.h"
+#include "rtc_base/async_packet_socket.h"
+#include "rtc_base/async_udp_socket.h"
+#include "rtc_base/fake_clock.h"
+#include "rtc_base/location.h"
+#include "rtc_base/message_handler.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/third_party/sigslot/sigslot.h"
+#include "rtc_base/time_utils.h"
+#include "rtc_base/virtual_socket_server.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace cricket {
+namespace {
+
+const rtc::SocketAddress kSenderAddress("11.11.11.11", 5000);
+const rtc::SocketAddress kReceiverAddress("22.22.22.22", 5000);
+const uint16_t kMtu = 1500;
+const int kReceiveBufferSize = 1000000;
+const int kSendBufferSize = 1500000;
+const int kTransferSize = 2000000;
+const int kBlockSize = 16384;
+const int kTimeoutMs = 300000;
+
+// A PseudoTcp over a UDP socket on a VirtualSocketServer. Clocks are driven
+// by messages posted to the current thread, as a real application would. If
+// |sends_data| is true, the endpoint writes |kTransferSize| bytes once
+// connected.
+class Endpoint : public IPseudoTcpNotify,
+                 public rtc::MessageHandler,
+                 public sigslot::has_slots<> {
+ public:
+  Endpoint(rtc::VirtualSocketServer* vss,
+           const rtc::SocketAddress& address,
+           const rtc::SocketAddress& remote_address,
+           bool sack,
+           bool sends_data)
+      : socket_(rtc::AsyncUDPSocket::Create(vss, address)),
+        remote_address_(remote_address),
+        sends_data_(sends_data),
+        tcp_(this, 1) {
+    socket_->SignalReadPacket.connect(this, &Endpoint::OnReadPacket);
+    tcp_.NotifyMTU(kMtu);
+    tcp_.SetOption(PseudoTcp::OPT_RCVBUF, kReceiveBufferSize);
+    tcp_.SetOption(PseudoTcp::OPT_SNDBUF, kSendBufferSize);
+    tcp_.SetOption(PseudoTcp::OPT_SACK, sack);
+  }
+
+  void Connect() {
+    tcp_.Connect();
+    UpdateClock();
+  }
+
+  int bytes_received() const { return bytes_received_; }
+
+ private:
+  // IPseudoTcpNotify implementation.
+  void OnTcpOpen(PseudoTcp* tcp) override { OnTcpWriteable(tcp); }
+  void OnTcpReadable(PseudoTcp* tcp) override {
+    char block[kBlockSize];
+    int read;
+    while ((read = tcp_.Recv(block, sizeof(block))) > 0) {
+      bytes_received_ += read;
+    }
+  }
+  void OnTcpWriteable(PseudoTcp* tcp) override {
+    if (!sends_data_) {
+      return;
+    }
+    const std::string block(kBlockSize, 'x');
+    while (bytes_sent_ < kTransferSize) {
+      int sent = tcp_.Send(block.data(),
+                           std::min(kBlockSize, kTransferSize - bytes_sent_));
+      if (sent <= 0) {
+        break;
+      }
+      bytes_sent_ += sent;
+    }
+    UpdateClock();
+  }
+  void OnTcpClosed(PseudoTcp* tcp, uint32_t error) override {}
+  WriteResult TcpWritePacket(PseudoTcp* tcp,
+                             const char* buffer,
+                             size_t len) override {
+    // Lost packets are dropped by the VirtualSocketServer.
+    socket_->SendTo(buffer, len, remote_address_, rtc::PacketOptions());
+    return WR_SUCCESS;
+  }
+
+  // rtc::MessageHandler implementation.
+  void OnMessage(rtc::Message* message) override {
+    tcp_.NotifyClock(PseudoTcp::Now());
+    UpdateClock();
+  }
+
+  void OnReadPacket(rtc::AsyncPacketSocket* socket,
+                    const char* data,
+                    size_t size,
+                    const rtc::SocketAddress& remote_addr,
+                    const int64_t& packet_time_us) {
+    tcp_.NotifyPacket(data, size);
+    UpdateClock();
+  }
+
+  void UpdateClock() {
+    long interval = 0;  // NOLINT
+    tcp_.GetNextClock(PseudoTcp::Now(), interval);
+    rtc::Thread::Current()->Clear(this);
+    rtc::Thread::Current()->PostDelayed(RTC_FROM_HERE,
+                                        std::max<long>(interval, 0L), this);
+  }
+
+  std::unique_ptr<rtc::AsyncPacketSocket> socket_;
+  const rtc::SocketAddress remote_address_;
+  const bool sends_data_;
+  PseudoTcp tcp_;
+  int bytes_sent_ = 0;
+  int bytes_received_ = 0;
+};
+
+// Sends |kTransferSize| bytes over a network with a fixed one way delay and
+// random loss, in simulated time.
+class Transfer {
+ public:
+  Transfer(int delay_ms, double loss, bool sack) : thread_(&vss_) {
+    // PseudoTcp treats a timestamp of zero as unset.
+    clock_.AdvanceTime(webrtc::TimeDelta::seconds(1));
+    vss_.set_delay_mean(delay_ms);
+    vss_.UpdateDelayDistribution();
+    vss_.set_drop_probability(loss);
+    sender_ = std::make_unique<Endpoint>(&vss_, kSenderAddress,
+                                         kReceiverAddress, sack,
+                                         /*sends_data=*/true);
+    receiver_ = std::make_unique<Endpoint>(&vss_, kReceiverAddress,
+                                           kSenderAddress, sack,
+                                           /*sends_data=*/false);
+  }
+
+  // Returns the goodput in kbps, or 0 if the transfer did not complete.
+  double MeasureGoodputKbps() {
+    const int64_t start_ms = rtc::TimeMillis();
+    sender_->Connect();
+    while (receiver_->bytes_received() < kTransferSize &&
+           rtc::TimeMillis() - start_ms < kTimeoutMs) {
+      clock_.AdvanceTime(webrtc::TimeDelta::ms(1));
+    }
+    EXPECT_EQ(kTransferSize, receiver_->bytes_received());
+    if (receiver_->bytes_received() < kTransferSize) {
+      return 0;
+    }
+    const int64_t elapsed_ms = rtc::TimeMillis() - start_ms;
+    return 8.0 * kTransferSize / elapsed_ms;
+  }
+
+ private:
+  rtc::ScopedFakeClock clock_;
+  rtc::VirtualSocketServer vss_;
+  rtc::AutoSocketServerThread thread_;
+  std::unique_ptr<Endpoint> sender_;
+  std::unique_ptr<Endpoint> receiver_;
+};
+
+void RunTransfer(int delay_ms, int loss_percent) {
+  const std::string trace = "delay_" + std::to_string(delay_ms) + "ms_loss_" +
+                            std::to_string(loss_percent) + "pct";
+  for (bool sack : {false, true}) {
+    Transfer transfer(delay_ms, loss_percent / 100.0, sack);
+    webrtc::test::PrintResult("pseudo_tcp_goodput", sack ? "_sack" : "", trace,
+                              transfer.MeasureGoodputKbps(), "kbps",
+                              /*important=*/false,
+                              webrtc::test::ImproveDirection::kBiggerIsBetter);
+  }
+}
+
+}  // namespace
+
+TEST(PseudoTcpPerfTest, GoodputWithoutLoss) {
+  RunTransfer(/*delay_ms=*/25, /*loss_percent=*/0);
+}
+
+TEST(PseudoTcpPerfTest, GoodputWithLoss) {
+  RunTransfer(/*delay_ms=*/25, /*loss_percent=*/1);
+  RunTransfer(/*delay_ms=*/25, /*loss_percent=*/5);
+}
+
+TEST(PseudoTcpPerfTest, GoodputWithLongDelayAndLoss) {
+  RunTransfer(/*delay_ms=*/100, /*loss_percent=*/1);
+}
+
+}  // namespace cricket
@@ -14,9 +14,14 @@
 
 #include <algorithm>
 #include <cstddef>
+#include <memory>
+#include <set>
 #include <string>
 #include <vector>
 
+#include "rtc_base/arraysize.h"
+#include "rtc_base/byte_order.h"
+#include "rtc_base/fake_clock.h"
 #include "rtc_base/gunit.h"
 #include "rtc_base/helpers.h"
 #include "rtc_base/location.h"
@@ -41,6 +46,38 @@ class PseudoTcpForTest : public cricket::PseudoTcp {
   bool isReceiveBufferFull() const { return PseudoTcp::isReceiveBufferFull(); }
 
   void disableWindowScale() { PseudoTcp::disableWindowScale(); }
+
+  bool isSackEnabled() const { return PseudoTcp::isSackEnabled(); }
+
+  uint32_t retransmitCount() const { return PseudoTcp::retransmitCount(); }
+};
+
+// Halves the congestion window on loss and grows it by one segment per ack,
+// counting how often it is consulted.
+class CountingCongestionControl : public cricket::IPseudoTcpCongestionControl {
+ public:
+  CountingCongestionControl(int* acks, int* losses)
+      : acks_(acks), losses_(losses) {}
+
+  uint32_t OnAck(uint32_t cwnd,
+                 uint32_t ssthresh,
+                 uint32_t acked,
+                 uint32_t mss,
+                 uint32_t now) override {
+    ++*acks_;
+    return cwnd + mss;
+  }
+  uint32_t OnLoss(uint32_t cwnd,
+                  uint32_t in_flight,
+                  uint32_t mss,
+                  uint32_t now) override {
+    ++*losses_;
+    return std::max(cwnd / 2, 2 * mss);
+  }
+
+ private:
+  int* const acks_;
+  int* const losses_;
 };
 
 class PseudoTcpTestBase : public ::testing::Test,
@@ -81,6 +118,10 @@ class PseudoTcpTestBase : public ::testing::Test,
   // Used to cause the initial "connect" segment to be lost, needed for a
   // regression test.
   void DropNextPacket() { drop_next_packet_ = true; }
+  // Drops the packets |local_| sends with these indices, counting from 0.
+  void DropLocalPackets(const std::set<int>& indices) {
+    local_packets_to_drop_ = indices;
+  }
   void SetOptNagling(bool enable_nagles) {
     local_.SetOption(PseudoTcp::OPT_NODELAY, !enable_nagles);
     remote_.SetOption(PseudoTcp::OPT_NODELAY, !enable_nagles);
@@ -99,6 +140,12 @@ class PseudoTcpTestBase : public ::testing::Test,
   void SetLocalOptRcvBuf(int size) {
     local_.SetOption(PseudoTcp::OPT_RCVBUF, size);
   }
+  void SetLocalOptSack(bool enable) {
+    local_.SetOption(PseudoTcp::OPT_SACK, enable);
+  }
+  void SetRemoteOptSack(bool enable) {
+    remote_.SetOption(PseudoTcp::OPT_SACK, enable);
+  }
   void DisableRemoteWindowScale() { remote_.disableWindowScale(); }
   void DisableLocalWindowScale() { local_.disableWindowScale(); }
 
@@ -162,6 +209,11 @@ class PseudoTcpTestBase : public ::testing::Test,
                           << len;
       return WR_SUCCESS;
     }
+    if (tcp == &local_ && local_packets_to_drop_.count(local_packets_sent_++)) {
+      RTC_LOG(LS_VERBOSE) << "Dropping packet due to DropLocalPackets, size="
+                          << len;
+      return WR_SUCCESS;
+    }
     // Randomly drop the desired percentage of packets.
     if (rtc::CreateRandomId() % 100 < static_cast<uint32_t>(loss_)) {
       RTC_LOG(LS_VERBOSE) << "Randomly dropping packet, size=" << len;
@@ -229,12 +281,15 @@ class PseudoTcpTestBase : public ::testing::Test,
   int delay_;
   int loss_;
   bool drop_next_packet_ = false;
+  std::set<int> local_packets_to_drop_;
+  int local_packets_sent_ = 0;
   bool simultaneous_open_ = false;
 };
 
 class PseudoTcpTest : public PseudoTcpTestBase {
  public:
-  void TestTransfer(int size) {
+  // Returns the time the transfer took, in milliseconds.
+  int32_t TestTransfer(int size) {
     uint32_t start;
     int32_t elapsed;
     size_t received;
@@ -250,10 +305,10 @@ class PseudoTcpTest : public PseudoTcpTestBase {
     // Connect and wait until connected.
     start = rtc::Time32();
     EXPECT_EQ(0, Connect());
-    EXPECT_TRUE_WAIT(have_connected_, kConnectTimeoutMs);
+    EXPECT_TRUE(Wait(&have_connected_, kConnectTimeoutMs));
     // Sending will start from OnTcpWriteable and complete when all data has
     // been received.
-    EXPECT_TRUE_WAIT(have_disconnected_, kTransferTimeoutMs);
+    EXPECT_TRUE(Wait(&have_disconnected_, kTransferTimeoutMs));
     elapsed = rtc::Time32() - start;
     recv_stream_.GetSize(&received);
     // Ensure we closed down OK and we got the right data.
@@ -265,6 +320,16 @@ class PseudoTcpTest : public PseudoTcpTestBase {
               memcmp(send_stream_.GetBuffer(), recv_stream_.GetBuffer(), size));
     RTC_LOG(LS_INFO) << "Transferred " << received << " bytes in " << elapsed
                      << " ms (" << size * 8 / elapsed << " Kbps)";
+    return elapsed;
+  }
+
+ protected:
+  // Processes messages until |*done| is set, or |timeout_ms| have passed.
+  // Returns |*done|.
+  virtual bool Wait(const bool* done, int timeout_ms) {
+    bool res;
+    WAIT_(*done, timeout_ms, res);
+    return res;
   }
 
  private:
@@ -765,6 +830,158 @@ TEST_F(PseudoTcpTest, TestSendVerySmallReceiveBuffer) {
   TestTransfer(100000);
 }
 
+// Test sending data with packet loss when both sides use selective acks.
+TEST_F(PseudoTcpTest, TestSendWithLossAndSack) {
+  SetLocalMtu(1500);
+  SetRemoteMtu(1500);
+  SetLoss(10);
+  SetLocalOptSack(true);
+  SetRemoteOptSack(true);
+  TestTransfer(100000);
+  EXPECT_TRUE(local_.isSackEnabled());
+  EXPECT_TRUE(remote_.isSackEnabled());
+}
+
+// Test sending data with a 50 ms RTT and 10% packet loss, so that several
+// segments are lost per window and recovered with selective acks.
+TEST_F(PseudoTcpTest, TestSendWithDelayAndLossAndSack) {
+  SetLocalMtu(1500);
+  SetRemoteMtu(1500);
+  SetDelay(50);
+  SetLoss(10);
+  SetLocalOptSack(true);
+  SetRemoteOptSack(true);
+  TestTransfer(100000);
+  EXPECT_TRUE(local_.isSackEnabled());
+  EXPECT_TRUE(remote_.isSackEnabled());
+}
+
+// Test that selective acks are not used when only one side offers them.
+TEST_F(PseudoTcpTest, TestSendWithLossAndSackOnOneSide) {
+  SetLocalMtu(1500);
+  SetRemoteMtu(1500);
+  SetLoss(10);
+  SetLocalOptSack(true);
+  TestTransfer(100000);
+  EXPECT_FALSE(local_.isSackEnabled());
+  EXPECT_FALSE(remote_.isSackEnabled());
+}
+
+// Indices of the packets lost, all in the same window.
+static const int kLostSegments[] = {50, 52, 54, 56, 58, 60, 62, 64};
+
+// Transfers data on a fake clock, over a link with a 100 ms RTT that loses the
+// packets of |local_| passed to DropLocalPackets().
+class PseudoTcpLossyTransferTest : public PseudoTcpTest {
+ protected:
+  static const int kRttMs = 100;
+
+  PseudoTcpLossyTransferTest() {
+    // |local_| and |remote_| have already read the real clock.
+    fake_clock_.SetTime(webrtc::Timestamp::us(rtc::SystemTimeNanos() / 1000));
+    local_.SetCongestionControl(
+        std::make_unique<CountingCongestionControl>(&acks_, &losses_));
+    SetLocalMtu(1500);
+    SetRemoteMtu(1500);
+    SetDelay(kRttMs / 2);
+  }
+
+  bool Wait(const bool* done, int timeout_ms) override {
+    bool res;
+    SIMULATED_WAIT_(*done, timeout_ms, res, fake_clock_);
+    return res;
+  }
+
+  // Records when |local_| sends a segment again, before applying the losses.
+  WriteResult TcpWritePacket(PseudoTcp* tcp,
+                             const char* buffer,
+                             size_t len) override {
+    // Past the 24 byte header of a data segment is its payload.
+    if (tcp == &local_ && len > 24) {
+      uint32_t seq = rtc::GetBE32(buffer + 4);
+      if (!sent_seqs_.insert(seq).second) {
+        retransmit_times_.push_back(rtc::TimeMillis());
+      }
+    }
+    return PseudoTcpTest::TcpWritePacket(tcp, buffer, len);
+  }
+
+  // Returns how many round trips passed between the first and the last
+  // retransmission.
+  int64_t RecoveryRoundTrips() const {
+    if (retransmit_times_.empty()) {
+      return 0;
+    }
+    return (retransmit_times_.back() - retransmit_times_.front()) / kRttMs;
+  }
+
+  rtc::ScopedFakeClock fake_clock_;
+  int acks_ = 0;
+  int losses_ = 0;
+  std::set<uint32_t> sent_seqs_;
+  std::vector<int64_t> retransmit_times_;
+};
+
+// Test that without selective acks the losses of a window are repaired one per
+// round trip.
+TEST_F(PseudoTcpLossyTransferTest, RepairsOneLossPerRoundTripWithoutSack) {
+  DropLocalPackets(std::set<int>(kLostSegments,
+                                 kLostSegments + arraysize(kLostSegments)));
+  TestTransfer(100000);
+  EXPECT_FALSE(local_.isSackEnabled());
+  // Only the lost segments are retransmitted, each once, in a single recovery.
+  EXPECT_EQ(arraysize(kLostSegments), local_.retransmitCount());
+  EXPECT_EQ(arraysize(kLostSegments), retransmit_times_.size());
+  EXPECT_EQ(1, losses_);
+  EXPECT_EQ(static_cast<int64_t>(arraysize(kLostSegments) - 1),
+            RecoveryRoundTrips());
+}
+
+// Test that selective acks repair the losses of a window in fewer round trips.
+TEST_F(PseudoTcpLossyTransferTest, RepairsLossesInFewerRoundTripsWithSack) {
+  DropLocalPackets(std::set<int>(kLostSegments,
+                                 kLostSegments + arraysize(kLostSegments)));
+  SetLocalOptSack(true);
+  SetRemoteOptSack(true);
+  TestTransfer(100000);
+  EXPECT_TRUE(local_.isSackEnabled());
+  EXPECT_EQ(arraysize(kLostSegments), local_.retransmitCount());
+  EXPECT_EQ(arraysize(kLostSegments), retransmit_times_.size());
+  EXPECT_EQ(1, losses_);
+  EXPECT_LE(RecoveryRoundTrips(), 2);
+}
+
+// Test that after a timeout, segments that were retransmitted during recovery
+// are sent again as soon as they are the next hole, rather than after another
+// timeout.
+TEST_F(PseudoTcpLossyTransferTest, ForgetsSackStateOnTimeout) {
+  std::set<int> lost(kLostSegments, kLostSegments + arraysize(kLostSegments));
+  // Also lose the retransmissions of the fifth and the seventh segment.
+  lost.insert(77);
+  lost.insert(79);
+  DropLocalPackets(lost);
+  SetLocalOptSack(true);
+  SetRemoteOptSack(true);
+  TestTransfer(100000);
+  EXPECT_EQ(arraysize(kLostSegments) + 2, local_.retransmitCount());
+  // One fast retransmit and a single timeout.
+  EXPECT_EQ(2, losses_);
+}
+
+// Test that a custom congestion control is used for the transfer.
+TEST_F(PseudoTcpTest, TestSendWithCustomCongestionControl) {
+  int acks = 0;
+  int losses = 0;
+  local_.SetCongestionControl(
+      std::make_unique<CountingCongestionControl>(&acks, &losses));
+  SetLocalMtu(1500);
+  SetRemoteMtu(1500);
+  SetLoss(10);
+  TestTransfer(100000);
+  EXPECT_GT(acks, 0);
+  EXPECT_GT(losses, 0);
+}
+
 // Ping-pong (request/response) tests
 
 // Test sending <= 1x MTU of data in each ping/pong.  Should take <10ms.
@@ -0,0 +1,147 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "p2p/base/sharded_turn_server.h"
+
+#include <utility>
+
+#include "p2p/base/basic_packet_socket_factory.h"
+#include "rtc_base/async_udp_socket.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/helpers.h"
+#include "rtc_base/logging.h"
+#include "rtc_base/socket_server.h"
+#include "rtc_base/string_encode.h"
+
+namespace cricket {
+
+namespace {
+const size_t kNonceKeySize = 16;
+}  // namespace
+
+ShardedTurnServer::ShardedTurnServer(size_t num_shards)
+    : ShardedTurnServer(num_shards, &rtc::SocketServer::CreateDefault) {}
+
+ShardedTurnServer::ShardedTurnServer(size_t num_shards,
+                                     SocketServerFactory socket_server_factory)
+    : num_shards_(num_shards),
+      socket_server_factory_(std::move(socket_server_factory)),
+      nonce_key_(rtc::CreateRandomString(kNonceKeySize)) {
+  RTC_DCHECK_GT(num_shards_, 0);
+}
+
+ShardedTurnServer::~ShardedTurnServer() {
+  RTC_DCHECK(thread_checker_.IsCurrent());
+  Stop();
+}
+
+void ShardedTurnServer::set_realm(const std::string& realm) {
+  RTC_DCHECK(thread_checker_.IsCurrent());
+  RTC_DCHECK(shards_.empty());
+  realm_ = realm;
+}
+
+void ShardedTurnServer::set_software(const std::string& software) {
+  RTC_DCHECK(thread_checker_.IsCurrent());
+  RTC_DCHECK(shards_.empty());
+  software_ = software;
+}
+
+void ShardedTurnServer::set_auth_hook(TurnAuthInterface* auth_hook) {
+  RTC_DCHECK(thread_checker_.IsCurrent());
+  RTC_DCHECK(shards_.empty());
+  auth_hook_ = auth_hook;
+}
+
+bool ShardedTurnServer::Start(const rtc::SocketAddress& internal_address,
+                              const rtc::IPAddress& external_ip) {
+  RTC_DCHECK(thread_checker_.IsCurrent());
+  RTC_DCHECK(shards_.empty());
+  internal_address_ = internal_address;
+  shards_.reserve(num_shards_);
+  for (size_t i = 0; i < num_shards_; ++i) {
+    // Only shards with a running thread are added, so that Stop() can clean
+    // up after a shard failing to start.
+    auto thread = std::make_unique<rtc::Thread>(socket_server_factory_());
+    thread->SetName("TurnServerShard" + rtc::ToString(i), nullptr);
+    thread->Start();
+    shards_.push_back({std::move(thread), nullptr});
+    Shard* shard = &shards_.back();
+    bool started = shard->thread->Invoke<bool>(RTC_FROM_HERE, [&] {
+      return StartShard(shard, internal_address_, external_ip);
+    });
+    if (!started) {
+      Stop();
+      return false;
+    }
+  }
+  return true;
+}
+
+void ShardedTurnServer::Stop() {
+  RTC_DCHECK(thread_checker_.IsCurrent());
+  for (Shard& shard : shards_) {
+    // The server must be destroyed on the thread it was created on.
+    if (shard.server) {
+      shard.thread->Invoke<void>(RTC_FROM_HERE, [&] { shard.server.reset(); });
+    }
+    shard.thread->Stop();
+  }
+  shards_.clear();
+}
+
+std::vector<size_t> ShardedTurnServer::GetAllocationCounts() {
+  RTC_DCHECK(thread_checker_.IsCurrent());
+  std::vector<size_t> counts;
+  for (Shard& shard : shards_) {
+    counts.push_back(shard.thread->Invoke<size_t>(
+        RTC_FROM_HERE, [&] { return shard.server->allocations().size(); }));
+  }
+  return counts;
+}
+
+bool ShardedTurnServer::StartShard(Shard* shard,
+                                   const rtc::SocketAddress& internal_address,
+                                   const rtc::IPAddress& external_ip) {
+  RTC_DCHECK(shard->thread->IsCurrent());
+  rtc::AsyncSocket* socket = shard->thread->socketserver()->CreateAsyncSocket(
+      internal_address.family(), SOCK_DGRAM);
+  if (!socket) {
+    return false;
+  }
+  if (socket->SetOption(rtc::Socket::OPT_REUSEPORT, 1) != 0 &&
+      num_shards_ > 1) {
+    RTC_LOG(LS_ERROR) << "Failed to set SO_REUSEPORT, error "
+                      << socket->GetError();
+    delete socket;
+    return false;
+  }
+  if (socket->Bind(internal_address) != 0) {
+    RTC_LOG(LS_ERROR) << "Failed to bind " << internal_address.ToString()
+                      << ", error " << socket->GetError();
+    delete socket;
+    return false;
+  }
+  // Let the remaining shards bind the port picked for the first one.
+  internal_address_ = socket->GetLocalAddress();
+
+  shard->server = std::make_unique<TurnServer>(shard->thread.get());
+  shard->server->set_realm(realm_);
+  shard->server->set_software(software_);
+  shard->server->set_auth_hook(auth_hook_);
+  shard->server->set_nonce_key(nonce_key_);
+  shard->server->AddInternalSocket(new rtc::AsyncUDPSocket(socket), PROTO_UDP);
+  shard->server->SetExternalSocketFactory(
+      new rtc::BasicPacketSocketFactory(shard->thread.get()),
+      rtc::SocketAddress(external_ip, 0));
+  return true;
+}
+
+}  // namespace cricket
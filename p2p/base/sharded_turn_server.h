@@ -0,0 +1,99 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef P2P_BASE_SHARDED_TURN_SERVER_H_
+#define P2P_BASE_SHARDED_TURN_SERVER_H_
+
+#include <stddef.h>
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "p2p/base/turn_server.h"
+#include "rtc_base/ip_address.h"
+#include "rtc_base/socket_address.h"
+#include "rtc_base/socket_server.h"
+#include "rtc_base/thread.h"
+#include "rtc_base/thread_checker.h"
+
+namespace cricket {
+
+// Runs one TurnServer per worker thread, all listening for UDP on the same
+// address. Each worker binds its own socket with SO_REUSEPORT, and the kernel
+// spreads incoming packets over the sockets by hashing the client's address,
+// so all packets of a client reach the same worker, which owns the
+// allocations created for it. The workers share nothing but the
+// authentication hook and the NONCE secret, so relaying scales with the
+// number of threads.
+//
+// Only available where the socket server supports OPT_REUSEPORT; Start()
+// fails otherwise when more than one shard is requested.
+class ShardedTurnServer {
+ public:
+  using SocketServerFactory =
+      std::function<std::unique_ptr<rtc::SocketServer>()>;
+
+  explicit ShardedTurnServer(size_t num_shards);
+  // |socket_server_factory| creates the socket server of each shard's thread.
+  ShardedTurnServer(size_t num_shards,
+                    SocketServerFactory socket_server_factory);
+  ~ShardedTurnServer();
+
+  // Configuration shared by all shards; must be set before Start().
+  void set_realm(const std::string& realm);
+  void set_software(const std::string& software);
+  // Does not take ownership. GetKey() is called from all worker threads, so
+  // the hook must be thread safe.
+  void set_auth_hook(TurnAuthInterface* auth_hook);
+
+  // Starts the worker threads, binds a UDP socket at |internal_address| on
+  // each of them, and relays from sockets bound to |external_ip|. If the port
+  // of |internal_address| is 0, the port picked for the first shard is used
+  // for all of them. Returns false, with no threads running, on failure.
+  bool Start(const rtc::SocketAddress& internal_address,
+             const rtc::IPAddress& external_ip);
+  // Stops the worker threads, destroying all allocations.
+  void Stop();
+
+  size_t num_shards() const { return num_shards_; }
+  // Address the shards listen on, once started.
+  const rtc::SocketAddress& internal_address() const {
+    return internal_address_;
+  }
+  // Number of allocations on each shard.
+  std::vector<size_t> GetAllocationCounts();
+
+ private:
+  struct Shard {
+    std::unique_ptr<rtc::Thread> thread;
+    std::unique_ptr<TurnServer> server;
+  };
+
+  // Runs on the shard's thread.
+  bool StartShard(Shard* shard,
+                  const rtc::SocketAddress& internal_address,
+                  const rtc::IPAddress& external_ip);
+
+  const size_t num_shards_;
+  const SocketServerFactory socket_server_factory_;
+  rtc::ThreadChecker thread_checker_;
+  std::string realm_;
+  std::string software_;
+  TurnAuthInterface* auth_hook_ = nullptr;
+  const std::string nonce_key_;
+  rtc::SocketAddress internal_address_;
+  std::vector<Shard> shards_;
+};
+
+}  // namespace cricket
+
+#endif  // P2P_BASE_SHARDED_TURN_SERVER_H_
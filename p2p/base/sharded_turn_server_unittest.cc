@@ -0,0 +1,182 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "p2p/base/sharded_turn_server.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "api/transport/stun.h"
+#include "p2p/base/test_turn_credentials.h"
+#include "rtc_base/async_udp_socket.h"
+#include "rtc_base/byte_buffer.h"
+#include "rtc_base/physical_socket_server.h"
+#include "rtc_base/test_client.h"
+#include "test/gtest.h"
+
+namespace cricket {
+namespace {
+
+const int kTimeoutMs = 5000;
+
+// Socket server that fails to create sockets.
+class FailingSocketServer : public rtc::PhysicalSocketServer {
+ public:
+  rtc::AsyncSocket* CreateAsyncSocket(int family, int type) override {
+    return nullptr;
+  }
+};
+
+std::unique_ptr<TurnMessage> ReadTurnMessage(
+    const rtc::TestClient::Packet& packet) {
+  auto msg = std::make_unique<TurnMessage>();
+  rtc::ByteBufferReader buf(packet.buf, packet.size);
+  if (!msg->Read(&buf)) {
+    return nullptr;
+  }
+  return msg;
+}
+
+class ShardedTurnServerTest : public ::testing::Test {
+ public:
+  ShardedTurnServerTest() : thread_(&ss_) {}
+
+ protected:
+  // Allocates a relay address for |client|. Returns the response to the
+  // authenticated request.
+  std::unique_ptr<TurnMessage> Allocate(rtc::TestClient* client,
+                                        const rtc::SocketAddress& server) {
+    std::string nonce;
+    return AllocateTestTurnRelay(
+        [&](const TurnMessage& request) {
+          return SendRequest(client, server, request);
+        },
+        &nonce);
+  }
+
+  std::unique_ptr<TurnMessage> SendRequest(rtc::TestClient* client,
+                                           const rtc::SocketAddress& server,
+                                           const TurnMessage& request) {
+    rtc::ByteBufferWriter buf;
+    request.Write(&buf);
+    client->SendTo(buf.Data(), buf.Length(), server);
+    std::unique_ptr<rtc::TestClient::Packet> packet =
+        client->NextPacket(kTimeoutMs);
+    if (!packet) {
+      return nullptr;
+    }
+    EXPECT_EQ(server, packet->addr);
+    return ReadTurnMessage(*packet);
+  }
+
+  std::unique_ptr<rtc::TestClient> CreateClient() {
+    return std::make_unique<rtc::TestClient>(
+        std::unique_ptr<rtc::AsyncPacketSocket>(rtc::AsyncUDPSocket::Create(
+            &ss_, rtc::SocketAddress("127.0.0.1", 0))));
+  }
+
+  rtc::PhysicalSocketServer ss_;
+  rtc::AutoSocketServerThread thread_;
+  FixedKeyAuth auth_;
+};
+
+TEST_F(ShardedTurnServerTest, AllocatesOnSingleShard) {
+  ShardedTurnServer server(1);
+  server.set_realm(kTestTurnRealm);
+  server.set_auth_hook(&auth_);
+  ASSERT_TRUE(server.Start(rtc::SocketAddress("127.0.0.1", 0),
+                           rtc::IPAddress(INADDR_LOOPBACK)));
+  EXPECT_NE(0, server.internal_address().port());
+
+  std::unique_ptr<rtc::TestClient> client = CreateClient();
+  std::unique_ptr<TurnMessage> response =
+      Allocate(client.get(), server.internal_address());
+  ASSERT_TRUE(response);
+  EXPECT_EQ(STUN_ALLOCATE_RESPONSE, response->type());
+  EXPECT_TRUE(response->GetAddress(STUN_ATTR_XOR_RELAYED_ADDRESS));
+  EXPECT_EQ(std::vector<size_t>({1}), server.GetAllocationCounts());
+}
+
+TEST_F(ShardedTurnServerTest, StopsStartedShardsWhenAShardFailsToStart) {
+  const size_t kNumShards = 3;
+  // The second shard cannot create its socket.
+  size_t num_socket_servers = 0;
+  ShardedTurnServer server(
+      kNumShards, [&]() -> std::unique_ptr<rtc::SocketServer> {
+        if (num_socket_servers++ == 1) {
+          return std::make_unique<FailingSocketServer>();
+        }
+        return std::make_unique<rtc::PhysicalSocketServer>();
+      });
+  server.set_realm(kTestTurnRealm);
+  server.set_auth_hook(&auth_);
+  EXPECT_FALSE(server.Start(rtc::SocketAddress("127.0.0.1", 0),
+                            rtc::IPAddress(INADDR_LOOPBACK)));
+  EXPECT_EQ(2u, num_socket_servers);
+  EXPECT_TRUE(server.GetAllocationCounts().empty());
+
+  // The server can be started again once the shards can start.
+  EXPECT_TRUE(server.Start(rtc::SocketAddress("127.0.0.1", 0),
+                           rtc::IPAddress(INADDR_LOOPBACK)));
+  EXPECT_EQ(kNumShards, server.GetAllocationCounts().size());
+}
+
+#if defined(WEBRTC_LINUX)
+// SO_REUSEPORT only balances UDP packets over the sockets on Linux.
+TEST_F(ShardedTurnServerTest, SpreadsClientsOverShards) {
+  const size_t kNumShards = 4;
+  const size_t kNumClients = 32;
+  ShardedTurnServer server(kNumShards);
+  server.set_realm(kTestTurnRealm);
+  server.set_auth_hook(&auth_);
+  ASSERT_TRUE(server.Start(rtc::SocketAddress("127.0.0.1", 0),
+                           rtc::IPAddress(INADDR_LOOPBACK)));
+
+  std::vector<std::unique_ptr<rtc::TestClient>> clients;
+  std::vector<size_t> counts = server.GetAllocationCounts();
+  ASSERT_EQ(kNumShards, counts.size());
+  for (size_t i = 0; i < kNumClients; ++i) {
+    clients.push_back(CreateClient());
+    // The shards share the nonce key, so the challenge and the authenticated
+    // request may be handled by different shards. Each client sends from a
+    // single socket though, and SO_REUSEPORT hashes its 5-tuple to one shard.
+    std::unique_ptr<TurnMessage> response =
+        Allocate(clients.back().get(), server.internal_address());
+    ASSERT_TRUE(response);
+    EXPECT_EQ(STUN_ALLOCATE_RESPONSE, response->type());
+
+    // Exactly one shard holds the new allocation.
+    std::vector<size_t> new_counts = server.GetAllocationCounts();
+    ASSERT_EQ(kNumShards, new_counts.size());
+    size_t shards_allocated = 0;
+    for (size_t shard = 0; shard < kNumShards; ++shard) {
+      ASSERT_GE(new_counts[shard], counts[shard]);
+      shards_allocated += new_counts[shard] - counts[shard];
+    }
+    EXPECT_EQ(1u, shards_allocated);
+    counts = new_counts;
+  }
+
+  size_t total = 0;
+  size_t shards_in_use = 0;
+  for (size_t count : counts) {
+    total += count;
+    if (count > 0) {
+      ++shards_in_use;
+    }
+  }
+  EXPECT_EQ(kNumClients, total);
+  EXPECT_GT(shards_in_use, 1u);
+}
+#endif  // defined(WEBRTC_LINUX)
+
+}  // namespace
+}  // namespace cricket
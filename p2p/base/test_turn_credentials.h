@@ -0,0 +1,92 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef P2P_BASE_TEST_TURN_CREDENTIALS_H_
+#define P2P_BASE_TEST_TURN_CREDENTIALS_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "api/transport/stun.h"
+#include "p2p/base/turn_server.h"
+#include "rtc_base/helpers.h"
+
+// Helpers for tests that talk to a TurnServer using hand-crafted TURN
+// messages.
+
+namespace cricket {
+
+static const char kTestTurnRealm[] = "example.org";
+static const char kTestTurnUsername[] = "test";
+static const char kTestTurnKey[] = "key";
+
+// Hands out kTestTurnKey for all users.
+class FixedKeyAuth : public TurnAuthInterface {
+ public:
+  bool GetKey(const std::string& username,
+              const std::string& realm,
+              std::string* key) override {
+    *key = kTestTurnKey;
+    return true;
+  }
+};
+
+// Adds the attributes authenticating |request| with the test credentials,
+// using the NONCE from an earlier 401 response.
+inline void AddTestTurnCredentials(const std::string& nonce,
+                                   TurnMessage* request) {
+  request->AddAttribute(std::make_unique<StunByteStringAttribute>(
+      STUN_ATTR_USERNAME, kTestTurnUsername));
+  request->AddAttribute(std::make_unique<StunByteStringAttribute>(
+      STUN_ATTR_REALM, kTestTurnRealm));
+  request->AddAttribute(
+      std::make_unique<StunByteStringAttribute>(STUN_ATTR_NONCE, nonce));
+  request->AddMessageIntegrity(kTestTurnKey);
+}
+
+// Sends |request| to the server and returns the response, or nullptr.
+using TestTurnRequestSender =
+    std::function<std::unique_ptr<TurnMessage>(const TurnMessage& request)>;
+
+// Allocates a UDP relay, going through the 401 challenge first. Returns the
+// response to the authenticated request, or nullptr, and sets |nonce| to the
+// NONCE to authenticate later requests with.
+inline std::unique_ptr<TurnMessage> AllocateTestTurnRelay(
+    const TestTurnRequestSender& send_request,
+    std::string* nonce) {
+  auto create_request = [] {
+    auto request = std::make_unique<TurnMessage>();
+    request->SetType(STUN_ALLOCATE_REQUEST);
+    request->SetTransactionID(
+        rtc::CreateRandomString(kStunTransactionIdLength));
+    auto transport_attr =
+        StunAttribute::CreateUInt32(STUN_ATTR_REQUESTED_TRANSPORT);
+    transport_attr->SetValue(IPPROTO_UDP << 24);
+    request->AddAttribute(std::move(transport_attr));
+    return request;
+  };
+
+  std::unique_ptr<TurnMessage> challenge = send_request(*create_request());
+  if (!challenge ||
+      challenge->GetErrorCodeValue() != STUN_ERROR_UNAUTHORIZED ||
+      !challenge->GetByteString(STUN_ATTR_NONCE)) {
+    return nullptr;
+  }
+  *nonce = challenge->GetByteString(STUN_ATTR_NONCE)->GetString();
+
+  std::unique_ptr<TurnMessage> request = create_request();
+  AddTestTurnCredentials(*nonce, request.get());
+  return send_request(*request);
+}
+
+}  // namespace cricket
+
+#endif  // P2P_BASE_TEST_TURN_CREDENTIALS_H_
@@ -10,11 +10,11 @@
 
 #include "p2p/base/turn_server.h"
 
+#include <algorithm>
 #include <memory>
 #include <tuple>  // for std::tie
 #include <utility>
 
-#include "absl/algorithm/container.h"
 #include "api/packet_socket_factory.h"
 #include "api/transport/stun.h"
 #include "p2p/base/async_stun_tcp_socket.h"
@@ -27,6 +27,7 @@
 #include "rtc_base/socket_adapters.h"
 #include "rtc_base/strings/string_builder.h"
 #include "rtc_base/thread.h"
+#include "rtc_base/time_utils.h"
 
 namespace cricket {
 
@@ -54,48 +55,7 @@ inline bool IsTurnChannelData(uint16_t msg_type) {
 // IDs used for posted messages for TurnServerAllocation.
 enum {
   MSG_ALLOCATION_TIMEOUT,
-};
-
-// Encapsulates a TURN permission.
-// The object is created when a create permission request is received by an
-// allocation, and self-deletes when its lifetime timer expires.
-class TurnServerAllocation::Permission : public rtc::MessageHandler {
- public:
-  Permission(rtc::Thread* thread, const rtc::IPAddress& peer);
-  ~Permission() override;
-
-  const rtc::IPAddress& peer() const { return peer_; }
-  void Refresh();
-
-  sigslot::signal1<Permission*> SignalDestroyed;
-
- private:
-  void OnMessage(rtc::Message* msg) override;
-
-  rtc::Thread* thread_;
-  rtc::IPAddress peer_;
-};
-
-// Encapsulates a TURN channel binding.
-// The object is created when a channel bind request is received by an
-// allocation, and self-deletes when its lifetime timer expires.
-class TurnServerAllocation::Channel : public rtc::MessageHandler {
- public:
-  Channel(rtc::Thread* thread, int id, const rtc::SocketAddress& peer);
-  ~Channel() override;
-
-  int id() const { return id_; }
-  const rtc::SocketAddress& peer() const { return peer_; }
-  void Refresh();
-
-  sigslot::signal1<Channel*> SignalDestroyed;
-
- private:
-  void OnMessage(rtc::Message* msg) override;
-
-  rtc::Thread* thread_;
-  int id_;
-  rtc::SocketAddress peer_;
+  MSG_PEER_EXPIRATION,
 };
 
 static bool InitResponse(const StunMessage* req, StunMessage* resp) {
@@ -525,14 +485,26 @@ void TurnServer::SendErrorResponseWithAlternateServer(
 
 void TurnServer::SendStun(TurnServerConnection* conn, StunMessage* msg) {
   RTC_DCHECK(thread_checker_.IsCurrent());
-  rtc::ByteBufferWriter buf;
   // Add a SOFTWARE attribute if one is set.
   if (!software_.empty()) {
     msg->AddAttribute(std::make_unique<StunByteStringAttribute>(
         STUN_ATTR_SOFTWARE, software_));
   }
-  msg->Write(&buf);
-  Send(conn, buf);
+  send_buffer_.Clear();
+  msg->Write(&send_buffer_);
+  Send(conn, send_buffer_);
+}
+
+void TurnServer::SendChannelData(TurnServerConnection* conn,
+                                 uint16_t channel_id,
+                                 const char* data,
+                                 size_t size) {
+  RTC_DCHECK(thread_checker_.IsCurrent());
+  send_buffer_.Clear();
+  send_buffer_.WriteUInt16(channel_id);
+  send_buffer_.WriteUInt16(static_cast<uint16_t>(size));
+  send_buffer_.WriteBytes(data, size);
+  Send(conn, send_buffer_);
 }
 
 void TurnServer::Send(TurnServerConnection* conn,
@@ -623,14 +595,7 @@ TurnServerAllocation::TurnServerAllocation(TurnServer* server,
 }
 
 TurnServerAllocation::~TurnServerAllocation() {
-  for (ChannelList::iterator it = channels_.begin(); it != channels_.end();
-       ++it) {
-    delete *it;
-  }
-  for (PermissionList::iterator it = perms_.begin(); it != perms_.end(); ++it) {
-    delete *it;
-  }
-  thread_->Clear(this, MSG_ALLOCATION_TIMEOUT);
+  thread_->Clear(this);
   RTC_LOG(LS_INFO) << ToString() << ": Allocation destroyed";
 }
 
@@ -797,22 +762,15 @@ void TurnServerAllocation::HandleChannelBindRequest(const TurnMessage* msg) {
 
   // Check that this channel id isn't bound to another transport address, and
   // that this transport address isn't bound to another channel id.
-  Channel* channel1 = FindChannel(channel_id);
-  Channel* channel2 = FindChannel(peer_attr->GetAddress());
-  if (channel1 != channel2) {
+  const Channel* channel = FindChannel(channel_id);
+  int bound_channel_id = FindChannelId(peer_attr->GetAddress());
+  if ((channel || bound_channel_id != 0) && bound_channel_id != channel_id) {
     SendBadRequestResponse(msg);
     return;
   }
 
   // Add or refresh this channel.
-  if (!channel1) {
-    channel1 = new Channel(thread_, channel_id, peer_attr->GetAddress());
-    channel1->SignalDestroyed.connect(
-        this, &TurnServerAllocation::OnChannelDestroyed);
-    channels_.push_back(channel1);
-  } else {
-    channel1->Refresh();
-  }
+  BindChannel(channel_id, peer_attr->GetAddress());
 
   // Channel binds also refresh permissions.
   AddPermission(peer_attr->GetAddress().ipaddr());
@@ -829,11 +787,11 @@ void TurnServerAllocation::HandleChannelBindRequest(const TurnMessage* msg) {
 void TurnServerAllocation::HandleChannelData(const char* data, size_t size) {
   // Extract the channel number from the data.
   uint16_t channel_id = rtc::GetBE16(data);
-  Channel* channel = FindChannel(channel_id);
+  const Channel* channel = FindChannel(channel_id);
   if (channel) {
     // Send the data to the peer address.
     SendExternal(data + TURN_CHANNEL_HEADER_SIZE,
-                 size - TURN_CHANNEL_HEADER_SIZE, channel->peer());
+                 size - TURN_CHANNEL_HEADER_SIZE, channel->peer);
   } else {
     RTC_LOG(LS_WARNING) << ToString()
                         << ": Received channel data for invalid channel, id="
@@ -848,14 +806,11 @@ void TurnServerAllocation::OnExternalPacket(
     const rtc::SocketAddress& addr,
     const int64_t& /* packet_time_us */) {
   RTC_DCHECK(external_socket_.get() == socket);
-  Channel* channel = FindChannel(addr);
-  if (channel) {
+  int channel_id = FindChannelId(addr);
+  if (channel_id != 0) {
     // There is a channel bound to this address. Send as a channel message.
-    rtc::ByteBufferWriter buf;
-    buf.WriteUInt16(channel->id());
-    buf.WriteUInt16(static_cast<uint16_t>(size));
-    buf.WriteBytes(data, size);
-    server_->Send(&conn_, buf);
+    server_->SendChannelData(&conn_, static_cast<uint16_t>(channel_id), data,
+                             size);
   } else if (!server_->enable_permission_checks_ ||
              HasPermission(addr.ipaddr())) {
     // No channel, but a permission exists. Send as a data indication.
@@ -884,50 +839,117 @@ int TurnServerAllocation::ComputeLifetime(const TurnMessage* msg) {
   return lifetime;
 }
 
-bool TurnServerAllocation::HasPermission(const rtc::IPAddress& addr) {
-  return (FindPermission(addr) != NULL);
+bool TurnServerAllocation::HasPermission(const rtc::IPAddress& addr) const {
+  auto it = permissions_.find(addr);
+  return it != permissions_.end() && it->second > rtc::TimeMillis();
 }
 
 void TurnServerAllocation::AddPermission(const rtc::IPAddress& addr) {
-  Permission* perm = FindPermission(addr);
-  if (!perm) {
-    perm = new Permission(thread_, addr);
-    perm->SignalDestroyed.connect(this,
-                                  &TurnServerAllocation::OnPermissionDestroyed);
-    perms_.push_back(perm);
-  } else {
-    perm->Refresh();
+  int64_t expiration_ms = rtc::TimeMillis() + kPermissionTimeout;
+  permissions_[addr] = expiration_ms;
+  SchedulePeerExpiration(expiration_ms);
+}
+
+const TurnServerAllocation::Channel* TurnServerAllocation::FindChannel(
+    int channel_id) const {
+  auto it = channels_.find(channel_id);
+  if (it == channels_.end() || it->second.expiration_ms <= rtc::TimeMillis()) {
+    return nullptr;
   }
+  return &it->second;
 }
 
-TurnServerAllocation::Permission* TurnServerAllocation::FindPermission(
-    const rtc::IPAddress& addr) const {
-  for (PermissionList::const_iterator it = perms_.begin(); it != perms_.end();
-       ++it) {
-    if ((*it)->peer() == addr)
-      return *it;
+int TurnServerAllocation::FindChannelId(const rtc::SocketAddress& addr) const {
+  auto it = channel_ids_.find(addr);
+  if (it == channel_ids_.end() || !FindChannel(it->second)) {
+    return 0;
   }
-  return NULL;
+  return it->second;
 }
 
-TurnServerAllocation::Channel* TurnServerAllocation::FindChannel(
-    int channel_id) const {
-  for (ChannelList::const_iterator it = channels_.begin();
-       it != channels_.end(); ++it) {
-    if ((*it)->id() == channel_id)
-      return *it;
+void TurnServerAllocation::BindChannel(int channel_id,
+                                       const rtc::SocketAddress& peer) {
+  RTC_DCHECK_GE(channel_id, kMinChannelNumber);
+  RTC_DCHECK_LE(channel_id, kMaxChannelNumber);
+  if (!FindChannel(channel_id)) {
+    // Drop expired bindings of the channel number and the peer, if they
+    // haven't been removed yet.
+    UnbindChannel(channel_id);
+    auto it = channel_ids_.find(peer);
+    if (it != channel_ids_.end()) {
+      UnbindChannel(it->second);
+    }
+    channels_[channel_id].peer = peer;
+    channel_ids_[peer] = channel_id;
+  }
+  Channel& channel = channels_[channel_id];
+  RTC_DCHECK(channel.peer == peer);
+  channel.expiration_ms = rtc::TimeMillis() + kChannelTimeout;
+  SchedulePeerExpiration(channel.expiration_ms);
+}
+
+void TurnServerAllocation::UnbindChannel(int channel_id) {
+  auto channel = channels_.find(channel_id);
+  if (channel == channels_.end()) {
+    return;
   }
-  return NULL;
+  auto it = channel_ids_.find(channel->second.peer);
+  if (it != channel_ids_.end() && it->second == channel_id) {
+    channel_ids_.erase(it);
+  }
+  channels_.erase(channel);
 }
 
-TurnServerAllocation::Channel* TurnServerAllocation::FindChannel(
-    const rtc::SocketAddress& addr) const {
-  for (ChannelList::const_iterator it = channels_.begin();
-       it != channels_.end(); ++it) {
-    if ((*it)->peer() == addr)
-      return *it;
+void TurnServerAllocation::SchedulePeerExpiration(int64_t expiration_ms) {
+  if (peer_expiration_ms_ != 0) {
+    if (peer_expiration_ms_ <= expiration_ms) {
+      // The pending message fires first and reschedules itself.
+      return;
+    }
+    // E.g. a permission created after a channel binding expires earlier
+    // than the binding.
+    thread_->Clear(this, MSG_PEER_EXPIRATION);
+  }
+  int64_t delay_ms = std::max<int64_t>(0, expiration_ms - rtc::TimeMillis());
+  thread_->PostDelayed(RTC_FROM_HERE, static_cast<int>(delay_ms), this,
+                       MSG_PEER_EXPIRATION);
+  peer_expiration_ms_ = expiration_ms;
+}
+
+void TurnServerAllocation::ExpirePeers() {
+  peer_expiration_ms_ = 0;
+  const int64_t now = rtc::TimeMillis();
+  int64_t next_expiration_ms = 0;
+  auto update_next_expiration = [&](int64_t expiration_ms) {
+    if (next_expiration_ms == 0 || expiration_ms < next_expiration_ms) {
+      next_expiration_ms = expiration_ms;
+    }
+  };
+
+  for (auto it = permissions_.begin(); it != permissions_.end();) {
+    if (it->second <= now) {
+      it = permissions_.erase(it);
+    } else {
+      update_next_expiration(it->second);
+      ++it;
+    }
+  }
+  for (auto it = channels_.begin(); it != channels_.end();) {
+    if (it->second.expiration_ms <= now) {
+      auto id = channel_ids_.find(it->second.peer);
+      if (id != channel_ids_.end() && id->second == it->first) {
+        channel_ids_.erase(id);
+      }
+      it = channels_.erase(it);
+    } else {
+      update_next_expiration(it->second.expiration_ms);
+      ++it;
+    }
+  }
+
+  if (next_expiration_ms != 0) {
+    SchedulePeerExpiration(next_expiration_ms);
   }
-  return NULL;
 }
 
 void TurnServerAllocation::SendResponse(TurnMessage* msg) {
@@ -954,63 +976,10 @@ void TurnServerAllocation::SendExternal(const void* data,
 }
 
 void TurnServerAllocation::OnMessage(rtc::Message* msg) {
-  RTC_DCHECK(msg->message_id == MSG_ALLOCATION_TIMEOUT);
-  SignalDestroyed(this);
-  delete this;
-}
-
-void TurnServerAllocation::OnPermissionDestroyed(Permission* perm) {
-  auto it = absl::c_find(perms_, perm);
-  RTC_DCHECK(it != perms_.end());
-  perms_.erase(it);
-}
-
-void TurnServerAllocation::OnChannelDestroyed(Channel* channel) {
-  auto it = absl::c_find(channels_, channel);
-  RTC_DCHECK(it != channels_.end());
-  channels_.erase(it);
-}
-
-TurnServerAllocation::Permission::Permission(rtc::Thread* thread,
-                                             const rtc::IPAddress& peer)
-    : thread_(thread), peer_(peer) {
-  Refresh();
-}
-
-TurnServerAllocation::Permission::~Permission() {
-  thread_->Clear(this, MSG_ALLOCATION_TIMEOUT);
-}
-
-void TurnServerAllocation::Permission::Refresh() {
-  thread_->Clear(this, MSG_ALLOCATION_TIMEOUT);
-  thread_->PostDelayed(RTC_FROM_HERE, kPermissionTimeout, this,
-                       MSG_ALLOCATION_TIMEOUT);
-}
-
-void TurnServerAllocation::Permission::OnMessage(rtc::Message* msg) {
-  RTC_DCHECK(msg->message_id == MSG_ALLOCATION_TIMEOUT);
-  SignalDestroyed(this);
-  delete this;
-}
-
-TurnServerAllocation::Channel::Channel(rtc::Thread* thread,
-                                       int id,
-                                       const rtc::SocketAddress& peer)
-    : thread_(thread), id_(id), peer_(peer) {
-  Refresh();
-}
-
-TurnServerAllocation::Channel::~Channel() {
-  thread_->Clear(this, MSG_ALLOCATION_TIMEOUT);
-}
-
-void TurnServerAllocation::Channel::Refresh() {
-  thread_->Clear(this, MSG_ALLOCATION_TIMEOUT);
-  thread_->PostDelayed(RTC_FROM_HERE, kChannelTimeout, this,
-                       MSG_ALLOCATION_TIMEOUT);
-}
-
-void TurnServerAllocation::Channel::OnMessage(rtc::Message* msg) {
+  if (msg->message_id == MSG_PEER_EXPIRATION) {
+    ExpirePeers();
+    return;
+  }
   RTC_DCHECK(msg->message_id == MSG_ALLOCATION_TIMEOUT);
   SignalDestroyed(this);
   delete this;
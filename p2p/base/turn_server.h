@@ -11,24 +11,25 @@
 #ifndef P2P_BASE_TURN_SERVER_H_
 #define P2P_BASE_TURN_SERVER_H_
 
-#include <list>
 #include <map>
 #include <memory>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "p2p/base/port_interface.h"
 #include "rtc_base/async_invoker.h"
 #include "rtc_base/async_packet_socket.h"
+#include "rtc_base/byte_buffer.h"
+#include "rtc_base/ip_address.h"
 #include "rtc_base/socket_address.h"
 #include "rtc_base/third_party/sigslot/sigslot.h"
 #include "rtc_base/thread.h"
 #include "rtc_base/thread_checker.h"
 
 namespace rtc {
-class ByteBufferWriter;
 class PacketSocketFactory;
 }  // namespace rtc
 
@@ -83,6 +84,10 @@ class TurnServerAllocation : public rtc::MessageHandler,
   const std::string& origin() const { return origin_; }
   const std::string& last_nonce() const { return last_nonce_; }
   void set_last_nonce(const std::string& nonce) { last_nonce_ = nonce; }
+  // Include expired permissions and channel bindings that haven't been
+  // removed yet.
+  size_t permission_count() const { return permissions_.size(); }
+  size_t channel_count() const { return channels_.size(); }
 
   std::string ToString() const;
 
@@ -92,10 +97,23 @@ class TurnServerAllocation : public rtc::MessageHandler,
   sigslot::signal1<TurnServerAllocation*> SignalDestroyed;
 
  private:
-  class Channel;
-  class Permission;
-  typedef std::list<Permission*> PermissionList;
-  typedef std::list<Channel*> ChannelList;
+  // A channel number bound to a peer transport address.
+  struct Channel {
+    rtc::SocketAddress peer;
+    // rtc::TimeMillis() at which the binding expires.
+    int64_t expiration_ms = 0;
+  };
+
+  struct IPAddressHash {
+    size_t operator()(const rtc::IPAddress& ip) const {
+      return rtc::HashIP(ip);
+    }
+  };
+  struct SocketAddressHash {
+    size_t operator()(const rtc::SocketAddress& address) const {
+      return address.Hash();
+    }
+  };
 
   void HandleAllocateRequest(const TurnMessage* msg);
   void HandleRefreshRequest(const TurnMessage* msg);
@@ -110,11 +128,21 @@ class TurnServerAllocation : public rtc::MessageHandler,
                         const int64_t& packet_time_us);
 
   static int ComputeLifetime(const TurnMessage* msg);
-  bool HasPermission(const rtc::IPAddress& addr);
+  bool HasPermission(const rtc::IPAddress& addr) const;
   void AddPermission(const rtc::IPAddress& addr);
-  Permission* FindPermission(const rtc::IPAddress& addr) const;
-  Channel* FindChannel(int channel_id) const;
-  Channel* FindChannel(const rtc::SocketAddress& addr) const;
+  // Returns the unexpired binding of |channel_id|, or null if there is none.
+  const Channel* FindChannel(int channel_id) const;
+  // Returns the channel number bound to |addr|, or 0 if there is none.
+  int FindChannelId(const rtc::SocketAddress& addr) const;
+  // Binds |channel_id| to |peer|, or refreshes the binding.
+  void BindChannel(int channel_id, const rtc::SocketAddress& peer);
+  void UnbindChannel(int channel_id);
+
+  // Permissions and channel bindings are refreshed by updating their
+  // expiration time; lookups ignore expired entries, and a single posted
+  // message per allocation removes them.
+  void SchedulePeerExpiration(int64_t expiration_ms);
+  void ExpirePeers();
 
   void SendResponse(TurnMessage* msg);
   void SendBadRequestResponse(const TurnMessage* req);
@@ -125,8 +153,6 @@ class TurnServerAllocation : public rtc::MessageHandler,
                     size_t size,
                     const rtc::SocketAddress& peer);
 
-  void OnPermissionDestroyed(Permission* perm);
-  void OnChannelDestroyed(Channel* channel);
   void OnMessage(rtc::Message* msg) override;
 
   TurnServer* server_;
@@ -138,8 +164,14 @@ class TurnServerAllocation : public rtc::MessageHandler,
   std::string username_;
   std::string origin_;
   std::string last_nonce_;
-  PermissionList perms_;
-  ChannelList channels_;
+  // Expiration time of the permission for each peer IP address.
+  std::unordered_map<rtc::IPAddress, int64_t, IPAddressHash> permissions_;
+  // Keyed by channel number. Only holds the bound channels, as a client may
+  // pick any number up to 0x7FFF.
+  std::unordered_map<int, Channel> channels_;
+  std::unordered_map<rtc::SocketAddress, int, SocketAddressHash> channel_ids_;
+  // Time the posted expiration message fires, or 0 if none is pending.
+  int64_t peer_expiration_ms_ = 0;
 };
 
 // An interface through which the MD5 credential hash can be retrieved.
@@ -201,6 +233,13 @@ class TurnServer : public sigslot::has_slots<> {
     software_ = software;
   }
 
+  // Sets the secret used to generate and validate NONCEs. Servers sharing a
+  // secret accept each other's NONCEs. Defaults to a random string.
+  void set_nonce_key(const std::string& nonce_key) {
+    RTC_DCHECK(thread_checker_.IsCurrent());
+    nonce_key_ = nonce_key;
+  }
+
   const AllocationMap& allocations() const {
     RTC_DCHECK(thread_checker_.IsCurrent());
     return allocations_;
@@ -304,6 +343,12 @@ class TurnServer : public sigslot::has_slots<> {
                                             const rtc::SocketAddress& addr);
 
   void SendStun(TurnServerConnection* conn, StunMessage* msg);
+  // Sends |size| bytes of relayed |data| to the client of |conn|, prefixed
+  // with the ChannelData header for |channel_id|.
+  void SendChannelData(TurnServerConnection* conn,
+                       uint16_t channel_id,
+                       const char* data,
+                       size_t size);
   void Send(TurnServerConnection* conn, const rtc::ByteBufferWriter& buf);
 
   void OnAllocationDestroyed(TurnServerAllocation* allocation);
@@ -337,6 +382,10 @@ class TurnServer : public sigslot::has_slots<> {
   rtc::SocketAddress external_addr_;
 
   AllocationMap allocations_;
+  // Holds each message sent to a client while it is being written. Reused so
+  // that, once it has grown to the largest packet size, sending does not
+  // allocate.
+  rtc::ByteBufferWriter send_buffer_;
 
   rtc::AsyncInvoker invoker_;
 
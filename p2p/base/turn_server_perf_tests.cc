@@ -0,0 +1,217 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include <stdint.h>
+
+#include <memory>
+#include <string>
+
+#include "api/transport/stun.h"
+#include "p2p/base/basic_packet_socket_factory.h"
+#include "p2p/base/test_turn_credentials.h"
+#include "p2p/base/turn_server.h"
+#include "rtc_base/async_packet_socket.h"
+#include "rtc_base/byte_buffer.h"
+#include "rtc_base/gunit.h"
+#include "rtc_base/helpers.h"
+#include "rtc_base/third_party/sigslot/sigslot.h"
+#include "rtc_base/time_utils.h"
+#include "rtc_base/virtual_socket_server.h"
+#include "test/gtest.h"
+#include "test/testsupport/perf_test.h"
+
+namespace cricket {
+namespace {
+
+const rtc::SocketAddress kTurnServerAddress("99.99.99.1", 3478);
+const rtc::SocketAddress kClientAddress("11.11.11.11", 0);
+const rtc::SocketAddress kPeerAddress("22.22.22.22", 0);
+const rtc::SocketAddress kUnboundPeerAddress("33.33.33.33", 0);
+const uint16_t kChannelId = 0x4000;
+// Typical size of a video packet.
+const size_t kPayloadSize = 1200;
+const int kPacketsPerBatch = 100;
+const int kNumBatches = 1000;
+const int kTimeoutMs = 1000;
+
+// UDP socket that counts the packets it receives and keeps the last one.
+// Unlike rtc::TestClient it does not queue the packets, so it adds little
+// to the cost of relaying.
+class Endpoint : public sigslot::has_slots<> {
+ public:
+  Endpoint(rtc::PacketSocketFactory* socket_factory,
+           const rtc::SocketAddress& address)
+      : socket_(socket_factory->CreateUdpSocket(address, 0, 0)) {
+    socket_->SignalReadPacket.connect(this, &Endpoint::OnReadPacket);
+  }
+
+  void SendTo(const void* data, size_t size, const rtc::SocketAddress& addr) {
+    socket_->SendTo(data, size, addr, rtc::PacketOptions());
+  }
+
+  rtc::SocketAddress address() const { return socket_->GetLocalAddress(); }
+  int packets_received() const { return packets_received_; }
+  const std::string& last_packet() const { return last_packet_; }
+
+ private:
+  void OnReadPacket(rtc::AsyncPacketSocket* socket,
+                    const char* data,
+                    size_t size,
+                    const rtc::SocketAddress& remote_addr,
+                    const int64_t& packet_time_us) {
+    ++packets_received_;
+    last_packet_.assign(data, size);
+  }
+
+  std::unique_ptr<rtc::AsyncPacketSocket> socket_;
+  int packets_received_ = 0;
+  std::string last_packet_;
+};
+
+// A TurnServer on a VirtualSocketServer, with one allocation that has a
+// channel bound to |peer_| but not to |unbound_peer_|. Packets are delivered
+// without delay, so the time it takes to relay them is spent in the server
+// and in the socket server.
+class TurnRelay {
+ public:
+  TurnRelay()
+      : thread_(&vss_),
+        socket_factory_(&vss_),
+        server_(&thread_),
+        client_(&socket_factory_, kClientAddress),
+        peer_(&socket_factory_, kPeerAddress),
+        unbound_peer_(&socket_factory_, kUnboundPeerAddress) {
+    server_.set_realm(kTestTurnRealm);
+    server_.set_auth_hook(&auth_);
+    // Lets |unbound_peer_| reach the client with data indications.
+    server_.set_enable_permission_checks(false);
+    server_.AddInternalSocket(
+        socket_factory_.CreateUdpSocket(kTurnServerAddress, 0, 0), PROTO_UDP);
+    server_.SetExternalSocketFactory(new rtc::BasicPacketSocketFactory(&vss_),
+                                     rtc::SocketAddress("5.5.5.5", 0));
+  }
+
+  bool Allocate() {
+    std::string nonce;
+    std::unique_ptr<TurnMessage> response = AllocateTestTurnRelay(
+        [this](const TurnMessage& request) { return SendRequest(request); },
+        &nonce);
+    if (!response || !response->GetAddress(STUN_ATTR_XOR_RELAYED_ADDRESS)) {
+      return false;
+    }
+    relayed_address_ =
+        response->GetAddress(STUN_ATTR_XOR_RELAYED_ADDRESS)->GetAddress();
+
+    TurnMessage request;
+    request.SetType(TURN_CHANNEL_BIND_REQUEST);
+    request.SetTransactionID(rtc::CreateRandomString(kStunTransactionIdLength));
+    request.AddAttribute(std::make_unique<StunUInt32Attribute>(
+        STUN_ATTR_CHANNEL_NUMBER, kChannelId << 16));
+    request.AddAttribute(std::make_unique<StunXorAddressAttribute>(
+        STUN_ATTR_XOR_PEER_ADDRESS, peer_.address()));
+    AddTestTurnCredentials(nonce, &request);
+    response = SendRequest(request);
+    return response && response->type() == TURN_CHANNEL_BIND_RESPONSE;
+  }
+
+  // Returns the average time, in nanoseconds, it takes to relay a packet
+  // sent by |from| to |to|.
+  double MeasureRelayCostNs(Endpoint* from,
+                            Endpoint* to,
+                            const rtc::SocketAddress& destination,
+                            const std::string& packet) {
+    const int num_packets = kPacketsPerBatch * kNumBatches;
+    const int expected_packets_received = to->packets_received() + num_packets;
+    const int64_t start_time_us = rtc::TimeMicros();
+    for (int batch = 0; batch < kNumBatches; ++batch) {
+      for (int i = 0; i < kPacketsPerBatch; ++i) {
+        from->SendTo(packet.data(), packet.size(), destination);
+      }
+      thread_.ProcessMessages(0);
+    }
+    // Packets posted for delivery at the next millisecond may still be in
+    // flight.
+    WAIT(to->packets_received() == expected_packets_received, kTimeoutMs);
+    const int64_t elapsed_us = rtc::TimeMicros() - start_time_us;
+    EXPECT_EQ(expected_packets_received, to->packets_received());
+    return 1000.0 * elapsed_us / num_packets;
+  }
+
+  Endpoint* client() { return &client_; }
+  Endpoint* peer() { return &peer_; }
+  Endpoint* unbound_peer() { return &unbound_peer_; }
+  const rtc::SocketAddress& relayed_address() const {
+    return relayed_address_;
+  }
+
+ private:
+  std::unique_ptr<TurnMessage> SendRequest(const TurnMessage& request) {
+    rtc::ByteBufferWriter buf;
+    request.Write(&buf);
+    const int packets_received = client_.packets_received();
+    client_.SendTo(buf.Data(), buf.Length(), kTurnServerAddress);
+    thread_.ProcessMessages(0);
+    if (client_.packets_received() == packets_received) {
+      return nullptr;
+    }
+    auto response = std::make_unique<TurnMessage>();
+    rtc::ByteBufferReader reader(client_.last_packet().data(),
+                                 client_.last_packet().size());
+    if (!response->Read(&reader)) {
+      return nullptr;
+    }
+    return response;
+  }
+
+  rtc::VirtualSocketServer vss_;
+  rtc::AutoSocketServerThread thread_;
+  rtc::BasicPacketSocketFactory socket_factory_;
+  FixedKeyAuth auth_;
+  TurnServer server_;
+  Endpoint client_;
+  Endpoint peer_;
+  Endpoint unbound_peer_;
+  rtc::SocketAddress relayed_address_;
+};
+
+void PrintRelayCost(const std::string& trace, double cost_ns) {
+  webrtc::test::PrintResult("turn_relay_cost", "", trace, cost_ns, "ns",
+                            /*important=*/false,
+                            webrtc::test::ImproveDirection::kSmallerIsBetter);
+}
+
+}  // namespace
+
+TEST(TurnServerPerfTest, RelayThroughput) {
+  TurnRelay relay;
+  ASSERT_TRUE(relay.Allocate());
+  const std::string payload(kPayloadSize, 'x');
+
+  rtc::ByteBufferWriter channel_data;
+  channel_data.WriteUInt16(kChannelId);
+  channel_data.WriteUInt16(static_cast<uint16_t>(payload.size()));
+  channel_data.WriteString(payload);
+  PrintRelayCost("client_to_peer_channel_data",
+                 relay.MeasureRelayCostNs(
+                     relay.client(), relay.peer(), kTurnServerAddress,
+                     std::string(channel_data.Data(), channel_data.Length())));
+  EXPECT_EQ(payload, relay.peer()->last_packet());
+
+  PrintRelayCost("peer_to_client_channel_data",
+                 relay.MeasureRelayCostNs(relay.peer(), relay.client(),
+                                          relay.relayed_address(), payload));
+  EXPECT_EQ(4 + payload.size(), relay.client()->last_packet().size());
+
+  PrintRelayCost("peer_to_client_data_indication",
+                 relay.MeasureRelayCostNs(relay.unbound_peer(), relay.client(),
+                                          relay.relayed_address(), payload));
+}
+
+}  // namespace cricket
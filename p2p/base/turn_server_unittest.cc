@@ -10,12 +10,24 @@
 
 #include "p2p/base/turn_server.h"
 
+#include <memory>
+#include <string>
+
+#include "api/transport/stun.h"
 #include "p2p/base/basic_packet_socket_factory.h"
+#include "p2p/base/test_turn_credentials.h"
+#include "rtc_base/byte_buffer.h"
+#include "rtc_base/byte_order.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/fake_clock.h"
+#include "rtc_base/helpers.h"
+#include "rtc_base/test_client.h"
 #include "rtc_base/virtual_socket_server.h"
 #include "test/gtest.h"
 
 // NOTE: This is a work in progress. Currently this file only has tests for
-// TurnServerConnection, a primitive class used by TurnServer.
+// TurnServerConnection, a primitive class used by TurnServer, NONCE
+// generation, and channel bindings.
 
 namespace cricket {
 
@@ -64,4 +76,245 @@ TEST_F(TurnServerConnectionTest, ComparisonOperators) {
   ExpectNotEqual(connection1, connection4);
 }
 
+TEST(TurnServerTest, ServersWithSameNonceKeyGenerateSameNonces) {
+  rtc::AutoThread thread;
+  TurnServer server1(&thread);
+  TurnServer server2(&thread);
+  TurnServer server3(&thread);
+  server1.set_nonce_key("nonce key");
+  server2.set_nonce_key("nonce key");
+  const int64_t kTimestamp = 123456789;
+  EXPECT_EQ(server1.SetTimestampForNextNonce(kTimestamp),
+            server2.SetTimestampForNextNonce(kTimestamp));
+  EXPECT_NE(server1.SetTimestampForNextNonce(kTimestamp),
+            server3.SetTimestampForNextNonce(kTimestamp));
+}
+
+namespace {
+const rtc::SocketAddress kTurnServerAddress("1.1.1.1", 3478);
+const rtc::SocketAddress kClientAddress("2.2.2.2", 0);
+const rtc::SocketAddress kPeerAddress1("3.3.3.3", 0);
+const rtc::SocketAddress kPeerAddress2("4.4.4.4", 0);
+const int kChannelId = 0x4000;
+const int kTimeoutMs = 1000;
+}  // namespace
+
+// Talks to a TurnServer using hand-crafted TURN messages, to test channel
+// bindings and their expiration from the server's side.
+class TurnServerAllocationTest : public ::testing::Test {
+ public:
+  TurnServerAllocationTest()
+      : thread_(&vss_), socket_factory_(&vss_), server_(&thread_) {
+    fake_clock_.AdvanceTime(webrtc::TimeDelta::seconds(1));
+    server_.set_realm(kTestTurnRealm);
+    server_.set_auth_hook(&auth_);
+    server_.AddInternalSocket(
+        socket_factory_.CreateUdpSocket(kTurnServerAddress, 0, 0), PROTO_UDP);
+    server_.SetExternalSocketFactory(new rtc::BasicPacketSocketFactory(&vss_),
+                                     rtc::SocketAddress("5.5.5.5", 0));
+    client_ = CreateClient(kClientAddress);
+    peer1_ = CreateClient(kPeerAddress1);
+    peer2_ = CreateClient(kPeerAddress2);
+  }
+
+ protected:
+  std::unique_ptr<rtc::TestClient> CreateClient(
+      const rtc::SocketAddress& address) {
+    return std::make_unique<rtc::TestClient>(
+        std::unique_ptr<rtc::AsyncPacketSocket>(
+            socket_factory_.CreateUdpSocket(address, 0, 0)),
+        &fake_clock_);
+  }
+
+  // Authenticates and sends |request|, once allocated.
+  std::unique_ptr<TurnMessage> SendRequest(TurnMessage* request) {
+    request->SetTransactionID(
+        rtc::CreateRandomString(kStunTransactionIdLength));
+    AddTestTurnCredentials(nonce_, request);
+    return SendMessage(*request);
+  }
+
+  std::unique_ptr<TurnMessage> SendMessage(const TurnMessage& request) {
+    rtc::ByteBufferWriter buf;
+    request.Write(&buf);
+    client_->SendTo(buf.Data(), buf.Length(), kTurnServerAddress);
+    std::unique_ptr<rtc::TestClient::Packet> packet =
+        client_->NextPacket(kTimeoutMs);
+    if (!packet) {
+      return nullptr;
+    }
+    auto response = std::make_unique<TurnMessage>();
+    rtc::ByteBufferReader reader(packet->buf, packet->size);
+    if (!response->Read(&reader)) {
+      return nullptr;
+    }
+    return response;
+  }
+
+  // Returns the relayed address.
+  rtc::SocketAddress Allocate() {
+    std::unique_ptr<TurnMessage> response = AllocateTestTurnRelay(
+        [this](const TurnMessage& request) { return SendMessage(request); },
+        &nonce_);
+    EXPECT_TRUE(response);
+    if (!response || !response->GetAddress(STUN_ATTR_XOR_RELAYED_ADDRESS)) {
+      return rtc::SocketAddress();
+    }
+    return response->GetAddress(STUN_ATTR_XOR_RELAYED_ADDRESS)->GetAddress();
+  }
+
+  // Returns the type of the response.
+  int BindChannel(int channel_id, const rtc::SocketAddress& peer) {
+    TurnMessage request;
+    request.SetType(TURN_CHANNEL_BIND_REQUEST);
+    request.AddAttribute(std::make_unique<StunUInt32Attribute>(
+        STUN_ATTR_CHANNEL_NUMBER, channel_id << 16));
+    request.AddAttribute(std::make_unique<StunXorAddressAttribute>(
+        STUN_ATTR_XOR_PEER_ADDRESS, peer));
+    std::unique_ptr<TurnMessage> response = SendRequest(&request);
+    return response ? response->type() : -1;
+  }
+
+  bool CreatePermission(const rtc::SocketAddress& peer) {
+    TurnMessage request;
+    request.SetType(TURN_CREATE_PERMISSION_REQUEST);
+    request.AddAttribute(std::make_unique<StunXorAddressAttribute>(
+        STUN_ATTR_XOR_PEER_ADDRESS, peer));
+    std::unique_ptr<TurnMessage> response = SendRequest(&request);
+    return response && response->type() == TURN_CREATE_PERMISSION_RESPONSE;
+  }
+
+  bool RefreshAllocation() {
+    TurnMessage request;
+    request.SetType(TURN_REFRESH_REQUEST);
+    std::unique_ptr<TurnMessage> response = SendRequest(&request);
+    return response && response->type() == TURN_REFRESH_RESPONSE;
+  }
+
+  size_t permission_count() const {
+    RTC_DCHECK_EQ(1, server_.allocations().size());
+    return server_.allocations().begin()->second->permission_count();
+  }
+
+  size_t channel_count() const {
+    RTC_DCHECK_EQ(1, server_.allocations().size());
+    return server_.allocations().begin()->second->channel_count();
+  }
+
+  void SendChannelData(int channel_id, const std::string& payload) {
+    rtc::ByteBufferWriter buf;
+    buf.WriteUInt16(static_cast<uint16_t>(channel_id));
+    buf.WriteUInt16(static_cast<uint16_t>(payload.size()));
+    buf.WriteString(payload);
+    client_->SendTo(buf.Data(), buf.Length(), kTurnServerAddress);
+  }
+
+  rtc::ScopedFakeClock fake_clock_;
+  rtc::VirtualSocketServer vss_;
+  rtc::AutoSocketServerThread thread_;
+  rtc::BasicPacketSocketFactory socket_factory_;
+  FixedKeyAuth auth_;
+  TurnServer server_;
+  std::unique_ptr<rtc::TestClient> client_;
+  std::unique_ptr<rtc::TestClient> peer1_;
+  std::unique_ptr<rtc::TestClient> peer2_;
+  std::string nonce_;
+};
+
+TEST_F(TurnServerAllocationTest, RelaysOverChannelInBothDirections) {
+  rtc::SocketAddress relayed_address = Allocate();
+  ASSERT_FALSE(relayed_address.IsNil());
+  EXPECT_EQ(TURN_CHANNEL_BIND_RESPONSE,
+            BindChannel(kChannelId, peer1_->address()));
+
+  const std::string kPayload = "client to peer";
+  SendChannelData(kChannelId, kPayload);
+  rtc::SocketAddress from;
+  EXPECT_TRUE(peer1_->CheckNextPacket(kPayload.data(), kPayload.size(), &from));
+  EXPECT_EQ(relayed_address, from);
+
+  const std::string kReply = "peer to client";
+  peer1_->SendTo(kReply.data(), kReply.size(), relayed_address);
+  std::unique_ptr<rtc::TestClient::Packet> packet =
+      client_->NextPacket(kTimeoutMs);
+  ASSERT_TRUE(packet);
+  ASSERT_EQ(4 + kReply.size(), packet->size);
+  EXPECT_EQ(kChannelId, rtc::GetBE16(packet->buf));
+  EXPECT_EQ(kReply.size(), rtc::GetBE16(packet->buf + 2));
+  EXPECT_EQ(kReply, std::string(packet->buf + 4, kReply.size()));
+}
+
+TEST_F(TurnServerAllocationTest, RejectsConflictingChannelBinds) {
+  ASSERT_FALSE(Allocate().IsNil());
+  EXPECT_EQ(TURN_CHANNEL_BIND_RESPONSE,
+            BindChannel(kChannelId, peer1_->address()));
+  // Refreshing the same binding is fine.
+  EXPECT_EQ(TURN_CHANNEL_BIND_RESPONSE,
+            BindChannel(kChannelId, peer1_->address()));
+  // The channel is bound to another peer.
+  EXPECT_EQ(TURN_CHANNEL_BIND_ERROR_RESPONSE,
+            BindChannel(kChannelId, peer2_->address()));
+  // The peer is bound to another channel.
+  EXPECT_EQ(TURN_CHANNEL_BIND_ERROR_RESPONSE,
+            BindChannel(kChannelId + 1, peer1_->address()));
+  // Channel numbers don't need to be consecutive.
+  EXPECT_EQ(TURN_CHANNEL_BIND_RESPONSE,
+            BindChannel(kChannelId + 100, peer2_->address()));
+}
+
+TEST_F(TurnServerAllocationTest, HighestChannelNumberOnlyStoresItsBinding) {
+  ASSERT_FALSE(Allocate().IsNil());
+  constexpr int kHighestChannelId = 0x7FFF;
+  EXPECT_EQ(TURN_CHANNEL_BIND_RESPONSE,
+            BindChannel(kHighestChannelId, peer1_->address()));
+  EXPECT_EQ(1u, channel_count());
+
+  const std::string kPayload = "highest channel";
+  SendChannelData(kHighestChannelId, kPayload);
+  EXPECT_TRUE(peer1_->CheckNextPacket(kPayload.data(), kPayload.size(),
+                                      nullptr));
+}
+
+TEST_F(TurnServerAllocationTest, ChannelBindingExpires) {
+  ASSERT_FALSE(Allocate().IsNil());
+  EXPECT_EQ(TURN_CHANNEL_BIND_RESPONSE,
+            BindChannel(kChannelId, peer1_->address()));
+
+  // Keep the allocation, but not the channel binding, alive past the 10
+  // minute channel lifetime.
+  fake_clock_.AdvanceTime(webrtc::TimeDelta::seconds(6 * 60));
+  ASSERT_TRUE(RefreshAllocation());
+  fake_clock_.AdvanceTime(webrtc::TimeDelta::seconds(5 * 60));
+
+  SendChannelData(kChannelId, "expired");
+  EXPECT_TRUE(peer1_->CheckNoPacket());
+  thread_.ProcessMessages(0);
+  EXPECT_EQ(0u, channel_count());
+  // Both the channel number and the peer can be bound again.
+  EXPECT_EQ(TURN_CHANNEL_BIND_RESPONSE,
+            BindChannel(kChannelId, peer2_->address()));
+  EXPECT_EQ(TURN_CHANNEL_BIND_RESPONSE,
+            BindChannel(kChannelId + 1, peer1_->address()));
+}
+
+TEST_F(TurnServerAllocationTest, PermissionCreatedAfterChannelBindExpires) {
+  ASSERT_FALSE(Allocate().IsNil());
+  EXPECT_EQ(TURN_CHANNEL_BIND_RESPONSE,
+            BindChannel(kChannelId, peer1_->address()));
+  fake_clock_.AdvanceTime(webrtc::TimeDelta::seconds(60));
+  ASSERT_TRUE(CreatePermission(peer2_->address()));
+  EXPECT_EQ(2u, permission_count());
+
+  // Both permissions expire within 6 minutes, long before the channel
+  // binding.
+  fake_clock_.AdvanceTime(webrtc::TimeDelta::seconds(6 * 60));
+  thread_.ProcessMessages(0);
+  EXPECT_EQ(0u, permission_count());
+
+  const std::string kPayload = "still bound";
+  SendChannelData(kChannelId, kPayload);
+  EXPECT_TRUE(peer1_->CheckNextPacket(kPayload.data(), kPayload.size(),
+                                      nullptr));
+}
+
 }  // namespace cricket
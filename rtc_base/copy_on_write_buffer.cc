@@ -47,6 +47,14 @@ CopyOnWriteBuffer::CopyOnWriteBuffer(size_t size, size_t capacity)
   RTC_DCHECK(IsConsistent());
 }
 
+CopyOnWriteBuffer::CopyOnWriteBuffer(
+    scoped_refptr<RefCountedObject<Buffer>> buffer)
+    : buffer_(buffer && buffer->capacity() > 0 ? std::move(buffer) : nullptr),
+      offset_(0),
+      size_(buffer_ ? buffer_->size() : 0) {
+  RTC_DCHECK(IsConsistent());
+}
+
 CopyOnWriteBuffer::~CopyOnWriteBuffer() = default;
 
 bool CopyOnWriteBuffer::operator==(const CopyOnWriteBuffer& buf) const {
@@ -43,6 +43,11 @@ class RTC_EXPORT CopyOnWriteBuffer {
   explicit CopyOnWriteBuffer(size_t size);
   CopyOnWriteBuffer(size_t size, size_t capacity);
 
+  // Use the given ref-counted buffer as underlying storage, without copying.
+  // The contents of |buffer| are kept as-is. Intended for buffer pools that
+  // recycle storage once the last reference to it is released.
+  explicit CopyOnWriteBuffer(scoped_refptr<RefCountedObject<Buffer>> buffer);
+
   // Construct a buffer and copy the specified number of bytes into it. The
   // source array may be (const) uint8_t*, int8_t*, or char*.
   template <typename T,
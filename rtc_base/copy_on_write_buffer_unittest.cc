@@ -51,6 +51,19 @@ TEST(CopyOnWriteBufferTest, TestCreateEmptyData) {
   EXPECT_EQ(buf.data(), nullptr);
 }
 
+TEST(CopyOnWriteBufferTest, AdoptsExistingBufferWithoutCopy) {
+  scoped_refptr<RefCountedObject<Buffer>> storage(
+      new RefCountedObject<Buffer>(kTestData, 3, 10));
+  const uint8_t* storage_data = storage->data();
+
+  CopyOnWriteBuffer buf(std::move(storage));
+  EXPECT_EQ(buf.size(), 3u);
+  EXPECT_EQ(buf.capacity(), 10u);
+  // The buffer is not shared, so writing must not reallocate.
+  EXPECT_EQ(buf.data(), storage_data);
+  EXPECT_EQ(0, memcmp(buf.cdata(), kTestData, 3));
+}
+
 TEST(CopyOnWriteBufferTest, TestMoveConstruct) {
   CopyOnWriteBuffer buf1(kTestData, 3, 10);
   size_t buf1_size = buf1.size();
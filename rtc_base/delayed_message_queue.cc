@@ -0,0 +1,334 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/delayed_message_queue.h"
+
+#include <algorithm>
+
+#include "rtc_base/checks.h"
+
+namespace rtc {
+
+namespace {
+
+// |bits| must not be zero.
+int LowestSetBit(uint64_t bits) {
+#if defined(__GNUC__)
+  return __builtin_ctzll(bits);
+#else
+  int index = 0;
+  while ((bits & 1) == 0) {
+    bits >>= 1;
+    ++index;
+  }
+  return index;
+#endif
+}
+
+}  // namespace
+
+DelayedMessageQueue::DelayedMessageQueue()
+    : free_(kNone), current_ms_(0), size_(0), next_number_(0) {
+  std::fill(std::begin(slots_), std::end(slots_), kNone);
+  std::fill(std::begin(occupied_), std::end(occupied_), 0);
+}
+
+DelayedMessageQueue::~DelayedMessageQueue() = default;
+
+void DelayedMessageQueue::Push(const Message& msg,
+                               int64_t run_at_ms,
+                               int64_t now_ms) {
+  if (size_ == 0) {
+    current_ms_ = now_ms - 1;
+  } else if (now_ms < current_ms_) {
+    // The clock went back, e.g. when a fake clock was installed.
+    Rebase(now_ms - 1);
+  }
+  int index = Allocate();
+  Entry& entry = entries_[index];
+  entry.msg = msg;
+  entry.run_at_ms = run_at_ms;
+  entry.number = next_number_;
+  // If this message queue processes 1 message every millisecond for 50 days,
+  // we will wrap this number.  Even then, only messages with identical times
+  // will be misordered, and then only briefly.  This is probably ok.
+  ++next_number_;
+  Place(index);
+  LinkHandler(index);
+  ++size_;
+}
+
+void DelayedMessageQueue::PopExpired(int64_t now_ms, MessageList* messages) {
+  if (size_ == 0) {
+    return;
+  }
+  if (now_ms < current_ms_) {
+    Rebase(now_ms);
+  } else {
+    Advance(now_ms);
+  }
+  expired_.clear();
+  for (int index = slots_[kExpiredSlot]; index != kNone;
+       index = entries_[index].next) {
+    expired_.push_back(index);
+  }
+  std::sort(expired_.begin(), expired_.end(), [this](int a, int b) {
+    const Entry& entry_a = entries_[a];
+    const Entry& entry_b = entries_[b];
+    return (entry_a.run_at_ms < entry_b.run_at_ms) ||
+           ((entry_a.run_at_ms == entry_b.run_at_ms) &&
+            (entry_a.number < entry_b.number));
+  });
+  for (int index : expired_) {
+    messages->push_back(Remove(index));
+  }
+}
+
+bool DelayedMessageQueue::GetNextRunTime(int64_t* run_at_ms) const {
+  if (size_ == 0) {
+    return false;
+  }
+  int slot = kExpiredSlot;
+  if (slots_[kExpiredSlot] == kNone) {
+    int64_t start_ms;
+    int level = FindNextSlot(&start_ms);
+    RTC_DCHECK_NE(level, kNone);
+    if (level == 0) {
+      // All the entries of a slot of the first level run at its start.
+      *run_at_ms = start_ms;
+      return true;
+    }
+    slot = (level == kLevels)
+               ? kOverflowSlot
+               : level * kSlotsPerLevel +
+                     static_cast<int>((start_ms >> (level * kBitsPerLevel)) &
+                                      (kSlotsPerLevel - 1));
+  }
+  int index = slots_[slot];
+  *run_at_ms = entries_[index].run_at_ms;
+  for (; index != kNone; index = entries_[index].next) {
+    *run_at_ms = std::min(*run_at_ms, entries_[index].run_at_ms);
+  }
+  return true;
+}
+
+void DelayedMessageQueue::Clear(MessageHandler* phandler,
+                                uint32_t id,
+                                MessageList* removed) {
+  MessageList local_removed;
+  MessageList* target = removed ? removed : &local_removed;
+  if (!phandler) {
+    for (size_t index = 0; index < entries_.size(); ++index) {
+      if (entries_[index].slot != kNone &&
+          entries_[index].msg.Match(phandler, id)) {
+        target->push_back(Remove(static_cast<int>(index)));
+      }
+    }
+  } else {
+    auto it = handlers_.find(phandler);
+    int index = (it != handlers_.end()) ? it->second : kNone;
+    while (index != kNone) {
+      int next = entries_[index].handler_next;
+      if (entries_[index].msg.Match(phandler, id)) {
+        target->push_back(Remove(index));
+      }
+      index = next;
+    }
+  }
+  // Deleting the data may destroy handlers, which clear their messages from
+  // this queue again, so it is done once the queue is consistent.
+  for (Message& msg : local_removed) {
+    delete msg.pdata;
+  }
+}
+
+int DelayedMessageQueue::Allocate() {
+  if (free_ == kNone) {
+    entries_.emplace_back();
+    return static_cast<int>(entries_.size() - 1);
+  }
+  int index = free_;
+  free_ = entries_[index].next;
+  return index;
+}
+
+void DelayedMessageQueue::Free(int index) {
+  Entry& entry = entries_[index];
+  entry.msg = Message();
+  entry.slot = kNone;
+  entry.next = free_;
+  free_ = index;
+}
+
+Message DelayedMessageQueue::Remove(int index) {
+  Message msg = entries_[index].msg;
+  UnlinkSlot(index);
+  UnlinkHandler(index);
+  Free(index);
+  --size_;
+  return msg;
+}
+
+void DelayedMessageQueue::LinkSlot(int index, int slot) {
+  Entry& entry = entries_[index];
+  entry.slot = slot;
+  entry.prev = kNone;
+  entry.next = slots_[slot];
+  if (entry.next != kNone) {
+    entries_[entry.next].prev = index;
+  }
+  slots_[slot] = index;
+  if (slot < kOverflowSlot) {
+    occupied_[slot / kSlotsPerLevel] |= uint64_t{1} << (slot % kSlotsPerLevel);
+  }
+}
+
+void DelayedMessageQueue::UnlinkSlot(int index) {
+  Entry& entry = entries_[index];
+  if (entry.prev != kNone) {
+    entries_[entry.prev].next = entry.next;
+  } else {
+    slots_[entry.slot] = entry.next;
+    if (entry.next == kNone && entry.slot < kOverflowSlot) {
+      occupied_[entry.slot / kSlotsPerLevel] &=
+          ~(uint64_t{1} << (entry.slot % kSlotsPerLevel));
+    }
+  }
+  if (entry.next != kNone) {
+    entries_[entry.next].prev = entry.prev;
+  }
+}
+
+void DelayedMessageQueue::LinkHandler(int index) {
+  Entry& entry = entries_[index];
+  auto result = handlers_.emplace(entry.msg.phandler, index);
+  entry.handler_prev = kNone;
+  entry.handler_next = kNone;
+  if (!result.second) {
+    entry.handler_next = result.first->second;
+    entries_[entry.handler_next].handler_prev = index;
+    result.first->second = index;
+  }
+}
+
+void DelayedMessageQueue::UnlinkHandler(int index) {
+  Entry& entry = entries_[index];
+  if (entry.handler_prev != kNone) {
+    entries_[entry.handler_prev].handler_next = entry.handler_next;
+  } else if (entry.handler_next != kNone) {
+    handlers_[entry.msg.phandler] = entry.handler_next;
+  } else {
+    handlers_.erase(entry.msg.phandler);
+  }
+  if (entry.handler_next != kNone) {
+    entries_[entry.handler_next].handler_prev = entry.handler_prev;
+  }
+}
+
+void DelayedMessageQueue::Place(int index) {
+  const int64_t run_at_ms = entries_[index].run_at_ms;
+  if (run_at_ms <= current_ms_) {
+    LinkSlot(index, kExpiredSlot);
+    return;
+  }
+  // The level is given by the highest group of bits in which the run time
+  // differs from the current time. The run time is then in a later slot of
+  // that level than the current time.
+  const uint64_t diff = static_cast<uint64_t>(run_at_ms ^ current_ms_);
+  for (int level = 0; level < kLevels; ++level) {
+    const int shift = level * kBitsPerLevel;
+    if ((diff >> (shift + kBitsPerLevel)) == 0) {
+      LinkSlot(index, level * kSlotsPerLevel +
+                          static_cast<int>((run_at_ms >> shift) &
+                                           (kSlotsPerLevel - 1)));
+      return;
+    }
+  }
+  LinkSlot(index, kOverflowSlot);
+}
+
+void DelayedMessageQueue::Redistribute(int slot) {
+  int index = slots_[slot];
+  slots_[slot] = kNone;
+  if (slot < kOverflowSlot) {
+    occupied_[slot / kSlotsPerLevel] &=
+        ~(uint64_t{1} << (slot % kSlotsPerLevel));
+  }
+  while (index != kNone) {
+    int next = entries_[index].next;
+    Place(index);
+    index = next;
+  }
+}
+
+void DelayedMessageQueue::Rebase(int64_t current_ms) {
+  current_ms_ = current_ms;
+  // Collect the entries first, since placing them may link them in slots not
+  // visited yet. The expired entries are placed again too, as some of them
+  // may not be due any more.
+  std::vector<int> indices;
+  for (int slot = 0; slot < kNumSlots; ++slot) {
+    for (int index = slots_[slot]; index != kNone;
+         index = entries_[index].next) {
+      indices.push_back(index);
+    }
+    slots_[slot] = kNone;
+  }
+  std::fill(std::begin(occupied_), std::end(occupied_), 0);
+  for (int index : indices) {
+    Place(index);
+  }
+}
+
+void DelayedMessageQueue::Advance(int64_t now_ms) {
+  while (current_ms_ < now_ms) {
+    int64_t start_ms;
+    int level = FindNextSlot(&start_ms);
+    if (level == kNone || start_ms > now_ms) {
+      // No slot is crossed, so the entries stay where they are.
+      current_ms_ = now_ms;
+      return;
+    }
+    current_ms_ = start_ms;
+    if (level == kLevels) {
+      Redistribute(kOverflowSlot);
+    } else {
+      Redistribute(level * kSlotsPerLevel +
+                   static_cast<int>((start_ms >> (level * kBitsPerLevel)) &
+                                    (kSlotsPerLevel - 1)));
+    }
+  }
+}
+
+int DelayedMessageQueue::FindNextSlot(int64_t* start_ms) const {
+  for (int level = 0; level < kLevels; ++level) {
+    const int shift = level * kBitsPerLevel;
+    const int current_slot =
+        static_cast<int>((current_ms_ >> shift) & (kSlotsPerLevel - 1));
+    // Slots up to the current one are empty at every level.
+    const uint64_t later_slots =
+        occupied_[level] & ~((uint64_t{2} << current_slot) - 1);
+    if (later_slots) {
+      const int64_t block_ms = (current_ms_ >> (shift + kBitsPerLevel))
+                               << (shift + kBitsPerLevel);
+      *start_ms = block_ms |
+                  (static_cast<int64_t>(LowestSetBit(later_slots)) << shift);
+      return level;
+    }
+  }
+  if (slots_[kOverflowSlot] != kNone) {
+    const int shift = kLevels * kBitsPerLevel;
+    *start_ms = ((current_ms_ >> shift) + 1) << shift;
+    return kLevels;
+  }
+  return kNone;
+}
+
+}  // namespace rtc
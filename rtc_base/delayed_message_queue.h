@@ -0,0 +1,127 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_DELAYED_MESSAGE_QUEUE_H_
+#define RTC_BASE_DELAYED_MESSAGE_QUEUE_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <unordered_map>
+#include <vector>
+
+#include "rtc_base/message_handler.h"
+#include "rtc_base/thread_message.h"
+
+namespace rtc {
+
+// Holds the delayed messages of a Thread until they are due, in a
+// hierarchical timer wheel with millisecond resolution. Adding a message,
+// and removing the messages of a handler, take constant time in the number
+// of other messages queued. Due messages are returned in order of run time,
+// and in the order they were added for equal run times.
+//
+// The wheel has four levels of 64 slots. A slot of level n covers 64^n
+// milliseconds, so the wheel spans about 4.6 hours; messages further in the
+// future wait in an overflow list. Not thread safe.
+class DelayedMessageQueue {
+ public:
+  DelayedMessageQueue();
+  // The data of messages still queued is not deleted.
+  ~DelayedMessageQueue();
+
+  DelayedMessageQueue(const DelayedMessageQueue&) = delete;
+  DelayedMessageQueue& operator=(const DelayedMessageQueue&) = delete;
+
+  bool empty() const { return size_ == 0; }
+  size_t size() const { return size_; }
+
+  // Adds |msg| to be run at |run_at_ms|. |now_ms| is the current time.
+  void Push(const Message& msg, int64_t run_at_ms, int64_t now_ms);
+
+  // Moves the messages due at |now_ms| to the end of |messages|.
+  void PopExpired(int64_t now_ms, MessageList* messages);
+
+  // Returns false if the queue is empty. Otherwise sets |run_at_ms| to the
+  // run time of the next message, which is in the past if it is due.
+  bool GetNextRunTime(int64_t* run_at_ms) const;
+
+  // Removes the messages matching |phandler| and |id|, see Message::Match().
+  // They are appended to |removed| if it is not null, and their data is
+  // deleted otherwise.
+  void Clear(MessageHandler* phandler, uint32_t id, MessageList* removed);
+
+ private:
+  static constexpr int kNone = -1;
+  static constexpr int kBitsPerLevel = 6;
+  static constexpr int kSlotsPerLevel = 1 << kBitsPerLevel;
+  static constexpr int kLevels = 4;
+  static constexpr int kOverflowSlot = kLevels * kSlotsPerLevel;
+  static constexpr int kExpiredSlot = kOverflowSlot + 1;
+  static constexpr int kNumSlots = kExpiredSlot + 1;
+
+  struct Entry {
+    Message msg;
+    int64_t run_at_ms;
+    // Orders messages with the same run time.
+    uint32_t number;
+    // Slot the entry is linked in, or kNone if it is free.
+    int slot;
+    // Links in the slot list, and in the list of entries of the handler.
+    int prev, next;
+    int handler_prev, handler_next;
+  };
+
+  int Allocate();
+  void Free(int index);
+  // Unlinks and frees |index|, returning its message.
+  Message Remove(int index);
+
+  void LinkSlot(int index, int slot);
+  void UnlinkSlot(int index);
+  void LinkHandler(int index);
+  void UnlinkHandler(int index);
+
+  // Links |index| in the slot for its run time relative to |current_ms_|, or
+  // in the expired list if it is due.
+  void Place(int index);
+  // Unlinks all the entries of |slot| and places them again.
+  void Redistribute(int slot);
+  // Places all entries again, including the expired ones, after |current_ms_|
+  // moved back in time.
+  void Rebase(int64_t current_ms);
+  // Moves |current_ms_| forward to |now_ms|, moving the entries that become
+  // due to the expired list.
+  void Advance(int64_t now_ms);
+  // Returns the level of the first occupied slot after |current_ms_|, and
+  // sets |start_ms| to the start of that slot. Returns kLevels, with the
+  // time the overflow list is redistributed, if only that list is occupied,
+  // and kNone if the wheel is empty.
+  int FindNextSlot(int64_t* start_ms) const;
+
+  std::vector<Entry> entries_;
+  int free_;
+  // Heads of the slot lists, by level and index, followed by the overflow and
+  // the expired lists.
+  int slots_[kNumSlots];
+  // One bit per occupied slot, for each level.
+  uint64_t occupied_[kLevels];
+  std::unordered_map<MessageHandler*, int> handlers_;
+  // Everything in the wheel and the overflow list runs after this time.
+  int64_t current_ms_;
+  size_t size_;
+  uint32_t next_number_;
+  // Reused by PopExpired() to sort the expired entries.
+  std::vector<int> expired_;
+};
+
+}  // namespace rtc
+
+#endif  // RTC_BASE_DELAYED_MESSAGE_QUEUE_H_
@@ -0,0 +1,223 @@
+/*
+ *  Copyright 2020 The WebRTC Project Authors. All rights reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/delayed_message_queue.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <tuple>
+#include <vector>
+
+#include "rtc_base/random.h"
+#include "test/gtest.h"
+
+namespace rtc {
+namespace {
+
+const int64_t kStartMs = 1000000;
+
+class TestHandler : public MessageHandler {
+ public:
+  void OnMessage(Message* msg) override {}
+};
+
+class DeletionTracker : public MessageData {
+ public:
+  explicit DeletionTracker(bool* deleted) : deleted_(deleted) {}
+  ~DeletionTracker() override { *deleted_ = true; }
+
+ private:
+  bool* const deleted_;
+};
+
+Message CreateMessage(MessageHandler* handler, uint32_t id) {
+  Message msg;
+  msg.phandler = handler;
+  msg.message_id = id;
+  return msg;
+}
+
+std::vector<uint32_t> PopIds(DelayedMessageQueue* queue, int64_t now_ms) {
+  MessageList messages;
+  queue->PopExpired(now_ms, &messages);
+  std::vector<uint32_t> ids;
+  for (const Message& msg : messages) {
+    ids.push_back(msg.message_id);
+  }
+  return ids;
+}
+
+TEST(DelayedMessageQueueTest, PopsMessagesInRunTimeOrder) {
+  TestHandler handler;
+  DelayedMessageQueue queue;
+  queue.Push(CreateMessage(&handler, 1), kStartMs + 300, kStartMs);
+  queue.Push(CreateMessage(&handler, 2), kStartMs + 10, kStartMs);
+  queue.Push(CreateMessage(&handler, 3), kStartMs + 100000, kStartMs);
+  queue.Push(CreateMessage(&handler, 4), kStartMs + 10, kStartMs);
+  queue.Push(CreateMessage(&handler, 5), kStartMs, kStartMs);
+  EXPECT_EQ(5u, queue.size());
+
+  EXPECT_EQ(std::vector<uint32_t>({5, 2, 4, 1, 3}),
+            PopIds(&queue, kStartMs + 1000000));
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(DelayedMessageQueueTest, PopsOnlyExpiredMessages) {
+  TestHandler handler;
+  DelayedMessageQueue queue;
+  // One message for each level of the wheel, and one in the overflow list.
+  const std::vector<int64_t> delays = {5, 500, 50000, 5000000, 50000000};
+  for (size_t i = 0; i < delays.size(); ++i) {
+    queue.Push(CreateMessage(&handler, i), kStartMs + delays[i], kStartMs);
+  }
+
+  for (size_t i = 0; i < delays.size(); ++i) {
+    int64_t run_at_ms;
+    ASSERT_TRUE(queue.GetNextRunTime(&run_at_ms));
+    EXPECT_EQ(kStartMs + delays[i], run_at_ms);
+    EXPECT_TRUE(PopIds(&queue, run_at_ms - 1).empty());
+    EXPECT_EQ(std::vector<uint32_t>({static_cast<uint32_t>(i)}),
+              PopIds(&queue, run_at_ms));
+  }
+  int64_t run_at_ms;
+  EXPECT_FALSE(queue.GetNextRunTime(&run_at_ms));
+}
+
+TEST(DelayedMessageQueueTest, ReportsPastRunTimeOfDueMessage) {
+  TestHandler handler;
+  DelayedMessageQueue queue;
+  queue.Push(CreateMessage(&handler, 1), kStartMs + 100, kStartMs);
+  EXPECT_TRUE(PopIds(&queue, kStartMs + 50).empty());
+  // Posted with a run time that has already passed.
+  queue.Push(CreateMessage(&handler, 2), kStartMs + 20, kStartMs + 50);
+  int64_t run_at_ms;
+  ASSERT_TRUE(queue.GetNextRunTime(&run_at_ms));
+  EXPECT_EQ(kStartMs + 20, run_at_ms);
+  EXPECT_EQ(std::vector<uint32_t>({2}), PopIds(&queue, kStartMs + 50));
+}
+
+TEST(DelayedMessageQueueTest, ClearsMessagesOfHandler) {
+  TestHandler handler1;
+  TestHandler handler2;
+  DelayedMessageQueue queue;
+  bool deleted = false;
+  Message msg = CreateMessage(&handler1, 1);
+  msg.pdata = new DeletionTracker(&deleted);
+  queue.Push(msg, kStartMs + 10, kStartMs);
+  queue.Push(CreateMessage(&handler1, 2), kStartMs + 20, kStartMs);
+  queue.Push(CreateMessage(&handler2, 3), kStartMs + 30, kStartMs);
+
+  queue.Clear(&handler1, 1, nullptr);
+  EXPECT_TRUE(deleted);
+  EXPECT_EQ(2u, queue.size());
+
+  MessageList removed;
+  queue.Clear(&handler1, MQID_ANY, &removed);
+  ASSERT_EQ(1u, removed.size());
+  EXPECT_EQ(2u, removed.front().message_id);
+
+  EXPECT_EQ(std::vector<uint32_t>({3}), PopIds(&queue, kStartMs + 100));
+}
+
+TEST(DelayedMessageQueueTest, ClearsAllMessages) {
+  TestHandler handler1;
+  TestHandler handler2;
+  DelayedMessageQueue queue;
+  queue.Push(CreateMessage(&handler1, 1), kStartMs + 10, kStartMs);
+  queue.Push(CreateMessage(&handler2, 2), kStartMs + 20, kStartMs);
+  MessageList removed;
+  queue.Clear(nullptr, MQID_ANY, &removed);
+  EXPECT_EQ(2u, removed.size());
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(DelayedMessageQueueTest, HandlesClockGoingBack) {
+  TestHandler handler;
+  DelayedMessageQueue queue;
+  queue.Push(CreateMessage(&handler, 1), kStartMs + 10, kStartMs);
+  // E.g. a fake clock starting at zero was installed.
+  queue.Push(CreateMessage(&handler, 2), 1010, 1000);
+  EXPECT_TRUE(PopIds(&queue, 1009).empty());
+  EXPECT_EQ(std::vector<uint32_t>({2}), PopIds(&queue, 1010));
+  EXPECT_EQ(std::vector<uint32_t>({1}), PopIds(&queue, kStartMs + 10));
+}
+
+TEST(DelayedMessageQueueTest, RebasesExpiredMessagesWhenClockGoesBack) {
+  TestHandler handler;
+  DelayedMessageQueue queue;
+  // Due as soon as it is pushed.
+  queue.Push(CreateMessage(&handler, 1), kStartMs - 10, kStartMs);
+  queue.Push(CreateMessage(&handler, 2), 1010, 1000);
+  EXPECT_TRUE(PopIds(&queue, 1009).empty());
+  EXPECT_EQ(std::vector<uint32_t>({2}), PopIds(&queue, 1010));
+  EXPECT_TRUE(PopIds(&queue, kStartMs - 11).empty());
+  EXPECT_EQ(std::vector<uint32_t>({1}), PopIds(&queue, kStartMs - 10));
+}
+
+// Compares the queue with a sorted list of messages, with random delays
+// spanning all the levels of the wheel, messages pushed already due, and the
+// clock occasionally going back.
+TEST(DelayedMessageQueueTest, MatchesReferenceOrder) {
+  TestHandler handlers[4];
+  DelayedMessageQueue queue;
+  // Run time, order of push and id of the messages not popped yet.
+  std::vector<std::tuple<int64_t, uint32_t, uint32_t>> reference;
+  webrtc::Random random(12345);
+  int64_t now_ms = kStartMs;
+  uint32_t next_id = 0;
+  for (int round = 0; round < 2000; ++round) {
+    const int pushes = random.Rand(0, 5);
+    for (int i = 0; i < pushes; ++i) {
+      const uint32_t max_delay_ms = 1u << random.Rand(0, 26);
+      const int64_t run_at_ms =
+          now_ms + random.Rand(0u, max_delay_ms) - random.Rand(0, 10);
+      const uint32_t id = next_id++;
+      queue.Push(CreateMessage(&handlers[id % 4], id), run_at_ms, now_ms);
+      reference.emplace_back(run_at_ms, id, id);
+    }
+    if (random.Rand(0, 50) == 0) {
+      const int handler = random.Rand(0, 3);
+      queue.Clear(&handlers[handler], MQID_ANY, nullptr);
+      reference.erase(
+          std::remove_if(reference.begin(), reference.end(),
+                         [handler](const std::tuple<int64_t, uint32_t,
+                                                    uint32_t>& message) {
+                           return std::get<2>(message) % 4 ==
+                                  static_cast<uint32_t>(handler);
+                         }),
+          reference.end());
+    }
+    std::sort(reference.begin(), reference.end());
+    ASSERT_EQ(reference.size(), queue.size());
+    int64_t run_at_ms;
+    if (!reference.empty()) {
+      ASSERT_TRUE(queue.GetNextRunTime(&run_at_ms));
+      EXPECT_EQ(std::get<0>(reference.front()), run_at_ms);
+    }
+
+    if (random.Rand(0, 20) == 0) {
+      now_ms -= int64_t{1} << random.Rand(0, 26);
+    } else {
+      now_ms += random.Rand(0, 1) ? random.Rand(0, 100)
+                                  : (int64_t{1} << random.Rand(0, 26));
+    }
+    std::vector<uint32_t> expected_ids;
+    auto it = reference.begin();
+    for (; it != reference.end() && std::get<0>(*it) <= now_ms; ++it) {
+      expected_ids.push_back(std::get<2>(*it));
+    }
+    reference.erase(reference.begin(), it);
+    ASSERT_EQ(expected_ids, PopIds(&queue, now_ms));
+  }
+}
+
+}  // namespace
+}  // namespace rtc
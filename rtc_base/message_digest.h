@@ -108,6 +108,19 @@ size_t ComputeHmac(const std::string& alg,
                    size_t in_len,
                    void* output,
                    size_t out_len);
+// Like the first ComputeHmac() function, but computes the HMAC of
+// |prefix_len| bytes of |prefix| followed by |in_len| bytes of |input|. This
+// lets callers replace the first bytes of a message, e.g. a length field,
+// without copying the message.
+size_t ComputeHmacWithPrefix(MessageDigest* digest,
+                             const void* key,
+                             size_t key_len,
+                             const void* prefix,
+                             size_t prefix_len,
+                             const void* input,
+                             size_t in_len,
+                             void* output,
+                             size_t out_len);
 // Computes the HMAC of |input| using the |digest| hash implementation and |key|
 // to key the HMAC, and returns it as a hex-encoded string.
 std::string ComputeHmac(MessageDigest* digest,
@@ -10,6 +10,8 @@
 
 #include "rtc_base/message_digest.h"
 
+#include <memory>
+
 #include "rtc_base/string_encode.h"
 #include "test/gtest.h"
 
@@ -146,6 +148,22 @@ TEST(MessageDigestTest, TestSha1Hmac) {
                         input.size(), output, sizeof(output) - 1));
 }
 
+TEST(MessageDigestTest, TestHmacWithPrefix) {
+  std::unique_ptr<MessageDigest> digest(
+      MessageDigestFactory::Create(DIGEST_SHA_1));
+  ASSERT_TRUE(digest);
+  std::string key("Jefe");
+  std::string prefix("what do ya ");
+  std::string input("want for nothing?");
+  char output[20];
+  EXPECT_EQ(sizeof(output),
+            ComputeHmacWithPrefix(digest.get(), key.data(), key.size(),
+                                  prefix.data(), prefix.size(), input.data(),
+                                  input.size(), output, sizeof(output)));
+  EXPECT_EQ("effcdf6ae5eb2fa2d27416d5f184df9c259a7c79",
+            hex_encode(output, sizeof(output)));
+}
+
 TEST(MessageDigestTest, TestBadHmac) {
   std::string output;
   EXPECT_FALSE(ComputeHmac("sha-9000", "key", "abc", &output));
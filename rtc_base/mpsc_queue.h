@@ -0,0 +1,120 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_MPSC_QUEUE_H_
+#define RTC_BASE_MPSC_QUEUE_H_
+
+#include <stddef.h>
+
+#include <atomic>
+#include <utility>
+#include <vector>
+
+#include "rtc_base/checks.h"
+#include "rtc_base/system/unused.h"
+
+namespace webrtc {
+
+// This class is a fixed-size, lock-free queue. Any number of producers may
+// call Insert() concurrently to insert an element of type T at the back of the
+// queue, and a single consumer calls Remove() to remove an element from the
+// front of the queue. Unlike SwapQueue, which only supports a single producer,
+// it is meant for small messages that may be posted from any thread, e.g.,
+// settings. Elements are moved in and out of preallocated slots, hence there
+// are no allocations after construction if moving a T does not allocate.
+//
+// Each slot carries a sequence number that tells whether it is free for the
+// producer that claimed its position or holds an element for the consumer.
+// Producers claim positions with a compare-and-swap on the write index, which
+// only fails if another producer claimed the same position in the meantime.
+// Remove() is wait-free.
+template <typename T>
+class MpscQueue {
+ public:
+  // Creates a queue of size |size| and fills it with default constructed Ts.
+  explicit MpscQueue(size_t size) : slots_(size) {
+    RTC_DCHECK_LT(0, size);
+    for (size_t k = 0; k < size; ++k) {
+      slots_[k].sequence.store(k, std::memory_order_relaxed);
+    }
+  }
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+
+  // Inserts |input| at the back of the queue. Returns true if the item was
+  // inserted or false if not (the queue was full). Can be called concurrently
+  // from several threads.
+  bool Insert(T input) RTC_WARN_UNUSED_RESULT {
+    size_t position = next_write_index_.load(std::memory_order_relaxed);
+    while (true) {
+      Slot& slot = slots_[position % slots_.size()];
+      // Acquire memory ordering ensures that the consumer is done reading the
+      // slot before it is overwritten.
+      const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+      if (sequence == position) {
+        // The slot is free; try to claim it. On failure, |position| is updated
+        // to the current write index.
+        if (next_write_index_.compare_exchange_weak(
+                position, position + 1, std::memory_order_relaxed)) {
+          slot.item = std::move(input);
+          // Release memory ordering publishes the item to the consumer.
+          slot.sequence.store(position + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (sequence < position) {
+        // The slot still holds the element inserted one lap earlier.
+        return false;
+      } else {
+        // Another producer claimed |position|.
+        position = next_write_index_.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  // Removes the frontmost element from the queue and moves it into *output.
+  // Returns true if an item could be removed or false if not (the queue was
+  // empty). Can only be called from the consumer.
+  bool Remove(T* output) RTC_WARN_UNUSED_RESULT {
+    RTC_DCHECK(output);
+    Slot& slot = slots_[next_read_index_ % slots_.size()];
+    // Acquire memory ordering ensures that the item written by the producer is
+    // visible.
+    if (slot.sequence.load(std::memory_order_acquire) !=
+        next_read_index_ + 1) {
+      return false;
+    }
+    *output = std::move(slot.item);
+    // Release memory ordering hands the slot back to the producers for the
+    // next lap.
+    slot.sequence.store(next_read_index_ + slots_.size(),
+                        std::memory_order_release);
+    ++next_read_index_;
+    return true;
+  }
+
+ private:
+  struct Slot {
+    std::atomic<size_t> sequence{0};
+    T item;
+  };
+
+  // Only accessed by the consumer.
+  size_t next_read_index_ = 0;
+
+  std::atomic<size_t> next_write_index_{0};
+
+  // The slots are created once and never reallocated, so their atomics are
+  // never moved.
+  std::vector<Slot> slots_;
+};
+
+}  // namespace webrtc
+
+#endif  // RTC_BASE_MPSC_QUEUE_H_
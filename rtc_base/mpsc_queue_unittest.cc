@@ -0,0 +1,148 @@
+/*
+ *  Copyright (c) 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/mpsc_queue.h"
+
+#include <memory>
+#include <vector>
+
+#include "rtc_base/platform_thread.h"
+#include "system_wrappers/include/sleep.h"
+#include "test/gtest.h"
+
+namespace webrtc {
+
+namespace {
+
+constexpr int kNumProducers = 4;
+constexpr int kNumItemsPerProducer = 1000;
+
+struct ProducerParams {
+  MpscQueue<int>* queue;
+  int producer_index;
+};
+
+// Inserts kNumItemsPerProducer increasing values tagged with the producer
+// index, retrying while the queue is full. Sleeping lets the consumer run on
+// single core machines.
+void ProducerThreadFunc(void* params_ptr) {
+  const ProducerParams* params = static_cast<ProducerParams*>(params_ptr);
+  for (int k = 0; k < kNumItemsPerProducer; ++k) {
+    const int item = params->producer_index * kNumItemsPerProducer + k;
+    while (!params->queue->Insert(item)) {
+      SleepMs(1);
+    }
+  }
+}
+
+}  // namespace
+
+TEST(MpscQueueTest, BasicOperation) {
+  MpscQueue<int> queue(2);
+  int i = 0;
+  EXPECT_TRUE(queue.Insert(1));
+  EXPECT_TRUE(queue.Insert(2));
+  EXPECT_TRUE(queue.Remove(&i));
+  EXPECT_EQ(i, 1);
+  EXPECT_TRUE(queue.Remove(&i));
+  EXPECT_EQ(i, 2);
+}
+
+TEST(MpscQueueTest, FullQueue) {
+  MpscQueue<int> queue(2);
+
+  // Fill the queue.
+  EXPECT_TRUE(queue.Insert(0));
+  EXPECT_TRUE(queue.Insert(1));
+  EXPECT_FALSE(queue.Insert(2));
+
+  // Ensure that the Insert didn't overwrite anything in the queue.
+  int i = -1;
+  EXPECT_TRUE(queue.Remove(&i));
+  EXPECT_EQ(i, 0);
+
+  // Ensure that the queue is no longer full.
+  EXPECT_TRUE(queue.Insert(3));
+  EXPECT_TRUE(queue.Remove(&i));
+  EXPECT_EQ(i, 1);
+  EXPECT_TRUE(queue.Remove(&i));
+  EXPECT_EQ(i, 3);
+}
+
+TEST(MpscQueueTest, EmptyQueue) {
+  MpscQueue<int> queue(2);
+  int i = 0;
+  EXPECT_FALSE(queue.Remove(&i));
+  EXPECT_TRUE(queue.Insert(i));
+  EXPECT_TRUE(queue.Remove(&i));
+  EXPECT_FALSE(queue.Remove(&i));
+}
+
+TEST(MpscQueueTest, WrapsAround) {
+  MpscQueue<int> queue(3);
+  int i = 0;
+  for (int k = 0; k < 10; ++k) {
+    EXPECT_TRUE(queue.Insert(k));
+    EXPECT_TRUE(queue.Insert(-k));
+    EXPECT_TRUE(queue.Remove(&i));
+    EXPECT_EQ(i, k);
+    EXPECT_TRUE(queue.Remove(&i));
+    EXPECT_EQ(i, -k);
+  }
+}
+
+TEST(MpscQueueTest, MovesItems) {
+  MpscQueue<std::unique_ptr<int>> queue(2);
+  EXPECT_TRUE(queue.Insert(std::make_unique<int>(42)));
+  std::unique_ptr<int> item;
+  EXPECT_TRUE(queue.Remove(&item));
+  ASSERT_TRUE(item);
+  EXPECT_EQ(*item, 42);
+}
+
+// Verifies that no item is lost or duplicated and that the items of each
+// producer are removed in order when several producers insert concurrently.
+TEST(MpscQueueTest, ConcurrentProducers) {
+  MpscQueue<int> queue(8);
+  std::vector<ProducerParams> params;
+  std::vector<std::unique_ptr<rtc::PlatformThread>> threads;
+  for (int p = 0; p < kNumProducers; ++p) {
+    params.push_back({&queue, p});
+  }
+  for (int p = 0; p < kNumProducers; ++p) {
+    threads.push_back(std::make_unique<rtc::PlatformThread>(
+        ProducerThreadFunc, &params[p], "MpscQueueProducer"));
+    threads.back()->Start();
+  }
+
+  std::vector<int> next_item(kNumProducers, 0);
+  int num_removed = 0;
+  while (num_removed < kNumProducers * kNumItemsPerProducer) {
+    int item;
+    if (!queue.Remove(&item)) {
+      SleepMs(1);
+      continue;
+    }
+    const int producer_index = item / kNumItemsPerProducer;
+    ASSERT_LE(0, producer_index);
+    ASSERT_LT(producer_index, kNumProducers);
+    ASSERT_EQ(next_item[producer_index], item % kNumItemsPerProducer);
+    ++next_item[producer_index];
+    ++num_removed;
+  }
+
+  for (auto& thread : threads) {
+    thread->Stop();
+  }
+  int item;
+  EXPECT_FALSE(queue.Remove(&item));
+}
+
+}  // namespace webrtc
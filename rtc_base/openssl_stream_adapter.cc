@@ -25,6 +25,7 @@
 #include <utility>
 #include <vector>
 
+#include "rtc_base/buffer.h"
 #include "rtc_base/checks.h"
 #include "rtc_base/logging.h"
 #include "rtc_base/numerics/safe_conversions.h"
@@ -145,6 +146,30 @@ void TimeCallbackForTesting(const SSL* ssl, struct timeval* out_clock) {
 }
 #endif
 
+// The largest packet OpenSSL is told it may send. The handshake doesn't
+// actually need to send packets above 1k, so this seems like a sensible value
+// that should work in most cases. Webrtc uses the same value for video
+// packets.
+const size_t kMaxPacketSize = 1200;
+
+// State of a stream BIO. While |coalesce| is set, the records written are
+// collected in |pending| instead of being written to |stream| one by one, and
+// are written in as few packets of at most |kMaxPacketSize| bytes as possible
+// when coalescing ends. DTLS allows several records in one datagram, so a
+// whole handshake flight can usually go in a single packet. A packet the
+// stream blocks on stays in |pending| until the stream is writable again.
+struct StreamBIOData {
+  explicit StreamBIOData(StreamInterface* stream) : stream(stream) {}
+
+  StreamInterface* const stream;
+  bool coalesce = false;
+  Buffer pending;
+  // Set when writing |pending| failed while coalescing, to be reported when
+  // coalescing ends.
+  bool write_failed = false;
+  int write_error = 0;
+};
+
 }  // namespace
 
 //////////////////////////////////////////////////////////////////////
@@ -177,10 +202,55 @@ static BIO* BIO_new_stream(StreamInterface* stream) {
   if (ret == nullptr) {
     return nullptr;
   }
-  BIO_set_data(ret, stream);
+  BIO_set_data(ret, new StreamBIOData(stream));
   return ret;
 }
 
+// Writes the records collected while coalescing. They are kept if the stream
+// blocks, and dropped if it fails.
+static StreamResult stream_flush_pending(StreamBIOData* data, int* error) {
+  if (data->pending.empty()) {
+    return SR_SUCCESS;
+  }
+  size_t written;
+  StreamResult result = data->stream->Write(
+      data->pending.data(), data->pending.size(), &written, error);
+  if (result == SR_BLOCK) {
+    return result;
+  }
+  data->pending.Clear();
+  if (result == SR_ERROR && data->coalesce && !data->write_failed) {
+    data->write_failed = true;
+    data->write_error = *error;
+  }
+  return result;
+}
+
+// Writes the records the stream blocked on. Returns SR_ERROR if writing them
+// failed, now or while coalescing.
+static StreamResult BIO_stream_flush(BIO* b, int* error) {
+  StreamBIOData* data = static_cast<StreamBIOData*>(BIO_get_data(b));
+  if (data->write_failed) {
+    data->write_failed = false;
+    *error = data->write_error;
+    return SR_ERROR;
+  }
+  return stream_flush_pending(data, error);
+}
+
+// Starts collecting the records written to |b|, to be sent together.
+static void BIO_stream_begin_coalescing(BIO* b) {
+  StreamBIOData* data = static_cast<StreamBIOData*>(BIO_get_data(b));
+  data->coalesce = true;
+}
+
+// Writes the records collected since BIO_stream_begin_coalescing().
+static StreamResult BIO_stream_end_coalescing(BIO* b, int* error) {
+  StreamBIOData* data = static_cast<StreamBIOData*>(BIO_get_data(b));
+  data->coalesce = false;
+  return BIO_stream_flush(b, error);
+}
+
 // bio methods return 1 (or at least non-zero) on success and 0 on failure.
 
 static int stream_new(BIO* b) {
@@ -194,6 +264,8 @@ static int stream_free(BIO* b) {
   if (b == nullptr) {
     return 0;
   }
+  delete static_cast<StreamBIOData*>(BIO_get_data(b));
+  BIO_set_data(b, nullptr);
   return 1;
 }
 
@@ -201,7 +273,8 @@ static int stream_read(BIO* b, char* out, int outl) {
   if (!out) {
     return -1;
   }
-  StreamInterface* stream = static_cast<StreamInterface*>(BIO_get_data(b));
+  StreamInterface* stream =
+      static_cast<StreamBIOData*>(BIO_get_data(b))->stream;
   BIO_clear_retry_flags(b);
   size_t read;
   int error;
@@ -218,11 +291,24 @@ static int stream_write(BIO* b, const char* in, int inl) {
   if (!in) {
     return -1;
   }
-  StreamInterface* stream = static_cast<StreamInterface*>(BIO_get_data(b));
+  StreamBIOData* data = static_cast<StreamBIOData*>(BIO_get_data(b));
   BIO_clear_retry_flags(b);
+  int error = 0;
+  // Records written earlier go first. While coalescing, they only need to
+  // be written once |in| doesn't fit in the same packet.
+  StreamResult result = SR_SUCCESS;
+  if (!data->coalesce ||
+      data->pending.size() + static_cast<size_t>(inl) > kMaxPacketSize) {
+    result = stream_flush_pending(data, &error);
+  }
+  if (result == SR_SUCCESS && data->coalesce) {
+    data->pending.AppendData(in, inl);
+    return inl;
+  }
   size_t written;
-  int error;
-  StreamResult result = stream->Write(in, inl, &written, &error);
+  if (result == SR_SUCCESS) {
+    result = data->stream->Write(in, inl, &written, &error);
+  }
   if (result == SR_SUCCESS) {
     return checked_cast<int>(written);
   } else if (result == SR_BLOCK) {
@@ -248,13 +334,11 @@ static long stream_ctrl(BIO* b, int cmd, long num, void* ptr) {
     case BIO_CTRL_PENDING:
       return 0;
     case BIO_CTRL_FLUSH:
+      // While coalescing, the records are written when it ends.
       return 1;
     case BIO_CTRL_DGRAM_QUERY_MTU:
       // openssl defaults to mtu=256 unless we return something here.
-      // The handshake doesn't actually need to send packets above 1k,
-      // so this seems like a sensible value that should work in most cases.
-      // Webrtc uses the same value for video packets.
-      return 1200;
+      return kMaxPacketSize;
     default:
       return 0;
   }
@@ -738,6 +822,15 @@ void OpenSSLStreamAdapter::OnEvent(StreamInterface* stream,
     }
   }
 
+  if ((events & SE_WRITE) && ssl_) {
+    // Write the retransmitted records the stream blocked on.
+    int error = 0;
+    if (BIO_stream_flush(SSL_get_wbio(ssl_), &error) == SR_ERROR) {
+      Error("BIO_stream_flush", error, 0, true);
+      return;
+    }
+  }
+
   if ((events & (SE_READ | SE_WRITE))) {
     RTC_LOG(LS_VERBOSE) << "OpenSSLStreamAdapter::OnEvent"
                         << ((events & SE_READ) ? " SE_READ" : "")
@@ -945,7 +1038,16 @@ void OpenSSLStreamAdapter::OnMessage(Message* msg) {
   // Process our own messages and then pass others to the superclass
   if (MSG_TIMEOUT == msg->message_id) {
     RTC_LOG(LS_INFO) << "DTLS timeout expired";
+    // The first transmission of a flight is packed by the SSL library, but
+    // retransmitted messages are written one by one.
+    BIO* bio = SSL_get_wbio(ssl_);
+    BIO_stream_begin_coalescing(bio);
     DTLSv1_handle_timeout(ssl_);
+    int error = 0;
+    if (BIO_stream_end_coalescing(bio, &error) == SR_ERROR) {
+      Error("DTLSv1_handle_timeout", error, 0, true);
+      return;
+    }
     ContinueSSL();
   } else {
     StreamInterface::OnMessage(msg);
@@ -42,17 +42,21 @@ enum {
 class RTCCertificateGenerationTask : public RefCountInterface,
                                      public MessageHandler {
  public:
+  // If |certificate| is set, it is handed to |callback| without generating a
+  // new one.
   RTCCertificateGenerationTask(
       Thread* signaling_thread,
       Thread* worker_thread,
       const KeyParams& key_params,
       const absl::optional<uint64_t>& expires_ms,
-      const scoped_refptr<RTCCertificateGeneratorCallback>& callback)
+      const scoped_refptr<RTCCertificateGeneratorCallback>& callback,
+      const scoped_refptr<RTCCertificate>& certificate)
       : signaling_thread_(signaling_thread),
         worker_thread_(worker_thread),
         key_params_(key_params),
         expires_ms_(expires_ms),
-        callback_(callback) {
+        callback_(callback),
+        certificate_(certificate) {
     RTC_DCHECK(signaling_thread_);
     RTC_DCHECK(worker_thread_);
     RTC_DCHECK(callback_);
@@ -135,7 +139,15 @@ scoped_refptr<RTCCertificate> RTCCertificateGenerator::GenerateCertificate(
 
 RTCCertificateGenerator::RTCCertificateGenerator(Thread* signaling_thread,
                                                  Thread* worker_thread)
-    : signaling_thread_(signaling_thread), worker_thread_(worker_thread) {
+    : RTCCertificateGenerator(signaling_thread, worker_thread, nullptr) {}
+
+RTCCertificateGenerator::RTCCertificateGenerator(
+    Thread* signaling_thread,
+    Thread* worker_thread,
+    scoped_refptr<RTCCertificatePool> pool)
+    : signaling_thread_(signaling_thread),
+      worker_thread_(worker_thread),
+      pool_(std::move(pool)) {
   RTC_DCHECK(signaling_thread_);
   RTC_DCHECK(worker_thread_);
 }
@@ -147,6 +159,11 @@ void RTCCertificateGenerator::GenerateCertificateAsync(
   RTC_DCHECK(signaling_thread_->IsCurrent());
   RTC_DCHECK(callback);
 
+  scoped_refptr<RTCCertificate> certificate;
+  if (pool_ && !expires_ms) {
+    certificate = pool_->Take(key_params);
+  }
+
   // Create a new |RTCCertificateGenerationTask| for this generation request. It
   // is reference counted and referenced by the message data, ensuring it lives
   // until the task has completed (independent of |RTCCertificateGenerator|).
@@ -154,7 +171,13 @@ void RTCCertificateGenerator::GenerateCertificateAsync(
       new ScopedRefMessageData<RTCCertificateGenerationTask>(
           new RefCountedObject<RTCCertificateGenerationTask>(
               signaling_thread_, worker_thread_, key_params, expires_ms,
-              callback));
+              callback, certificate));
+  if (certificate) {
+    // The callback is still invoked asynchronously, as callers expect.
+    signaling_thread_->Post(RTC_FROM_HERE, msg_data->data().get(),
+                            MSG_GENERATE_DONE, msg_data);
+    return;
+  }
   worker_thread_->Post(RTC_FROM_HERE, msg_data->data().get(), MSG_GENERATE,
                        msg_data);
 }
@@ -17,6 +17,7 @@
 #include "api/scoped_refptr.h"
 #include "rtc_base/ref_count.h"
 #include "rtc_base/rtc_certificate.h"
+#include "rtc_base/rtc_certificate_pool.h"
 #include "rtc_base/ssl_identity.h"
 #include "rtc_base/system/rtc_export.h"
 #include "rtc_base/thread.h"
@@ -67,6 +68,12 @@ class RTC_EXPORT RTCCertificateGenerator
       const absl::optional<uint64_t>& expires_ms);
 
   RTCCertificateGenerator(Thread* signaling_thread, Thread* worker_thread);
+  // Hands out certificates from |pool| when it has one ready for the
+  // requested key type and no expiration time is specified, and generates
+  // them on |worker_thread| otherwise.
+  RTCCertificateGenerator(Thread* signaling_thread,
+                          Thread* worker_thread,
+                          scoped_refptr<RTCCertificatePool> pool);
   ~RTCCertificateGenerator() override {}
 
   // |RTCCertificateGeneratorInterface| overrides.
@@ -82,6 +89,7 @@ class RTC_EXPORT RTCCertificateGenerator
  private:
   Thread* const signaling_thread_;
   Thread* const worker_thread_;
+  const scoped_refptr<RTCCertificatePool> pool_;
 };
 
 }  // namespace rtc
@@ -0,0 +1,164 @@
+/*
+ *  Copyright 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/rtc_certificate_pool.h"
+
+#include <algorithm>
+
+#include "absl/types/optional.h"
+#include "rtc_base/checks.h"
+#include "rtc_base/ref_counted_object.h"
+#include "rtc_base/rtc_certificate_generator.h"
+#include "rtc_base/time_utils.h"
+
+namespace rtc {
+
+namespace {
+
+bool SameKeyParams(const KeyParams& a, const KeyParams& b) {
+  if (a.type() != b.type()) {
+    return false;
+  }
+  switch (a.type()) {
+    case KT_RSA:
+      return a.rsa_params().mod_size == b.rsa_params().mod_size &&
+             a.rsa_params().pub_exp == b.rsa_params().pub_exp;
+    case KT_ECDSA:
+      return a.ec_curve() == b.ec_curve();
+    default:
+      return true;
+  }
+}
+
+}  // namespace
+
+RTCCertificatePool::Config::Config() = default;
+RTCCertificatePool::Config::Config(const Config&) = default;
+RTCCertificatePool::Config::~Config() = default;
+
+RTCCertificatePool::Entry::Entry(const KeyParams& key_params)
+    : key_params(key_params) {}
+RTCCertificatePool::Entry::Entry(const Entry&) = default;
+RTCCertificatePool::Entry::~Entry() = default;
+
+// static
+scoped_refptr<RTCCertificatePool> RTCCertificatePool::Create(
+    webrtc::TaskQueueFactory* task_queue_factory,
+    const Config& config) {
+  scoped_refptr<RTCCertificatePool> pool =
+      new RefCountedObject<RTCCertificatePool>(task_queue_factory, config);
+  for (size_t i = 0; i < config.key_params.size(); ++i) {
+    pool->Refill(i);
+  }
+  return pool;
+}
+
+RTCCertificatePool::RTCCertificatePool(
+    webrtc::TaskQueueFactory* task_queue_factory,
+    const Config& config)
+    : certificates_per_key_type_(config.certificates_per_key_type),
+      min_remaining_lifetime_ms_(config.min_remaining_lifetime_ms),
+      task_queue_(task_queue_factory->CreateTaskQueue(
+          "RTCCertificatePool",
+          webrtc::TaskQueueFactory::Priority::LOW)) {
+  for (const KeyParams& key_params : config.key_params) {
+    RTC_DCHECK(key_params.IsValid());
+    entries_.emplace_back(key_params);
+  }
+}
+
+RTCCertificatePool::~RTCCertificatePool() = default;
+
+scoped_refptr<RTCCertificate> RTCCertificatePool::Take(
+    const KeyParams& key_params) {
+  const uint64_t min_expires =
+      static_cast<uint64_t>(TimeUTCMillis()) + min_remaining_lifetime_ms_;
+  scoped_refptr<RTCCertificate> certificate;
+  size_t index;
+  {
+    CritScope cs(&lock_);
+    for (index = 0; index < entries_.size(); ++index) {
+      if (SameKeyParams(entries_[index].key_params, key_params)) {
+        break;
+      }
+    }
+    if (index == entries_.size()) {
+      ++misses_;
+      return nullptr;
+    }
+    std::vector<scoped_refptr<RTCCertificate>>& certificates =
+        entries_[index].certificates;
+    certificates.erase(
+        std::remove_if(certificates.begin(), certificates.end(),
+                       [min_expires](const scoped_refptr<RTCCertificate>& c) {
+                         return c->HasExpired(min_expires);
+                       }),
+        certificates.end());
+    if (certificates.empty()) {
+      ++misses_;
+    } else {
+      ++hits_;
+      certificate = std::move(certificates.back());
+      certificates.pop_back();
+    }
+  }
+  Refill(index);
+  return certificate;
+}
+
+RTCCertificatePool::Stats RTCCertificatePool::GetStats() const {
+  CritScope cs(&lock_);
+  Stats stats;
+  stats.hits = hits_;
+  stats.misses = misses_;
+  for (const Entry& entry : entries_) {
+    stats.certificates_ready += entry.certificates.size();
+  }
+  return stats;
+}
+
+void RTCCertificatePool::Refill(size_t index) {
+  size_t missing;
+  {
+    CritScope cs(&lock_);
+    Entry& entry = entries_[index];
+    const size_t available = entry.certificates.size() + entry.pending;
+    if (available >= certificates_per_key_type_) {
+      return;
+    }
+    missing = certificates_per_key_type_ - available;
+    entry.pending += missing;
+  }
+  for (size_t i = 0; i < missing; ++i) {
+    task_queue_.PostTask([this, index] { GenerateCertificate(index); });
+  }
+}
+
+void RTCCertificatePool::GenerateCertificate(size_t index) {
+  RTC_DCHECK(task_queue_.IsCurrent());
+  KeyParams key_params;
+  {
+    CritScope cs(&lock_);
+    key_params = entries_[index].key_params;
+  }
+  // Generating the key is what takes time, so it is done without the lock.
+  scoped_refptr<RTCCertificate> certificate =
+      RTCCertificateGenerator::GenerateCertificate(key_params, absl::nullopt);
+  CritScope cs(&lock_);
+  Entry& entry = entries_[index];
+  RTC_DCHECK_GT(entry.pending, 0);
+  --entry.pending;
+  // A failure is not retried; the next Take() schedules another attempt.
+  if (certificate) {
+    entry.certificates.push_back(std::move(certificate));
+  }
+}
+
+}  // namespace rtc
@@ -0,0 +1,111 @@
+/*
+ *  Copyright 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#ifndef RTC_BASE_RTC_CERTIFICATE_POOL_H_
+#define RTC_BASE_RTC_CERTIFICATE_POOL_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <vector>
+
+#include "api/scoped_refptr.h"
+#include "api/task_queue/task_queue_factory.h"
+#include "rtc_base/critical_section.h"
+#include "rtc_base/ref_count.h"
+#include "rtc_base/rtc_certificate.h"
+#include "rtc_base/ssl_identity.h"
+#include "rtc_base/system/rtc_export.h"
+#include "rtc_base/task_queue.h"
+#include "rtc_base/thread_annotations.h"
+
+namespace rtc {
+
+// Keeps certificates generated ahead of time for a set of key types, so that
+// they can be handed out without waiting for a key to be generated, which
+// takes tens of milliseconds for ECDSA and hundreds for RSA. Certificates that
+// are taken, or that are about to expire, are replaced on a low priority task
+// queue. The pool is thread safe and can be shared by several
+// |RTCCertificateGenerator|s.
+class RTC_EXPORT RTCCertificatePool : public RefCountInterface {
+ public:
+  struct Config {
+    Config();
+    Config(const Config&);
+    ~Config();
+
+    // Key types to keep certificates for.
+    std::vector<KeyParams> key_params;
+    // Number of certificates to keep ready for each key type.
+    size_t certificates_per_key_type = 2;
+    // Certificates that expire sooner than this are dropped instead of being
+    // handed out.
+    uint64_t min_remaining_lifetime_ms = 24 * 60 * 60 * 1000;
+  };
+
+  struct Stats {
+    // Number of calls to Take() that returned a certificate.
+    uint64_t hits = 0;
+    // Number of calls to Take() that found no certificate ready.
+    uint64_t misses = 0;
+    // Number of certificates currently ready, for all key types.
+    size_t certificates_ready = 0;
+  };
+
+  // Creates a pool and starts generating certificates on a task queue created
+  // with |task_queue_factory|, which is only used during the call.
+  static scoped_refptr<RTCCertificatePool> Create(
+      webrtc::TaskQueueFactory* task_queue_factory,
+      const Config& config);
+
+  // Removes a ready certificate for |key_params| from the pool and schedules
+  // its replacement. Returns null if there is none, or if the pool is not
+  // configured for |key_params|.
+  scoped_refptr<RTCCertificate> Take(const KeyParams& key_params);
+
+  Stats GetStats() const;
+
+ protected:
+  RTCCertificatePool(webrtc::TaskQueueFactory* task_queue_factory,
+                     const Config& config);
+  ~RTCCertificatePool() override;
+
+ private:
+  struct Entry {
+    explicit Entry(const KeyParams& key_params);
+    Entry(const Entry&);
+    ~Entry();
+
+    KeyParams key_params;
+    std::vector<scoped_refptr<RTCCertificate>> certificates;
+    // Number of certificates being generated.
+    size_t pending = 0;
+  };
+
+  // Posts tasks to generate the certificates missing for |entries_[index]|.
+  void Refill(size_t index);
+  // Runs on |task_queue_|.
+  void GenerateCertificate(size_t index);
+
+  const size_t certificates_per_key_type_;
+  const uint64_t min_remaining_lifetime_ms_;
+  mutable rtc::CriticalSection lock_;
+  // Not resized after construction, so indices stay valid.
+  std::vector<Entry> entries_ RTC_GUARDED_BY(lock_);
+  uint64_t hits_ RTC_GUARDED_BY(lock_) = 0;
+  uint64_t misses_ RTC_GUARDED_BY(lock_) = 0;
+  // Declared last so that it is destroyed, and its pending tasks dropped,
+  // before the members the tasks use.
+  TaskQueue task_queue_;
+};
+
+}  // namespace rtc
+
+#endif  // RTC_BASE_RTC_CERTIFICATE_POOL_H_
@@ -0,0 +1,130 @@
+/*
+ *  Copyright 2020 The WebRTC project authors. All Rights Reserved.
+ *
+ *  Use of this source code is governed by a BSD-style license
+ *  that can be found in the LICENSE file in the root of the source
+ *  tree. An additional intellectual property rights grant can be found
+ *  in the file PATENTS.  All contributing project authors may
+ *  be found in the AUTHORS file in the root of the source tree.
+ */
+
+#include "rtc_base/rtc_certificate_pool.h"
+
+#include <memory>
+
+#include "absl/types/optional.h"
+#include "api/task_queue/default_task_queue_factory.h"
+#include "rtc_base/gunit.h"
+#include "rtc_base/ref_counted_object.h"
+#include "rtc_base/rtc_certificate_generator.h"
+#include "rtc_base/thread.h"
+#include "test/gtest.h"
+
+namespace rtc {
+namespace {
+
+const int kGenerationTimeoutMs = 10000;
+// Longer than the default lifetime of a generated certificate.
+const uint64_t kYearMs = 365ull * 24 * 60 * 60 * 1000;
+
+class CertificateCallback : public RTCCertificateGeneratorCallback {
+ public:
+  void OnSuccess(const scoped_refptr<RTCCertificate>& certificate) override {
+    certificate_ = certificate;
+    completed_ = true;
+  }
+  void OnFailure() override { completed_ = true; }
+
+  bool completed() const { return completed_; }
+  RTCCertificate* certificate() const { return certificate_.get(); }
+
+ private:
+  bool completed_ = false;
+  scoped_refptr<RTCCertificate> certificate_;
+};
+
+class RTCCertificatePoolTest : public ::testing::Test {
+ public:
+  RTCCertificatePoolTest()
+      : task_queue_factory_(webrtc::CreateDefaultTaskQueueFactory()) {
+    config_.key_params.push_back(KeyParams::ECDSA());
+    config_.certificates_per_key_type = 2;
+  }
+
+ protected:
+  scoped_refptr<RTCCertificatePool> CreatePool() {
+    return RTCCertificatePool::Create(task_queue_factory_.get(), config_);
+  }
+
+  std::unique_ptr<webrtc::TaskQueueFactory> task_queue_factory_;
+  RTCCertificatePool::Config config_;
+};
+
+}  // namespace
+
+TEST_F(RTCCertificatePoolTest, HandsOutPreGeneratedCertificates) {
+  scoped_refptr<RTCCertificatePool> pool = CreatePool();
+  EXPECT_EQ_WAIT(2u, pool->GetStats().certificates_ready,
+                 kGenerationTimeoutMs);
+
+  scoped_refptr<RTCCertificate> first = pool->Take(KeyParams::ECDSA());
+  scoped_refptr<RTCCertificate> second = pool->Take(KeyParams::ECDSA());
+  ASSERT_TRUE(first);
+  ASSERT_TRUE(second);
+  EXPECT_NE(first, second);
+  EXPECT_EQ(2u, pool->GetStats().hits);
+  EXPECT_EQ(0u, pool->GetStats().misses);
+
+  // The certificates taken are replaced.
+  EXPECT_EQ_WAIT(2u, pool->GetStats().certificates_ready,
+                 kGenerationTimeoutMs);
+}
+
+TEST_F(RTCCertificatePoolTest, MissesForKeyTypeNotInPool) {
+  scoped_refptr<RTCCertificatePool> pool = CreatePool();
+  EXPECT_FALSE(pool->Take(KeyParams::RSA()));
+  EXPECT_EQ(0u, pool->GetStats().hits);
+  EXPECT_EQ(1u, pool->GetStats().misses);
+}
+
+TEST_F(RTCCertificatePoolTest, DropsCertificatesAboutToExpire) {
+  config_.min_remaining_lifetime_ms = kYearMs;
+  scoped_refptr<RTCCertificatePool> pool = CreatePool();
+  EXPECT_EQ_WAIT(2u, pool->GetStats().certificates_ready,
+                 kGenerationTimeoutMs);
+
+  EXPECT_FALSE(pool->Take(KeyParams::ECDSA()));
+  EXPECT_EQ(0u, pool->GetStats().hits);
+  EXPECT_EQ(1u, pool->GetStats().misses);
+}
+
+TEST_F(RTCCertificatePoolTest, GeneratorTakesCertificatesFromPool) {
+  scoped_refptr<RTCCertificatePool> pool = CreatePool();
+  EXPECT_EQ_WAIT(2u, pool->GetStats().certificates_ready,
+                 kGenerationTimeoutMs);
+  std::unique_ptr<Thread> worker_thread = Thread::Create();
+  ASSERT_TRUE(worker_thread->Start());
+  RTCCertificateGenerator generator(Thread::Current(), worker_thread.get(),
+                                    pool);
+
+  scoped_refptr<CertificateCallback> callback =
+      new RefCountedObject<CertificateCallback>();
+  generator.GenerateCertificateAsync(KeyParams::ECDSA(), absl::nullopt,
+                                     callback);
+  // The callback is invoked asynchronously even when the pool has a
+  // certificate ready.
+  EXPECT_FALSE(callback->completed());
+  EXPECT_TRUE_WAIT(callback->completed(), kGenerationTimeoutMs);
+  EXPECT_TRUE(callback->certificate());
+  EXPECT_EQ(1u, pool->GetStats().hits);
+
+  // Certificates with a specific expiration time are not taken from the pool.
+  callback = new RefCountedObject<CertificateCallback>();
+  generator.GenerateCertificateAsync(KeyParams::ECDSA(), 60000, callback);
+  EXPECT_TRUE_WAIT(callback->completed(), kGenerationTimeoutMs);
+  EXPECT_TRUE(callback->certificate());
+  EXPECT_EQ(1u, pool->GetStats().hits);
+  EXPECT_EQ(0u, pool->GetStats().misses);
+}
+
+}  // namespace rtc
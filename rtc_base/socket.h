@@ -118,6 +118,8 @@ class Socket {
     OPT_RTP_SENDTIME_EXTN_ID,  // This is a non-traditional socket option param.
                                // This is specific to libjingle and will be used
                                // if SendTime option is needed at socket level.
+    OPT_REUSEPORT,             // Whether other sockets may bind the same port
+                               // (SO_REUSEPORT). Must be set before Bind().
   };
   virtual int GetOption(Option opt, int* value) = 0;
   virtual int SetOption(Option opt, int value) = 0;
@@ -12,6 +12,7 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "rtc_base/buffer_queue.h"
 #include "rtc_base/checks.h"
@@ -201,6 +202,9 @@ class SSLDummyStreamBase : public rtc::StreamInterface,
                           size_t* written,
                           int* error) override;
 
+  // Signals that writing may succeed again after a write blocked.
+  void PostWritable() { PostEvent(rtc::SE_WRITE, 0); }
+
   void Close() override {
     RTC_LOG(LS_INFO) << "Closing outbound stream";
     out_->Close();
@@ -277,6 +281,27 @@ static const int kFifoBufferSize = 4096;
 static const int kBufferCapacity = 1;
 static const size_t kDefaultBufferSize = 2048;
 
+static const size_t kDtlsRecordHeaderSize = 13;
+static const uint8_t kDtlsContentTypeHandshake = 22;
+static const uint8_t kDtlsHandshakeTypeServerHello = 2;
+static const uint8_t kDtlsHandshakeTypeServerHelloDone = 14;
+
+// Returns the types of the handshake messages in the unencrypted DTLS
+// records of |packet|.
+static std::vector<uint8_t> GetDtlsHandshakeTypes(
+    const std::vector<uint8_t>& packet) {
+  std::vector<uint8_t> types;
+  size_t offset = 0;
+  while (offset + kDtlsRecordHeaderSize < packet.size()) {
+    size_t length = (packet[offset + 11] << 8) | packet[offset + 12];
+    if (packet[offset] == kDtlsContentTypeHandshake) {
+      types.push_back(packet[offset + kDtlsRecordHeaderSize]);
+    }
+    offset += kDtlsRecordHeaderSize + length;
+  }
+  return types;
+}
+
 class SSLStreamAdapterTestBase : public ::testing::Test,
                                  public sigslot::has_slots<> {
  public:
@@ -527,6 +552,17 @@ class SSLStreamAdapterTestBase : public ::testing::Test,
                                 size_t data_len,
                                 size_t* written,
                                 int* error) {
+    if (from == server_stream_) {
+      const uint8_t* bytes = static_cast<const uint8_t*>(data);
+      if (server_writes_to_block_ > 0) {
+        --server_writes_to_block_;
+        blocked_server_packets_.emplace_back(bytes, bytes + data_len);
+        from->PostWritable();
+        return rtc::SR_BLOCK;
+      }
+      server_packets_.emplace_back(bytes, bytes + data_len);
+    }
+
     // Randomly drop loss_ percent of packets
     if (rtc::CreateRandomId() % 100 < static_cast<uint32_t>(loss_)) {
       RTC_LOG(LS_VERBOSE) << "Randomly dropping packet, size=" << data_len;
@@ -564,6 +600,10 @@ class SSLStreamAdapterTestBase : public ::testing::Test,
 
   void SetLoss(int percent) { loss_ = percent; }
 
+  // Makes the next |count| writes of the server block. The server is told
+  // it can write again after each of them.
+  void BlockServerWrites(int count) { server_writes_to_block_ = count; }
+
   void SetDamage() { damage_ = true; }
 
   void SetMtu(size_t mtu) { mtu_ = mtu; }
@@ -646,6 +686,11 @@ class SSLStreamAdapterTestBase : public ::testing::Test,
   bool dtls_;
   int handshake_wait_;
   bool identities_set_;
+  // The packets written by the server, except the lost first packet and the
+  // blocked ones.
+  std::vector<std::vector<uint8_t>> server_packets_;
+  int server_writes_to_block_ = 0;
+  std::vector<std::vector<uint8_t>> blocked_server_packets_;
 };
 
 class SSLStreamAdapterTestTLS
@@ -1104,6 +1149,51 @@ TEST_P(SSLStreamAdapterTestDTLS, TestDTLSConnectWithLostFirstPacket) {
   TestHandshake();
 }
 
+// Test that a lost flight is retransmitted in fewer packets than it has
+// messages, rather than one packet per message.
+TEST_P(SSLStreamAdapterTestDTLS, TestDTLSRetransmittedFlightIsCoalesced) {
+  SetLoseFirstPacket(true);
+  TestHandshake();
+
+  // The server's first flight went in the lost first packet, so the
+  // retransmitted flight goes from the first packet that got through to the
+  // one with the ServerHelloDone.
+  ASSERT_FALSE(server_packets_.empty());
+  std::vector<uint8_t> types = GetDtlsHandshakeTypes(server_packets_[0]);
+  ASSERT_FALSE(types.empty());
+  EXPECT_EQ(kDtlsHandshakeTypeServerHello, types[0]);
+  size_t num_packets = 0;
+  std::set<uint8_t> messages;
+  for (const std::vector<uint8_t>& packet : server_packets_) {
+    types = GetDtlsHandshakeTypes(packet);
+    ++num_packets;
+    messages.insert(types.begin(), types.end());
+    if (messages.count(kDtlsHandshakeTypeServerHelloDone)) {
+      break;
+    }
+  }
+  ASSERT_TRUE(messages.count(kDtlsHandshakeTypeServerHelloDone));
+  EXPECT_GT(messages.size(), 1u);
+  EXPECT_LT(num_packets, messages.size());
+}
+
+// Test that a retransmitted flight the stream blocks on is kept in one packet,
+// which is written as soon as the stream is writable again.
+TEST_P(SSLStreamAdapterTestDTLS, TestDTLSBlockedRetransmittedFlightIsKept) {
+  SetLoseFirstPacket(true);
+  BlockServerWrites(1);
+  TestHandshake();
+
+  ASSERT_EQ(1u, blocked_server_packets_.size());
+  const std::vector<uint8_t>& blocked = blocked_server_packets_[0];
+  std::vector<uint8_t> types = GetDtlsHandshakeTypes(blocked);
+  ASSERT_FALSE(types.empty());
+  EXPECT_EQ(kDtlsHandshakeTypeServerHello, types.front());
+  EXPECT_EQ(kDtlsHandshakeTypeServerHelloDone, types.back());
+  ASSERT_FALSE(server_packets_.empty());
+  EXPECT_EQ(blocked, server_packets_[0]);
+}
+
 // Test a handshake with loss and delay
 TEST_P(SSLStreamAdapterTestDTLS, TestDTLSConnectWithLostFirstPacketDelay2s) {
   SetLoseFirstPacket(true);
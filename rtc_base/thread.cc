@@ -304,7 +304,6 @@ Thread::Thread(std::unique_ptr<SocketServer> ss)
 
 Thread::Thread(SocketServer* ss, bool do_init)
     : fPeekKeep_(false),
-      delayed_next_num_(0),
       fInitialized_(false),
       fDestroyed_(false),
       stop_(0),
@@ -420,14 +419,10 @@ bool Thread::Get(Message* pmsg, int cmsWait, bool process_io) {
         // triggered and calculate the next trigger time.
         if (first_pass) {
           first_pass = false;
-          while (!delayed_messages_.empty()) {
-            if (msCurrent < delayed_messages_.top().run_time_ms_) {
-              cmsDelayNext =
-                  TimeDiff(delayed_messages_.top().run_time_ms_, msCurrent);
-              break;
-            }
-            messages_.push_back(delayed_messages_.top().msg_);
-            delayed_messages_.pop();
+          delayed_messages_.PopExpired(msCurrent, &messages_);
+          int64_t run_time_ms;
+          if (delayed_messages_.GetNextRunTime(&run_time_ms)) {
+            cmsDelayNext = TimeDiff(run_time_ms, msCurrent);
           }
         }
         // Pull a message off the message queue, if available.
@@ -538,7 +533,7 @@ void Thread::DoDelayPost(const Location& posted_from,
   }
 
   // Keep thread safe
-  // Add to the priority queue. Gets sorted soonest first.
+  // Add to the timer wheel.
   // Signal for the multiplexer to return.
 
   {
@@ -548,13 +543,7 @@ void Thread::DoDelayPost(const Location& posted_from,
     msg.phandler = phandler;
     msg.message_id = id;
     msg.pdata = pdata;
-    DelayedMessage delayed(delay_ms, run_at_ms, delayed_next_num_, msg);
-    delayed_messages_.push(delayed);
-    // If this message queue processes 1 message every millisecond for 50 days,
-    // we will wrap this number.  Even then, only messages with identical times
-    // will be misordered, and then only briefly.  This is probably ok.
-    ++delayed_next_num_;
-    RTC_DCHECK_NE(0, delayed_next_num_);
+    delayed_messages_.Push(msg, run_at_ms, run_at_ms - delay_ms);
   }
   WakeUpSocketServer();
 }
@@ -565,8 +554,9 @@ int Thread::GetDelay() {
   if (!messages_.empty())
     return 0;
 
-  if (!delayed_messages_.empty()) {
-    int delay = TimeUntil(delayed_messages_.top().run_time_ms_);
+  int64_t run_time_ms;
+  if (delayed_messages_.GetNextRunTime(&run_time_ms)) {
+    int delay = TimeUntil(run_time_ms);
     if (delay < 0)
       delay = 0;
     return delay;
@@ -604,23 +594,9 @@ void Thread::ClearInternal(MessageHandler* phandler,
     }
   }
 
-  // Remove from priority queue. Not directly iterable, so use this approach
+  // Remove from the timer wheel, without visiting other handlers' messages
 
-  auto new_end = delayed_messages_.container().begin();
-  for (auto it = new_end; it != delayed_messages_.container().end(); ++it) {
-    if (it->msg_.Match(phandler, id)) {
-      if (removed) {
-        removed->push_back(it->msg_);
-      } else {
-        delete it->msg_.pdata;
-      }
-    } else {
-      *new_end++ = *it;
-    }
-  }
-  delayed_messages_.container().erase(new_end,
-                                      delayed_messages_.container().end());
-  delayed_messages_.reheap();
+  delayed_messages_.Clear(phandler, id, removed);
 }
 
 void Thread::Dispatch(Message* pmsg) {
@@ -17,8 +17,9 @@
 extern "C" {
 #endif
 
-// List of features in x86.
-typedef enum { kSSE2, kSSE3 } CPUFeature;
+// List of features in x86. kAVX2 also requires FMA3 and operating system
+// support for saving the AVX registers.
+typedef enum { kSSE2, kSSE3, kAVX2 } CPUFeature;
 
 // List of features in ARM.
 enum {
@@ -25,26 +25,41 @@ int GetCPUInfoNoASM(CPUFeature feature) {
 
 #if defined(WEBRTC_ARCH_X86_FAMILY)
 #ifndef _MSC_VER
-// Intrinsic for "cpuid".
+// Intrinsics for "cpuid", with and without a subleaf in ECX.
 #if defined(__pic__) && defined(__i386__)
-static inline void __cpuid(int cpu_info[4], int info_type) {
+static inline void __cpuidex(int cpu_info[4], int info_type, int info_index) {
   __asm__ volatile(
       "mov %%ebx, %%edi\n"
       "cpuid\n"
       "xchg %%edi, %%ebx\n"
       : "=a"(cpu_info[0]), "=D"(cpu_info[1]), "=c"(cpu_info[2]),
         "=d"(cpu_info[3])
-      : "a"(info_type));
+      : "a"(info_type), "c"(info_index));
 }
 #else
-static inline void __cpuid(int cpu_info[4], int info_type) {
+static inline void __cpuidex(int cpu_info[4], int info_type, int info_index) {
   __asm__ volatile("cpuid\n"
                    : "=a"(cpu_info[0]), "=b"(cpu_info[1]), "=c"(cpu_info[2]),
                      "=d"(cpu_info[3])
-                   : "a"(info_type));
+                   : "a"(info_type), "c"(info_index));
 }
 #endif
+static inline void __cpuid(int cpu_info[4], int info_type) {
+  __cpuidex(cpu_info, info_type, 0);
+}
 #endif  // _MSC_VER
+
+// Returns the value of the extended control register |xcr|. Only XCR0 is
+// defined, so |xcr| should be zero.
+static inline uint64_t xgetbv(uint32_t xcr) {
+#if defined(_MSC_VER)
+  return _xgetbv(xcr);
+#else
+  uint32_t eax, edx;
+  __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(xcr));
+  return (static_cast<uint64_t>(edx) << 32) | eax;
+#endif  // _MSC_VER
+}
 #endif  // WEBRTC_ARCH_X86_FAMILY
 
 #if defined(WEBRTC_ARCH_X86_FAMILY)
@@ -58,6 +73,24 @@ static int GetCPUInfo(CPUFeature feature) {
   if (feature == kSSE3) {
     return 0 != (cpu_info[2] & 0x00000001);
   }
+  if (feature == kAVX2) {
+    // AVX and FMA must be supported, and the operating system must save the
+    // SSE and AVX registers (OSXSAVE set and XCR0 bits 1 and 2 set).
+    // See http://software.intel.com/en-us/blogs/2011/04/14/is-avx-enabled
+    const bool avx_enabled = (cpu_info[2] & 0x10000000) != 0 &&
+                             (cpu_info[2] & 0x08000000) != 0 &&
+                             (xgetbv(0) & 0x00000006) == 6;
+    const bool fma = (cpu_info[2] & 0x00001000) != 0;
+    if (!avx_enabled || !fma) {
+      return 0;
+    }
+    __cpuid(cpu_info, 0);
+    if (cpu_info[0] < 7) {
+      return 0;
+    }
+    __cpuidex(cpu_info, 7, 0);
+    return 0 != (cpu_info[1] & 0x00000020);
+  }
   return 0;
 }
 #else